@@ -77,6 +77,12 @@ AIM_LOG_STRUCT_DEFINE(
 #define INDIGO_LOGLEVEL_VERBOSE 1
 #define INDIGO_LOGLEVEL_TRACE   2
 
+#define OFAGENT_STATS_INTERVAL_DEFAULT 1000
+#define OFAGENT_PORT_STATUS_WINDOW_DEFAULT 100
+#define OFAGENT_PORT_DAMPING_DEFAULT 0
+#define OFAGENT_RPC_WORKERS_DEFAULT 0
+#define OFAGENT_RPC_WINDOW_DEFAULT 64
+
 int ofagent_of_version = OF_VERSION_1_3;
 const char *argp_program_version;
 
@@ -85,6 +91,7 @@ static ind_cxn_config_t cxn_cfg;
 static ind_core_config_t core_cfg;
 
 static int sighup_eventfd;
+static int sigusr1_eventfd;
 static int sigterm_eventfd;
 
 static biglist_t *controllers = NULL;
@@ -93,6 +100,11 @@ static biglist_t *listeners = NULL;
 typedef struct
 {
   int           agentdebuglvl;
+  unsigned int  statsinterval;
+  unsigned int  portstatuswindow;
+  unsigned int  portdamping;
+  unsigned int  rpcworkers;
+  unsigned int  rpcwindow;
 #ifdef OFAGENT_APP
   int           debuglvl;
   int           debugComps[10]; // 10: TODO: update from OF Agent debug levels
@@ -107,6 +119,11 @@ static struct argp_option options[] =
   { "ofdpadebuglvl", 'd', "OFDPADEBUGLVL",  0, "The verbosity of OF-DPA debug messages.",                             0 },
   { "ofdpadebugcomp",'c', "OFPDACOMPONENT", 0, "The OF-DPA component for which debug messages are enabled.",          0 },
 #endif /* OFAGENT_APP */
+  { "statsinterval", 's', "MS",         0, "Port statistics refresh interval in ms; 0 reads OF-DPA on every request.", 0 },
+  { "portstatuswindow", 'w', "MS",      0, "Merge each port's events for this long before sending one port status.", 0 },
+  { "portdamping",   'p', "MS",         0, "Half-life of the port flap penalty in ms; 0 disables flap damping.", 0 },
+  { "rpcworkers",    'r', "COUNT",      0, "Threads making OF-DPA flow adds; 0 makes them synchronous.", 0 },
+  { "rpcwindow",     'i', "COUNT",      0, "OF-DPA flow adds queued or in progress at most.", 0 },
   { "controller", 't', "IP:PORT", 0,  "Controller" },
   { "listen",   'l',  "IP:PORT", 0,  "Listen" },
   { 0 }
@@ -186,6 +203,32 @@ sighup(int signum)
     }
 }
 
+static void
+sigusr1_callback(int socket_id, void *cookie,
+                 int read_ready, int write_ready, int error_seen)
+{
+    uint64_t x;
+    if (read(sigusr1_eventfd, &x, sizeof(x)) < 0) {
+        /* silence warn_unused_result */
+    }
+    AIM_LOG_MSG("Received SIGUSR1, reconciling with OF-DPA");
+
+    /* Resync with OF-DPA, e.g. after flows were removed behind our back */
+    ind_ofdpa_reconcile_stats_t stats;
+    if (ind_ofdpa_reconcile(&stats) < 0) {
+        AIM_LOG_ERROR("Failed to reconcile with OF-DPA");
+    }
+}
+
+static void
+sigusr1(int signum)
+{
+    uint64_t x = 1;
+    if (write(sigusr1_eventfd, &x, sizeof(x)) < 0) {
+        /* silence warn_unused_result */
+    }
+}
+
 static void
 sigterm_callback(int socket_id, void *cookie,
                  int read_ready, int write_ready, int error_seen)
@@ -258,6 +301,66 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
 
     break;
 
+    case 's':                           /* statsinterval */
+      errno = 0;
+
+      arguments->statsinterval = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid statsinterval \"%s\"", arg);
+        return errno;
+      }
+
+    break;
+
+    case 'w':                           /* portstatuswindow */
+      errno = 0;
+
+      arguments->portstatuswindow = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid portstatuswindow \"%s\"", arg);
+        return errno;
+      }
+
+    break;
+
+    case 'p':                           /* portdamping */
+      errno = 0;
+
+      arguments->portdamping = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid portdamping \"%s\"", arg);
+        return errno;
+      }
+
+    break;
+
+    case 'r':                           /* rpcworkers */
+      errno = 0;
+
+      arguments->rpcworkers = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid rpcworkers \"%s\"", arg);
+        return errno;
+      }
+
+    break;
+
+    case 'i':                           /* rpcwindow */
+      errno = 0;
+
+      arguments->rpcwindow = strtoul(arg, NULL, 0);
+      if ((errno != 0) || (arguments->rpcwindow == 0))
+      {
+        argp_error(state, "Invalid rpcwindow \"%s\"", arg);
+        return errno;
+      }
+
+    break;
+
     case 't':                           /* controller */
       errno = 0;
       controllers = biglist_append(controllers, arg);
@@ -479,8 +582,10 @@ int main(int argc, char *argv[])
   int j;
 #endif
   int i;
-  static char docBuffer[600];
+  static char docBuffer[2000];
   OFDPA_ERROR_t     rc;
+  ind_ofdpa_port_status_config_t portStatusConfig;
+  ind_ofdpa_rpc_config_t rpcConfig;
 
   /* Our argp parser. */
   struct argp argp =
@@ -493,6 +598,11 @@ int main(int argc, char *argv[])
   arguments_t arguments =
   {
     .agentdebuglvl   = 0,
+    .statsinterval   = OFAGENT_STATS_INTERVAL_DEFAULT,
+    .portstatuswindow = OFAGENT_PORT_STATUS_WINDOW_DEFAULT,
+    .portdamping     = OFAGENT_PORT_DAMPING_DEFAULT,
+    .rpcworkers      = OFAGENT_RPC_WORKERS_DEFAULT,
+    .rpcwindow       = OFAGENT_RPC_WINDOW_DEFAULT,
 #ifdef OFAGENT_APP
     .debuglvl   = 0,
     .debugComps = { 0 },
@@ -511,6 +621,11 @@ int main(int argc, char *argv[])
   i = strlen(docBuffer);
   i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "OFAGENTDEBUGLVL  = %d\n", 0);
   i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "Valid OF Agent debug levels are 0 - %d.\n", 2);
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "STATSINTERVAL  = %d ms\n", OFAGENT_STATS_INTERVAL_DEFAULT);
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "PORTSTATUSWINDOW  = %d ms\n", OFAGENT_PORT_STATUS_WINDOW_DEFAULT);
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "PORTDAMPING  = %d ms\n", OFAGENT_PORT_DAMPING_DEFAULT);
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "RPCWORKERS  = %d\n", OFAGENT_RPC_WORKERS_DEFAULT);
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "RPCWINDOW  = %d\n", OFAGENT_RPC_WINDOW_DEFAULT);
 #ifdef OFAGENT_APP
   i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "OFDPADEBUGLVL  = %d\n", 0);
   i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "Valid OF-DPA debug levels are 0 - %d.\n", 0);
@@ -526,6 +641,7 @@ int main(int argc, char *argv[])
     }
   }
 #endif
+  i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "Send SIGUSR1 to reconcile the flow and group tables with OF-DPA.\n");
   i += snprintf(&docBuffer[i], sizeof(docBuffer) - i, "\n");
 
   AIM_LOG_STRUCT_REGISTER();
@@ -737,6 +853,16 @@ int main(int argc, char *argv[])
       abort();
   }
 
+  /* The SIGUSR1 handler triggers sigusr1_callback to run in the main loop. */
+  if ((sigusr1_eventfd = eventfd(0, 0)) < 0) {
+      AIM_LOG_FATAL("Failed to allocate eventfd");
+      abort();
+  }
+  signal(SIGUSR1, sigusr1);
+  if (ind_soc_socket_register(sigusr1_eventfd, sigusr1_callback, NULL) < 0) {
+      abort();
+  }
+
   /* The SIGTERM handler triggers sigterm_callback to run in the main loop. */
   if ((sigterm_eventfd = eventfd(0, 0)) < 0) {
       AIM_LOG_FATAL("Failed to allocate eventfd");
@@ -747,6 +873,28 @@ int main(int argc, char *argv[])
       abort();
   }
 
+  portStatusConfig.windowMs = arguments.portstatuswindow;
+  portStatusConfig.dampHalfLifeMs = arguments.portdamping;
+  ind_ofdpa_port_status_config_set(&portStatusConfig);
+
+  /* Port events keep the cache current from here on */
+  if (ind_ofdpa_port_desc_cache_init() < 0)
+  {
+    AIM_LOG_ERROR("Failed to cache port descriptions; reading OF-DPA per request");
+  }
+
+  /* Flow mods keep the table entry counts current from here on */
+  if (ind_ofdpa_table_stats_init() < 0)
+  {
+    AIM_LOG_ERROR("Failed to read flow table sizes; reading OF-DPA per request");
+  }
+
+  /* Table features include the table sizes, so are encoded after them */
+  if (ind_ofdpa_table_features_init() < 0)
+  {
+    AIM_LOG_ERROR("Failed to encode table features; encoding on first request");
+  }
+
   if (ind_soc_socket_register(ofdpaClientEventSockFdGet(), ind_ofdpa_event_socket_ready, NULL) < 0)
   {
     return 1;
@@ -757,11 +905,31 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (ind_ofdpa_port_stats_cache_init(arguments.statsinterval) < 0)
+  {
+    AIM_LOG_ERROR("Failed to start port stats cache; reading OF-DPA per request");
+  }
+
+  /* Flow adds complete through the socket manager from here on */
+  rpcConfig.workers = arguments.rpcworkers;
+  rpcConfig.window = arguments.rpcwindow;
+  if (ind_ofdpa_rpc_init(&rpcConfig) < 0)
+  {
+    AIM_LOG_ERROR("Failed to start OF-DPA workers; making flow adds synchronously");
+  }
+
   ind_soc_select_and_run(-1);
 
   AIM_LOG_MSG("Stopping %s", argp_program_version);
 
+  /* The last flow adds are reported before the state manager goes */
+  ind_ofdpa_rpc_finish();
+  ind_ofdpa_port_stats_cache_finish();
+  ind_ofdpa_port_status_finish();
+  ind_ofdpa_port_desc_cache_finish();
   ind_core_finish();
+  ind_ofdpa_table_features_finish();
+  ind_ofdpa_table_stats_finish();
   ind_cxn_finish();
   ind_soc_finish();
   return 0;
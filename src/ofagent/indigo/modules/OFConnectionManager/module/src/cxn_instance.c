@@ -133,7 +133,6 @@ static void
 cleanup_disconnect(connection_t *cxn)
 {
     uint8_t *data;
-    biglist_t *ble;
 
     cxn->status.disconnect_count++;
 
@@ -151,12 +150,10 @@ cleanup_disconnect(connection_t *cxn)
                 cxn->read_bytes);
     cxn->read_bytes = 0;
     /* Clear write queue */
-    BIGLIST_FOREACH_DATA(ble, cxn->output_list, uint8_t *, data) {
+    while ((data = biglist_deque_pop_head(&cxn->output_list)) != NULL) {
         LOG_TRACE(cxn, "Freeing outgoing msg %p", data);
         INDIGO_MEM_FREE(data);
     }
-    biglist_free(cxn->output_list);
-    cxn->output_list = NULL;
 
     cxn->bytes_enqueued = 0;
     cxn->pkts_enqueued = 0;
@@ -1207,7 +1204,7 @@ ind_cxn_process_write_buffer(connection_t *cxn)
     struct iovec *iov;
 
     /* Iterate over cxn->output_list adding buffers to iovecs */
-    cur_node = cxn->output_list;
+    cur_node = cxn->output_list.head;
     while (cur_node != NULL && num_iovecs < MAX_WRITE_MSGS) {
         iov = &iovecs[num_iovecs];
         iov->iov_base = BIGLIST_CAST(void *, cur_node);
@@ -1237,7 +1234,6 @@ ind_cxn_process_write_buffer(connection_t *cxn)
     iov = iovecs;
     while (left > 0) {
         int to_write, bytes_out;
-        cur_node = cxn->output_list;
 
         /* Number of bytes we attempted to send in this message */
         to_write = iov->iov_len;
@@ -1247,9 +1243,7 @@ ind_cxn_process_write_buffer(connection_t *cxn)
         cxn->bytes_enqueued -= bytes_out;
 
         if (bytes_out == to_write) { /* Completed this message */
-            INDIGO_MEM_FREE(BIGLIST_CAST(void *, cur_node));
-            cur_node = cxn->output_list =
-                biglist_remove_link_free(cxn->output_list, cur_node);
+            INDIGO_MEM_FREE(biglist_deque_pop_head(&cxn->output_list));
             cxn->pkts_enqueued--;
             cxn->status.messages_out++;
             cxn->output_head_offset = 0;
@@ -1264,7 +1258,7 @@ ind_cxn_process_write_buffer(connection_t *cxn)
         iov++;
     }
 
-    if (cxn->output_list == NULL) { /* Nothing (more) to send */
+    if (cxn->output_list.head == NULL) { /* Nothing (more) to send */
         LOG_TRACE(cxn, "No more data to write");
         INDIGO_ASSERT(cxn->bytes_enqueued == 0);
         INDIGO_ASSERT(cxn->pkts_enqueued == 0);
@@ -1307,7 +1301,9 @@ ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len)
                   len, msg_len);
         return INDIGO_ERROR_UNKNOWN;
     }
-    cxn->output_list = biglist_append(cxn->output_list, (void *)data);
+    if (biglist_deque_push_tail(&cxn->output_list, (void *)data) == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
     cxn->bytes_enqueued += len;
     cxn->pkts_enqueued += 1;
 
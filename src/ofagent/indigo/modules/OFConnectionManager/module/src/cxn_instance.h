@@ -31,6 +31,7 @@
 #include <loci/loci.h>
 #include <OFConnectionManager/ofconnectionmanager.h>
 #include <BigList/biglist.h>
+#include <BigList/biglist_deque.h>
 
 #define READ_BUFFER_SIZE (64 * 1024)
 
@@ -80,7 +81,7 @@ typedef struct connection_s {
     int bytes_needed; /* Num bytes needed for next process step */
 
     /* Write queue */
-    biglist_t *output_list; /* List of outgoing messages */
+    biglist_deque_t output_list; /* Queue of outgoing messages */
     int output_head_offset; /* Bytes already sent out from head of output_list */
     int bytes_enqueued;     /* Total bytes queued */
     int pkts_enqueued;      /* Total pkts queued */
@@ -1056,8 +1056,15 @@ ind_cxn_enable_get(int *enable)
 indigo_error_t
 ind_cxn_finish(void)
 {
+    int idx;
+
     LOG_TRACE("Indigo connection manager fini");
     ind_cxn_enable_set(0);
+
+    /* Release the pooled write queue links */
+    for (idx = 0; idx < MAX_CONTROLLER_CONNECTIONS; ++idx) {
+        biglist_deque_denit(&connection[idx].output_list);
+    }
     return INDIGO_ERROR_NONE;
 }
 
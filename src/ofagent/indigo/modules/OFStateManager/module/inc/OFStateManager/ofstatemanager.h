@@ -118,6 +118,104 @@ void ind_core_ft_stats(aim_pvs_t* pvs);
  */
 void ind_core_flow_expiry_handler(indigo_flow_id_t id, 
                                   indigo_fi_flow_removed_t reason);
+
+/**
+ * Reconciliation with forwarding
+ *
+ * A flow digest covers one table and splits the id space into
+ * IND_CORE_FLOW_DIGEST_LEAVES leaves. Each leaf holds an order
+ * independent sum of the hashes of the flows whose ids fall in it, each
+ * hash covering the id and a hash of the flow's content, and the root
+ * hashes the leaves. Forwarding hashes the content of the flows it
+ * holds and builds the same digest with ind_core_flow_digest_add; it
+ * hashes the state manager's flows the same way from the flow add
+ * that would create each one. Only tables whose roots differ, and only
+ * their differing leaves, need to be compared flow by flow.
+ */
+
+#define IND_CORE_FLOW_DIGEST_LEAVES 64
+
+typedef struct ind_core_flow_digest_s {
+    uint32_t count;
+    uint64_t leaves[IND_CORE_FLOW_DIGEST_LEAVES];
+    uint64_t root;
+} ind_core_flow_digest_t;
+
+/**
+ * Returns nonzero if forwarding holds the flow or group with this id
+ */
+typedef int (*ind_core_present_f)(uint64_t id, void *cookie);
+
+/**
+ * Returns the hash of the content forwarding would hold for the flow
+ * added by flow_add
+ */
+typedef uint64_t (*ind_core_flow_hash_f)(of_flow_add_t *flow_add);
+
+/**
+ * Returns nonzero if forwarding holds the flow with this id and
+ * content hash
+ */
+typedef int (*ind_core_flow_present_f)(indigo_flow_id_t id, uint64_t hash,
+                                       void *cookie);
+
+/**
+ * Leaf a flow id falls in
+ */
+int ind_core_flow_digest_leaf(indigo_flow_id_t id);
+
+/**
+ * Add a flow to a digest; the digest must start zeroed
+ */
+void ind_core_flow_digest_add(ind_core_flow_digest_t *digest,
+                              indigo_flow_id_t id, uint64_t hash);
+
+/**
+ * Compute the root of a digest once all flows are added
+ */
+void ind_core_flow_digest_finish(ind_core_flow_digest_t *digest);
+
+/**
+ * Digest of the flow table entries in table_id, their content hashed
+ * with hash
+ */
+void ind_core_flow_digest_get(uint8_t table_id, ind_core_flow_hash_f hash,
+                              ind_core_flow_digest_t *digest);
+
+/**
+ * Whether the flow table holds a flow with this id
+ */
+int ind_core_flow_id_present(indigo_flow_id_t id);
+
+/**
+ * Remove flow table entries that forwarding no longer holds as they are
+ *
+ * @param table_id Table to reconcile
+ * @param leaf_mask Bit n set if leaf n of the table's digests differs
+ * @param hash Hashes the content of each entry in those leaves
+ * @param present Called for each entry in those leaves with its hash
+ * @param cookie Passed to present
+ * @returns The number of entries removed
+ *
+ * Entries are removed without calling forwarding; a flow-removed
+ * message is sent if the controller asked for one. Forwarding deletes
+ * its own copy of an entry removed for differing content.
+ */
+int ind_core_flow_reconcile(uint8_t table_id, uint64_t leaf_mask,
+                            ind_core_flow_hash_f hash,
+                            ind_core_flow_present_f present, void *cookie);
+
+/**
+ * Whether the group table holds a group with this id
+ */
+int ind_core_group_id_present(uint32_t id);
+
+/**
+ * Remove group table entries that forwarding no longer holds
+ *
+ * @returns The number of groups removed
+ */
+int ind_core_group_reconcile(ind_core_present_f present, void *cookie);
 #endif
 
 #endif /* __OFSTATEMANAGER_H__ */
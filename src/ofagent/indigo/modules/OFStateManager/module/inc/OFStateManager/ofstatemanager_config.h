@@ -119,6 +119,16 @@
 #define OFSTATEMANAGER_CONFIG_DPID_DEFAULT 55930
 #endif
 
+/**
+ * OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT
+ *
+ * Number of buckets in the group id hash table */
+
+
+#ifndef OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT
+#define OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT 4096
+#endif
+
 
 
 /**
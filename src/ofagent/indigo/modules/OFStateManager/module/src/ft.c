@@ -29,9 +29,10 @@
 #include "ofstatemanager_log.h"
 #include "ft.h"
 
-static indigo_error_t ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p);
+static indigo_error_t ft_entry_create(ft_instance_t ft, indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p);
 static void ft_entry_destroy(ft_instance_t ft, ft_entry_t *entry);
-static indigo_error_t ft_entry_set_effects(ft_entry_t *entry, of_flow_modify_t *flow_mod);
+static indigo_error_t ft_entry_set_effects(ft_instance_t ft, ft_entry_t *entry, of_flow_modify_t *flow_mod);
+static void ft_effects_release(ft_instance_t ft, ft_effects_t *ref);
 static void ft_entry_link(ft_instance_t ft, ft_entry_t *entry);
 static void ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry);
 static int ft_entry_has_out_port(ft_entry_t *entry, of_port_no_t port);
@@ -67,6 +68,246 @@ ft_cookie_to_bucket_index(ft_instance_t ft, uint64_t cookie)
     return cookie >> (64-FT_COOKIE_PREFIX_LEN);
 }
 
+static int
+ft_effects_to_bucket_index(ft_instance_t ft, uint32_t hash)
+{
+    return hash % FT_EFFECTS_BUCKET_COUNT;
+}
+
+/****************************************************************
+ * Compact match storage
+ *
+ * See ft_entry.h.  The word view of of_match_fields_t is the one used
+ * by the LOCI match comparison kernels.
+ ****************************************************************/
+
+/* One bit per word in ft_entry_t.match_present */
+AIM_STATIC_ASSERT(FT_MATCH_WORDS, OF_MATCH_FIELDS_WORDS <= 64);
+
+#define FT_MATCH_WORD_PRESENT(_entry, _idx) \
+    ((_entry)->match_present & ((uint64_t)1 << (_idx)))
+
+/**
+ * Count the words of a match that need storing and build their bitmap
+ */
+static int
+ft_match_compact_count(of_match_t *match, uint64_t *present)
+{
+    const of_match_word_t *f = (const of_match_word_t *)&match->fields;
+    const of_match_word_t *m = (const of_match_word_t *)&match->masks;
+    int idx, count = 0;
+
+    *present = 0;
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        if (f[idx] | m[idx]) {
+            *present |= (uint64_t)1 << idx;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Store a match into an entry allocated with room for its words
+ */
+static void
+ft_match_compact_set(ft_entry_t *entry, of_match_t *match,
+                     uint64_t present, int count)
+{
+    const of_match_word_t *f = (const of_match_word_t *)&match->fields;
+    const of_match_word_t *m = (const of_match_word_t *)&match->masks;
+    int idx, k = 0;
+
+    entry->match_version = match->version;
+    entry->match_present = present;
+    entry->match_count = count;
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        if (FT_MATCH_WORD_PRESENT(entry, idx)) {
+            entry->match_words[k] = f[idx];
+            entry->match_words[count + k] = m[idx];
+            k++;
+        }
+    }
+}
+
+void
+ft_entry_match_get(ft_entry_t *entry, of_match_t *match)
+{
+    of_match_word_t *f = (of_match_word_t *)&match->fields;
+    of_match_word_t *m = (of_match_word_t *)&match->masks;
+    int idx, k = 0;
+
+    INDIGO_MEM_SET(match, 0, sizeof(*match));
+    match->version = entry->match_version;
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        if (FT_MATCH_WORD_PRESENT(entry, idx)) {
+            f[idx] = entry->match_words[k];
+            m[idx] = entry->match_words[entry->match_count + k];
+            k++;
+        }
+    }
+}
+
+/*
+ * The comparisons below are of_match_more_specific, of_match_eq and
+ * of_match_overlap with the entry side read from its compact form;
+ * absent words are zero.  Violation bits are accumulated and tested
+ * once at the end.
+ */
+
+static int
+ft_entry_match_more_specific(ft_entry_t *entry, of_match_t *query)
+{
+    const of_match_word_t *q_f = (const of_match_word_t *)&query->fields;
+    const of_match_word_t *q_m = (const of_match_word_t *)&query->masks;
+    uint64_t acc = 0;
+    uint64_t e_f, e_m;
+    int idx, k = 0;
+
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        e_f = e_m = 0;
+        if (FT_MATCH_WORD_PRESENT(entry, idx)) {
+            e_f = entry->match_words[k];
+            e_m = entry->match_words[entry->match_count + k];
+            k++;
+        }
+        acc |= ~e_m & q_m[idx];
+        acc |= (e_f ^ q_f[idx]) & q_m[idx];
+    }
+
+    return acc == 0;
+}
+
+static int
+ft_entry_match_eq(ft_entry_t *entry, of_match_t *query)
+{
+    const of_match_word_t *q_f = (const of_match_word_t *)&query->fields;
+    const of_match_word_t *q_m = (const of_match_word_t *)&query->masks;
+    uint64_t acc = 0;
+    uint64_t e_f, e_m;
+    int idx, k = 0;
+
+    if (entry->match_version != query->version) {
+        return 0;
+    }
+
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        e_f = e_m = 0;
+        if (FT_MATCH_WORD_PRESENT(entry, idx)) {
+            e_f = entry->match_words[k];
+            e_m = entry->match_words[entry->match_count + k];
+            k++;
+        }
+        acc |= (e_f ^ q_f[idx]) | (e_m ^ q_m[idx]);
+    }
+
+    return acc == 0;
+}
+
+static int
+ft_entry_match_overlap(ft_entry_t *entry, of_match_t *query)
+{
+    const of_match_word_t *q_f = (const of_match_word_t *)&query->fields;
+    const of_match_word_t *q_m = (const of_match_word_t *)&query->masks;
+    uint64_t acc = 0;
+    int idx, k = 0;
+
+    /* Absent words have a zero mask and cannot differentiate */
+    for (idx = 0; idx < OF_MATCH_FIELDS_WORDS; idx++) {
+        if (FT_MATCH_WORD_PRESENT(entry, idx)) {
+            acc |= (entry->match_words[k] ^ q_f[idx]) &
+                entry->match_words[entry->match_count + k] & q_m[idx];
+            k++;
+        }
+    }
+
+    return acc == 0;
+}
+
+/****************************************************************
+ * Interned effects
+ *
+ * Flows programmed for bridging and routing very often carry identical
+ * instruction lists.  Each distinct list (by version and wire data) is
+ * kept once per flow table and reference counted.
+ ****************************************************************/
+
+static uint32_t
+ft_effects_hash(of_object_t *list)
+{
+    uint32_t h = FT_HASH_SEED;
+    h = murmur_hash(&list->version, sizeof(list->version), h);
+    h = murmur_hash(OF_OBJECT_BUFFER_INDEX(list, 0), list->length, h);
+    return h;
+}
+
+/**
+ * Find or create the interned record for a list
+ *
+ * Takes ownership of list; if an identical one is already interned, list
+ * is freed and the existing record returned.  Returns NULL on allocation
+ * failure, in which case list has been freed as well.
+ */
+static ft_effects_t *
+ft_effects_intern(ft_instance_t ft, of_object_t *list)
+{
+    uint32_t hash = ft_effects_hash(list);
+    list_head_t *bucket =
+        &ft->effects_buckets[ft_effects_to_bucket_index(ft, hash)];
+    list_links_t *cur;
+    ft_effects_t *ref;
+
+    LIST_FOREACH(bucket, cur) {
+        ref = container_of(cur, links, ft_effects_t);
+        if (ref->hash == hash &&
+                ref->list->version == list->version &&
+                ref->list->object_id == list->object_id &&
+                ref->list->length == list->length &&
+                !INDIGO_MEM_COMPARE(OF_OBJECT_BUFFER_INDEX(ref->list, 0),
+                                OF_OBJECT_BUFFER_INDEX(list, 0),
+                                list->length)) {
+            of_object_delete(list);
+            ref->refcount += 1;
+            return ref;
+        }
+    }
+
+    if ((ref = INDIGO_MEM_ALLOC(sizeof(*ref))) == NULL) {
+        of_object_delete(list);
+        return NULL;
+    }
+    ref->hash = hash;
+    ref->refcount = 1;
+    ref->list = list;
+    list_push(bucket, &ref->links);
+
+    ft->status.effects_lists += 1;
+    ft->status.effects_bytes += sizeof(*ref) + list->length;
+
+    return ref;
+}
+
+static void
+ft_effects_release(ft_instance_t ft, ft_effects_t *ref)
+{
+    if (ref == NULL) {
+        return;
+    }
+
+    INDIGO_ASSERT(ref->refcount > 0);
+    if (--ref->refcount > 0) {
+        return;
+    }
+
+    ft->status.effects_lists -= 1;
+    ft->status.effects_bytes -= sizeof(*ref) + ref->list->length;
+
+    list_remove(&ref->links);
+    of_object_delete(ref->list);
+    INDIGO_MEM_FREE(ref);
+}
+
 ft_instance_t
 ft_create(ft_config_t *config)
 {
@@ -122,6 +363,18 @@ ft_create(ft_config_t *config)
         list_init(&ft->cookie_buckets[idx]);
     }
 
+    bytes = sizeof(list_head_t) * FT_EFFECTS_BUCKET_COUNT;
+    ft->effects_buckets = INDIGO_MEM_ALLOC(bytes);
+    if (ft->effects_buckets == NULL) {
+        LOG_ERROR("ERROR: Flow table, effects bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+    INDIGO_MEM_SET(ft->effects_buckets, 0, bytes);
+    for (idx = 0; idx < FT_EFFECTS_BUCKET_COUNT; idx++) {
+        list_init(&ft->effects_buckets[idx]);
+    }
+
     return ft;
 }
 
@@ -170,6 +423,11 @@ ft_destroy(ft_instance_t ft)
         INDIGO_MEM_FREE(ft->cookie_buckets);
         ft->cookie_buckets = NULL;
     }
+    if (ft->effects_buckets != NULL) {
+        INDIGO_ASSERT(ft->status.effects_lists == 0);
+        INDIGO_MEM_FREE(ft->effects_buckets);
+        ft->effects_buckets = NULL;
+    }
 
     INDIGO_MEM_FREE(ft);
 }
@@ -188,7 +446,7 @@ ft_add(ft_instance_t ft, indigo_flow_id_t id,
         return INDIGO_ERROR_EXISTS;
     }
 
-    if ((rv = ft_entry_create(id, flow_add, &entry)) < 0) {
+    if ((rv = ft_entry_create(ft, id, flow_add, &entry)) < 0) {
         return rv;
     }
 
@@ -300,7 +558,7 @@ ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
     switch (query->mode) {
     case OF_MATCH_NON_STRICT:
         /* Check if the entry's match is more specific than the query's */
-        if (!of_match_more_specific(&entry->match, &query->match)) {
+        if (!ft_entry_match_more_specific(entry, &query->match)) {
             break;
         }
         if (query->out_port != OF_PORT_DEST_WILDCARD) {
@@ -311,7 +569,7 @@ ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
         rv = 1;
         break;
     case OF_MATCH_STRICT:
-        if (!of_match_eq(&entry->match, &query->match)) {
+        if (!ft_entry_match_eq(entry, &query->match)) {
             break;
         }
         if (query->out_port != OF_PORT_DEST_WILDCARD) {
@@ -326,7 +584,7 @@ ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
         rv = 1;
         break;
     case OF_MATCH_OVERLAP:
-        if (!of_match_overlap(&entry->match, &query->match)) {
+        if (!ft_entry_match_overlap(entry, &query->match)) {
             break;
         }
         rv = 1;
@@ -350,7 +608,7 @@ ft_entry_modify_effects(ft_instance_t instance,
     LOG_TRACE("Modifying effects of entry " INDIGO_FLOW_ID_PRINTF_FORMAT,
               entry->id);
 
-    err = ft_entry_set_effects(entry, flow_mod);
+    err = ft_entry_set_effects(instance, entry, flow_mod);
     if (err == INDIGO_ERROR_NONE) {
         instance->status.updates += 1;
     }
@@ -529,6 +787,7 @@ ft_iterator_cleanup(ft_iterator_t *iter)
 static void
 ft_entry_link(ft_instance_t ft, ft_entry_t *entry)
 {
+    of_match_t match;
     int idx;
 
     if (ft == NULL || entry == NULL) {
@@ -540,7 +799,8 @@ ft_entry_link(ft_instance_t ft, ft_entry_t *entry)
     list_push(&ft->all_list, &entry->table_links);
 
     if (ft->strict_match_buckets) { /* Strict match hash */
-        idx = ft_strict_match_to_bucket_index(ft, &entry->match, entry->priority);
+        ft_entry_match_get(entry, &match);
+        idx = ft_strict_match_to_bucket_index(ft, &match, entry->priority);
         list_push(&ft->strict_match_buckets[idx], &entry->strict_match_links);
     }
     if (ft->flow_id_buckets) { /* Flow ID hash */
@@ -579,8 +839,12 @@ ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry)
     list_remove(&entry->table_links);
 
     if (ft->strict_match_buckets) { /* Strict match hash */
+#if !defined(FT_NO_ERROR_CHECKING)
+        of_match_t match;
+        ft_entry_match_get(entry, &match);
         INDIGO_ASSERT(!list_empty(&ft->strict_match_buckets[
-            ft_strict_match_to_bucket_index(ft, &entry->match, entry->priority)]));
+            ft_strict_match_to_bucket_index(ft, &match, entry->priority)]));
+#endif
         list_remove(&entry->strict_match_links);
     }
     if (ft->flow_id_buckets) { /* Flow ID hash */
@@ -598,6 +862,7 @@ ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry)
 /**
  * Allocate and initialize a new flowtable entry
  *
+ * @param ft The flow table the entry is created for
  * @param id The flow ID to use
  * @param flow_add Pointer to the flow add object for the entry
  * @param_p entry Populated with pointer to new flowtable entry on success
@@ -605,35 +870,45 @@ ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry)
  * The list links are not modified by this call.
  */
 static indigo_error_t
-ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p)
+ft_entry_create(ft_instance_t ft, indigo_flow_id_t id, of_flow_add_t *flow_add,
+                ft_entry_t **entry_p)
 {
     indigo_error_t err;
     ft_entry_t *entry;
+    of_match_t match;
+    uint64_t present;
+    int count;
+    int bytes;
 
-    entry = INDIGO_MEM_ALLOC(sizeof(*entry));
+    if (of_flow_add_match_get(flow_add, &match) < 0) {
+        return INDIGO_ERROR_UNKNOWN;
+    }
+    count = ft_match_compact_count(&match, &present);
+
+    bytes = sizeof(*entry) + 2 * count * sizeof(uint64_t);
+    entry = INDIGO_MEM_ALLOC(bytes);
     if (entry == NULL) {
         return INDIGO_ERROR_RESOURCE;
     }
-    INDIGO_MEM_SET(entry, 0, sizeof(*entry));
+    INDIGO_MEM_SET(entry, 0, bytes);
 
     entry->id = id;
+    ft_match_compact_set(entry, &match, present, count);
 
-    if (of_flow_add_match_get(flow_add, &entry->match) < 0) {
-        INDIGO_MEM_FREE(entry);
-        return INDIGO_ERROR_UNKNOWN;
-    }
     of_flow_add_cookie_get(flow_add, &entry->cookie);
     of_flow_add_priority_get(flow_add, &entry->priority);
     of_flow_add_flags_get(flow_add, &entry->flags);
     of_flow_add_idle_timeout_get(flow_add, &entry->idle_timeout);
     of_flow_add_hard_timeout_get(flow_add, &entry->hard_timeout);
 
-    err = ft_entry_set_effects(entry, flow_add);
+    err = ft_entry_set_effects(ft, entry, flow_add);
     if (err != INDIGO_ERROR_NONE) {
         INDIGO_MEM_FREE(entry);
         return err;
     }
 
+    ft->status.entry_bytes += bytes;
+
     entry->insert_time = INDIGO_CURRENT_TIME;
     entry->last_counter_change = entry->insert_time;
 
@@ -652,38 +927,46 @@ ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry
 static void
 ft_entry_destroy(ft_instance_t ft, ft_entry_t *entry)
 {
-    if (entry->effects.actions != NULL) {
-        of_list_action_delete(entry->effects.actions);
-        entry->effects.actions = NULL;
-    }
+    ft_effects_release(ft, entry->effects_ref);
+    entry->effects_ref = NULL;
+    entry->effects.actions = NULL;
+
+    ft->status.entry_bytes -=
+        sizeof(*entry) + 2 * entry->match_count * sizeof(uint64_t);
 
     INDIGO_MEM_FREE(entry);
 }
 
 /* Populate the output port list and effects */
 static indigo_error_t
-ft_entry_set_effects(ft_entry_t *entry,
-                    of_flow_modify_t *flow_mod)
+ft_entry_set_effects(ft_instance_t ft, ft_entry_t *entry,
+                     of_flow_modify_t *flow_mod)
 {
+    of_object_t *list;
+    ft_effects_t *ref;
+
     if (flow_mod->version == OF_VERSION_1_0)
     {
-        of_list_action_t *actions;
-        if ((actions = of_flow_modify_actions_get(flow_mod)) == NULL) {
+        if ((list = of_flow_modify_actions_get(flow_mod)) == NULL) {
             LOG_ERROR("Could not get action list");
             return INDIGO_ERROR_RESOURCE;
         }
-        of_list_action_delete(entry->effects.actions);
-        entry->effects.actions = actions;
     } else {
-        of_list_instruction_t *instructions;
-        if ((instructions = of_flow_modify_instructions_get(flow_mod)) == NULL) {
+        if ((list = of_flow_modify_instructions_get(flow_mod)) == NULL) {
             LOG_ERROR("Could not get instruction list");
             return INDIGO_ERROR_RESOURCE;
         }
-        of_list_instruction_delete(entry->effects.instructions);
-        entry->effects.instructions = instructions;
     }
 
+    if ((ref = ft_effects_intern(ft, list)) == NULL) {
+        LOG_ERROR("Could not intern effects list");
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    ft_effects_release(ft, entry->effects_ref);
+    entry->effects_ref = ref;
+    entry->effects.actions = ref->list;
+
     return INDIGO_ERROR_NONE;
 }
 
@@ -62,6 +62,11 @@
 #define FT_COOKIE_PREFIX_LEN 8
 #define FT_COOKIE_PREFIX_MASK (~(uint64_t)0 << (64-FT_COOKIE_PREFIX_LEN))
 
+/**
+ * Number of buckets for the interned effects hash table.
+ */
+#define FT_EFFECTS_BUCKET_COUNT 1024
+
 /**
  * Forward declaration of flowtable handle for other typedefs
  */
@@ -105,6 +110,10 @@ typedef struct ft_config_s {
  * in the table.
  * @param forwarding_add_errors Number of adds that failed due to a
  * failure in the forwarding layer.
+ * @param entry_bytes Memory held by the current entries, including
+ * their compact matches
+ * @param effects_lists Number of distinct interned effects lists
+ * @param effects_bytes Memory held by the interned effects lists
  */
 
 typedef struct ft_status_s {
@@ -116,6 +125,9 @@ typedef struct ft_status_s {
     uint64_t updates;
     uint64_t table_full_errors;
     uint64_t forwarding_add_errors;
+    uint64_t entry_bytes;
+    uint64_t effects_lists;
+    uint64_t effects_bytes;
 } ft_status_t;
 
 /**
@@ -133,6 +145,7 @@ struct ft_public_s {
     list_head_t *strict_match_buckets;  /* Array of strict match based buckets */
     list_head_t *flow_id_buckets;  /* Array of flow_id based buckets */
     list_head_t *cookie_buckets;   /* Array of cookie (prefix) based buckets */
+    list_head_t *effects_buckets;  /* Array of interned effects buckets */
 };
 
 #define FT_CONFIG(_ft) (&(_ft)->config)
@@ -252,6 +265,15 @@ indigo_error_t ft_strict_match(ft_instance_t instance,
 ft_entry_t *
 ft_lookup(ft_instance_t ft, indigo_flow_id_t id);
 
+/**
+ * Rebuild the full match structure of a flow entry
+ * @param entry The entry
+ * @param match (out) Populated with the match from the original add
+ */
+
+void
+ft_entry_match_get(ft_entry_t *entry, of_match_t *match);
+
 /**
  * Modify the effects of a flow entry in the table
  * @param ft The flow table handle
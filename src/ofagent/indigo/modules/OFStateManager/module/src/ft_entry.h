@@ -34,13 +34,16 @@
  * The data in a flow table entry
  *
  * @param id The externally determined flow ID; primary key
- * @param match The match structure recorded from the original add
+ * @param match_version OF version of the match from the original add
+ * @param match_count Number of match words stored; see match_words
+ * @param match_present Bitmap of the of_match_fields_t words stored
  * @param priority The priority, from the original add
  * @param idle_timeout The idle_timeout, from the original add
  * @param hard_timeout The hard_timeout, from the original add
  * @param cookie The cookie, from the original or as updated
  * @param effects The actions or instructions from the add or as updated.
  * See below.
+ * @param effects_ref The interned effects record holding the list
  * @param insert_time The timestamp when the entry was inserted
  * @param packets Number of packets matched by the entry
  * @param bytes Number of bytes matched by the entry
@@ -49,23 +52,52 @@
  * @param prio_links Search by priority
  * @param match_links Search by strict match
  * @param flow_id_links Search by flow id
+ * @param match_words The compact match, see below
  *
  * The effects (actions or instructions) are tied to a specific OpenFlow
  * version. For example, a flow may be added using OpenFlow 1.0 but
  * modified using OpenFlow 1.3. Either union member may be used to check
  * the version and LOCI object type.
  *
+ * The effects lists are interned per flow table: entries whose actions
+ * or instructions are identical on the wire share one list object,
+ * which must therefore be treated as read-only.
+ *
+ * The match is stored compactly.  of_match_fields_t is viewed as an
+ * array of 64-bit words and only the words with a nonzero value or mask
+ * are kept: match_words holds the match_count values of the words set
+ * in match_present, in increasing word order, followed by their masks.
+ * Use ft_entry_match_get to rebuild the full of_match_t.
+ *
  * The match, priority, timeouts and flags are invariant once the entry
  * has been added to the table.  The cookie and effects may be updated by
  * modify commands.
  */
 
+/**
+ * An interned actions or instructions list
+ *
+ * @param links Links in the owning flow table's effects buckets
+ * @param hash Hash of the list version and wire data
+ * @param refcount Number of entries referring to the list
+ * @param list The list object; of_list_action_t or of_list_instruction_t
+ */
+
+typedef struct ft_effects_s {
+    list_links_t links;
+    uint32_t hash;
+    uint32_t refcount;
+    of_object_t *list;
+} ft_effects_t;
+
 typedef struct ft_entry_s {
     /* Key */
     indigo_flow_id_t     id;
 
     /* Invariant */
-    of_match_t match;
+    uint64_t match_present;
+    uint8_t match_version;
+    uint8_t match_count;
     uint16_t priority;
     uint16_t idle_timeout;
     uint16_t hard_timeout;
@@ -77,9 +109,11 @@ typedef struct ft_entry_s {
         of_list_action_t *actions;
         of_list_instruction_t *instructions;
     } effects;
+    ft_effects_t *effects_ref;
 
     /* Updated by implementation */
     uint8_t table_id;
+    uint8_t pending;               /* Add not yet completed by forwarding */
     indigo_time_t insert_time;
     uint64_t packets;
     uint64_t bytes;
@@ -92,6 +126,9 @@ typedef struct ft_entry_s {
     list_links_t cookie_links;     /* Search by cookie */
     list_head_t iterators;         /* List of ft_iterator_t objects
                                       pointing to this entry */
+
+    /* Compact match; variable length, must be last */
+    uint64_t match_words[];
 } ft_entry_t;
 
 /**
@@ -33,12 +33,37 @@
 #include <indigo/forwarding.h>
 #include <loci/loci.h>
 #include <AIM/aim_list.h>
+#include <murmur/murmur.h>
 #include "ofstatemanager_decs.h"
 #include "ofstatemanager_int.h"
 #include "handlers.h"
 
+/**
+ * Multipart replies are sent and a new one started once they exceed this
+ */
+#define IND_CORE_GROUP_REPLY_MAX (1 << 15)
+
+/**
+ * The group table
+ *
+ * Every group is on ind_core_groups_list (in creation order), on a hash
+ * bucket keyed by group id, and on a list per group id "type".
+ *
+ * The type lists follow the OF-DPA group id encoding, where the top 4
+ * bits of the id are the group entry type and the remaining bits encode
+ * VLAN/port or an index depending on that type.  They let a delete-all
+ * remove groups that reference other groups (ECMP, flood, multicast)
+ * before the groups they reference.
+ */
+
+#define IND_CORE_GROUP_ID_TYPE_SHIFT 28
+#define IND_CORE_GROUP_ID_TYPE_COUNT 16
+#define IND_CORE_GROUP_ID_TYPE(_id) ((_id) >> IND_CORE_GROUP_ID_TYPE_SHIFT)
+
 typedef struct ind_core_group_s {
     list_links_t links;
+    list_links_t hash_links;
+    list_links_t type_links;
     uint32_t id;
     uint32_t type;
     of_list_bucket_t *buckets;
@@ -46,13 +71,45 @@ typedef struct ind_core_group_s {
 } ind_core_group_t;
 
 static LIST_DEFINE(ind_core_groups_list);
+static list_head_t ind_core_group_buckets[OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT];
+static list_head_t ind_core_group_type_lists[IND_CORE_GROUP_ID_TYPE_COUNT];
+
+/**
+ * Order in which delete-all walks the type lists: referencing group
+ * types first (L3 ECMP, L3 multicast, L2 flood, L2 multicast,
+ * L2 overlay, L3 unicast, L3 interface, L2 rewrite), L2 interface last.
+ * Types not used by OF-DPA come before all of them.
+ */
+static const uint8_t ind_core_group_delete_order[IND_CORE_GROUP_ID_TYPE_COUNT] = {
+    15, 14, 13, 12, 11, 10, 9, 7, 6, 4, 3, 8, 2, 5, 1, 0
+};
+
+void
+ind_core_group_init(void)
+{
+    int idx;
+
+    for (idx = 0; idx < OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT; idx++) {
+        list_init(&ind_core_group_buckets[idx]);
+    }
+    for (idx = 0; idx < IND_CORE_GROUP_ID_TYPE_COUNT; idx++) {
+        list_init(&ind_core_group_type_lists[idx]);
+    }
+}
+
+static list_head_t *
+ind_core_group_bucket(uint32_t id)
+{
+    return &ind_core_group_buckets[murmur_hash(&id, sizeof(id), 0) %
+                                   OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT];
+}
 
 static ind_core_group_t *
 ind_core_group_lookup(uint32_t id)
 {
     list_links_t *cur;
-    LIST_FOREACH(&ind_core_groups_list, cur) {
-        ind_core_group_t *group = container_of(cur, links, ind_core_group_t);
+    LIST_FOREACH(ind_core_group_bucket(id), cur) {
+        ind_core_group_t *group = container_of(cur, hash_links, ind_core_group_t);
         if (group->id == id) {
             return group;
         }
@@ -60,6 +117,23 @@ ind_core_group_lookup(uint32_t id)
     return NULL;
 }
 
+static void
+ind_core_group_link(ind_core_group_t *group)
+{
+    list_push(&ind_core_groups_list, &group->links);
+    list_push(ind_core_group_bucket(group->id), &group->hash_links);
+    list_push(&ind_core_group_type_lists[IND_CORE_GROUP_ID_TYPE(group->id)],
+              &group->type_links);
+}
+
+static void
+ind_core_group_unlink(ind_core_group_t *group)
+{
+    list_remove(&group->links);
+    list_remove(&group->hash_links);
+    list_remove(&group->type_links);
+}
+
 #ifdef OFDPA_FIXUP
 static indigo_error_t
 ind_core_group_delete_one(ind_core_group_t *group)
@@ -68,22 +142,79 @@ ind_core_group_delete_one(ind_core_group_t *group)
     result = indigo_fwd_group_delete(group->id);
     if (result >= 0) {
       of_object_delete(group->buckets);
-      list_remove(&group->links);
+      ind_core_group_unlink(group);
       INDIGO_MEM_FREE(group);
     }
     return result;
 }
 #else
-static void
+static indigo_error_t
 ind_core_group_delete_one(ind_core_group_t *group)
 {
     indigo_fwd_group_delete(group->id);
     of_object_delete(group->buckets);
-    list_remove(&group->links);
+    ind_core_group_unlink(group);
     INDIGO_MEM_FREE(group);
+    return INDIGO_ERROR_NONE;
+}
+#endif
+
+#ifdef OFDPA_FIXUP
+int
+ind_core_group_id_present(uint32_t id)
+{
+    return ind_core_group_lookup(id) != NULL;
+}
+
+int
+ind_core_group_reconcile(ind_core_present_f present, void *cookie)
+{
+    list_links_t *cur, *next;
+    int removed = 0;
+
+    LIST_FOREACH_SAFE(&ind_core_groups_list, cur, next) {
+        ind_core_group_t *group = container_of(cur, links, ind_core_group_t);
+        if (present(group->id, cookie)) {
+            continue;
+        }
+
+        LOG_INFO("Group 0x%x missing from forwarding, removing", group->id);
+        of_object_delete(group->buckets);
+        ind_core_group_unlink(group);
+        INDIGO_MEM_FREE(group);
+        removed++;
+    }
+
+    return removed;
 }
 #endif
 
+/**
+ * Delete every group, referencing group types first
+ */
+static indigo_error_t
+ind_core_group_delete_all(void)
+{
+    list_links_t *cur, *next;
+    indigo_error_t result;
+    int idx;
+
+    for (idx = 0; idx < IND_CORE_GROUP_ID_TYPE_COUNT; idx++) {
+        list_head_t *head =
+            &ind_core_group_type_lists[ind_core_group_delete_order[idx]];
+        LIST_FOREACH_SAFE(head, cur, next) {
+            ind_core_group_t *group =
+                container_of(cur, type_links, ind_core_group_t);
+            result = ind_core_group_delete_one(group);
+            if (result < 0) {
+                return result;
+            }
+        }
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
 indigo_error_t
 ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
 {
@@ -131,7 +262,7 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
         AIM_TRUE_OR_DIE(group->buckets != NULL);
         group->creation_time = INDIGO_CURRENT_TIME;
 
-        list_push(&ind_core_groups_list, &group->links);
+        ind_core_group_link(group);
     } else if (command == OF_GROUP_MODIFY) {
         if (group == NULL) {
             err_code = OF_GROUP_MOD_FAILED_UNKNOWN_GROUP;
@@ -171,16 +302,10 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
         AIM_TRUE_OR_DIE(group->buckets != NULL);
     } else if (command == OF_GROUP_DELETE) {
         if (id == OF_GROUP_ALL) {
-            list_links_t *cur, *next;
-            LIST_FOREACH_SAFE(&ind_core_groups_list, cur, next) {
-                group = container_of(cur, links, ind_core_group_t);
-#ifdef OFDPA_FIXUP
-                result = ind_core_group_delete_one(group);
-                if (result < 0) {
-                    err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
-                    goto error;
-                }
-#endif
+            result = ind_core_group_delete_all();
+            if (result < 0) {
+                err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
+                goto error;
             }
         } else if (group != NULL) {
 #ifdef OFDPA_FIXUP
@@ -224,7 +349,23 @@ ind_core_group_stats_entry_populate(of_group_stats_entry_t *entry,
     indigo_fwd_group_stats_get(group->id, entry);
 }
 
-/* TODO segment long replies */
+static of_group_stats_reply_t *
+ind_core_group_stats_reply_new(of_group_stats_request_t *obj,
+                               of_list_group_stats_entry_t *entries)
+{
+    of_group_stats_reply_t *reply;
+    uint32_t xid;
+
+    reply = of_group_stats_reply_new(obj->version);
+    AIM_TRUE_OR_DIE(reply != NULL);
+
+    of_group_stats_request_xid_get(obj, &xid);
+    of_group_stats_reply_xid_set(reply, xid);
+    of_group_stats_reply_entries_bind(reply, entries);
+
+    return reply;
+}
+
 indigo_error_t
 ind_core_group_stats_request_handler(of_object_t *_obj,
                                      indigo_cxn_id_t cxn_id)
@@ -233,19 +374,14 @@ ind_core_group_stats_request_handler(of_object_t *_obj,
     of_group_stats_reply_t *reply;
     of_list_group_stats_entry_t entries;
     of_group_stats_entry_t *entry;
-    uint32_t xid;
     uint32_t id;
     list_links_t *cur, *next;
     indigo_time_t current_time = INDIGO_CURRENT_TIME;
+    int count = 0;
 
     of_group_stats_request_group_id_get(obj, &id);
 
-    reply = of_group_stats_reply_new(obj->version);
-    AIM_TRUE_OR_DIE(reply != NULL);
-
-    of_group_stats_request_xid_get(obj, &xid);
-    of_group_stats_reply_xid_set(reply, xid);
-    of_group_stats_reply_entries_bind(reply, &entries);
+    reply = ind_core_group_stats_reply_new(obj, &entries);
 
     entry = of_group_stats_entry_new(entries.version);
     AIM_TRUE_OR_DIE(entry != NULL);
@@ -255,8 +391,20 @@ ind_core_group_stats_request_handler(of_object_t *_obj,
             ind_core_group_t *group = container_of(cur, links, ind_core_group_t);
             ind_core_group_stats_entry_populate(entry, group, current_time);
 
+            if ((count > 0) &&
+                (reply->length + entry->length > IND_CORE_GROUP_REPLY_MAX)) {
+                /* Send this segment with the "more" flag and start anew */
+                of_group_stats_reply_flags_set(reply, 1);
+                IND_CORE_MSG_SEND(cxn_id, reply);
+                reply = ind_core_group_stats_reply_new(obj, &entries);
+                count = 0;
+            }
+
             if (of_list_append(&entries, entry) < 0) {
-                break;
+                LOG_ERROR("Stats of group 0x%x do not fit in a reply; skipped",
+                          group->id);
+            } else {
+                count++;
             }
 
             /* HACK unable to truncate existing object */
@@ -270,7 +418,8 @@ ind_core_group_stats_request_handler(of_object_t *_obj,
             ind_core_group_stats_entry_populate(entry, group, current_time);
 
             if (of_list_append(&entries, entry) < 0) {
-                AIM_DIE("unexpected failure appending single group stats entry");
+                LOG_ERROR("Stats of group 0x%x do not fit in a reply; skipped",
+                          group->id);
             }
         }
     }
@@ -282,7 +431,23 @@ ind_core_group_stats_request_handler(of_object_t *_obj,
     return INDIGO_ERROR_NONE;
 }
 
-/* TODO segment long replies */
+static of_group_desc_stats_reply_t *
+ind_core_group_desc_stats_reply_new(of_group_desc_stats_request_t *obj,
+                                    of_list_group_desc_stats_entry_t *entries)
+{
+    of_group_desc_stats_reply_t *reply;
+    uint32_t xid;
+
+    reply = of_group_desc_stats_reply_new(obj->version);
+    AIM_TRUE_OR_DIE(reply != NULL);
+
+    of_group_desc_stats_request_xid_get(obj, &xid);
+    of_group_desc_stats_reply_xid_set(reply, xid);
+    of_group_desc_stats_reply_entries_bind(reply, entries);
+
+    return reply;
+}
+
 indigo_error_t
 ind_core_group_desc_stats_request_handler(of_object_t *_obj,
                                           indigo_cxn_id_t cxn_id)
@@ -291,15 +456,10 @@ ind_core_group_desc_stats_request_handler(of_object_t *_obj,
     of_group_desc_stats_reply_t *reply;
     of_list_group_desc_stats_entry_t entries;
     of_group_desc_stats_entry_t *entry;
-    uint32_t xid;
     list_links_t *cur, *next;
+    int count = 0;
 
-    reply = of_group_desc_stats_reply_new(obj->version);
-    AIM_TRUE_OR_DIE(reply != NULL);
-
-    of_group_desc_stats_request_xid_get(obj, &xid);
-    of_group_desc_stats_reply_xid_set(reply, xid);
-    of_group_desc_stats_reply_entries_bind(reply, &entries);
+    reply = ind_core_group_desc_stats_reply_new(obj, &entries);
 
     entry = of_group_desc_stats_entry_new(entries.version);
     AIM_TRUE_OR_DIE(entry != NULL);
@@ -309,12 +469,32 @@ ind_core_group_desc_stats_request_handler(of_object_t *_obj,
         of_group_desc_stats_entry_group_type_set(entry, group->type);
         of_group_desc_stats_entry_group_id_set(entry, group->id);
         if (of_group_desc_stats_entry_buckets_set(entry, group->buckets) < 0) {
-            AIM_DIE("unexpected failure setting group desc stats entry buckets");
+            LOG_ERROR("Buckets of group 0x%x do not fit in a reply; skipped",
+                      group->id);
+            goto next_entry;
+        }
+
+        if ((count > 0) &&
+            (reply->length + entry->length > IND_CORE_GROUP_REPLY_MAX)) {
+            /* Send this segment with the "more" flag and start anew */
+            of_group_desc_stats_reply_flags_set(reply, 1);
+            IND_CORE_MSG_SEND(cxn_id, reply);
+            reply = ind_core_group_desc_stats_reply_new(obj, &entries);
+            count = 0;
         }
 
         if (of_list_append(&entries, entry) < 0) {
-            break;
+            LOG_ERROR("Group 0x%x does not fit in a reply; skipped",
+                      group->id);
+        } else {
+            count++;
         }
+
+    next_entry:
+        /* HACK unable to truncate existing object */
+        of_object_delete(entry);
+        entry = of_group_desc_stats_entry_new(entries.version);
+        AIM_TRUE_OR_DIE(entry != NULL);
     }
 
     of_object_delete(entry);
@@ -34,6 +34,9 @@
 #include <indigo/forwarding.h>
 #include <loci/loci.h>
 #include <loci/loci_obj_dump.h>
+#include <murmur/murmur.h>
+#include <time.h>
+#include <unistd.h>
 #include "ofstatemanager_decs.h"
 #include "ofstatemanager_int.h"
 #include "handlers.h"
@@ -412,18 +415,78 @@ overlap_found(of_flow_modify_t *obj)
     return 0;
 }
 
-static indigo_flow_id_t
-flow_id_next(void)
+/*
+ * Flow ids double as forwarding cookies, which can outlive the agent.
+ * The top 24 bits of an id hold a generation picked at init, so ids
+ * given out after a restart never match the cookies of flows an
+ * earlier run left in forwarding. The 40 bit counter below it lasts
+ * years; should it wrap, a new generation is picked and ids of flows
+ * still installed are skipped.
+ */
+#define FLOW_ID_COUNTER_BITS 40
+#define FLOW_ID_COUNTER_MASK ((UINT64_C(1) << FLOW_ID_COUNTER_BITS) - 1)
+#define FLOW_ID_GENERATION_MASK 0xffffff
+
+static uint32_t flow_id_generation;
+static uint64_t next_flow_id = 1;
+
+static void
+flow_id_generation_next(void)
 {
-    static indigo_flow_id_t next_flow_id = 1;
+    uint32_t previous = flow_id_generation;
+    struct timespec ts;
+    uint32_t seed[4];
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    seed[0] = ts.tv_sec;
+    seed[1] = ts.tv_nsec;
+    seed[2] = getpid();
+    seed[3] = previous;
+    flow_id_generation = murmur_hash(seed, sizeof(seed), 0) & FLOW_ID_GENERATION_MASK;
+    if (flow_id_generation == previous) {
+        flow_id_generation = (previous + 1) & FLOW_ID_GENERATION_MASK;
+    }
+    next_flow_id = 1;
+}
 
-    indigo_flow_id_t result = next_flow_id;
+void
+ind_core_flow_id_init(void)
+{
+    flow_id_generation_next();
+}
 
-    if (++next_flow_id == 0)  next_flow_id = 1;
+static indigo_flow_id_t
+flow_id_next(void)
+{
+    indigo_flow_id_t result;
+
+    do {
+        result = ((indigo_flow_id_t)flow_id_generation << FLOW_ID_COUNTER_BITS) |
+            next_flow_id;
+        if (++next_flow_id > FLOW_ID_COUNTER_MASK) {
+            LOG_VERBOSE("Flow id counter wrapped; picking a new generation");
+            flow_id_generation_next();
+        }
+    } while (ft_lookup(ind_core_ft, result) != NULL);
 
     return (result);
 }
 
+/*
+ * A flow add the forwarding layer has yet to complete. The message is
+ * held, so its connection's outstanding op count keeps barriers
+ * waiting. Completions come mostly in order, so they are found near
+ * the head of the list.
+ */
+typedef struct flow_add_pending_s {
+    list_links_t links;
+    indigo_flow_id_t flow_id;
+    indigo_cxn_id_t cxn_id;
+    of_flow_add_t *obj;
+} flow_add_pending_t;
+
+static LIST_DEFINE(flow_add_pending);
+
 /**
  * Handle a flow_add message
  * @param cxn_id Connection handler for the owning connection
@@ -444,6 +507,8 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     indigo_flow_id_t  flow_id;
     uint16_t idle_timeout, hard_timeout;
     uint8_t table_id;
+    uint16_t bad_match_code = 0;
+    flow_add_pending_t *pending;
 
     obj = (of_flow_modify_t *)_obj;
     ver = obj->version;
@@ -487,6 +552,20 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
         goto done;
     }
 
+    /* Refuse a match the table cannot take before touching the table */
+    rv = indigo_fwd_flow_match_validate(query.table_id, &query.match,
+                                        &bad_match_code);
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_TRACE("Flow match rejected by forwarding: %d", rv);
+        ind_core_ft->status.forwarding_add_errors += 1;
+        if (ind_core_send_error_msg(ver, cxn_id, xid,
+                OF_ERROR_TYPE_BAD_MATCH_BY_VERSION(ver),
+                bad_match_code, obj, NULL) < 0) {
+            LOG_ERROR("Error sending bad match error message");
+        }
+        goto done;
+    }
+
     /* Delete existing flow if any */
     if (ft_strict_match(ind_core_ft, &query, &entry) == INDIGO_ERROR_NONE) {
         ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_OVERWRITE, cxn_id);
@@ -508,6 +587,19 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
         LOG_TRACE("Flow table now has %d entries",
                   FT_STATUS(ind_core_ft)->current_count);
         entry->table_id = table_id;
+    } else if (rv == INDIGO_ERROR_PENDING) {
+        entry->table_id = table_id;
+        entry->pending = 1;
+        pending = INDIGO_MEM_ALLOC(sizeof(*pending));
+        if (pending != NULL) {
+            pending->flow_id = flow_id;
+            pending->cxn_id = cxn_id;
+            pending->obj = (of_flow_add_t *)obj;
+            list_push(&flow_add_pending, &pending->links);
+            /* Deleted by indigo_core_flow_create_callback */
+            return INDIGO_ERROR_NONE;
+        }
+        LOG_ERROR("No memory to track pending flow add");
     } else { /* Error during insertion at forwarding layer */
        uint32_t xid;
 
@@ -528,6 +620,68 @@ done:
     return INDIGO_ERROR_NONE;
 }
 
+/**
+ * Complete a flow add left pending by forwarding
+ * @param result Result of the create
+ * @param flow_id The flow's id
+ */
+
+void
+indigo_core_flow_create_callback(indigo_error_t result,
+                                 indigo_cookie_t flow_id)
+{
+    flow_add_pending_t *pending = NULL;
+    flow_add_pending_t *cur_pending;
+    list_links_t *cur;
+    ft_entry_t *entry;
+
+    if (!ind_core_init_done) {
+        return;
+    }
+
+    LIST_FOREACH(&flow_add_pending, cur) {
+        cur_pending = container_of(cur, links, flow_add_pending_t);
+        if (cur_pending->flow_id == flow_id) {
+            pending = cur_pending;
+            list_remove(&pending->links);
+            break;
+        }
+    }
+    if (pending == NULL) {
+        /* Not tracked for want of memory; the message is gone */
+        LOG_VERBOSE("Completion for untracked flow add, id "
+                    INDIGO_FLOW_ID_PRINTF_FORMAT,
+                    INDIGO_FLOW_ID_PRINTF_ARG(flow_id));
+    }
+
+    if (result != INDIGO_ERROR_NONE) {
+        LOG_VERBOSE("Error from forwarding while inserting flow: %d", result);
+        ind_core_ft->status.forwarding_add_errors += 1;
+
+        if (pending != NULL) {
+            flow_mod_err_msg_send(result, pending->obj->version,
+                                  pending->cxn_id,
+                                  (of_flow_modify_t *)pending->obj);
+        }
+
+        /* The flow may already be gone, deleted or overwritten */
+        entry = ft_lookup(ind_core_ft, flow_id);
+        if (entry != NULL) {
+            ft_delete(ind_core_ft, entry);
+        }
+    } else {
+        entry = ft_lookup(ind_core_ft, flow_id);
+        if (entry != NULL) {
+            entry->pending = 0;
+        }
+    }
+
+    if (pending != NULL) {
+        of_object_delete(pending->obj);
+        INDIGO_MEM_FREE(pending);
+    }
+}
+
 /**
  * Translate the error status into the correct error code for the given
  * OpenFlow version, and send the error message to the controller.
@@ -921,6 +1075,11 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
         return;
     }
 
+    /* A flow whose add forwarding has yet to complete may never exist */
+    if (entry->pending) {
+        return;
+    }
+
     rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Failed to get stats for flow "INDIGO_FLOW_ID_PRINTF_FORMAT": %d",
@@ -943,6 +1102,7 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
     {
         of_list_flow_stats_entry_t list;
         of_flow_stats_entry_t stats_entry;
+        of_match_t match;
         of_flow_stats_reply_entries_bind(state->reply, &list);
         of_flow_stats_entry_init(&stats_entry, state->reply->version, -1, 1);
         if (of_list_flow_stats_entry_append_bind(&list, &stats_entry)) {
@@ -959,7 +1119,8 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
             of_flow_stats_entry_flags_set(&stats_entry, entry->flags);
         }
 
-        if (of_flow_stats_entry_match_set(&stats_entry, &entry->match)) {
+        ft_entry_match_get(entry, &match);
+        if (of_flow_stats_entry_match_set(&stats_entry, &match)) {
             LOG_ERROR("Failed to set match in flow stats entry");
             return;
         }
@@ -1093,6 +1254,9 @@ ind_core_aggregate_stats_iter(void *cookie, ft_entry_t *entry)
 
     if (entry != NULL) {
         indigo_fi_flow_stats_t flow_stats;
+        if (entry->pending) {
+            return;
+        }
         rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
         if (rv != INDIGO_ERROR_NONE) {
             LOG_ERROR("Failed to get stats for flow "INDIGO_FLOW_ID_PRINTF_FORMAT": %d",
@@ -1274,6 +1438,64 @@ done:
 
 /****************************************************************/
 
+/* OFPTFFC_EPERM; loci has no identifiers for the table features codes */
+#define IND_CORE_TABLE_FEATURES_FAILED_EPERM 5
+
+/**
+ * Handle a table_features_stats_request message
+ * @param cxn_id Connection handler for the owning connection
+ * @param _obj Generic type object for the message to be coerced
+ * @returns Error code
+ *
+ * A request carrying table features asks to reconfigure the pipeline,
+ * which is refused; an empty request is answered by the forwarding
+ * module.
+ */
+
+indigo_error_t
+ind_core_table_features_stats_request_handler(of_object_t *_obj,
+                                              indigo_cxn_id_t cxn_id)
+{
+    of_table_features_stats_request_t *obj = _obj;
+    of_table_features_stats_reply_t *reply = NULL;
+    indigo_error_t rv;
+    uint32_t xid;
+
+    LOG_TRACE("Handling of_table_features_stats_request message.");
+
+    if (obj->length >
+        of_object_fixed_len[obj->version][OF_TABLE_FEATURES_STATS_REQUEST]) {
+        of_table_features_stats_request_xid_get(obj, &xid);
+        LOG_ERROR("Setting table features is not supported");
+        rv = indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                 OF_ERROR_TYPE_TABLE_FEATURES_FAILED_BY_VERSION(obj->version),
+                 IND_CORE_TABLE_FEATURES_FAILED_EPERM, NULL);
+        goto done;
+    }
+
+    rv = indigo_fwd_table_features_get(obj, &reply);
+    if (rv < 0) {
+        reply = NULL;
+        LOG_ERROR("Table features returned error %d", rv);
+        goto done;
+    }
+
+    rv = IND_CORE_MSG_SEND(cxn_id, reply);
+    reply = NULL;
+    if (rv < 0) {
+        LOG_ERROR("Error %d sending table_features reply to cxn %d", rv, cxn_id);
+        goto done;
+    }
+
+done:
+    of_table_features_stats_reply_delete(reply);
+    of_table_features_stats_request_delete(obj);
+
+    return rv;
+}
+
+/****************************************************************/
+
 /**
  * Handle a port_desc_stats_request message
  * @param cxn_id Connection handler for the owning connection
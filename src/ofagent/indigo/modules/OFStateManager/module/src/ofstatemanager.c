@@ -34,6 +34,7 @@
 #include <indigo/of_state_manager.h>
 #include <loci/loci_dump.h>
 #include <loci/loci_show.h>
+#include <murmur/murmur.h>
 #include "ofstatemanager_int.h"
 #include "ofstatemanager_log.h"
 #include "ofstatemanager_decs.h"
@@ -136,6 +137,7 @@ static void
 send_flow_removed_message(ft_entry_t *entry, indigo_fi_flow_removed_t reason)
 {
     of_flow_removed_t *msg;
+    of_match_t match;
     int rv = 0;
     uint32_t secs;
     uint32_t nsecs;
@@ -144,7 +146,7 @@ send_flow_removed_message(ft_entry_t *entry, indigo_fi_flow_removed_t reason)
     current = INDIGO_CURRENT_TIME;
 
     /* TODO get version from OFConnectionManager */
-    if ((msg = of_flow_removed_new(entry->match.version)) == NULL) {
+    if ((msg = of_flow_removed_new(entry->match_version)) == NULL) {
         return;
     }
 
@@ -164,7 +166,8 @@ send_flow_removed_message(ft_entry_t *entry, indigo_fi_flow_removed_t reason)
         of_flow_removed_hard_timeout_set(msg, entry->hard_timeout);
     }
 
-    if (of_flow_removed_match_set(msg, &entry->match)) {
+    ft_entry_match_get(entry, &match);
+    if (of_flow_removed_match_set(msg, &match)) {
         LOG_ERROR("Failed to set match in flow removed message");
         of_object_delete(msg);
         return;
@@ -283,6 +286,10 @@ indigo_core_receive_controller_message(indigo_cxn_id_t cxn, of_object_t *obj)
         rv = ind_core_table_stats_request_handler(obj, cxn);
         break;
 
+    case OF_TABLE_FEATURES_STATS_REQUEST:
+        rv = ind_core_table_features_stats_request_handler(obj, cxn);
+        break;
+
     case OF_DESC_STATS_REQUEST:
         rv = ind_core_desc_stats_request_handler(obj, cxn);
         break;
@@ -403,6 +410,7 @@ indigo_core_receive_controller_message(indigo_cxn_id_t cxn, of_object_t *obj)
     case OF_QUEUE_GET_CONFIG_REPLY:
     case OF_QUEUE_STATS_REPLY:
     case OF_ROLE_REPLY:
+    case OF_TABLE_FEATURES_STATS_REPLY:
     case OF_TABLE_STATS_REPLY:
         rv = ind_core_unhandled_message(obj, cxn);
         break;
@@ -489,6 +497,9 @@ ind_core_init(ind_core_config_t *config)
         return INDIGO_ERROR_RESOURCE;
     }
 
+    ind_core_flow_id_init();
+    ind_core_group_init();
+
     ind_core_connection_count = 0;
 
     ind_core_init_done = 1;
@@ -513,17 +524,27 @@ ind_core_flow_entry_delete(ft_entry_t *entry, indigo_fi_flow_removed_t reason,
 {
     indigo_error_t rv;
     indigo_fi_flow_stats_t flow_stats;
+    indigo_flow_id_t id = entry->id;
+    int pending = entry->pending;
 
     LOG_TRACE("Removing flow " INDIGO_FLOW_ID_PRINTF_FORMAT,
-              INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+              INDIGO_FLOW_ID_PRINTF_ARG(id));
 
-    rv = indigo_fwd_flow_delete(entry->id, &flow_stats);
+    rv = indigo_fwd_flow_delete(id, &flow_stats);
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Error deleting flow, id " INDIGO_FLOW_ID_PRINTF_FORMAT,
-                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+                  INDIGO_FLOW_ID_PRINTF_ARG(id));
         /* Ignoring failure */
     }
 
+    /*
+     * Forwarding completes pending flow adds before the delete; one
+     * that failed has already removed the entry and reported its error
+     */
+    if (pending && ft_lookup(ind_core_ft, id) == NULL) {
+        return;
+    }
+
     process_flow_removal(entry, &flow_stats, reason);
 }
 
@@ -947,17 +968,28 @@ static void
 flow_expiration_timer(void *cookie)
 {
     ft_entry_t *entry;
-    list_links_t *cur, *next;
+    ft_iterator_t iter;
     indigo_time_t current_time = INDIGO_CURRENT_TIME;
 
     if (!ind_core_module_enabled) {
         return;
     }
 
-    FT_ITER(ind_core_ft, entry, cur, next) {
+    /*
+     * Forwarding may complete pending flow adds from any call, and a
+     * failed one removes its entry, so walk with an iterator that
+     * survives that
+     */
+    ft_iterator_init(&iter, ind_core_ft, NULL);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
         indigo_error_t rv;
         indigo_fi_flow_stats_t flow_stats;
 
+        /* Forwarding has no counters for the flow yet */
+        if (entry->pending) {
+            continue;
+        }
+
         if (entry->hard_timeout > 0) {
             uint32_t delta;
             delta = INDIGO_TIME_DIFF_ms(entry->insert_time,
@@ -1005,6 +1037,7 @@ flow_expiration_timer(void *cookie)
             }
         }
     }
+    ft_iterator_cleanup(&iter);
 }
 
 void
@@ -1012,10 +1045,12 @@ ind_core_ft_dump(aim_pvs_t* pvs)
 {
     ft_entry_t *entry;
     list_links_t *cur, *next;
+    of_match_t match;
 
     FT_ITER(ind_core_ft, entry, cur, next) {
         aim_printf(pvs, "Flow %d:\n", entry->id);
-        loci_dump_match((loci_writer_f)aim_printf, pvs, &entry->match);
+        ft_entry_match_get(entry, &match);
+        loci_dump_match((loci_writer_f)aim_printf, pvs, &match);
         aim_printf(pvs, "cookie: 0x%016"PRIx64"\n", entry->cookie);
         aim_printf(pvs, "idle_timeout: %hu\n", entry->idle_timeout);
         aim_printf(pvs, "hard_timeout: %hu\n", entry->hard_timeout);
@@ -1025,7 +1060,7 @@ ind_core_ft_dump(aim_pvs_t* pvs)
         aim_printf(pvs, "packets: %"PRIu64"\n", entry->packets);
         aim_printf(pvs, "bytes: %"PRIu64"\n", entry->bytes);
 
-        if (entry->match.version == OF_VERSION_1_0) {
+        if (entry->match_version == OF_VERSION_1_0) {
             int rv;
             of_action_t elt;
             OF_LIST_ACTION_ITER(entry->effects.actions, &elt, rv) {
@@ -1048,15 +1083,17 @@ ind_core_ft_show(aim_pvs_t* pvs)
 {
     ft_entry_t *entry;
     list_links_t *cur, *next;
+    of_match_t match;
 
     FT_ITER(ind_core_ft, entry, cur, next) {
         aim_printf(pvs, "Flow %d: ", entry->id);
-        loci_show_match((loci_writer_f)aim_printf, pvs, &entry->match);
+        ft_entry_match_get(entry, &match);
+        loci_show_match((loci_writer_f)aim_printf, pvs, &match);
         aim_printf(pvs, "cookie=0x%016"PRIx64" ", entry->cookie);
         aim_printf(pvs, "priority=%hu ", entry->priority);
         aim_printf(pvs, "table_id=%hhu ", entry->table_id);
 
-        if (entry->match.version == OF_VERSION_1_0) {
+        if (entry->match_version == OF_VERSION_1_0) {
             int rv;
             of_action_t elt;
             OF_LIST_ACTION_ITER(entry->effects.actions, &elt, rv) {
@@ -1095,6 +1132,14 @@ ind_core_ft_stats(aim_pvs_t *pvs)
                (int)ft->status.table_full_errors);
     aim_printf(pvs, "  Fwd Add Errors: %d\n",
                (int)ft->status.forwarding_add_errors);
+    aim_printf(pvs, "  Entry bytes:    %"PRIu64"\n", ft->status.entry_bytes);
+    aim_printf(pvs, "  Effects lists:  %"PRIu64"\n", ft->status.effects_lists);
+    aim_printf(pvs, "  Effects bytes:  %"PRIu64"\n", ft->status.effects_bytes);
+    if (ft->status.current_count > 0) {
+        aim_printf(pvs, "  Bytes/flow:     %"PRIu64"\n",
+                   (ft->status.entry_bytes + ft->status.effects_bytes) /
+                   ft->status.current_count);
+    }
 }
 
 
@@ -1140,4 +1185,142 @@ void ind_core_flow_expiry_handler(indigo_flow_id_t id,
                              INDIGO_CXN_ID_UNSPECIFIED);
   return;
 }
+
+/* Leaf selection in ind_core_flow_reconcile uses a 64 bit mask */
+AIM_STATIC_ASSERT(IND_CORE_FLOW_DIGEST_LEAVES,
+                  IND_CORE_FLOW_DIGEST_LEAVES <= 64);
+
+int
+ind_core_flow_digest_leaf(indigo_flow_id_t id)
+{
+    return murmur_hash(&id, sizeof(id), 0) % IND_CORE_FLOW_DIGEST_LEAVES;
+}
+
+void
+ind_core_flow_digest_add(ind_core_flow_digest_t *digest, indigo_flow_id_t id,
+                         uint64_t hash)
+{
+    uint64_t key[2] = { id, hash };
+    uint64_t flow_hash = ((uint64_t)murmur_hash(key, sizeof(key), 1) << 32) |
+        murmur_hash(key, sizeof(key), 2);
+
+    /* Addition keeps leaves independent of enumeration order */
+    digest->leaves[ind_core_flow_digest_leaf(id)] += flow_hash;
+    digest->count++;
+}
+
+void
+ind_core_flow_digest_finish(ind_core_flow_digest_t *digest)
+{
+    digest->root = ((uint64_t)murmur_hash(digest->leaves,
+                                          sizeof(digest->leaves),
+                                          digest->count) << 32) |
+        murmur_hash(digest->leaves, sizeof(digest->leaves), 0);
+}
+
+/*
+ * Hash an entry's content the way forwarding hashes its own flows, from
+ * the flow add that would create the entry as it is now. Returns 0 if
+ * the flow add cannot be built, which forwarding will not match.
+ */
+static uint64_t
+ind_core_flow_entry_hash(ft_entry_t *entry, ind_core_flow_hash_f hash)
+{
+    of_flow_add_t *flow_add;
+    of_match_t match;
+    of_version_t version;
+    uint64_t result = 0;
+
+    if (entry->effects.actions == NULL) {
+        return 0;
+    }
+    version = entry->effects.actions->version;
+    if (version < OF_VERSION_1_1) {
+        return 0;
+    }
+
+    flow_add = of_flow_add_new(version);
+    if (flow_add == NULL) {
+        LOG_ERROR("Failed to allocate flow add to hash flow "
+                  INDIGO_FLOW_ID_PRINTF_FORMAT,
+                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+        return 0;
+    }
+
+    of_flow_add_table_id_set(flow_add, entry->table_id);
+    of_flow_add_priority_set(flow_add, entry->priority);
+    of_flow_add_idle_timeout_set(flow_add, entry->idle_timeout);
+    of_flow_add_hard_timeout_set(flow_add, entry->hard_timeout);
+    of_flow_add_flags_set(flow_add, entry->flags);
+    of_flow_add_cookie_set(flow_add, entry->cookie);
+
+    ft_entry_match_get(entry, &match);
+    if (of_flow_add_match_set(flow_add, &match) < 0 ||
+        of_flow_add_instructions_set(flow_add, entry->effects.instructions) < 0) {
+        LOG_ERROR("Failed to build flow add to hash flow "
+                  INDIGO_FLOW_ID_PRINTF_FORMAT,
+                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+    } else {
+        result = hash(flow_add);
+    }
+
+    of_flow_add_delete(flow_add);
+    return result;
+}
+
+void
+ind_core_flow_digest_get(uint8_t table_id, ind_core_flow_hash_f hash,
+                         ind_core_flow_digest_t *digest)
+{
+    ft_entry_t *entry;
+    list_links_t *cur, *next;
+
+    INDIGO_MEM_SET(digest, 0, sizeof(*digest));
+    FT_ITER(ind_core_ft, entry, cur, next) {
+        /* Not in forwarding until its add completes */
+        if (entry->table_id != table_id || entry->pending) {
+            continue;
+        }
+        ind_core_flow_digest_add(digest, entry->id,
+                                 ind_core_flow_entry_hash(entry, hash));
+    }
+    ind_core_flow_digest_finish(digest);
+}
+
+int
+ind_core_flow_id_present(indigo_flow_id_t id)
+{
+    return ft_lookup(ind_core_ft, id) != NULL;
+}
+
+int
+ind_core_flow_reconcile(uint8_t table_id, uint64_t leaf_mask,
+                        ind_core_flow_hash_f hash,
+                        ind_core_flow_present_f present, void *cookie)
+{
+    ft_entry_t *entry;
+    list_links_t *cur, *next;
+    int removed = 0;
+
+    FT_ITER(ind_core_ft, entry, cur, next) {
+        if (entry->table_id != table_id || entry->pending) {
+            continue;
+        }
+        if (!(leaf_mask & (1ULL << ind_core_flow_digest_leaf(entry->id)))) {
+            continue;
+        }
+        if (present(entry->id, ind_core_flow_entry_hash(entry, hash), cookie)) {
+            continue;
+        }
+
+        LOG_INFO("Flow " INDIGO_FLOW_ID_PRINTF_FORMAT
+                 " missing from or differing in forwarding, removing",
+                 INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+        /* Forwarding deletes what it has itself, so no final stats */
+        process_flow_removal(entry, NULL, INDIGO_FLOW_REMOVED_DELETE);
+        removed++;
+    }
+
+    return removed;
+}
 #endif
@@ -78,6 +78,11 @@ ofstatemanager_config_settings_t ofstatemanager_config_settings[] =
     { __ofstatemanager_config_STRINGIFY_NAME(OFSTATEMANAGER_CONFIG_DPID_DEFAULT), __ofstatemanager_config_STRINGIFY_VALUE(OFSTATEMANAGER_CONFIG_DPID_DEFAULT) },
 #else
 { OFSTATEMANAGER_CONFIG_DPID_DEFAULT(__ofstatemanager_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT
+    { __ofstatemanager_config_STRINGIFY_NAME(OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT), __ofstatemanager_config_STRINGIFY_VALUE(OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT) },
+#else
+{ OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT(__ofstatemanager_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
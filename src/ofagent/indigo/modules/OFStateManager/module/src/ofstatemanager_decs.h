@@ -59,4 +59,10 @@ extern void ind_core_flow_entry_delete(ft_entry_t *entry,
                                        indigo_fi_flow_removed_t reason,
                                        indigo_cxn_id_t cxn_id);
 
+/* Pick the generation of the flow ids to come; in handlers.c */
+extern void ind_core_flow_id_init(void);
+
+/* Initialize the group table indexes; in group_handlers.c */
+extern void ind_core_group_init(void);
+
 #endif /* OFSTATEMANAGER_DECS_H */
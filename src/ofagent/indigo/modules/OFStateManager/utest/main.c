@@ -90,13 +90,44 @@ indigo_error_t create_error = INDIGO_ERROR_NONE;
    if (create_error == INDIGO_ERROR_NONE) \
        TEST_ASSERT((status)->current_count == (count))
 
+/* When set, creates complete from a task with create_error */
+int create_pending = 0;
+
+static ind_soc_task_status_t
+flow_create_complete(void *cookie)
+{
+    indigo_cookie_t *flow_id = cookie;
+
+    indigo_core_flow_create_callback(create_error, *flow_id);
+    INDIGO_MEM_FREE(flow_id);
+    return IND_SOC_TASK_FINISHED;
+}
+
 indigo_error_t
 indigo_fwd_flow_create(indigo_cookie_t flow_id,
                        of_flow_add_t *flow_add,
                        uint8_t *table_id)
 {
+    indigo_cookie_t *cookie;
+
     AIM_LOG_VERBOSE("flow create called\n");
     *table_id = 0;
+    if (create_pending) {
+        cookie = INDIGO_MEM_ALLOC(sizeof(*cookie));
+        INDIGO_ASSERT(cookie != NULL);
+        *cookie = flow_id;
+        OK(ind_soc_task_register(flow_create_complete, cookie,
+                                 IND_SOC_DEFAULT_PRIORITY));
+        return INDIGO_ERROR_PENDING;
+    }
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+indigo_fwd_flow_match_validate(uint8_t table_id,
+                               of_match_t *match,
+                               uint16_t *bad_match_code)
+{
     return INDIGO_ERROR_NONE;
 }
 
@@ -110,6 +141,15 @@ indigo_fwd_table_stats_get(of_table_stats_request_t *request,
     return INDIGO_ERROR_NONE;
 }
 
+indigo_error_t
+indigo_fwd_table_features_get(of_table_features_stats_request_t *request,
+                              of_table_features_stats_reply_t **reply)
+{
+    AIM_LOG_VERBOSE("table features get called\n");
+    *reply = of_table_features_stats_reply_new(request->version);
+    return INDIGO_ERROR_NONE;
+}
+
 indigo_error_t delete_error = INDIGO_ERROR_NONE;
 
 indigo_error_t
@@ -159,6 +199,10 @@ ind_cxn_reset(indigo_cxn_id_t cxn_id)
     return;
 }
 
+/* The last error sent to the controller */
+static int error_msg_count;
+static uint16_t error_msg_code;
+
 int
 indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
                           uint32_t xid, uint16_t type, uint16_t code,
@@ -166,14 +210,22 @@ indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
 {
     AIM_LOG_VERBOSE("Send error msg called for cxn id %d\n",
                       cxn_id);
+    error_msg_count++;
+    error_msg_code = code;
     return INDIGO_ERROR_NONE;
 }
 
+/* Called with each message sent to the controller, when set */
+static void (*controller_message_check)(of_object_t *obj);
+
 indigo_error_t
 indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
 {
     AIM_LOG_VERBOSE("Send msg called for cxn id %d, obj type %d\n",
                       cxn_id, obj->object_id);
+    if (controller_message_check != NULL) {
+        controller_message_check(obj);
+    }
     of_object_delete(obj);
     return INDIGO_ERROR_NONE;
 }
@@ -261,21 +313,33 @@ indigo_error_t indigo_port_desc_stats_get(
     return INDIGO_ERROR_NONE;
 }
 
+/* Must be more than OFSTATEMANAGER_CONFIG_GROUP_BUCKET_COUNT / 8 so
+   that ids share hash buckets */
+#define TEST_GROUP_COUNT 1000
+
+/* Group ids deleted from forwarding, in order */
+static int group_delete_count;
+static uint32_t group_delete_ids[TEST_GROUP_COUNT];
+
 indigo_error_t
 indigo_fwd_group_add(uint32_t id, uint8_t group_type, of_list_bucket_t *buckets)
 {
-    return INDIGO_ERROR_NOT_SUPPORTED;
+    return INDIGO_ERROR_NONE;
 }
 
 indigo_error_t
 indigo_fwd_group_modify(uint32_t id, of_list_bucket_t *buckets)
 {
-    return INDIGO_ERROR_NOT_SUPPORTED;
+    return INDIGO_ERROR_NONE;
 }
 
 void
 indigo_fwd_group_delete(uint32_t id)
 {
+    if (group_delete_count < TEST_GROUP_COUNT) {
+        group_delete_ids[group_delete_count] = id;
+    }
+    group_delete_count++;
 }
 
 void
@@ -345,13 +409,15 @@ depopulate_table(ft_instance_t ft)
 {
     int idx;
     ft_entry_t *entry;
+    of_match_t match;
     int count;
 
     count = ft->status.current_count;
     for (idx = 0; idx < count; ++idx) {
         entry = ft_lookup(ft, TEST_KEY(idx));
         TEST_ASSERT(entry != NULL);
-        TEST_ASSERT(entry->match.fields.eth_type == TEST_ETH_TYPE(idx));
+        ft_entry_match_get(entry, &match);
+        TEST_ASSERT(match.fields.eth_type == TEST_ETH_TYPE(idx));
         ft_delete_id(ft, TEST_KEY(idx));
         TEST_ASSERT(check_table_entry_states(ft) == 0);
     }
@@ -496,6 +562,10 @@ test_ft_hash(void)
 
     TEST_ASSERT(ft->status.current_count == 2);
     TEST_ASSERT(check_table_entry_states(ft) == 0);
+    /* Identical actions are interned */
+    TEST_ASSERT(ft->status.effects_lists == 1);
+    TEST_ASSERT(ft_lookup(ft, TEST_ENT_ID)->effects.actions ==
+                ft_lookup(ft, TEST_ENT_ID + 1)->effects.actions);
     entry = ft_lookup(ft, TEST_ENT_ID);
     ft_destroy(ft);
     of_object_delete(flow_add);
@@ -653,6 +723,8 @@ test_ft_hash(void)
 
     TEST_OK(depopulate_table(ft));
     TEST_ASSERT(check_bucket_counts(ft, 0) == 0);
+    TEST_ASSERT(ft->status.effects_lists == 0);
+    TEST_ASSERT(ft->status.entry_bytes == 0);
     ft_destroy(ft);
     ft = NULL;
 
@@ -1177,6 +1249,293 @@ test_flow_stats(void)
     return TEST_PASS;
 }
 
+/****************************************************************
+ * Groups
+ ****************************************************************/
+
+/* Group id of an OF-DPA group entry type, as group_handlers.c reads it */
+#define TEST_GROUP_ID(type, idx) (((uint32_t)(type) << 28) | (idx))
+
+/* As in group_handlers.c */
+#define TEST_GROUP_REPLY_MAX (1 << 15)
+
+/*
+ * Make a group mod with empty_buckets buckets without actions, then
+ * action_buckets buckets holding one pop_vlan action
+ */
+static of_group_mod_t *
+group_mod_new(uint16_t command, uint32_t id, int empty_buckets,
+              int action_buckets)
+{
+    of_group_mod_t *group_mod;
+    of_list_bucket_t buckets;
+    of_list_action_t actions;
+    of_bucket_t *bucket;
+    of_action_pop_vlan_t *action;
+    int idx;
+
+    group_mod = of_group_mod_new(OF_VERSION_1_3);
+    AIM_TRUE_OR_DIE(group_mod != NULL);
+    of_group_mod_command_set(group_mod, command);
+    of_group_mod_group_type_set(group_mod, OF_GROUP_TYPE_ALL);
+    of_group_mod_group_id_set(group_mod, id);
+    of_group_mod_buckets_bind(group_mod, &buckets);
+
+    for (idx = 0; idx < empty_buckets + action_buckets; idx++) {
+        bucket = of_bucket_new(OF_VERSION_1_3);
+        AIM_TRUE_OR_DIE(bucket != NULL);
+        if (idx >= empty_buckets) {
+            of_bucket_actions_bind(bucket, &actions);
+            action = of_action_pop_vlan_new(OF_VERSION_1_3);
+            AIM_TRUE_OR_DIE(action != NULL);
+            AIM_TRUE_OR_DIE(of_list_append(&actions, action) == 0);
+            of_object_delete(action);
+        }
+        AIM_TRUE_OR_DIE(of_list_append(&buckets, bucket) == 0);
+        of_object_delete(bucket);
+    }
+
+    return group_mod;
+}
+
+static int
+group_mod(uint16_t command, uint32_t id, int empty_buckets, int action_buckets)
+{
+    error_msg_count = 0;
+    handle_message(group_mod_new(command, id, empty_buckets, action_buckets));
+    TEST_INDIGO_OK(do_barrier());
+    return error_msg_count == 0 ? INDIGO_ERROR_NONE : error_msg_code;
+}
+
+/* What came back in a multipart reply made of several messages */
+static struct {
+    int messages;
+    int entries;
+    int empty;          /* messages with no entries */
+    int more_last;      /* the last message had the "more" flag */
+    int more_missing;   /* a message before the last lacked it */
+    int too_long;       /* messages over the segment size, less one entry */
+    uint32_t ids[TEST_GROUP_COUNT + 2];
+} group_reply;
+
+static void
+group_reply_check(of_object_t *obj)
+{
+    of_list_group_desc_stats_entry_t desc_entries;
+    of_group_desc_stats_entry_t desc_entry;
+    of_list_group_stats_entry_t stats_entries;
+    of_group_stats_entry_t stats_entry;
+    uint16_t flags;
+    uint32_t id;
+    uint32_t last_length = 0;
+    int count = 0;
+    int rv;
+
+    if (obj->object_id == OF_GROUP_DESC_STATS_REPLY) {
+        of_group_desc_stats_reply_flags_get(obj, &flags);
+        of_group_desc_stats_reply_entries_bind(obj, &desc_entries);
+        OF_LIST_GROUP_DESC_STATS_ENTRY_ITER(&desc_entries, &desc_entry, rv) {
+            of_group_desc_stats_entry_group_id_get(&desc_entry, &id);
+            last_length = desc_entry.length;
+            if (group_reply.entries < AIM_ARRAYSIZE(group_reply.ids)) {
+                group_reply.ids[group_reply.entries] = id;
+            }
+            group_reply.entries++;
+            count++;
+        }
+    } else if (obj->object_id == OF_GROUP_STATS_REPLY) {
+        of_group_stats_reply_flags_get(obj, &flags);
+        of_group_stats_reply_entries_bind(obj, &stats_entries);
+        OF_LIST_GROUP_STATS_ENTRY_ITER(&stats_entries, &stats_entry, rv) {
+            of_group_stats_entry_group_id_get(&stats_entry, &id);
+            last_length = stats_entry.length;
+            if (group_reply.entries < AIM_ARRAYSIZE(group_reply.ids)) {
+                group_reply.ids[group_reply.entries] = id;
+            }
+            group_reply.entries++;
+            count++;
+        }
+    } else {
+        return;
+    }
+
+    if (group_reply.messages > 0 && !group_reply.more_last) {
+        group_reply.more_missing++;
+    }
+    group_reply.messages++;
+    group_reply.more_last = flags & 1;
+    group_reply.empty += (count == 0);
+    group_reply.too_long += (count > 1 &&
+                             obj->length - last_length > TEST_GROUP_REPLY_MAX);
+}
+
+static int
+group_request(of_object_t *request)
+{
+    memset(&group_reply, 0, sizeof(group_reply));
+    controller_message_check = group_reply_check;
+    handle_message(request);
+    TEST_INDIGO_OK(do_barrier());
+    controller_message_check = NULL;
+
+    TEST_ASSERT(group_reply.messages > 0);
+    TEST_ASSERT(!group_reply.more_last);
+    TEST_ASSERT(group_reply.more_missing == 0);
+    TEST_ASSERT(group_reply.too_long == 0);
+    return TEST_PASS;
+}
+
+static int
+group_desc_request(void)
+{
+    return group_request(of_group_desc_stats_request_new(OF_VERSION_1_3));
+}
+
+static int
+group_stats_request(uint32_t id)
+{
+    of_group_stats_request_t *request;
+
+    request = of_group_stats_request_new(OF_VERSION_1_3);
+    TEST_ASSERT(request != NULL);
+    of_group_stats_request_group_id_set(request, id);
+    return group_request(request);
+}
+
+/* Position of a group id type in the delete-all order */
+static int
+group_delete_rank(uint32_t id)
+{
+    static const uint8_t order[] = {
+        15, 14, 13, 12, 11, 10, 9, 7, 6, 4, 3, 8, 2, 5, 1, 0
+    };
+    int idx;
+
+    for (idx = 0; idx < AIM_ARRAYSIZE(order); idx++) {
+        if (order[idx] == (id >> 28)) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+/* Group id types used by the tests: L2 interface, L3 unicast, L3 ECMP */
+static const uint8_t test_group_types[] = { 0, 2, 7 };
+
+static uint32_t
+test_group_id(int idx)
+{
+    return TEST_GROUP_ID(test_group_types[idx % AIM_ARRAYSIZE(test_group_types)],
+                         idx);
+}
+
+static int
+test_group_index(void)
+{
+    int idx;
+
+    for (idx = 0; idx < TEST_GROUP_COUNT; idx++) {
+        TEST_INDIGO_OK(group_mod(OF_GROUP_ADD, test_group_id(idx), 0, 1));
+    }
+
+    /* Every group is found through its hash bucket */
+    TEST_ASSERT(group_mod(OF_GROUP_ADD, test_group_id(0), 0, 1) ==
+                OF_GROUP_MOD_FAILED_GROUP_EXISTS);
+    for (idx = 0; idx < TEST_GROUP_COUNT; idx++) {
+        TEST_INDIGO_OK(group_mod(OF_GROUP_MODIFY, test_group_id(idx), 0, 2));
+    }
+    TEST_ASSERT(group_mod(OF_GROUP_MODIFY, test_group_id(TEST_GROUP_COUNT), 0, 1) ==
+                OF_GROUP_MOD_FAILED_UNKNOWN_GROUP);
+
+    /* Removing every other group leaves the rest on their buckets */
+    group_delete_count = 0;
+    for (idx = 0; idx < TEST_GROUP_COUNT; idx += 2) {
+        TEST_INDIGO_OK(group_mod(OF_GROUP_DELETE, test_group_id(idx), 0, 0));
+    }
+    TEST_ASSERT(group_delete_count == TEST_GROUP_COUNT / 2);
+    for (idx = 0; idx < TEST_GROUP_COUNT; idx++) {
+        TEST_ASSERT(group_mod(OF_GROUP_MODIFY, test_group_id(idx), 0, 1) ==
+                    (idx % 2 ? INDIGO_ERROR_NONE :
+                     OF_GROUP_MOD_FAILED_UNKNOWN_GROUP));
+    }
+
+    /* Groups are reported in the order they were added */
+    TEST_ASSERT(group_desc_request() == TEST_PASS);
+    TEST_ASSERT(group_reply.entries == TEST_GROUP_COUNT / 2);
+    for (idx = 0; idx < TEST_GROUP_COUNT / 2; idx++) {
+        TEST_ASSERT(group_reply.ids[idx] == test_group_id(2 * idx + 1));
+    }
+
+    TEST_ASSERT(group_stats_request(test_group_id(1)) == TEST_PASS);
+    TEST_ASSERT(group_reply.entries == 1);
+    TEST_ASSERT(group_reply.ids[0] == test_group_id(1));
+    TEST_ASSERT(group_stats_request(test_group_id(0)) == TEST_PASS);
+    TEST_ASSERT(group_reply.entries == 0);
+
+    /* Delete all removes referencing group types first */
+    group_delete_count = 0;
+    TEST_INDIGO_OK(group_mod(OF_GROUP_DELETE, OF_GROUP_ALL, 0, 0));
+    TEST_ASSERT(group_delete_count == TEST_GROUP_COUNT / 2);
+    for (idx = 1; idx < group_delete_count; idx++) {
+        TEST_ASSERT(group_delete_rank(group_delete_ids[idx - 1]) <=
+                    group_delete_rank(group_delete_ids[idx]));
+    }
+    TEST_ASSERT(group_mod(OF_GROUP_MODIFY, test_group_id(1), 0, 1) ==
+                OF_GROUP_MOD_FAILED_UNKNOWN_GROUP);
+
+    TEST_ASSERT(group_desc_request() == TEST_PASS);
+    TEST_ASSERT(group_reply.entries == 0);
+
+    return TEST_PASS;
+}
+
+static int
+test_group_segments(void)
+{
+    /* 16 bytes a bucket, so about 8 groups a segment */
+    const int buckets = 256;
+    int idx;
+
+    for (idx = 0; idx < TEST_GROUP_COUNT / 10; idx++) {
+        TEST_INDIGO_OK(group_mod(OF_GROUP_ADD, test_group_id(idx), buckets, 0));
+    }
+
+    TEST_ASSERT(group_desc_request() == TEST_PASS);
+    TEST_ASSERT(group_reply.messages > TEST_GROUP_COUNT / 10 / 8);
+    TEST_ASSERT(group_reply.empty == 0);
+    TEST_ASSERT(group_reply.entries == TEST_GROUP_COUNT / 10);
+    for (idx = 0; idx < TEST_GROUP_COUNT / 10; idx++) {
+        TEST_ASSERT(group_reply.ids[idx] == test_group_id(idx));
+    }
+
+    TEST_ASSERT(group_stats_request(OF_GROUP_ALL) == TEST_PASS);
+    TEST_ASSERT(group_reply.empty == 0);
+    TEST_ASSERT(group_reply.entries == TEST_GROUP_COUNT / 10);
+
+    TEST_INDIGO_OK(group_mod(OF_GROUP_DELETE, OF_GROUP_ALL, 0, 0));
+
+    /* A first group bigger than a segment goes out alone, not after an
+       empty segment */
+    TEST_INDIGO_OK(group_mod(OF_GROUP_ADD, test_group_id(0), 3000, 0));
+    TEST_INDIGO_OK(group_mod(OF_GROUP_ADD, test_group_id(1), 1, 0));
+    TEST_ASSERT(group_desc_request() == TEST_PASS);
+    TEST_ASSERT(group_reply.messages == 2);
+    TEST_ASSERT(group_reply.empty == 0);
+    TEST_ASSERT(group_reply.entries == 2);
+
+    /* A group whose description cannot fit in any reply is skipped; the
+       group mod has 16 bytes of header, its description 24 */
+    TEST_INDIGO_OK(group_mod(OF_GROUP_ADD, test_group_id(2), 4093, 1));
+    TEST_ASSERT(group_desc_request() == TEST_PASS);
+    TEST_ASSERT(group_reply.entries == 2);
+    TEST_ASSERT(group_reply.ids[0] == test_group_id(0));
+    TEST_ASSERT(group_reply.ids[1] == test_group_id(1));
+
+    TEST_INDIGO_OK(group_mod(OF_GROUP_DELETE, OF_GROUP_ALL, 0, 0));
+
+    return TEST_PASS;
+}
+
 int
 aim_main(int argc, char* argv[])
 {
@@ -1208,6 +1567,8 @@ aim_main(int argc, char* argv[])
     RUN_TEST(exact_add_del);
     RUN_TEST(modify);
     RUN_TEST(modify_strict);
+    RUN_TEST(group_index);
+    RUN_TEST(group_segments);
 
     /* Kill logging for OFStateManager as next tests gen errors */
     aim_log_pvs_set(aim_log_find("ofstatemanager"), NULL);
@@ -1231,6 +1592,21 @@ aim_main(int argc, char* argv[])
     RUN_TEST(modify);
     RUN_TEST(modify_strict);
 
+    /* Run with creates completing after the message is handled, so
+       barriers must wait for them */
+    create_pending = 1;
+    create_error = INDIGO_ERROR_NONE;
+    delete_error = INDIGO_ERROR_NONE;
+    RUN_TEST(simple_add_del);
+    RUN_TEST(modify);
+    RUN_TEST(modify_strict);
+
+    /* And with them failing */
+    create_error = INDIGO_ERROR_UNKNOWN;
+    RUN_TEST(simple_add_del);
+    RUN_TEST(modify);
+    RUN_TEST(modify_strict);
+
     TRY(ind_core_enable_set(0));
     TRY(ind_core_finish());
 
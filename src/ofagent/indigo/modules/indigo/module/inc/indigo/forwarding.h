@@ -62,6 +62,10 @@ extern indigo_error_t indigo_fwd_forwarding_features_get(
  *
  * Create a flow for the forwarding engine.
  *
+ * The forwarding engine may return INDIGO_ERROR_PENDING, having set
+ * table_id, and finish the create later; it then reports the result
+ * with indigo_core_flow_create_callback.
+ *
  * Ownership of the flow_add LOXI object is maintained by the
  * caller (OF state manager).
  */
@@ -71,6 +75,24 @@ extern indigo_error_t indigo_fwd_flow_create(
     of_flow_add_t *flow_add,
     uint8_t *table_id);
 
+/**
+ * @brief Flow match validate
+ * @param table_id Table the flow is to be added to
+ * @param match The flow's match
+ * @param [out] bad_match_code OF_MATCH_FAILED_* code for a bad match
+ * @returns INDIGO_ERROR_COMPAT if the table cannot take the match
+ *
+ * Called for each flow add before the flow enters the state manager's
+ * flow table, so a match the forwarding engine would refuse is
+ * rejected without a flow create. Unknown tables are left to
+ * indigo_fwd_flow_create.
+ */
+
+extern indigo_error_t indigo_fwd_flow_match_validate(
+    uint8_t table_id,
+    of_match_t *match,
+    uint16_t *bad_match_code);
+
 /**
  * @brief Modify an existing flow.
  * @param flow_id Flow identifier
@@ -127,6 +149,21 @@ extern indigo_error_t indigo_fwd_table_stats_get(
     of_table_stats_request_t *table_stats_request,
     of_table_stats_reply_t **table_stats_reply);
 
+/**
+ * @brief Table features
+ * @param table_features_request The LOXI request, which carries no
+ * table features
+ * @param [out] table_features_reply The LOXI reply
+ * @return Return code from operation
+ *
+ * Ownership of the table_features_request LOXI object is maintained by the
+ * caller (OF state manager).
+ */
+
+extern indigo_error_t indigo_fwd_table_features_get(
+    of_table_features_stats_request_t *table_features_request,
+    of_table_features_stats_reply_t **table_features_reply);
+
 /**
  * @brief Packet out operation
  * @param packet_out The LOXI packet out message
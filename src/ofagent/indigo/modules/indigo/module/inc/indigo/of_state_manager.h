@@ -155,6 +155,22 @@ extern void indigo_core_flow_removed(
     indigo_fi_flow_removed_t reason,
     indigo_fi_flow_stats_t *stats);
 
+/**
+ * @brief Complete a pending flow create
+ * @param result The result of the create
+ * @param flow_id The flow_id given to indigo_fwd_flow_create
+ *
+ * Made once for each indigo_fwd_flow_create that returned
+ * INDIGO_ERROR_PENDING. The flow_add message is held until then, so
+ * a barrier on its connection is not answered before the create is
+ * done. On failure the flow is removed and the controller is sent an
+ * error.
+ */
+
+extern void indigo_core_flow_create_callback(
+    indigo_error_t result,
+    indigo_cookie_t flow_id);
+
 /****************************************************************
  * Asynchronous connection manager notification, disconnection mode
  ****************************************************************/
@@ -156,6 +156,14 @@
 	
 /* Indexed by version number */
 extern const uint64_t of_match_incompat[4];
+
+/**
+ * Alignment of of_match_fields_t.  The fields and masks of a match are
+ * compared as whole vectors of 64-bit words (see of_match_more_specific),
+ * so both are kept on a vector boundary and padded to a multiple of it.
+ */
+#define OF_MATCH_FIELDS_ALIGN 16
+
 /* Unified, flat OpenFlow match structure based on OF 1.2 */
 typedef struct of_match_fields_s {
     /* Version 1.2 is used for field names */
@@ -206,7 +214,7 @@ typedef struct of_match_fields_s {
     uint64_t             tunnel_id;
 #endif /* OFDPA_FIXUP */
 
-} of_match_fields_t;
+} __attribute__((aligned(OF_MATCH_FIELDS_ALIGN))) of_match_fields_t;
 
 /**
  * @brief The LOCI match structure.
@@ -468,10 +476,13 @@ of_match_eq(of_match_t *match1, of_match_t *match2)
  *
  * The query has the less specific mask (fewer mask bits) so it is
  * used for the mask when checking values.
+ *
+ * This is the field-by-field reference version; of_match_more_specific
+ * computes the same result over the whole structure at once.
  */
 
 static inline int
-of_match_more_specific(of_match_t *entry, of_match_t *query)
+of_match_more_specific_fields(of_match_t *entry, of_match_t *query)
 {
     of_match_fields_t *q_m, *e_m;  /* Short hand for masks, fields */
     of_match_fields_t *q_f, *e_f;
@@ -889,10 +900,11 @@ of_match_more_specific(of_match_t *entry, of_match_t *query)
  * @param match2 Another match struct
  * @returns Boolean: true if there is a packet that would match both
  *
+ * This is the field-by-field reference version; see of_match_overlap.
  */
 
 static inline int
-of_match_overlap(of_match_t *match1, of_match_t *match2)
+of_match_overlap_fields(of_match_t *match1, of_match_t *match2)
 {
     of_match_fields_t *m1, *m2;  /* Short hand for masks, fields */
     of_match_fields_t *f1, *f2;
@@ -1171,4 +1183,156 @@ of_match_overlap(of_match_t *match1, of_match_t *match2)
     return 1; /* No field differentiates matches */
 }
 
+/*
+ * Word-wise match comparison kernels
+ *
+ * Every per-field test above is a pure bitwise relation, so it holds for
+ * the whole match exactly when it holds for every 64-bit word of the
+ * fields/masks structures.  Padding is zero in both (matches are memset
+ * on init, as of_match_eq already assumes), which makes it neutral.
+ *
+ * The kernels OR together the "violation" bits of all words and test the
+ * accumulator once at the end, so there are no data dependent branches.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define OF_MATCH_FIELDS_WORDS (sizeof(of_match_fields_t) / sizeof(uint64_t))
+
+/* The structures are read as words, so the word type must alias them */
+typedef uint64_t __attribute__((__may_alias__)) of_match_word_t;
+
+/**
+ * Violation bits for entry-more-specific-than-query:
+ * mask bits in the query missing from the entry, or value bits that
+ * differ under the query mask.
+ */
+static inline int
+of_match_words_more_specific(const of_match_word_t *e_f,
+                             const of_match_word_t *e_m,
+                             const of_match_word_t *q_f,
+                             const of_match_word_t *q_m)
+{
+    uint64_t acc = 0;
+    int idx = 0;
+
+#if defined(__AVX2__)
+    __m256i vacc = _mm256_setzero_si256();
+
+    for (; idx + 4 <= (int)OF_MATCH_FIELDS_WORDS; idx += 4) {
+        __m256i ef = _mm256_loadu_si256((const __m256i *)(e_f + idx));
+        __m256i em = _mm256_loadu_si256((const __m256i *)(e_m + idx));
+        __m256i qf = _mm256_loadu_si256((const __m256i *)(q_f + idx));
+        __m256i qm = _mm256_loadu_si256((const __m256i *)(q_m + idx));
+        vacc = _mm256_or_si256(vacc, _mm256_andnot_si256(em, qm));
+        vacc = _mm256_or_si256(vacc,
+                   _mm256_and_si256(_mm256_xor_si256(ef, qf), qm));
+    }
+    acc |= !_mm256_testz_si256(vacc, vacc);
+#endif
+#if defined(__SSE2__)
+    {
+        __m128i vacc2 = _mm_setzero_si128();
+
+        for (; idx + 2 <= (int)OF_MATCH_FIELDS_WORDS; idx += 2) {
+            __m128i ef = _mm_loadu_si128((const __m128i *)(e_f + idx));
+            __m128i em = _mm_loadu_si128((const __m128i *)(e_m + idx));
+            __m128i qf = _mm_loadu_si128((const __m128i *)(q_f + idx));
+            __m128i qm = _mm_loadu_si128((const __m128i *)(q_m + idx));
+            vacc2 = _mm_or_si128(vacc2, _mm_andnot_si128(em, qm));
+            vacc2 = _mm_or_si128(vacc2,
+                        _mm_and_si128(_mm_xor_si128(ef, qf), qm));
+        }
+        acc |= _mm_movemask_epi8(
+            _mm_cmpeq_epi8(vacc2, _mm_setzero_si128())) ^ 0xffff;
+    }
+#endif
+    for (; idx < (int)OF_MATCH_FIELDS_WORDS; idx++) {
+        acc |= ~e_m[idx] & q_m[idx];
+        acc |= (e_f[idx] ^ q_f[idx]) & q_m[idx];
+    }
+
+    return acc == 0;
+}
+
+/**
+ * Violation bits for overlap: value bits that differ under both masks.
+ */
+static inline int
+of_match_words_overlap(const of_match_word_t *f1,
+                       const of_match_word_t *m1,
+                       const of_match_word_t *f2,
+                       const of_match_word_t *m2)
+{
+    uint64_t acc = 0;
+    int idx = 0;
+
+#if defined(__AVX2__)
+    __m256i vacc = _mm256_setzero_si256();
+
+    for (; idx + 4 <= (int)OF_MATCH_FIELDS_WORDS; idx += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(f1 + idx));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(f2 + idx));
+        __m256i ma = _mm256_loadu_si256((const __m256i *)(m1 + idx));
+        __m256i mb = _mm256_loadu_si256((const __m256i *)(m2 + idx));
+        vacc = _mm256_or_si256(vacc,
+                   _mm256_and_si256(_mm256_xor_si256(a, b),
+                                    _mm256_and_si256(ma, mb)));
+    }
+    acc |= !_mm256_testz_si256(vacc, vacc);
+#endif
+#if defined(__SSE2__)
+    {
+        __m128i vacc2 = _mm_setzero_si128();
+
+        for (; idx + 2 <= (int)OF_MATCH_FIELDS_WORDS; idx += 2) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(f1 + idx));
+            __m128i b = _mm_loadu_si128((const __m128i *)(f2 + idx));
+            __m128i ma = _mm_loadu_si128((const __m128i *)(m1 + idx));
+            __m128i mb = _mm_loadu_si128((const __m128i *)(m2 + idx));
+            vacc2 = _mm_or_si128(vacc2,
+                        _mm_and_si128(_mm_xor_si128(a, b),
+                                      _mm_and_si128(ma, mb)));
+        }
+        acc |= _mm_movemask_epi8(
+            _mm_cmpeq_epi8(vacc2, _mm_setzero_si128())) ^ 0xffff;
+    }
+#endif
+    for (; idx < (int)OF_MATCH_FIELDS_WORDS; idx++) {
+        acc |= (f1[idx] ^ f2[idx]) & m1[idx] & m2[idx];
+    }
+
+    return acc == 0;
+}
+
+/**
+ * Is the entry match more specific than (or equal to) the query match?
+ *
+ * Same semantics as of_match_more_specific_fields.
+ */
+static inline int
+of_match_more_specific(of_match_t *entry, of_match_t *query)
+{
+    return of_match_words_more_specific(
+        (const of_match_word_t *)&entry->fields, (const of_match_word_t *)&entry->masks,
+        (const of_match_word_t *)&query->fields, (const of_match_word_t *)&query->masks);
+}
+
+/**
+ * Do two entries overlap?
+ *
+ * Same semantics as of_match_overlap_fields.
+ */
+static inline int
+of_match_overlap(of_match_t *match1, of_match_t *match2)
+{
+    return of_match_words_overlap(
+        (const of_match_word_t *)&match1->fields, (const of_match_word_t *)&match1->masks,
+        (const of_match_word_t *)&match2->fields, (const of_match_word_t *)&match2->masks);
+}
+
 #endif /* Match header file */
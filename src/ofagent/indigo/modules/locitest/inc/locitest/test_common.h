@@ -51,6 +51,7 @@ extern int test_dump_objs(void);
 
 /* In test_match_utils.c */
 extern int test_match_utils(void);
+extern int test_match_utils_random(void);
 
 extern int run_unified_accessor_tests(void);
 extern int run_match_tests(void);
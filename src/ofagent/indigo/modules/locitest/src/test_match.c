@@ -181,6 +181,7 @@ int run_match_tests(void)
     RUN_TEST(match_2);
     RUN_TEST(match_3);
     RUN_TEST(match_utils);
+    RUN_TEST(match_utils_random);
 
     return TEST_PASS;
 }
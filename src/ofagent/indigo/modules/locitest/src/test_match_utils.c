@@ -10,6 +10,7 @@
  */
 
 #include <locitest/test_common.h>
+#include <time.h>
 
 int
 test_match_utils(void)
@@ -196,3 +197,132 @@ test_match_utils(void)
     
     return TEST_PASS;
 }
+
+/*
+ * Randomized comparison of the word-wise match kernels against the
+ * field-by-field reference versions, plus a small timing loop.
+ */
+
+#define MATCH_RANDOM_COUNT 256
+#define MATCH_BENCH_ITERS 100
+
+static uint32_t
+match_random_mask32(void)
+{
+    switch (rand() % 4) {
+    case 0: return 0;
+    case 1: return 0xffffffff;
+    default: return 0xffffffff << (rand() % 32);
+    }
+}
+
+static void
+match_random_fill(of_match_t *match)
+{
+    int idx;
+
+    memset(match, 0, sizeof(*match));
+    match->version = OF_VERSION_1_3;
+
+    match->fields.in_port = rand() % 8;
+    match->masks.in_port = (rand() % 2) ? 0xffffffff : 0;
+    for (idx = 0; idx < OF_MAC_ADDR_BYTES; idx++) {
+        match->fields.eth_dst.addr[idx] = rand() % 4;
+        match->masks.eth_dst.addr[idx] = (rand() % 2) ? 0xff : 0;
+    }
+    match->fields.eth_type = (rand() % 2) ? 0x0800 : 0x86dd;
+    match->masks.eth_type = (rand() % 2) ? 0xffff : 0;
+    match->fields.vlan_vid = 0x1000 | (rand() % 4);
+    match->masks.vlan_vid = (rand() % 2) ? 0x1fff : 0x1000;
+    match->fields.ipv4_dst = rand();
+    match->masks.ipv4_dst = match_random_mask32();
+    match->fields.ip_proto = (rand() % 2) ? 6 : 17;
+    match->masks.ip_proto = (rand() % 2) ? 0xff : 0;
+    for (idx = 0; idx < OF_IPV6_BYTES; idx++) {
+        match->fields.ipv6_src.addr[idx] = rand() % 2;
+        match->masks.ipv6_src.addr[idx] = (rand() % 4) ? 0 : 0xff;
+    }
+    match->fields.bsn_vrf = rand() % 4;
+    match->masks.bsn_vrf = (rand() % 2) ? 0xffffffff : 0;
+    match->fields.ip_dscp = rand() % 4;
+    match->masks.ip_dscp = (rand() % 2) ? 0x3f : 0;
+
+    of_match_values_mask(match);
+}
+
+static double
+match_elapsed_ns(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e9 +
+        (end->tv_nsec - start->tv_nsec);
+}
+
+int
+test_match_utils_random(void)
+{
+    static of_match_t matches[MATCH_RANDOM_COUNT];
+    struct timespec start, end;
+    int i, j, iter;
+    int hits_fields = 0, hits_words = 0;
+    double ns_fields, ns_words;
+
+    srand(0x0f1a);
+    for (i = 0; i < MATCH_RANDOM_COUNT; i++) {
+        match_random_fill(&matches[i]);
+        if (i % 2) {
+            /* Widen the previous match so some pairs are related */
+            matches[i] = matches[i - 1];
+            matches[i].masks.ipv4_dst &= match_random_mask32();
+            if (rand() % 2) {
+                memset(&matches[i].masks.eth_dst, 0, sizeof(of_mac_addr_t));
+            }
+            if (rand() % 2) {
+                matches[i].masks.in_port = 0;
+            }
+            of_match_values_mask(&matches[i]);
+        }
+    }
+
+    for (i = 0; i < MATCH_RANDOM_COUNT; i++) {
+        for (j = 0; j < MATCH_RANDOM_COUNT; j++) {
+            TEST_ASSERT(of_match_more_specific(&matches[i], &matches[j]) ==
+                of_match_more_specific_fields(&matches[i], &matches[j]));
+            TEST_ASSERT(of_match_overlap(&matches[i], &matches[j]) ==
+                of_match_overlap_fields(&matches[i], &matches[j]));
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (iter = 0; iter < MATCH_BENCH_ITERS; iter++) {
+        for (i = 0; i < MATCH_RANDOM_COUNT; i++) {
+            for (j = 0; j < MATCH_RANDOM_COUNT; j++) {
+                hits_fields +=
+                    of_match_more_specific_fields(&matches[i], &matches[j]);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns_fields = match_elapsed_ns(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (iter = 0; iter < MATCH_BENCH_ITERS; iter++) {
+        for (i = 0; i < MATCH_RANDOM_COUNT; i++) {
+            for (j = 0; j < MATCH_RANDOM_COUNT; j++) {
+                hits_words += of_match_more_specific(&matches[i], &matches[j]);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns_words = match_elapsed_ns(&start, &end);
+
+    TEST_ASSERT(hits_fields == hits_words);
+
+    fprintf(stderr, "\n  of_match_more_specific: fields %.1f ns/op, "
+            "words %.1f ns/op\n",
+            ns_fields / ((double)MATCH_BENCH_ITERS *
+                         MATCH_RANDOM_COUNT * MATCH_RANDOM_COUNT),
+            ns_words / ((double)MATCH_BENCH_ITERS *
+                        MATCH_RANDOM_COUNT * MATCH_RANDOM_COUNT));
+
+    return TEST_PASS;
+}
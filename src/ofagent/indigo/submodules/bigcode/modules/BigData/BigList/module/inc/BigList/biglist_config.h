@@ -114,6 +114,16 @@
 #define BIGLIST_CONFIG_INCLUDE_LOCKED 1
 #endif
 
+/**
+ * BIGLIST_CONFIG_DEQUE_SLAB_SIZE
+ *
+ * Number of links allocated at once by a deque. */
+
+
+#ifndef BIGLIST_CONFIG_DEQUE_SLAB_SIZE
+#define BIGLIST_CONFIG_DEQUE_SLAB_SIZE 32
+#endif
+
 
 
 /**
@@ -0,0 +1,142 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**************************************************************************//**
+ *
+ * module/inc/biglist_deque.h
+ *
+ * @file
+ * @brief Tail-aware, Pooled List Interface
+ *
+ * A deque keeps head and tail pointers and a cached length, so
+ * operations at either end are constant time. Elements are ordinary
+ * biglist_t links drawn from per-deque slabs, so the deque head can be
+ * walked with biglist_next() and BIGLIST_FOREACH().
+ *
+ * @addtogroup biglist-deque
+ * @{
+ *
+ *****************************************************************************/
+#ifndef __BIGLIST_DEQUE_H__
+#define __BIGLIST_DEQUE_H__
+
+#include <BigList/biglist_config.h>
+#include <BigList/biglist.h>
+
+/**
+ * Deque head.
+ */
+typedef struct biglist_deque_s {
+    /** First element */
+    biglist_t* head;
+    /** Last element */
+    biglist_t* tail;
+    /** Number of elements */
+    int length;
+
+    /** Free links */
+    biglist_t* pool;
+    /** Slabs backing the free links */
+    void* slabs;
+
+    /** Pending lock-free pushes, most recent first */
+    biglist_t* mpsc;
+} biglist_deque_t;
+
+/**
+ * @brief Initialize a deque.
+ * @param dq The deque.
+ */
+void biglist_deque_init(biglist_deque_t* dq);
+
+/**
+ * @brief Deinitialize a deque and release all of its memory.
+ * @param dq The deque.
+ * @note The client data is NOT freed.
+ */
+void biglist_deque_denit(biglist_deque_t* dq);
+
+/**
+ * @brief Add an element at the head.
+ * @param dq The deque.
+ * @param data The client data.
+ * @returns The new link, or NULL on allocation failure.
+ */
+biglist_t* biglist_deque_push_head(biglist_deque_t* dq, void* data);
+
+/**
+ * @brief Add an element at the tail.
+ * @param dq The deque.
+ * @param data The client data.
+ * @returns The new link, or NULL on allocation failure.
+ */
+biglist_t* biglist_deque_push_tail(biglist_deque_t* dq, void* data);
+
+/**
+ * @brief Remove the element at the head.
+ * @param dq The deque.
+ * @returns The client data, or NULL if the deque is empty.
+ */
+void* biglist_deque_pop_head(biglist_deque_t* dq);
+
+/**
+ * @brief Remove the element at the tail.
+ * @param dq The deque.
+ * @returns The client data, or NULL if the deque is empty.
+ */
+void* biglist_deque_pop_tail(biglist_deque_t* dq);
+
+/**
+ * @brief Remove a specific link.
+ * @param dq The deque.
+ * @param blink The link to remove.
+ * @note This operation is constant time. The link is returned to the
+ * deque's pool and must not be used afterwards.
+ */
+void biglist_deque_remove_link(biglist_deque_t* dq, biglist_t* blink);
+
+/**
+ * @brief Get the number of elements.
+ * @param dq The deque.
+ * @note This operation is constant time.
+ */
+int biglist_deque_length(biglist_deque_t* dq);
+
+/**
+ * @brief Push an element from any thread.
+ * @param dq The deque.
+ * @param data The client data.
+ * @returns 0 on success, -1 on allocation failure.
+ *
+ * @note Any number of threads may push concurrently without a lock. The
+ * element is not visible until the owner calls biglist_deque_mpsc_drain().
+ */
+int biglist_deque_mpsc_push(biglist_deque_t* dq, void* data);
+
+/**
+ * @brief Move all pending pushes to the tail, in push order.
+ * @param dq The deque.
+ * @returns The number of elements moved.
+ * @note Only the thread which owns the deque may call this.
+ */
+int biglist_deque_mpsc_drain(biglist_deque_t* dq);
+
+#endif /* __BIGLIST_DEQUE_H__ */
+
+/* @} */
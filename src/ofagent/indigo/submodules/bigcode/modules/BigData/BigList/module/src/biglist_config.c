@@ -71,6 +71,11 @@ biglist_config_settings_t biglist_config_settings[] =
     { __biglist_config_STRINGIFY_NAME(BIGLIST_CONFIG_INCLUDE_LOCKED), __biglist_config_STRINGIFY_VALUE(BIGLIST_CONFIG_INCLUDE_LOCKED) },
 #else
 { BIGLIST_CONFIG_INCLUDE_LOCKED(__biglist_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef BIGLIST_CONFIG_DEQUE_SLAB_SIZE
+    { __biglist_config_STRINGIFY_NAME(BIGLIST_CONFIG_DEQUE_SLAB_SIZE), __biglist_config_STRINGIFY_VALUE(BIGLIST_CONFIG_DEQUE_SLAB_SIZE) },
+#else
+{ BIGLIST_CONFIG_DEQUE_SLAB_SIZE(__biglist_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -0,0 +1,43 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/******************************************************************************
+ *
+ * module/src/biglist_deque_denit.c
+ *
+ *
+ *****************************************************************************/
+#include "biglist_int.h"
+
+void
+biglist_deque_denit(biglist_deque_t* dq)
+{
+    biglist_deque_slab_t* slab;
+
+    /* Discard pending lock-free pushes */
+    biglist_free(__atomic_exchange_n(&dq->mpsc, NULL, __ATOMIC_ACQUIRE));
+
+    slab = dq->slabs;
+    while(slab) {
+        biglist_deque_slab_t* next = slab->next;
+        aim_free(slab);
+        slab = next;
+    }
+    BIGLIST_MEMSET(dq, 0, sizeof(*dq));
+}
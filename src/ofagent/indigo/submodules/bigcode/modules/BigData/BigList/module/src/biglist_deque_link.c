@@ -0,0 +1,65 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/******************************************************************************
+ *
+ * module/src/biglist_deque_link.c
+ *
+ *
+ *****************************************************************************/
+#include "biglist_int.h"
+
+biglist_t*
+biglist_deque_link_alloc(biglist_deque_t* dq, void* data)
+{
+    biglist_t* ble = dq->pool;
+
+    if(ble == NULL) {
+        /* Carve a new slab into free links */
+        int i;
+        biglist_deque_slab_t* slab = aim_zmalloc(sizeof(*slab));
+        if(slab == NULL) {
+            return NULL;
+        }
+        slab->next = dq->slabs;
+        dq->slabs = slab;
+        for(i = BIGLIST_CONFIG_DEQUE_SLAB_SIZE - 1; i > 0; i--) {
+            slab->links[i].next = dq->pool;
+            dq->pool = slab->links + i;
+        }
+        ble = slab->links;
+    }
+    else {
+        dq->pool = ble->next;
+    }
+
+    ble->data = data;
+    ble->next = NULL;
+    ble->previous = NULL;
+    return ble;
+}
+
+void
+biglist_deque_link_free(biglist_deque_t* dq, biglist_t* ble)
+{
+    ble->data = NULL;
+    ble->previous = NULL;
+    ble->next = dq->pool;
+    dq->pool = ble;
+}
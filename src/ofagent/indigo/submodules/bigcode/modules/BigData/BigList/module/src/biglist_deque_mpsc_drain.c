@@ -0,0 +1,52 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/******************************************************************************
+ *
+ * module/src/biglist_deque_mpsc_drain.c
+ *
+ *
+ *****************************************************************************/
+#include "biglist_int.h"
+
+int
+biglist_deque_mpsc_drain(biglist_deque_t* dq)
+{
+    int count = 0;
+    biglist_t* reversed = NULL;
+    biglist_t* ble = __atomic_exchange_n(&dq->mpsc, NULL, __ATOMIC_ACQUIRE);
+
+    /* Pending links are most recent first */
+    while(ble) {
+        biglist_t* next = ble->next;
+        ble->next = reversed;
+        reversed = ble;
+        ble = next;
+    }
+
+    while(reversed) {
+        biglist_t* next = reversed->next;
+        if(biglist_deque_push_tail(dq, reversed->data)) {
+            count++;
+        }
+        aim_free(reversed);
+        reversed = next;
+    }
+    return count;
+}
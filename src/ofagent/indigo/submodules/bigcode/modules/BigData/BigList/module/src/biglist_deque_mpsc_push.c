@@ -0,0 +1,45 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/******************************************************************************
+ *
+ * module/src/biglist_deque_mpsc_push.c
+ *
+ *
+ *****************************************************************************/
+#include "biglist_int.h"
+
+int
+biglist_deque_mpsc_push(biglist_deque_t* dq, void* data)
+{
+    /*
+     * Producers cannot share the deque's pool, so pending links come
+     * from the heap. They are recycled into pooled links on drain.
+     */
+    biglist_t* ble = biglist_alloc(data, NULL, NULL);
+    if(ble == NULL) {
+        return -1;
+    }
+    ble->next = __atomic_load_n(&dq->mpsc, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&dq->mpsc, &ble->next, ble, 1,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        /* ble->next was reloaded by the failed exchange */
+    }
+    return 0;
+}
@@ -30,6 +30,27 @@
 #include <BigList/biglist_config.h>
 #include <BigList/biglist.h>
 #include <BigList/biglist_locked.h>
+#include <BigList/biglist_deque.h>
+
+/**
+ * Deque link slab.
+ */
+typedef struct biglist_deque_slab_s {
+    /** Next slab */
+    struct biglist_deque_slab_s* next;
+    /** Links */
+    biglist_t links[BIGLIST_CONFIG_DEQUE_SLAB_SIZE];
+} biglist_deque_slab_t;
+
+/**
+ * Take a link from the deque's pool, growing it by a slab if empty.
+ */
+biglist_t* biglist_deque_link_alloc(biglist_deque_t* dq, void* data);
+
+/**
+ * Return a link to the deque's pool.
+ */
+void biglist_deque_link_free(biglist_deque_t* dq, biglist_t* ble);
 
 
 #endif /* __BIGLIST_INT_H__ */
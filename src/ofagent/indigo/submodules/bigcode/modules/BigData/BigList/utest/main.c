@@ -27,8 +27,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <BigList/biglist.h>
+#include <BigList/biglist_deque.h>
 
 #define FAIL(list, fmt, ...)                                        \
     do {                                                            \
@@ -327,6 +329,163 @@ int utest_BigList(void)
     return 0;
 }
 
+#define DQFAIL(dq, fmt, ...)                                        \
+    do {                                                            \
+        biglist_deque_denit(dq);                                    \
+        FATAL(fmt, __VA_ARGS__);                                    \
+    } while(0)
+
+int utest_BigListDeque(void)
+{
+    biglist_deque_t dq;
+    biglist_t* ble;
+    int i;
+
+    biglist_deque_init(&dq);
+
+    /* biglist_deque_push_tail, enough to span several slabs */
+    for(i = 0; i < 100; i++) {
+        if(biglist_deque_push_tail(&dq, IP(i)) == NULL) {
+            DQFAIL(&dq, "push_tail failed at %d", i);
+        }
+    }
+    if((i=biglist_deque_length(&dq)) != 100) {
+        DQFAIL(&dq, "length is %d, should be 100", i);
+    }
+    for(i = 0, ble = dq.head; ble; ble = biglist_next(ble), i++) {
+        if(ble->data != IP(i)) {
+            DQFAIL(&dq, "push_tail: elements do not match at %d", i);
+        }
+    }
+    if(dq.tail == NULL || dq.tail->data != IP(99)) {
+        DQFAIL(&dq, "tail is wrong, tail=%p", (void*)dq.tail);
+    }
+
+    /* biglist_deque_pop_head and biglist_deque_pop_tail */
+    if(biglist_deque_pop_head(&dq) != IP(0)) {
+        DQFAIL(&dq, "pop_head failed, length=%d", dq.length);
+    }
+    if(biglist_deque_pop_tail(&dq) != IP(99)) {
+        DQFAIL(&dq, "pop_tail failed, length=%d", dq.length);
+    }
+    if((i=biglist_deque_length(&dq)) != 98) {
+        DQFAIL(&dq, "length is %d, should be 98", i);
+    }
+
+    /* biglist_deque_push_head */
+    biglist_deque_push_head(&dq, IP(0));
+    if(dq.head->data != IP(0) || dq.head->next->data != IP(1)) {
+        DQFAIL(&dq, "push_head failed, head=%p", dq.head->data);
+    }
+
+    /* biglist_deque_remove_link */
+    biglist_deque_remove_link(&dq, dq.head->next->next);
+    if(dq.head->next->next->data != IP(3)) {
+        DQFAIL(&dq, "remove_link failed, data=%p", dq.head->next->next->data);
+    }
+    biglist_deque_remove_link(&dq, dq.tail);
+    if(dq.tail->data != IP(97) || dq.tail->next != NULL) {
+        DQFAIL(&dq, "remove_link at tail failed, data=%p", dq.tail->data);
+    }
+
+    /* Drain, then reuse the pooled links */
+    while(dq.head) {
+        biglist_deque_pop_head(&dq);
+    }
+    if(dq.head != NULL || dq.tail != NULL) {
+        DQFAIL(&dq, "deque not empty, head=%p", (void*)dq.head);
+    }
+    if(biglist_deque_pop_tail(&dq) != NULL) {
+        DQFAIL(&dq, "pop_tail on empty deque, length=%d", dq.length);
+    }
+    for(i = 1; i <= 10; i++) {
+        biglist_deque_push_head(&dq, IP(i));
+    }
+    for(i = 1; i <= 10; i++) {
+        if(biglist_deque_pop_tail(&dq) != IP(i)) {
+            DQFAIL(&dq, "pop_tail after reuse failed at %d", i);
+        }
+    }
+
+    /* biglist_deque_mpsc_push and biglist_deque_mpsc_drain */
+    biglist_deque_push_tail(&dq, IP(1));
+    for(i = 2; i <= 5; i++) {
+        if(biglist_deque_mpsc_push(&dq, IP(i)) < 0) {
+            DQFAIL(&dq, "mpsc_push failed at %d", i);
+        }
+    }
+    if(biglist_deque_length(&dq) != 1) {
+        DQFAIL(&dq, "mpsc_push visible before drain, length=%d", dq.length);
+    }
+    if((i=biglist_deque_mpsc_drain(&dq)) != 4) {
+        DQFAIL(&dq, "mpsc_drain moved %d, should be 4", i);
+    }
+    for(i = 1, ble = dq.head; ble; ble = biglist_next(ble), i++) {
+        if(ble->data != IP(i)) {
+            DQFAIL(&dq, "mpsc_drain: order is wrong at %d", i);
+        }
+    }
+    if(i != 6) {
+        DQFAIL(&dq, "mpsc_drain: %d elements", i - 1);
+    }
+
+    /* Pending pushes are released by denit */
+    biglist_deque_mpsc_push(&dq, IP(6));
+    biglist_deque_denit(&dq);
+    if(dq.head || dq.mpsc || dq.slabs) {
+        FATAL("denit did not reset the deque, head=%p", (void*)dq.head);
+    }
+    return 0;
+}
+
+/**
+ * Queue throughput: append at the tail and consume from the head,
+ * as a transmit queue does.
+ */
+#define BENCH_COUNT 2000
+#define BENCH_ROUNDS 50
+
+static double
+__elapsed(clock_t start)
+{
+    return (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+}
+
+int utest_BigListDequeBench(void)
+{
+    biglist_deque_t dq;
+    biglist_t* bl = NULL;
+    clock_t start;
+    int i, r;
+
+    start = clock();
+    for(r = 0; r < BENCH_ROUNDS; r++) {
+        for(i = 0; i < BENCH_COUNT; i++) {
+            bl = biglist_append(bl, IP(i));
+        }
+        while(bl) {
+            bl = biglist_remove_link_free(bl, bl);
+        }
+    }
+    printf("biglist_append:          %d x %d in %.1f ms\n",
+           BENCH_ROUNDS, BENCH_COUNT, __elapsed(start));
+
+    biglist_deque_init(&dq);
+    start = clock();
+    for(r = 0; r < BENCH_ROUNDS; r++) {
+        for(i = 0; i < BENCH_COUNT; i++) {
+            biglist_deque_push_tail(&dq, IP(i));
+        }
+        while(dq.head) {
+            biglist_deque_pop_head(&dq);
+        }
+    }
+    printf("biglist_deque_push_tail: %d x %d in %.1f ms\n",
+           BENCH_ROUNDS, BENCH_COUNT, __elapsed(start));
+    biglist_deque_denit(&dq);
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     int rc;
@@ -338,6 +497,14 @@ int main(int argc, char* argv[])
     if(rc < 0) {
         return rc;
     }
+    rc = utest_BigListDeque();
+    if(rc < 0) {
+        return rc;
+    }
+    rc = utest_BigListDequeBench();
+    if(rc < 0) {
+        return rc;
+    }
     printf("PASS\n");
     return 0;
 }
@@ -135,6 +135,39 @@ int fme_entry_timeouts_get(fme_t* fme, fme_timeval_t now, biglist_t** list);
 int fme_match(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size, 
               fme_entry_t** matched); 
 
+/**
+ * @brief Get the highest priority match for each of several keys. 
+ * @param fme The FME. 
+ * @param keys The incoming match keys. 
+ * @param count The number of keys. 
+ * @param now The current time (for entry timeout processing). 
+ * @param sizes The size of the incoming data for each key (for entry 
+ * counter updates). May be NULL. 
+ * @param [out] matched Receives the matching entry for each key, 
+ * or NULL if the key did not match. 
+ * 
+ * @returns The number of keys that matched. 
+ * @note This gives the same results as calling fme_match() on each key, 
+ * @note but walks the classifier once per group of keys. 
+ */
+int fme_match_batch(fme_t* fme, fme_key_t* keys, int count, fme_timeval_t now, 
+                    const int* sizes, fme_entry_t** matched); 
+
+/**
+ * @brief Get the highest priority match by scanning the entry table. 
+ * @param fme The FME. 
+ * @param key The incoming match key. 
+ * @param now The current time (for entry timeout processing). 
+ * @param size The size of the incoming data (for entry counter updates). 
+ * @param [out] matched Receives the FME entry that matches the key. 
+ * 
+ * @note This gives the same result as fme_match() in time linear
+ * @note with the table size. It is kept as the reference for the
+ * @note tuple space classifier in tests and benchmarks. 
+ */
+int fme_match_linear(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size, 
+                     fme_entry_t** matched); 
+
 /**
  * @brief Get all matching entries, in priority order. 
  * @param fme The FME. 
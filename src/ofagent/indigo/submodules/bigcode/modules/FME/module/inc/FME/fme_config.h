@@ -135,6 +135,26 @@
 #define FME_CONFIG_KEY_SIZE_WORDS 20
 #endif
 
+/**
+ * FME_CONFIG_INCLUDE_SIMD
+ *
+ * Include the SSE4.2 and AVX2 key matching kernels (selected at runtime). */
+
+
+#ifndef FME_CONFIG_INCLUDE_SIMD
+#define FME_CONFIG_INCLUDE_SIMD 1
+#endif
+
+/**
+ * FME_CONFIG_MATCH_BATCH_MAX
+ *
+ * The number of keys fme_match_batch() walks the tuples with at once. */
+
+
+#ifndef FME_CONFIG_MATCH_BATCH_MAX
+#define FME_CONFIG_MATCH_BATCH_MAX 32
+#endif
+
 
 
 /**
@@ -60,6 +60,16 @@ typedef struct fme_counters_s {
 
 struct fme_key_s; 
 
+/**
+ * Key data alignment. Keys are compared a vector at a time, 
+ * so the value and mask arrays start on a vector boundary. 
+ */
+#if defined(__GNUC__)
+#define FME_KEY_ALIGNED __attribute__((aligned(16)))
+#else
+#define FME_KEY_ALIGNED
+#endif
+
 /** Key dumper signature. */
 typedef int (*fme_key_dump_f)(struct fme_key_s* key, aim_pvs_t* pvs); 
 
@@ -77,10 +87,10 @@ typedef struct fme_key_s {
     /** The length of this key (in bytes) */
     int size; 
     /** The value bytes for this key */
-    uint8_t values[FME_CONFIG_KEY_SIZE_WORDS*4]; 
+    uint8_t values[FME_CONFIG_KEY_SIZE_WORDS*4] FME_KEY_ALIGNED; 
 
     /** The mask bytes for this key */
-    uint8_t masks[FME_CONFIG_KEY_SIZE_WORDS*4]; 
+    uint8_t masks[FME_CONFIG_KEY_SIZE_WORDS*4] FME_KEY_ALIGNED; 
     
     /** The function to use for dumping this key data */
     fme_key_dump_f dumper; 
@@ -123,6 +133,18 @@ typedef struct fme_entry_s {
     /** Client entry dumper */
     fme_entry_cookie_dump_f cdumper; 
 
+    /** The FME this entry has been added to, if any. */
+    struct fme_s* fme; 
+
+    /** The classifier tuple holding this entry. */
+    struct fme_tuple_s* tuple; 
+
+    /** Hash of the key values within the tuple. */
+    uint32_t hash; 
+
+    /** Next entry in the tuple's hash bucket. */
+    struct fme_entry_s* next; 
+
 } fme_entry_t;
 
 /**
@@ -145,6 +167,22 @@ typedef struct fme_s {
     /** The entry table. */
     fme_entry_t** entries; 
 
+    /**
+     * Tuple space classifier. Entries are partitioned by their
+     * keymask, size, and masks. Tuples are kept in descending
+     * order of their highest entry priority.
+     */
+    struct fme_tuple_s** tuples; 
+
+    /** The current number of tuples. */
+    int num_tuples; 
+
+    /** Tuple hash table, keyed on the tuple's masks. */
+    struct fme_tuple_s** tuple_buckets; 
+
+    /** Tuple hash table size - 1. */
+    uint32_t tuple_bucket_mask; 
+
 } fme_t; 
 
 
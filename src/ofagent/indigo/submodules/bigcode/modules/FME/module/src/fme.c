@@ -23,16 +23,33 @@
 #include <stdlib.h>
 #include <IOF/iof.h>
 #include "fme_log.h"
+#include <murmur/murmur.h>
 
 static int fme_key_dump_default__(fme_key_t* key, aim_pvs_t* ap); 
+static void fme_classifier_insert__(fme_t* fme, fme_entry_t* entry); 
+static void fme_classifier_remove__(fme_t* fme, fme_entry_t* entry); 
+static void fme_tuple_destroy__(fme_t* fme, fme_tuple_t* t); 
+
+/** Initial size of a tuple's entry hash table. */
+#define FME_TUPLE_BUCKETS_MIN 8
 
 int
 fme_create(fme_t** rv, const char* name, int max_entries)
 {
     fme_t* fme = aim_zmalloc(sizeof(*fme));
+    fme_kernels_init(); 
     fme->max_entries = max_entries; 
     fme->num_entries = 0; 
     fme->entries = aim_zmalloc(sizeof(fme_entry_t*)*max_entries); 
+
+    /* There can never be more tuples than entries */
+    fme->tuples = aim_zmalloc(sizeof(fme_tuple_t*)*aim_imax(max_entries, 1)); 
+    fme->tuple_bucket_mask = 1; 
+    while((int)fme->tuple_bucket_mask < max_entries) {
+        fme->tuple_bucket_mask <<= 1; 
+    }
+    fme->tuple_buckets = aim_zmalloc(sizeof(fme_tuple_t*)*fme->tuple_bucket_mask); 
+    fme->tuple_bucket_mask--; 
     fme->log_string = aim_strdup(name ? name : "None"); 
     *rv = fme;
     return 0; 
@@ -45,6 +62,7 @@ fme_destroy_all(fme_t* fme)
     for(i = 0; i < fme->num_entries; i++) {
         fme_entry_destroy(fme->entries[i]); 
     }
+    fme->num_entries = 0; 
     if(fme->log_string) { 
         aim_free((void*)fme->log_string); 
     }
@@ -54,6 +72,19 @@ fme_destroy_all(fme_t* fme)
 void
 fme_destroy(fme_t* fme)
 {
+    int i; 
+
+    /* Entries outlive the FME, so detach them from the classifier */
+    for(i = 0; i < fme->num_entries; i++) {
+        fme->entries[i]->fme = NULL; 
+        fme->entries[i]->tuple = NULL; 
+        fme->entries[i]->next = NULL; 
+    }
+    while(fme->num_tuples) {
+        fme_tuple_destroy__(fme, fme->tuples[fme->num_tuples-1]); 
+    }
+    aim_free(fme->tuples); 
+    aim_free(fme->tuple_buckets); 
     aim_free(fme->entries); 
     aim_free(fme); 
 }
@@ -82,10 +113,17 @@ fme_entry_destroy(fme_entry_t* entry)
 int
 fme_entry_key_set(fme_entry_t* entry, fme_key_t* key)
 {
+    if(entry->fme) {
+        /* The new key may belong in a different tuple */
+        fme_classifier_remove__(entry->fme, entry); 
+    }
     FME_MEMCPY(&entry->key, key, sizeof(*key)); 
     if(entry->key.dumper == NULL) {
         entry->key.dumper = fme_key_dump_default__; 
     }
+    if(entry->fme) {
+        fme_classifier_insert__(entry->fme, entry); 
+    }
     return 0; 
 }
 
@@ -140,10 +178,10 @@ fme_entry_timeouts(fme_t* fme, fme_timeval_t now, biglist_t** list)
 }
 
 static void
-fme_update_indexes__(fme_t* fme)
+fme_update_indexes__(fme_t* fme, int from)
 {
     int i; 
-    for(i = 0; i < fme->num_entries; i++) {
+    for(i = from; i < fme->num_entries; i++) {
         fme->entries[i]->index = i; 
     }
 }
@@ -159,10 +197,9 @@ fme_add_entry(fme_t* fme, fme_entry_t* entry)
 
     if(fme->num_entries == 0) {
         fme->entries[fme->num_entries++] = entry; 
-        return 0; 
+        entry->index = 0; 
     }
-
-    if(fme->entries[fme->num_entries-1]->prio > entry->prio) {
+    else if(fme->entries[fme->num_entries-1]->prio > entry->prio) {
         fme->entries[fme->num_entries] = entry; 
         entry->index = fme->num_entries++;
     }
@@ -176,22 +213,27 @@ fme_add_entry(fme_t* fme, fme_entry_t* entry)
         fme->entries[i] = entry; 
         entry->index = i; 
         ++fme->num_entries;
-        fme_update_indexes__(fme); 
+        fme_update_indexes__(fme, i); 
     }
+    entry->fme = fme; 
+    fme_classifier_insert__(fme, entry); 
     return 0; 
 }
 
 int
 fme_remove_entry(fme_t* fme, fme_entry_t* entry)
 {
-    if(fme->entries[entry->index] == entry) {
+    if(entry->index < fme->num_entries && 
+       fme->entries[entry->index] == entry) {
         int msize = fme->num_entries - entry->index - 1;        
+        fme_classifier_remove__(fme, entry); 
+        entry->fme = NULL; 
         --fme->num_entries; 
         if(msize) {
             FME_MEMMOVE(fme->entries+(entry->index), 
                         fme->entries+(entry->index+1), 
                         msize*sizeof(fme_entry_t*));
-            fme_update_indexes__(fme); 
+            fme_update_indexes__(fme, entry->index); 
         }
     }
     else {
@@ -203,7 +245,6 @@ fme_remove_entry(fme_t* fme, fme_entry_t* entry)
 static int
 fme_key_match__(fme_key_t* value, fme_key_t* matchkey)
 {
-    int i; 
     uint32_t* vp; 
     uint32_t* mvp; 
     uint32_t* mmp; 
@@ -228,18 +269,15 @@ fme_key_match__(fme_key_t* value, fme_key_t* matchkey)
     /* key value masks */
     mmp = (uint32_t*) matchkey->masks; 
 
-    for(i = 0; i < value->size/4; i++) {
-        if( (vp[i] & mmp[i]) != mvp[i] ) {
-            /* No match */
-            return 0; 
-        }
-    }
-    return 1;
+    return fme_kernels->match(vp, mmp, mvp, value->size/4); 
 }
 
-static 
-int fme_entry_match__(fme_entry_t* entry, fme_key_t* key, fme_timeval_t now, 
-                      int size)
+/*
+ * Whether an entry may be matched at all. Timed-out entries are 
+ * disabled here. 
+ */
+static int
+fme_entry_usable__(fme_entry_t* entry, fme_timeval_t now)
 {
     if(entry->enabled == 0) {
         /* entry is disabled */
@@ -250,18 +288,269 @@ int fme_entry_match__(fme_entry_t* entry, fme_key_t* key, fme_timeval_t now,
         entry->enabled = 0; 
         return 0; 
     }
-    if(fme_key_match__(key, &entry->key) == 0) {
+    return 1; 
+}
+
+static void
+fme_entry_hit__(fme_entry_t* entry, fme_timeval_t now, int size)
+{
+    ++entry->counters.matches; 
+    entry->counters.bytes += size; 
+    entry->timestamp = now; 
+}
+
+static 
+int fme_entry_match__(fme_entry_t* entry, fme_key_t* key, fme_timeval_t now, 
+                      int size)
+{
+    if(fme_entry_usable__(entry, now) == 0) {
+        return 0; 
+    }
+    if(fme_key_match__(key, &entry->key) != 1) {
         /* no match */
         return 0; 
     }
     
     /* entry has matched */
-    ++entry->counters.matches; 
-    entry->counters.bytes += size; 
-    entry->timestamp = now; 
+    fme_entry_hit__(entry, now, size); 
     return 1; 
 }
-    
+
+
+/**************************************************************************
+ *
+ * Tuple space classifier
+ *
+ * Entries are partitioned into tuples by (keymask, size, masks). Within a 
+ * tuple every entry is compared against the same masked bits of the 
+ * incoming key, so the masked key can be hashed once and a single bucket 
+ * probed. Tuples are kept in descending order of their highest entry 
+ * priority, which lets a lookup stop as soon as no remaining tuple can 
+ * hold an entry that outranks the best match found so far. 
+ *
+ * Entry ranking is the entry table order, ie entry->index. 
+ *
+ *************************************************************************/
+
+static uint32_t
+fme_tuple_hash__(fme_key_t* key)
+{
+    uint32_t hash = murmur_hash(key->masks, (key->size/4)*4, key->keymask); 
+    return murmur_hash(&key->size, sizeof(key->size), hash); 
+}
+
+static fme_tuple_t*
+fme_tuple_find__(fme_t* fme, fme_key_t* key, uint32_t hash)
+{
+    fme_tuple_t* t; 
+    for(t = fme->tuple_buckets[hash & fme->tuple_bucket_mask]; t; t = t->next) {
+        if(t->hash == hash && t->keymask == key->keymask && 
+           t->size == key->size && 
+           fme_kernels->equal((uint32_t*)t->masks, (uint32_t*)key->masks, 
+                              key->size/4)) {
+            return t; 
+        }
+    }
+    return NULL; 
+}
+
+/*
+ * Move a tuple to its place in the tuple table after its
+ * max_prio has changed. 
+ */
+static void
+fme_tuple_reorder__(fme_t* fme, fme_tuple_t* t)
+{
+    int i = t->index; 
+
+    while(i > 0 && fme->tuples[i-1]->max_prio < t->max_prio) {
+        fme->tuples[i] = fme->tuples[i-1]; 
+        fme->tuples[i]->index = i; 
+        i--; 
+    }
+    while(i < fme->num_tuples-1 && fme->tuples[i+1]->max_prio > t->max_prio) {
+        fme->tuples[i] = fme->tuples[i+1]; 
+        fme->tuples[i]->index = i; 
+        i++; 
+    }
+    fme->tuples[i] = t; 
+    t->index = i; 
+}
+
+static void
+fme_tuple_bucket_insert__(fme_tuple_t* t, fme_entry_t* entry)
+{
+    fme_entry_t** bucket = t->buckets + (entry->hash & t->bucket_mask); 
+    entry->next = *bucket; 
+    *bucket = entry; 
+}
+
+static void
+fme_tuple_grow__(fme_tuple_t* t)
+{
+    fme_entry_t** old = t->buckets; 
+    uint32_t count = t->bucket_mask + 1; 
+    uint32_t i; 
+
+    t->buckets = aim_zmalloc(sizeof(fme_entry_t*)*count*2); 
+    t->bucket_mask = count*2 - 1; 
+    for(i = 0; i < count; i++) {
+        fme_entry_t* entry = old[i]; 
+        while(entry) {
+            fme_entry_t* next = entry->next; 
+            fme_tuple_bucket_insert__(t, entry); 
+            entry = next; 
+        }
+    }
+    aim_free(old); 
+}
+
+static fme_tuple_t*
+fme_tuple_create__(fme_t* fme, fme_key_t* key, uint32_t hash)
+{
+    fme_tuple_t** bucket = fme->tuple_buckets + (hash & fme->tuple_bucket_mask); 
+    fme_tuple_t* t = aim_zmalloc(sizeof(*t)); 
+
+    t->keymask = key->keymask; 
+    t->size = key->size; 
+    FME_MEMCPY(t->masks, key->masks, sizeof(t->masks)); 
+    t->hash = hash; 
+    t->buckets = aim_zmalloc(sizeof(fme_entry_t*)*FME_TUPLE_BUCKETS_MIN); 
+    t->bucket_mask = FME_TUPLE_BUCKETS_MIN - 1; 
+
+    t->next = *bucket; 
+    *bucket = t; 
+
+    /* Placed by fme_tuple_reorder__() once its max_prio is known */
+    t->index = fme->num_tuples; 
+    fme->tuples[fme->num_tuples++] = t; 
+    return t; 
+}
+
+static void
+fme_tuple_destroy__(fme_t* fme, fme_tuple_t* t)
+{
+    fme_tuple_t** tp; 
+    int i; 
+
+    for(tp = fme->tuple_buckets + (t->hash & fme->tuple_bucket_mask); 
+        *tp; tp = &(*tp)->next) {
+        if(*tp == t) {
+            *tp = t->next; 
+            break; 
+        }
+    }
+
+    --fme->num_tuples; 
+    FME_MEMMOVE(fme->tuples+t->index, fme->tuples+t->index+1, 
+                (fme->num_tuples - t->index)*sizeof(fme_tuple_t*)); 
+    for(i = t->index; i < fme->num_tuples; i++) {
+        fme->tuples[i]->index = i; 
+    }
+
+    aim_free(t->buckets); 
+    aim_free(t); 
+}
+
+static void
+fme_classifier_insert__(fme_t* fme, fme_entry_t* entry)
+{
+    fme_key_t* key = &entry->key; 
+    uint32_t hash = fme_tuple_hash__(key); 
+    fme_tuple_t* t = fme_tuple_find__(fme, key, hash); 
+
+    if(t == NULL) {
+        t = fme_tuple_create__(fme, key, hash); 
+        t->max_prio = entry->prio; 
+    }
+    else if(entry->prio > t->max_prio) {
+        t->max_prio = entry->prio; 
+    }
+
+    entry->tuple = t; 
+    entry->hash = murmur_hash(key->values, (key->size/4)*4, t->hash); 
+    if(++t->count > (int)t->bucket_mask + 1) {
+        fme_tuple_grow__(t); 
+    }
+    fme_tuple_bucket_insert__(t, entry); 
+    fme_tuple_reorder__(fme, t); 
+}
+
+static void
+fme_classifier_remove__(fme_t* fme, fme_entry_t* entry)
+{
+    fme_tuple_t* t = entry->tuple; 
+    fme_entry_t** ep; 
+    uint32_t i; 
+
+    if(t == NULL) {
+        return; 
+    }
+
+    for(ep = t->buckets + (entry->hash & t->bucket_mask); *ep; ep = &(*ep)->next) {
+        if(*ep == entry) {
+            *ep = entry->next; 
+            break; 
+        }
+    }
+    entry->next = NULL; 
+    entry->tuple = NULL; 
+
+    if(--t->count == 0) {
+        fme_tuple_destroy__(fme, t); 
+        return; 
+    }
+
+    if(entry->prio == t->max_prio) {
+        /* The tuple may have lost its highest priority entry */
+        t->max_prio = INT_MIN; 
+        for(i = 0; i <= t->bucket_mask; i++) {
+            for(ep = t->buckets + i; *ep; ep = &(*ep)->next) {
+                t->max_prio = aim_imax(t->max_prio, (*ep)->prio); 
+            }
+        }
+        fme_tuple_reorder__(fme, t); 
+    }
+}
+
+/*
+ * Returns the bucket for the key within the tuple, or NULL if the
+ * tuple cannot match the key. 
+ */
+static fme_entry_t*
+fme_tuple_lookup__(fme_tuple_t* t, fme_key_t* key, 
+                   uint32_t* masked, uint32_t* hash)
+{
+    if(key->size != t->size || 
+       (key->keymask & t->keymask) != t->keymask) {
+        return NULL; 
+    }
+    fme_kernels->mask(masked, (uint32_t*)key->values, (uint32_t*)t->masks, 
+                      t->size/4); 
+    *hash = murmur_hash(masked, (t->size/4)*4, t->hash); 
+    return t->buckets[*hash & t->bucket_mask]; 
+}
+
+/*
+ * Walk a bucket returned by fme_tuple_lookup__(). Returns the entry 
+ * which ranks first out of 'best' and the usable matches in the bucket. 
+ */
+static fme_entry_t*
+fme_tuple_probe__(fme_tuple_t* t, fme_entry_t* fe, uint32_t* masked, 
+                  uint32_t hash, fme_timeval_t now, fme_entry_t* best)
+{
+    for(; fe; fe = fe->next) {
+        if(fe->hash != hash || (best && fe->index > best->index)) {
+            continue; 
+        }
+        if(fme_kernels->equal(masked, (uint32_t*)fe->key.values, t->size/4) && 
+           fme_entry_usable__(fe, now)) {
+            best = fe; 
+        }
+    }
+    return best; 
+}
+
 int
 fme_match(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size, 
           fme_entry_t** matched)
@@ -269,6 +558,8 @@ fme_match(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size,
     int i; 
     int rv = 0; 
     iof_t iof; 
+    fme_entry_t* best = NULL; 
+    uint32_t masked[FME_CONFIG_KEY_SIZE_WORDS]; 
 
     /** @fixme */
     {
@@ -288,18 +579,25 @@ fme_match(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size,
     /*
      * Find the first match, in priority order
      */
-    for(i = 0; i < fme->num_entries; i++) {
-        fme_entry_t* fe = fme->entries[i];
-        if(fe == NULL) {
-            AIM_LOG_INTERNAL("entry is null"); 
-            continue; 
-        }
-        if(fme_entry_match__(fe, key, now, size)) { 
-            *matched = fe;
-            AIM_LOG_VERBOSE("matched index %d", fe->index); 
-            rv = 1; 
-            break;
+    for(i = 0; i < fme->num_tuples; i++) {
+        fme_tuple_t* t = fme->tuples[i]; 
+        fme_entry_t* fe; 
+        uint32_t hash; 
+
+        if(best && t->max_prio < best->prio) {
+            /* Nothing left can outrank the current match */
+            break; 
         }
+
+        fe = fme_tuple_lookup__(t, key, masked, &hash); 
+        best = fme_tuple_probe__(t, fe, masked, hash, now, best); 
+    }
+
+    if(best) {
+        fme_entry_hit__(best, now, size); 
+        *matched = best; 
+        AIM_LOG_VERBOSE("matched index %d", best->index); 
+        rv = 1; 
     }
 
     /** @fixme */
@@ -317,6 +615,106 @@ fme_match(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size,
     return rv;
 }
 
+/*
+ * Match up to FME_CONFIG_MATCH_BATCH_MAX keys. Each tuple is visited once
+ * for the whole batch: the keys are masked and hashed and their buckets 
+ * prefetched before any bucket is walked. A key drops out once no 
+ * remaining tuple can outrank its current match. 
+ */
+static int
+fme_match_batch__(fme_t* fme, fme_key_t* keys, int count, fme_timeval_t now, 
+                  const int* sizes, fme_entry_t** matched)
+{
+    uint32_t masked[FME_CONFIG_MATCH_BATCH_MAX][FME_CONFIG_KEY_SIZE_WORDS]; 
+    uint32_t hash[FME_CONFIG_MATCH_BATCH_MAX]; 
+    fme_entry_t* bucket[FME_CONFIG_MATCH_BATCH_MAX]; 
+    uint8_t done[FME_CONFIG_MATCH_BATCH_MAX]; 
+    int active = count; 
+    int rv = 0; 
+    int i, k; 
+
+    for(k = 0; k < count; k++) {
+        matched[k] = NULL; 
+        done[k] = 0; 
+    }
+
+    for(i = 0; i < fme->num_tuples && active; i++) {
+        fme_tuple_t* t = fme->tuples[i]; 
+
+        for(k = 0; k < count; k++) {
+            bucket[k] = NULL; 
+            if(done[k]) {
+                continue; 
+            }
+            if(matched[k] && t->max_prio < matched[k]->prio) {
+                done[k] = 1; 
+                active--; 
+                continue; 
+            }
+            bucket[k] = fme_tuple_lookup__(t, keys+k, masked[k], hash+k); 
+            if(bucket[k]) {
+                FME_PREFETCH(bucket[k]); 
+            }
+        }
+
+        for(k = 0; k < count; k++) {
+            if(bucket[k]) {
+                matched[k] = fme_tuple_probe__(t, bucket[k], masked[k], hash[k], 
+                                               now, matched[k]); 
+            }
+        }
+    }
+
+    for(k = 0; k < count; k++) {
+        if(matched[k]) {
+            fme_entry_hit__(matched[k], now, sizes ? sizes[k] : 0); 
+            rv++; 
+        }
+    }
+    return rv; 
+}
+
+int
+fme_match_batch(fme_t* fme, fme_key_t* keys, int count, fme_timeval_t now, 
+                const int* sizes, fme_entry_t** matched)
+{
+    int i; 
+    int rv = 0; 
+
+    for(i = 0; i < count; i += FME_CONFIG_MATCH_BATCH_MAX) {
+        rv += fme_match_batch__(fme, keys+i, 
+                                aim_imin(count-i, FME_CONFIG_MATCH_BATCH_MAX), 
+                                now, sizes ? sizes+i : NULL, matched+i); 
+    }
+    return rv; 
+}
+
+int
+fme_match_linear(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size, 
+                 fme_entry_t** matched)
+{
+    int i; 
+
+    for(i = 0; i < fme->num_entries; i++) {
+        fme_entry_t* fe = fme->entries[i];
+        if(fe == NULL) {
+            AIM_LOG_INTERNAL("entry is null"); 
+            continue; 
+        }
+        if(fme_entry_match__(fe, key, now, size)) { 
+            *matched = fe;
+            return 1; 
+        }
+    }
+    return 0; 
+}
+
+static int
+fme_entry_index_compare__(const void* a, const void* b)
+{
+    return ((fme_entry_t*)a)->index - ((fme_entry_t*)b)->index; 
+}
+
 int 
 fme_matches(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size, 
             biglist_t** matches)
@@ -324,23 +722,30 @@ fme_matches(fme_t* fme, fme_key_t* key, fme_timeval_t now, int size,
     int i; 
     int count = 0; 
     biglist_t* rv = NULL;
+    uint32_t masked[FME_CONFIG_KEY_SIZE_WORDS]; 
 
     /*
      * Find all matches
      */
-    for(i = 0; i < fme->num_entries; i++) {
-        fme_entry_t* fe = fme->entries[i]; 
-        if(fme->entries[i] == NULL) {
-            AIM_LOG_INTERNAL("entry is null"); 
-            continue; 
-        }
-        if(fme_entry_match__(fe, key, now, size)) { 
-            rv = biglist_prepend(rv, fe); 
-            count++; 
+    for(i = 0; i < fme->num_tuples; i++) {
+        fme_tuple_t* t = fme->tuples[i]; 
+        fme_entry_t* fe; 
+        uint32_t hash; 
+
+        fe = fme_tuple_lookup__(t, key, masked, &hash); 
+        for(; fe; fe = fe->next) {
+            if(fe->hash == hash && 
+               fme_kernels->equal(masked, (uint32_t*)fe->key.values, t->size/4) && 
+               fme_entry_usable__(fe, now)) {
+                fme_entry_hit__(fe, now, size); 
+                rv = biglist_prepend(rv, fe); 
+                count++; 
+            }
         }
     }
     if(count > 1) {
-        rv = biglist_reverse(rv); 
+        /* Tuples are visited out of entry order */
+        rv = biglist_sort(rv, fme_entry_index_compare__); 
     }
     *matches = rv; 
     return count; 
@@ -356,8 +761,9 @@ fme_dump(fme_t* fme, aim_pvs_t* ap)
 
     iof_push(&iof, "fme @ %p", fme); 
     if(fme) {
-        iof_iprintf(&iof, "name=%s num_entries = %d, max_entries = %d", 
-                    fme->log_string, fme->num_entries, fme->max_entries); 
+        iof_iprintf(&iof, "name=%s num_entries = %d, max_entries = %d, num_tuples = %d", 
+                    fme->log_string, fme->num_entries, fme->max_entries, 
+                    fme->num_tuples); 
         for(i = 0; i < fme->num_entries; i++) {
             fme_entry_dump(fme->entries[i], &iof.inherit); 
         }   
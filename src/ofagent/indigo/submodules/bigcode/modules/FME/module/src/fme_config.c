@@ -74,6 +74,16 @@ fme_config_settings_t fme_config_settings[] =
     { __fme_config_STRINGIFY_NAME(FME_CONFIG_KEY_SIZE_WORDS), __fme_config_STRINGIFY_VALUE(FME_CONFIG_KEY_SIZE_WORDS) },
 #else
 { FME_CONFIG_KEY_SIZE_WORDS(__fme_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef FME_CONFIG_INCLUDE_SIMD
+    { __fme_config_STRINGIFY_NAME(FME_CONFIG_INCLUDE_SIMD), __fme_config_STRINGIFY_VALUE(FME_CONFIG_INCLUDE_SIMD) },
+#else
+{ FME_CONFIG_INCLUDE_SIMD(__fme_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef FME_CONFIG_MATCH_BATCH_MAX
+    { __fme_config_STRINGIFY_NAME(FME_CONFIG_MATCH_BATCH_MAX), __fme_config_STRINGIFY_VALUE(FME_CONFIG_MATCH_BATCH_MAX) },
+#else
+{ FME_CONFIG_MATCH_BATCH_MAX(__fme_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
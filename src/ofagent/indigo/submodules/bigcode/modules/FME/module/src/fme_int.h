@@ -23,4 +23,75 @@
 #include <FME/fme_config.h>
 #include <FME/fme.h> 
 
+#if defined(__GNUC__)
+#define FME_PREFETCH(_p) __builtin_prefetch(_p)
+#else
+#define FME_PREFETCH(_p)
+#endif
+
+/**
+ * Key matching kernels. These operate on whole 32 bit words. 
+ */
+typedef struct fme_kernels_s {
+    /** Kernel set name. */
+    const char* name; 
+    /** dst = values & masks */
+    void (*mask)(uint32_t* dst, const uint32_t* values, 
+                 const uint32_t* masks, int words); 
+    /** Returns 1 if a == b */
+    int (*equal)(const uint32_t* a, const uint32_t* b, int words); 
+    /** Returns 1 if (values & masks) == expect */
+    int (*match)(const uint32_t* values, const uint32_t* masks, 
+                 const uint32_t* expect, int words); 
+} fme_kernels_t; 
+
+/** The kernels in use. */
+extern const fme_kernels_t* fme_kernels; 
+
+/**
+ * Select the best kernels supported by this CPU. 
+ * Does nothing once kernels have been selected. 
+ */
+void fme_kernels_init(void); 
+
+/**
+ * Select kernels by name. 
+ * Returns -1 if they are not built in or not supported by this CPU. 
+ */
+int fme_kernels_select(const char* name); 
+
+/** Name of the built in kernel set at index, or NULL past the end. */
+const char* fme_kernels_name(int index); 
+
+/**
+ * A classifier tuple. This holds all of the entries sharing the same 
+ * keymask, size, and masks, hashed on their key values. A lookup masks 
+ * the incoming key once per tuple and probes a single bucket. 
+ */
+typedef struct fme_tuple_s {
+    /** The keymask shared by all entries in this tuple. */
+    uint32_t keymask; 
+    /** The key size shared by all entries in this tuple. */
+    int size; 
+    /** The masks shared by all entries in this tuple. */
+    uint8_t masks[FME_CONFIG_KEY_SIZE_WORDS*4]; 
+    /** Hash of the fields above. */
+    uint32_t hash; 
+
+    /** The highest priority of any entry in this tuple. */
+    int max_prio; 
+    /** The number of entries in this tuple. */
+    int count; 
+
+    /** Entry hash table. */
+    fme_entry_t** buckets; 
+    /** Entry hash table size - 1. */
+    uint32_t bucket_mask; 
+
+    /** Current index in the parent FME's tuple table. */
+    int index; 
+    /** Next tuple in the parent FME's tuple hash bucket. */
+    struct fme_tuple_s* next; 
+} fme_tuple_t; 
+
 #endif /* __FME_INT_H__ */
@@ -19,11 +19,13 @@
 
 #include <FME/fme_config.h>
 #include "fme_log.h"
+#include "fme_int.h"
 
 int
 __fme_module_init__(void)
 {
     AIM_LOG_STRUCT_REGISTER(); 
+    fme_kernels_init(); 
     return 0; 
 }
 
@@ -0,0 +1,333 @@
+/****************************************************************
+ * 
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ ***************************************************************/
+
+/**************************************************************************
+ *
+ * Key matching kernels. 
+ *
+ * The scalar kernels are always available. The SSE4.2 and AVX2 kernels 
+ * are compiled with per-function target attributes so the module itself 
+ * needs no special compiler flags, and are only selected when the CPU 
+ * reports support for them. 
+ *
+ *************************************************************************/
+
+#include <FME/fme_config.h>
+#include "fme_int.h"
+#include "fme_log.h"
+#include <string.h>
+
+#if FME_CONFIG_INCLUDE_SIMD == 1 && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define FME_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define FME_SIMD_X86 0
+#endif
+
+static void
+fme_mask_scalar__(uint32_t* dst, const uint32_t* values, 
+                  const uint32_t* masks, int words)
+{
+    int i; 
+    for(i = 0; i < words; i++) {
+        dst[i] = values[i] & masks[i]; 
+    }
+}
+
+static int
+fme_equal_scalar__(const uint32_t* a, const uint32_t* b, int words)
+{
+    int i; 
+    for(i = 0; i < words; i++) {
+        if(a[i] != b[i]) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+static int
+fme_match_scalar__(const uint32_t* values, const uint32_t* masks, 
+                   const uint32_t* expect, int words)
+{
+    int i; 
+    for(i = 0; i < words; i++) {
+        if( (values[i] & masks[i]) != expect[i] ) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+static const fme_kernels_t fme_kernels_scalar__ = 
+    {
+        "scalar", 
+        fme_mask_scalar__, 
+        fme_equal_scalar__, 
+        fme_match_scalar__, 
+    }; 
+
+
+#if FME_SIMD_X86 == 1
+
+/*
+ * Key data is only guaranteed 16 byte alignment (heap allocated entries), 
+ * so all loads are unaligned loads. These cost nothing extra on aligned 
+ * data. 
+ */
+#define LOAD128(_p, _i) _mm_loadu_si128((const __m128i*)((_p)+(_i)))
+#define LOAD256(_p, _i) _mm256_loadu_si256((const __m256i*)((_p)+(_i)))
+
+__attribute__((target("sse4.2")))
+static void
+fme_mask_sse42__(uint32_t* dst, const uint32_t* values, 
+                 const uint32_t* masks, int words)
+{
+    int i; 
+    for(i = 0; i + 4 <= words; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst+i), 
+                         _mm_and_si128(LOAD128(values, i), LOAD128(masks, i))); 
+    }
+    for(; i < words; i++) {
+        dst[i] = values[i] & masks[i]; 
+    }
+}
+
+__attribute__((target("sse4.2")))
+static int
+fme_equal_sse42__(const uint32_t* a, const uint32_t* b, int words)
+{
+    int i; 
+    for(i = 0; i + 4 <= words; i += 4) {
+        __m128i x = _mm_xor_si128(LOAD128(a, i), LOAD128(b, i)); 
+        if(!_mm_testz_si128(x, x)) {
+            return 0; 
+        }
+    }
+    for(; i < words; i++) {
+        if(a[i] != b[i]) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+__attribute__((target("sse4.2")))
+static int
+fme_match_sse42__(const uint32_t* values, const uint32_t* masks, 
+                  const uint32_t* expect, int words)
+{
+    int i; 
+
+    /* Most mismatches show in the first word, so reject those early */
+    if(words && (values[0] & masks[0]) != expect[0]) {
+        return 0; 
+    }
+    for(i = 0; i + 4 <= words; i += 4) {
+        __m128i x = _mm_and_si128(LOAD128(values, i), LOAD128(masks, i)); 
+        x = _mm_xor_si128(x, LOAD128(expect, i)); 
+        if(!_mm_testz_si128(x, x)) {
+            return 0; 
+        }
+    }
+    for(; i < words; i++) {
+        if( (values[i] & masks[i]) != expect[i] ) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+static const fme_kernels_t fme_kernels_sse42__ = 
+    {
+        "sse4.2", 
+        fme_mask_sse42__, 
+        fme_equal_sse42__, 
+        fme_match_sse42__, 
+    }; 
+
+__attribute__((target("avx2")))
+static void
+fme_mask_avx2__(uint32_t* dst, const uint32_t* values, 
+                const uint32_t* masks, int words)
+{
+    int i; 
+    for(i = 0; i + 8 <= words; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst+i), 
+                            _mm256_and_si256(LOAD256(values, i), LOAD256(masks, i))); 
+    }
+    if(i + 4 <= words) {
+        _mm_storeu_si128((__m128i*)(dst+i), 
+                         _mm_and_si128(LOAD128(values, i), LOAD128(masks, i))); 
+        i += 4; 
+    }
+    for(; i < words; i++) {
+        dst[i] = values[i] & masks[i]; 
+    }
+}
+
+__attribute__((target("avx2")))
+static int
+fme_equal_avx2__(const uint32_t* a, const uint32_t* b, int words)
+{
+    int i; 
+    for(i = 0; i + 8 <= words; i += 8) {
+        __m256i x = _mm256_xor_si256(LOAD256(a, i), LOAD256(b, i)); 
+        if(!_mm256_testz_si256(x, x)) {
+            return 0; 
+        }
+    }
+    if(i + 4 <= words) {
+        __m128i x = _mm_xor_si128(LOAD128(a, i), LOAD128(b, i)); 
+        if(!_mm_testz_si128(x, x)) {
+            return 0; 
+        }
+        i += 4; 
+    }
+    for(; i < words; i++) {
+        if(a[i] != b[i]) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+__attribute__((target("avx2")))
+static int
+fme_match_avx2__(const uint32_t* values, const uint32_t* masks, 
+                 const uint32_t* expect, int words)
+{
+    int i; 
+
+    /* Most mismatches show in the first word, so reject those early */
+    if(words && (values[0] & masks[0]) != expect[0]) {
+        return 0; 
+    }
+    for(i = 0; i + 8 <= words; i += 8) {
+        __m256i x = _mm256_and_si256(LOAD256(values, i), LOAD256(masks, i)); 
+        x = _mm256_xor_si256(x, LOAD256(expect, i)); 
+        if(!_mm256_testz_si256(x, x)) {
+            return 0; 
+        }
+    }
+    if(i + 4 <= words) {
+        __m128i x = _mm_and_si128(LOAD128(values, i), LOAD128(masks, i)); 
+        x = _mm_xor_si128(x, LOAD128(expect, i)); 
+        if(!_mm_testz_si128(x, x)) {
+            return 0; 
+        }
+        i += 4; 
+    }
+    for(; i < words; i++) {
+        if( (values[i] & masks[i]) != expect[i] ) {
+            return 0; 
+        }
+    }
+    return 1; 
+}
+
+static const fme_kernels_t fme_kernels_avx2__ = 
+    {
+        "avx2", 
+        fme_mask_avx2__, 
+        fme_equal_avx2__, 
+        fme_match_avx2__, 
+    }; 
+
+#endif /* FME_SIMD_X86 */
+
+
+const fme_kernels_t* fme_kernels = &fme_kernels_scalar__; 
+
+static int
+fme_kernels_supported__(const fme_kernels_t* k)
+{
+#if FME_SIMD_X86 == 1
+    __builtin_cpu_init(); 
+    if(k == &fme_kernels_avx2__) {
+        return __builtin_cpu_supports("avx2"); 
+    }
+    if(k == &fme_kernels_sse42__) {
+        return __builtin_cpu_supports("sse4.2"); 
+    }
+#endif
+    return k == &fme_kernels_scalar__; 
+}
+
+/* In order of preference */
+static const fme_kernels_t* fme_kernels_all__[] = 
+    {
+#if FME_SIMD_X86 == 1
+        &fme_kernels_avx2__, 
+        &fme_kernels_sse42__, 
+#endif
+        &fme_kernels_scalar__, 
+        NULL
+    }; 
+
+static int fme_kernels_init__ = 0; 
+
+void
+fme_kernels_init(void)
+{
+    int i; 
+
+    if(fme_kernels_init__) {
+        return; 
+    }
+    for(i = 0; fme_kernels_all__[i]; i++) {
+        if(fme_kernels_supported__(fme_kernels_all__[i])) {
+            fme_kernels = fme_kernels_all__[i]; 
+            break; 
+        }
+    }
+    fme_kernels_init__ = 1; 
+    AIM_LOG_VERBOSE("using %s key matching kernels", fme_kernels->name); 
+}
+
+int
+fme_kernels_select(const char* name)
+{
+    int i; 
+
+    for(i = 0; fme_kernels_all__[i]; i++) {
+        if(!strcmp(fme_kernels_all__[i]->name, name)) {
+            if(fme_kernels_supported__(fme_kernels_all__[i]) == 0) {
+                return -1; 
+            }
+            fme_kernels = fme_kernels_all__[i]; 
+            fme_kernels_init__ = 1; 
+            return 0; 
+        }
+    }
+    return -1; 
+}
+
+const char*
+fme_kernels_name(int index)
+{
+    int i; 
+    for(i = 0; fme_kernels_all__[i]; i++) {
+        if(i == index) {
+            return fme_kernels_all__[i]->name; 
+        }
+    }
+    return NULL; 
+}
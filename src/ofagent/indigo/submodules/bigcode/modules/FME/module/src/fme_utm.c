@@ -22,9 +22,11 @@
 #if FME_CONFIG_INCLUDE_UTM == 1
 
 #include <FME/uCli/fme_utm.h>
+#include "fme_int.h"
 #include <uCli/ucli.h>
 #include <uCli/ucli_argparse.h>
 #include <OS/os_time.h>
+#include <stdlib.h>
 
 /**
  * Cast and assign our control pointer in every command handler
@@ -385,6 +387,266 @@ fme_ucli_utm__perf__(ucli_context_t* uc)
     return UCLI_STATUS_OK; 
 }
 
+/*
+ * Build a table spread randomly across 'tuples' distinct masks with 
+ * 'keysize' byte keys, and 'count' lookup keys that each hit a random 
+ * entry with random bits in the unmasked positions. 
+ */
+static fme_t*
+fme_utm_table_build__(int table_size, int tuples, int keysize, 
+                      fme_key_t** rkeys, int count)
+{
+    unsigned int seed = 1; 
+    fme_t* fme; 
+    fme_key_t* keys; 
+    int i; 
+    int w; 
+
+    fme_create(&fme, "fme_utm", table_size); 
+
+    for(i = 0; i < table_size; i++) { 
+        fme_entry_t* entry;
+        fme_key_t key;
+        uint32_t* values = (uint32_t*)key.values; 
+        uint32_t* masks = (uint32_t*)key.masks; 
+        int t = rand_r(&seed) % tuples; 
+
+        /* Prefix-style masks in words 1 and 2 select the tuple */
+        FME_MEMSET(&key, 0, sizeof(key)); 
+        key.size = keysize; 
+        for(w = 0; w < keysize/4; w++) {
+            masks[w] = 0xFFFFFFFF; 
+        }
+        masks[1] = 0xFFFFFFFF << (t % 32); 
+        masks[2] = 0xFFFFFFFF << (t / 32); 
+        masks[3] = 0; 
+        for(w = 0; w < keysize/4; w++) {
+            values[w] = ((uint32_t)rand_r(&seed) ^ ((uint32_t)rand_r(&seed) << 16)) & masks[w]; 
+        }
+        
+        fme_entry_create(&entry); 
+        fme_entry_key_set(entry, &key); 
+        /* Descending priorities keep the table build linear */
+        entry->prio = table_size - i; 
+        fme_add_entry(fme, entry); 
+    }
+
+    keys = aim_zmalloc(sizeof(*keys)*count); 
+    for(i = 0; i < count; i++) {
+        fme_entry_t* entry = fme->entries[rand_r(&seed) % table_size]; 
+        uint32_t* values = (uint32_t*)keys[i].values; 
+        uint32_t* evalues = (uint32_t*)entry->key.values; 
+        uint32_t* emasks = (uint32_t*)entry->key.masks; 
+
+        keys[i].size = keysize; 
+        for(w = 0; w < keysize/4; w++) {
+            values[w] = evalues[w] | ((uint32_t)rand_r(&seed) & ~emasks[w]); 
+        }
+    }
+    *rkeys = keys; 
+    return fme; 
+}
+
+typedef int (*fme_utm_match_f)(fme_t* fme, fme_key_t* keys, int count, 
+                               fme_entry_t** matched); 
+
+static int
+fme_utm_match_tuple__(fme_t* fme, fme_key_t* keys, int count, 
+                      fme_entry_t** matched)
+{
+    int i; 
+    int rv = 0; 
+    for(i = 0; i < count; i++) {
+        matched[i] = NULL; 
+        rv += fme_match(fme, keys+i, 0, 0, matched+i); 
+    }
+    return rv; 
+}
+
+static int
+fme_utm_match_linear__(fme_t* fme, fme_key_t* keys, int count, 
+                       fme_entry_t** matched)
+{
+    int i; 
+    int rv = 0; 
+    for(i = 0; i < count; i++) {
+        matched[i] = NULL; 
+        rv += fme_match_linear(fme, keys+i, 0, 0, matched+i); 
+    }
+    return rv; 
+}
+
+static int
+fme_utm_match_batch__(fme_t* fme, fme_key_t* keys, int count, 
+                      fme_entry_t** matched)
+{
+    return fme_match_batch(fme, keys, count, 0, NULL, matched); 
+}
+
+/*
+ * Run one lookup method over all keys. Every key must match and agree 
+ * with 'expect' (when given). Returns matches/sec or negative. 
+ */
+static double
+fme_utm_match_rate__(ucli_context_t* uc, const char* what, fme_t* fme, 
+                     fme_key_t* keys, int count, fme_utm_match_f match, 
+                     fme_entry_t** matched, fme_entry_t** expect)
+{
+    uint64_t start, end; 
+    int i; 
+
+    start = os_time_thread(); 
+    if(match(fme, keys, count, matched) != count) {
+        ucli_error(uc, "%s: not all keys matched", what); 
+        return -1; 
+    }
+    end = os_time_thread(); 
+
+    for(i = 0; expect && i < count; i++) {
+        if(matched[i] != expect[i]) {
+            ucli_error(uc, "%s: key %d matched index %d, expected index %d", 
+                       what, i, matched[i]->index, expect[i]->index); 
+            return -1; 
+        }
+    }
+    return count / ((end - start) / (1000.0*1000)); 
+}
+
+/*
+ * Time fme_match() against fme_match_linear() using keys drawn from 
+ * the table. Both must agree on every lookup. 
+ */
+static ucli_status_t
+fme_ucli_utm__classify__(ucli_context_t* uc)
+{
+    int table_size; 
+    int tuples; 
+    int iterations; 
+    fme_t* fme; 
+    fme_key_t* keys; 
+    fme_entry_t** expect; 
+    fme_entry_t** matched; 
+    double tuple_rate, linear_rate; 
+    ucli_status_t rv = UCLI_STATUS_OK; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "classify", 3, 
+                      "$summary#Compare tuple space and linear matching rates."
+                      "$args#<table_size> <tuples> <iterations>"); 
+
+    if(aim_valgrind_status() == 1) { 
+        ucli_printf(uc, "Skipping performance test while running under valgrind.\n"); 
+        return UCLI_STATUS_OK; 
+    }
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "iii", &table_size, &tuples, &iterations); 
+
+    if(tuples < 1 || tuples > 32*32) {
+        return ucli_error(uc, "tuples must be between 1 and %d", 32*32); 
+    }
+
+    fme = fme_utm_table_build__(table_size, tuples, 16, &keys, iterations); 
+    expect = aim_zmalloc(sizeof(*expect)*iterations); 
+    matched = aim_zmalloc(sizeof(*matched)*iterations); 
+
+    if( (linear_rate = fme_utm_match_rate__(uc, "linear", fme, keys, iterations, 
+                                            fme_utm_match_linear__, expect, NULL)) < 0 || 
+        (tuple_rate = fme_utm_match_rate__(uc, "tuple", fme, keys, iterations, 
+                                           fme_utm_match_tuple__, matched, expect)) < 0) {
+        rv = UCLI_STATUS_E_ERROR; 
+    }
+    else {
+        ucli_printf(uc, "%d entries, %d tuples: tuple %f matches/sec, linear %f matches/sec (%.1fx)\n", 
+                    table_size, fme->num_tuples, tuple_rate, linear_rate, 
+                    tuple_rate/linear_rate); 
+    }
+
+    aim_free(matched); 
+    aim_free(expect); 
+    aim_free(keys); 
+    fme_destroy_all(fme); 
+    return rv; 
+}
+
+/*
+ * Time the linear scan, single key and batched lookups with full size keys 
+ * under each set of key matching kernels this CPU supports. 
+ */
+static ucli_status_t
+fme_ucli_utm__kernels__(ucli_context_t* uc)
+{
+    int table_size; 
+    int tuples; 
+    int iterations; 
+    int i; 
+    const char* name; 
+    const char* current = fme_kernels->name; 
+    fme_t* fme; 
+    fme_key_t* keys; 
+    fme_entry_t** expect; 
+    fme_entry_t** matched; 
+    double linear_rate, tuple_rate, batch_rate; 
+    ucli_status_t rv = UCLI_STATUS_OK; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "kernels", 3, 
+                      "$summary#Compare matching rates for each set of key matching kernels."
+                      "$args#<table_size> <tuples> <iterations>"); 
+
+    if(aim_valgrind_status() == 1) { 
+        ucli_printf(uc, "Skipping performance test while running under valgrind.\n"); 
+        return UCLI_STATUS_OK; 
+    }
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "iii", &table_size, &tuples, &iterations); 
+
+    if(tuples < 1 || tuples > 32*32) {
+        return ucli_error(uc, "tuples must be between 1 and %d", 32*32); 
+    }
+
+    fme = fme_utm_table_build__(table_size, tuples, sizeof(keys->values), 
+                                &keys, iterations); 
+    expect = aim_zmalloc(sizeof(*expect)*iterations); 
+    matched = aim_zmalloc(sizeof(*matched)*iterations); 
+
+    /* The scalar linear scan is the reference for every other result */
+    fme_kernels_select("scalar"); 
+    if(fme_utm_match_rate__(uc, "reference", fme, keys, iterations, 
+                            fme_utm_match_linear__, expect, NULL) < 0) {
+        rv = UCLI_STATUS_E_ERROR; 
+        goto __kernels__done; 
+    }
+
+    for(i = 0; (name = fme_kernels_name(i)); i++) {
+        if(fme_kernels_select(name) < 0) {
+            ucli_printf(uc, "%s: not supported\n", name); 
+            continue; 
+        }
+        if( (linear_rate = fme_utm_match_rate__(uc, name, fme, keys, iterations, 
+                                                fme_utm_match_linear__, 
+                                                matched, expect)) < 0 || 
+            (tuple_rate = fme_utm_match_rate__(uc, name, fme, keys, iterations, 
+                                               fme_utm_match_tuple__, 
+                                               matched, expect)) < 0 || 
+            (batch_rate = fme_utm_match_rate__(uc, name, fme, keys, iterations, 
+                                               fme_utm_match_batch__, 
+                                               matched, expect)) < 0) {
+            rv = UCLI_STATUS_E_ERROR; 
+            goto __kernels__done; 
+        }
+        ucli_printf(uc, "%-8s: linear %f, tuple %f, batch %f matches/sec\n", 
+                    name, linear_rate, tuple_rate, batch_rate); 
+    }
+
+ __kernels__done:
+    fme_kernels_select(current); 
+    aim_free(matched); 
+    aim_free(expect); 
+    aim_free(keys); 
+    fme_destroy_all(fme); 
+    return rv; 
+}
+
 /* <auto.ucli.handlers.start> */
 /******************************************************************************
  *
@@ -408,6 +670,8 @@ static ucli_command_handler_f fme_ucli_utm_handlers__[] =
     fme_ucli_utm__relativetimeout,
     fme_ucli_utm__timestamp,
     fme_ucli_utm__perf__,
+    fme_ucli_utm__classify__,
+    fme_ucli_utm__kernels__,
     NULL
 };
 /******************************************************************************/
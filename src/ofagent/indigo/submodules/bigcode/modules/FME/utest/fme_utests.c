@@ -181,6 +181,31 @@ ucli_block_t fme_utests[] =
       "match 0xFF DEADBEEF 0 0", 
     },
   },
+  {
+    "tuple-priority", 
+    {
+      "entry 0", 
+      "key 0x1 DEAD0000 FFFF0000", 
+      "entry 1", 
+      "key 0x1 DEADBEEF FFFFFFFF", 
+      "entry 2", 
+      "key 0x1 DEAD0000 FFFF0000", 
+      "expect 2", 
+      "match 0x1 DEADBEEF 0 0", 
+    },
+  },
+  {
+    "tuple-rekey", 
+    {
+      "entry 1", 
+      "key 0x1 CAFECAFE FFFFFFFF", 
+      "key 0x1 DEAD0000 FFFF0000", 
+      "entry 0", 
+      "key 0x1 DEADBEEF FFFFFFFF", 
+      "expect 1", 
+      "match 0x1 DEADBEEF 0 0", 
+    },
+  },
   {
     "perf-10000-10000-0", 
     {
@@ -193,6 +218,30 @@ ucli_block_t fme_utests[] =
       "perf 10000 10000 1", 
     },
   },
+  {
+    "classify-1000", 
+    {
+      "classify 1000 16 10000", 
+    },
+  },
+  {
+    "classify-10000", 
+    {
+      "classify 10000 64 10000", 
+    },
+  },
+  {
+    "classify-100000", 
+    {
+      "classify 100000 256 1000", 
+    },
+  },
+  {
+    "kernels-100000", 
+    {
+      "kernels 100000 16 2000", 
+    },
+  },
   { (void*)0 }
 };
 int fme_utests_count = sizeof(fme_utests)/sizeof(fme_utests[0]); 
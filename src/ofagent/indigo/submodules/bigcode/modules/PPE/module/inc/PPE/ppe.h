@@ -64,6 +64,20 @@ void ppe_packet_denit(ppe_packet_t* ppep);
  */
 int ppe_parse(ppe_packet_t* ppep);
 
+/**
+ * @brief Parse a batch of packets. 
+ *
+ * Each packet is parsed as with ppe_parse(). The data and header 
+ * storage of upcoming packets is prefetched while the current packet 
+ * is parsed. 
+ *
+ * @param packets Array of initialized PPE packet structures. 
+ * @param count The number of packets. 
+ *
+ * @returns The number of packets parsed successfully. 
+ */
+int ppe_parse_batch(ppe_packet_t* packets, int count); 
+
 
 /**
  * @brief Duplicate a packet. 
@@ -218,6 +232,31 @@ int ppe_wide_field_set_header(uint8_t* header_start, ppe_field_t field,
 int ppe_wide_field_info_set_header(uint8_t* header_start, 
                                    const ppe_field_info_t* fi, uint8_t* sv); 
 
+/**
+ * @brief Set the value of the given field and update the checksums 
+ * covering it. 
+ * @param ppep The PPE packet structure. 
+ * @param field The PPE field identifier. 
+ * @param sv The new value for the field. 
+ *
+ * @note The IPv4, TCP and UDP checksums are adjusted incrementally 
+ * @note (RFC 1624), so the cost does not depend on the packet size. 
+ * @note The checksums must be correct beforehand. 
+ */
+int ppe_field_rewrite(ppe_packet_t* ppep, ppe_field_t field, uint32_t sv); 
+
+/**
+ * @brief Set the value of the given wide field and update the checksums 
+ * covering it. 
+ * @param ppep The PPE packet structure. 
+ * @param field The PPE field identifier. 
+ * @param [in] sv The data used to set the field. 
+ *
+ * @note See ppe_field_rewrite(). 
+ */
+int ppe_wide_field_rewrite(ppe_packet_t* ppep, ppe_field_t field, 
+                           uint8_t* sv); 
+
 /**
  * @brief Update dynamic packet fields. 
  * @param ppep The PPE packet structure. 
@@ -379,6 +418,41 @@ int ppe_dfk_show(ppe_dfk_t* dfk, aim_pvs_t* pvs);
  */
 int ppe_packet_dfk(ppe_packet_t* src, ppe_dfk_t* dst); 
 
+/**
+ * @brief Compile a key extraction plan for the given fields. 
+ * @param plan Receives the plan. 
+ * @param fields The fields in the key. 
+ * @param fcount The number of fields. 
+ * @returns The key size in bytes, or -1 if the fields do not fit. 
+ */
+int ppe_dfk_plan_compile(ppe_dfk_plan_t* plan, const ppe_field_t* fields, 
+                         int fcount); 
+
+/**
+ * @brief Extract a key from a parsed packet using a compiled plan. 
+ * @param plan The plan. 
+ * @param ppep The PPE packet structure. 
+ * @param key Receives the key data. Must hold plan->size bytes. 
+ * @param [out] mask Optional. Receives the mask of fields present in 
+ * the packet, as in ppe_dfk_t. 
+ * @returns The key size in bytes. 
+ *
+ * @note The key data is identical to ppe_packet_dfk() for the same
+ * fields. Fields missing from the packet are zero. 
+ */
+int ppe_dfk_plan_extract(const ppe_dfk_plan_t* plan, ppe_packet_t* ppep, 
+                         uint8_t* key, uint32_t* mask); 
+
+/**
+ * @brief Extract a key and return its hash. 
+ * @param plan The plan. 
+ * @param ppep The PPE packet structure. 
+ * @param key Receives the key data. Must hold plan->size bytes. 
+ * @param seed The hash seed. 
+ */
+uint32_t ppe_dfk_plan_hash(const ppe_dfk_plan_t* plan, ppe_packet_t* ppep, 
+                           uint8_t* key, uint32_t seed); 
+
 /**
  * @brief Set the value of a field in a field key. 
  * @param dfk Destination key. 
@@ -134,6 +134,36 @@
 #define PPE_CONFIG_INCLUDE_UTM 0
 #endif
 
+/**
+ * PPE_CONFIG_PARSE_BATCH_PREFETCH
+ *
+ * Number of packets ahead to prefetch in ppe_parse_batch(). */
+
+
+#ifndef PPE_CONFIG_PARSE_BATCH_PREFETCH
+#define PPE_CONFIG_PARSE_BATCH_PREFETCH 8
+#endif
+
+/**
+ * PPE_CONFIG_DFK_PLAN_FIELDS_MAX
+ *
+ * Maximum number of fields in a compiled key extraction plan. */
+
+
+#ifndef PPE_CONFIG_DFK_PLAN_FIELDS_MAX
+#define PPE_CONFIG_DFK_PLAN_FIELDS_MAX 16
+#endif
+
+/**
+ * PPE_CONFIG_DFK_PLAN_SIZE_MAX
+ *
+ * Maximum key size, in bytes, of a compiled key extraction plan. */
+
+
+#ifndef PPE_CONFIG_DFK_PLAN_SIZE_MAX
+#define PPE_CONFIG_DFK_PLAN_SIZE_MAX 64
+#endif
+
 
 
 /**
@@ -74,6 +74,16 @@
     #endif
 #endif
 
+#ifndef PPE_MEMCMP
+    #if defined(GLOBAL_MEMCMP)
+        #define PPE_MEMCMP GLOBAL_MEMCMP
+    #elif PPE_CONFIG_PORTING_STDLIB == 1
+        #define PPE_MEMCMP memcmp
+    #else
+        #error The macro PPE_MEMCMP is required but cannot be defined.
+    #endif
+#endif
+
 #ifndef PPE_STRNCPY
     #if defined(GLOBAL_STRNCPY)
         #define PPE_STRNCPY GLOBAL_STRNCPY
@@ -30,6 +30,8 @@
 #ifndef __PPE_TYPES_H__
 #define __PPE_TYPES_H__
 
+#include <PPE/ppe_config.h>
+
 /* <auto.start.enum(ALL).header> */
 /** ppe_ethertype */
 typedef enum ppe_ethertype_e {
@@ -423,6 +425,35 @@ typedef struct ppe_dfk_s {
     uint8_t size; 
 } ppe_dfk_t; 
 
+/** One step of a compiled key extraction plan. */
+typedef struct ppe_dfk_op_s {
+    /** The header containing the field */
+    uint16_t header; 
+    /** Offset of the field within the header */
+    uint16_t src_offset; 
+    /** Offset of the field within the key */
+    uint16_t dst_offset; 
+    /** Field size in bytes */
+    uint16_t size; 
+} ppe_dfk_op_t; 
+
+/**
+ * Compiled key extraction plan. 
+ *
+ * The key layout is the same as the layout of a dynamic field key 
+ * built from the same fields. 
+ */
+typedef struct ppe_dfk_plan_s {
+    /** Number of fields */
+    unsigned int fcount; 
+    /** Key size in bytes */
+    unsigned int size; 
+    /** Extraction steps, one per field */
+    ppe_dfk_op_t ops[PPE_CONFIG_DFK_PLAN_FIELDS_MAX]; 
+    /** Bits of each key byte which belong to a field */
+    uint8_t mask[PPE_CONFIG_DFK_PLAN_SIZE_MAX]; 
+} ppe_dfk_plan_t; 
+
         
 
 
@@ -74,6 +74,21 @@ ppe_config_settings_t ppe_config_settings[] =
     { __ppe_config_STRINGIFY_NAME(PPE_CONFIG_INCLUDE_UTM), __ppe_config_STRINGIFY_VALUE(PPE_CONFIG_INCLUDE_UTM) },
 #else
 { PPE_CONFIG_INCLUDE_UTM(__ppe_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef PPE_CONFIG_PARSE_BATCH_PREFETCH
+    { __ppe_config_STRINGIFY_NAME(PPE_CONFIG_PARSE_BATCH_PREFETCH), __ppe_config_STRINGIFY_VALUE(PPE_CONFIG_PARSE_BATCH_PREFETCH) },
+#else
+{ PPE_CONFIG_PARSE_BATCH_PREFETCH(__ppe_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef PPE_CONFIG_DFK_PLAN_FIELDS_MAX
+    { __ppe_config_STRINGIFY_NAME(PPE_CONFIG_DFK_PLAN_FIELDS_MAX), __ppe_config_STRINGIFY_VALUE(PPE_CONFIG_DFK_PLAN_FIELDS_MAX) },
+#else
+{ PPE_CONFIG_DFK_PLAN_FIELDS_MAX(__ppe_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef PPE_CONFIG_DFK_PLAN_SIZE_MAX
+    { __ppe_config_STRINGIFY_NAME(PPE_CONFIG_DFK_PLAN_SIZE_MAX), __ppe_config_STRINGIFY_VALUE(PPE_CONFIG_DFK_PLAN_SIZE_MAX) },
+#else
+{ PPE_CONFIG_DFK_PLAN_SIZE_MAX(__ppe_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
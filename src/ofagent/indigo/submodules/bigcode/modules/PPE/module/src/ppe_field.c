@@ -23,6 +23,7 @@
 #include "ppe_util.h"
 
 #include <IOF/iof.h>
+#include <murmur/murmur.h>
 
 /**
  * Field Information Table
@@ -532,6 +533,96 @@ ppe_packet_dfk(ppe_packet_t* ppep, ppe_dfk_t* dfk)
 }
 
 
+/**************************************************************************//**
+ *
+ * Compiled key extraction
+ *
+ *
+ *****************************************************************************/
 
+/* Source for fields whose header is missing from the packet */
+static const uint8_t dfk_plan_zeros__[16]; 
 
-    
+int
+ppe_dfk_plan_compile(ppe_dfk_plan_t* plan, const ppe_field_t* fields, 
+                     int fcount)
+{
+    int i; 
+    unsigned int offset_bytes = 0; 
+
+    PPE_MEMSET(plan, 0, sizeof(*plan)); 
+    if(fcount < 0 || fcount > PPE_CONFIG_DFK_PLAN_FIELDS_MAX) {
+        return -1; 
+    }
+
+    for(i = 0; i < fcount; i++) {
+        const ppe_field_info_t* fi = ppe_field_info_table + fields[i]; 
+        ppe_dfk_op_t* op = plan->ops + i; 
+        int size = DFK_FIELD_SIZE(fi->size_bits); 
+        int b; 
+
+        if(size > (int)sizeof(dfk_plan_zeros__) || 
+           offset_bytes + size > PPE_CONFIG_DFK_PLAN_SIZE_MAX) {
+            return -1; 
+        }
+
+        op->header = fi->header; 
+        op->src_offset = fi->offset_bytes; 
+        op->dst_offset = offset_bytes; 
+        op->size = size; 
+
+        if(fi->size_bits <= 32) {
+            /* The field's bits within its bytes, in network order */
+            uint32_t m = (fi->size_bits < 32) ? 
+                ((1U << fi->size_bits) - 1) : 0xFFFFFFFF; 
+            m <<= fi->shift_bits; 
+            for(b = 0; b < size; b++) {
+                plan->mask[offset_bytes + b] = m >> (8*(size - b - 1)); 
+            }
+        }
+        else {
+            PPE_MEMSET(plan->mask + offset_bytes, 0xFF, size); 
+        }
+        offset_bytes += size; 
+    }
+
+    plan->fcount = fcount; 
+    plan->size = offset_bytes; 
+    return plan->size; 
+}
+
+int
+ppe_dfk_plan_extract(const ppe_dfk_plan_t* plan, ppe_packet_t* ppep, 
+                     uint8_t* key, uint32_t* mask)
+{
+    unsigned int i; 
+    uint32_t m = 0; 
+
+    /* 
+     * Copy whole bytes for every field, then clear the bits 
+     * which do not belong to a field in one pass. 
+     */
+    for(i = 0; i < plan->fcount; i++) {
+        const ppe_dfk_op_t* op = plan->ops + i; 
+        const uint8_t* src = ppep->headers[op->header].start; 
+        m |= (uint32_t)(src != NULL) << i; 
+        src = (src) ? src + op->src_offset : dfk_plan_zeros__; 
+        PPE_MEMCPY(key + op->dst_offset, src, op->size); 
+    }
+    for(i = 0; i < plan->size; i++) {
+        key[i] &= plan->mask[i]; 
+    }
+
+    if(mask) {
+        *mask = m; 
+    }
+    return plan->size; 
+}
+
+uint32_t
+ppe_dfk_plan_hash(const ppe_dfk_plan_t* plan, ppe_packet_t* ppep, 
+                  uint8_t* key, uint32_t seed)
+{
+    ppe_dfk_plan_extract(plan, ppep, key, NULL); 
+    return murmur_hash(key, plan->size, seed); 
+}
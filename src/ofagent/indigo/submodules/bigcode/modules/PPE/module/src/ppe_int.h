@@ -26,4 +26,11 @@
 
 
 #include <PPE/ppe.h> 
+
+#if defined(__GNUC__)
+#define PPE_PREFETCH(_p) __builtin_prefetch(_p)
+#else
+#define PPE_PREFETCH(_p)
+#endif
+
 #endif /* __PPE_INT_H__ */
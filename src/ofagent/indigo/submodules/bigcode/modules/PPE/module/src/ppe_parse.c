@@ -19,6 +19,7 @@
 
 #include <PPE/ppe_config.h>
 #include <PPE/ppe.h>
+#include "ppe_int.h"
 
 #define PPE_LOG_PREFIX1 ".parse"
 #include "ppe_log.h"
@@ -99,115 +100,128 @@ uint8_t* datap__(int skip, int advance, int size, uint8_t** data, int* len)
 
 /**************************************************************************//**
  *
- * Parse packet headers. 
+ * Parse graph. 
  *
+ * Everything above the ethertype is described by a table of protocol 
+ * nodes. Each node records its headers, computes its own length, and 
+ * selects the next node by indexing a table with a one byte protocol 
+ * selector. The ethertype and IP protocol edges are generated from ppe.x. 
  *
  *****************************************************************************/
-static inline int
-ppe_parse_ip_protocol_TCP__(ppe_packet_t* ppep, uint8_t* data, int size)
-{
-    AIM_REFERENCE(size); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_TCP, data); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_L4, data); 
-    return 0; 
-}
-static inline int
-ppe_parse_ip_protocol_UDP__(ppe_packet_t* ppep, uint8_t* data, int size)
-{
-    AIM_REFERENCE(size); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_UDP, data); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_L4, data); 
-    return 0; 
-}
-static inline int
-ppe_parse_ip_protocol_ICMP__(ppe_packet_t* ppep, uint8_t* data, int size)
-{
-    AIM_REFERENCE(size); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_ICMP, data); 
-    return 0; 
-}
+typedef enum ppe_parse_node_e {
+    PPE_PARSE_NODE_NONE, 
+#define PPE_ETHERTYPE_ENTRY(_type, _value) PPE_PARSE_NODE_##_type,
+#include <PPE/ppe.x>
+#define PPE_IP_PROTOCOL_ENTRY(_proto, _value) PPE_PARSE_NODE_##_proto,
+#include <PPE/ppe.x>
+    PPE_PARSE_NODE_COUNT
+} ppe_parse_node_t; 
+
+/**
+ * Next node by IP protocol. 
+ */
+static const uint8_t ppe_parse_ip_protocol_next__[256] = 
+    {
+#define PPE_IP_PROTOCOL_ENTRY(_proto, _value)                   \
+        [PPE_IP_PROTOCOL_##_proto] = PPE_PARSE_NODE_##_proto,
+#include <PPE/ppe.x>
+    }; 
+
+typedef struct ppe_parse_graph_node_s {
+    /** Headers which start at this node */
+    uint32_t header_mask; 
+    /** Primary header */
+    uint8_t header; 
+    /** Secondary header, or 0 if none */
+    uint8_t alias; 
+    /** Fixed header length, or the minimum length if ihl is set */
+    uint8_t hlen; 
+    /** Header length is the low nibble of the first byte in words */
+    uint8_t ihl; 
+    /** Offset of the next protocol selector byte */
+    uint8_t next_offset; 
+    /** Next node by selector value. NULL for terminal nodes. */
+    const uint8_t* next; 
+} ppe_parse_graph_node_t; 
+
+#define HBIT(_h) (1 << PPE_HEADER_##_h)
+
+static const ppe_parse_graph_node_t ppe_parse_graph__[PPE_PARSE_NODE_COUNT] = 
+    {
+        [PPE_PARSE_NODE_ARP]  = { HBIT(ARP), PPE_HEADER_ARP, 0, 
+                                  0, 0, 0, NULL }, 
+        [PPE_PARSE_NODE_IP4]  = { HBIT(IP4), PPE_HEADER_IP4, 0, 
+                                  20, 1, 9, ppe_parse_ip_protocol_next__ }, 
+        [PPE_PARSE_NODE_IP6]  = { HBIT(IP6), PPE_HEADER_IP6, 0, 
+                                  40, 0, 6, ppe_parse_ip_protocol_next__ }, 
+        [PPE_PARSE_NODE_TCP]  = { HBIT(TCP) | HBIT(L4), PPE_HEADER_TCP, 
+                                  PPE_HEADER_L4, 0, 0, 0, NULL }, 
+        [PPE_PARSE_NODE_UDP]  = { HBIT(UDP) | HBIT(L4), PPE_HEADER_UDP, 
+                                  PPE_HEADER_L4, 0, 0, 0, NULL }, 
+        [PPE_PARSE_NODE_ICMP] = { HBIT(ICMP), PPE_HEADER_ICMP, 0, 
+                                  0, 0, 0, NULL }, 
+    }; 
 
 static inline int
-ppe_parse_ip_protocol(ppe_packet_t* ppep, uint8_t protocol, 
-                      uint8_t* data, int size)
+ppe_parse_ethertype_node__(uint16_t etype)
 {
-    switch(protocol) 
+    switch(etype) 
         {
-#define PPE_IP_PROTOCOL_ENTRY(_proto, _value)                           \
-            case PPE_IP_PROTOCOL_##_proto:                              \
-                return ppe_parse_ip_protocol_##_proto##__ (ppep, data, size);
+#define PPE_ETHERTYPE_ENTRY(_type, _value)                              \
+            case PPE_ETHERTYPE_##_type: return PPE_PARSE_NODE_##_type;
 #include <PPE/ppe.x>
-        default: return 0; 
+        default: return PPE_PARSE_NODE_NONE; 
         }
 }
-            
 
 static inline int
-ppe_parse_ethertype_ARP__(ppe_packet_t* ppep, uint8_t* data, int size)
+ppe_parse_graph_walk__(ppe_packet_t* ppep, int node_id, 
+                       uint8_t* data, int size)
 {
-    AIM_REFERENCE(size); 
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_ARP, data);
-    return 0; 
-}
+    while(node_id != PPE_PARSE_NODE_NONE && size > 0) {
+        const ppe_parse_graph_node_t* node = ppe_parse_graph__ + node_id; 
+        int hlen; 
 
-static inline int
-ppe_parse_ethertype_IP4__(ppe_packet_t* ppep, uint8_t* data, int size)
-{
-    int hsize = data[0] & 0xF; 
-    int hoffset;
-
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_IP4, data); 
-    
-    if(hsize < 5) { 
-        /* Invalid header size -- stop parsing */
-        return 0; 
-    }
+        ppep->header_mask |= node->header_mask; 
+        ppep->headers[node->header].start = data; 
+        if(node->alias) {
+            ppep->headers[node->alias].start = data; 
+        }
 
-    /*
-     * Protocol byte is at offset 9. 
-     * Next header offset is hsize*4 bytes
-     */
-    hoffset = hsize*4; 
-    return ppe_parse_ip_protocol(ppep, data[9], data+hoffset, size-hoffset);
-}
+        if(node->next == NULL) {
+            break; 
+        }
 
-static inline int
-ppe_parse_ethertype_IP6__(ppe_packet_t* ppep, uint8_t* data, int size)
-{
-    PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_IP6, data); 
+        hlen = (node->ihl) ? (data[0] & 0xF) * 4 : node->hlen; 
+        if(hlen < node->hlen || node->next_offset >= size) {
+            /* Invalid header size or no selector -- stop parsing */
+            break; 
+        }
 
-    /* The nextheader is at offset 6 */
-    return ppe_parse_ip_protocol(ppep, data[6], data+40, size-40); 
+        node_id = node->next[data[node->next_offset]]; 
+        data += hlen; 
+        size -= hlen; 
+    }
+    return 0; 
 }
 
-static inline int 
-ppe_parse_ethertype__(ppe_packet_t* ppep, uint16_t etype, 
-                      uint8_t* data, int size)
-{
-    switch(etype) 
-        {
-
-#define PPE_ETHERTYPE_ENTRY(_type, _value)                              \
-            case PPE_ETHERTYPE_##_type: return ppe_parse_ethertype_##_type##__ (ppep, data, size); 
-#include <PPE/ppe.x>
-        default:
-            /* Unknown type */  
-            return 0; 
-        }
-} 
 
+/**************************************************************************//**
+ *
+ * Parse link layer headers. 
+ *
+ *
+ *****************************************************************************/
 static inline int
 ppe_parse_snap__(ppe_packet_t* ppep, uint8_t* data, int size)
 {
-    uint32_t oui; 
     PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_SNAP, data); 
-    ppe_field_get(ppep, PPE_FIELD_SNAP_OUI, &oui); 
-    if(oui == 0) { 
+    if(size >= 5 && (data[0] | data[1] | data[2]) == 0) { 
         /* Protocol is Ethertype */
-        uint32_t etype; 
-        ppe_field_get(ppep, PPE_FIELD_SNAP_PROTOCOL, &etype); 
         PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_ETHER, data+3);
-        return ppe_parse_ethertype__(ppep, etype, data+5, size-5); 
+        return ppe_parse_graph_walk__(ppep, 
+                                      ppe_parse_ethertype_node__(data[3] << 8 | data[4]), 
+                                      data+5, size-5); 
     }
     else { 
         PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_ETHERTYPE_MISSING, NULL); 
@@ -271,7 +285,7 @@ ppe_parse(ppe_packet_t* ppep)
     /* Skip 12 bytes and check the Ethertype/Len/TPID field */
     data16 = data16__(12, 0, &data, &size); 
     
-    if(data16 == 0x8100) {
+    if(data16 == 0x8100 && size >= 6) {
         PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_8021Q, data); 
         /* Skip the tag and get the ethertype/len field */
         data16 = data16__(4, 0, &data, &size);
@@ -285,13 +299,39 @@ ppe_parse(ppe_packet_t* ppep)
     if(data16 >= 0x600) {
         /* EtherII */
         PPE_PACKET_HEADER_SET(ppep, PPE_HEADER_ETHER, data);
-        return ppe_parse_ethertype__(ppep, data16, data+2, size-2); 
+        return ppe_parse_graph_walk__(ppep, 
+                                      ppe_parse_ethertype_node__(data16), 
+                                      data+2, size-2); 
     }
-    else {
+    else if(size >= 5) {
         /* 802.3, assumed LLC */
         /* Note -- our LLC header includes the 802.3 length field */
         return ppe_parse_llc__(ppep, data, size); 
     }    
+    return 0; 
 }
 
+int
+ppe_parse_batch(ppe_packet_t* packets, int count)
+{
+    int i; 
+    int parsed = 0; 
 
+    for(i = 0; i < count; i++) {
+        /* 
+         * Prefetch the packet structure two strides ahead, so its data 
+         * pointer is already cached when the data itself is prefetched 
+         * one stride ahead. 
+         */
+        if(i + 2*PPE_CONFIG_PARSE_BATCH_PREFETCH < count) {
+            PPE_PREFETCH(packets + i + 2*PPE_CONFIG_PARSE_BATCH_PREFETCH); 
+        }
+        if(i + PPE_CONFIG_PARSE_BATCH_PREFETCH < count) {
+            PPE_PREFETCH(packets[i + PPE_CONFIG_PARSE_BATCH_PREFETCH].data); 
+        }
+        if(ppe_parse(packets + i) == 0) {
+            parsed++; 
+        }
+    }
+    return parsed; 
+}
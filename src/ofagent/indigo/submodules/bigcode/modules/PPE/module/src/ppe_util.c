@@ -24,31 +24,51 @@
 /* fixme */
 #include <arpa/inet.h>
 
+/*
+ * One's complement sum of the data, folded to 16 bits. 
+ *
+ * The data is summed as native order 32 bit words into a 64 bit 
+ * accumulator, which cannot overflow for any packet size, so there 
+ * is no carry handling in the loop. Folding the result gives the 
+ * same value as summing native order 16 bit words. 
+ */
 uint32_t
 sum16__(uint8_t* data, int len)
 {
-    uint32_t sum = 0; 
-    uint16_t* sdata = (uint16_t*)data; 
-    int olen = len;
-
-    while(len > 1) {
-        sum += *(sdata++);
-        if(sum & 0x80000000) {
-            sum = (sum & 0xFFFF) + (sum >> 16);
-        }
-        len -= 2;
-    }
+    uint64_t sum = 0; 
+    uint32_t w[4]; 
+    uint16_t h; 
 
+    while(len >= 16) {
+        PPE_MEMCPY(w, data, 16); 
+        sum += (uint64_t)w[0] + w[1] + w[2] + w[3]; 
+        data += 16; 
+        len -= 16; 
+    }
+    while(len >= 4) {
+        PPE_MEMCPY(w, data, 4); 
+        sum += w[0]; 
+        data += 4; 
+        len -= 4; 
+    }
+    if(len >= 2) {
+        PPE_MEMCPY(&h, data, 2); 
+        sum += h; 
+        data += 2; 
+        len -= 2; 
+    }
     if(len) {
-        uint16_t b = data[olen-1];
-        if(*sdata != b) { 
-            sum += b<<8; 
-        }
-        else {
-            sum += (b);
-        }
+        /* Pad the odd byte with a zero byte that follows it in memory */
+        uint8_t pad[2] = { data[0], 0 }; 
+        PPE_MEMCPY(&h, pad, 2); 
+        sum += h; 
     }
-    return sum; 
+
+    sum = (sum & 0xFFFFFFFF) + (sum >> 32); 
+    sum = (sum & 0xFFFFFFFF) + (sum >> 32); 
+    sum = (sum & 0xFFFF) + (sum >> 16); 
+    sum = (sum & 0xFFFF) + (sum >> 16); 
+    return (uint32_t)sum; 
 }
 
 /**************************************************************************//**
@@ -155,6 +175,10 @@ ppe_pseudoheader_checksum_update(ppe_packet_t* ppep,
         csum = ip_checksum__((uint8_t*)pseudo_header, sizeof(pseudo_header), 
                              header, size, 
                              NULL, 0); 
+        if(csum == 0 && protocol == PPE_IP_PROTOCOL_UDP) {
+            /* A zero UDP checksum means no checksum (RFC 768) */
+            csum = 0xFFFF; 
+        }
         ppe_field_set(ppep, 
                       checksum_field, 
                       csum); 
@@ -179,3 +203,151 @@ ppe_udp_header_checksum_update(ppe_packet_t* ppep)
                                             PPE_IP_PROTOCOL_UDP); 
 }
 
+
+/**************************************************************************//**
+ *
+ * Incremental checksum updates (RFC 1624). 
+ *
+ * When a field is rewritten, each checksum covering it is adjusted by 
+ * the difference between the old and new 16 bit words holding the field: 
+ *
+ *      HC' = ~(~HC + ~m + m')
+ *
+ * This costs the same for any packet size. 
+ *
+ *
+ *****************************************************************************/
+
+/**
+ * Widest field that can be rewritten, widened to whole 16 bit words. 
+ */
+#define REWRITE_BYTES_MAX 32
+
+static void
+checksum_adjust__(uint8_t* csum, uint32_t old_sum, uint32_t new_sum, 
+                  int udp)
+{
+    uint16_t hc; 
+    uint32_t sum; 
+
+    /* The sums are native order, so the checksum is handled in place */
+    PPE_MEMCPY(&hc, csum, 2); 
+    if(udp && hc == 0) {
+        /* UDP checksum is disabled */
+        return; 
+    }
+    sum = (uint16_t)~hc + (uint16_t)~old_sum + new_sum; 
+    sum = (sum & 0xFFFF) + (sum >> 16); 
+    sum = (sum & 0xFFFF) + (sum >> 16); 
+    hc = ~sum; 
+    if(udp && hc == 0) {
+        hc = 0xFFFF; 
+    }
+    PPE_MEMCPY(csum, &hc, 2); 
+}
+
+/*
+ * Adjust the TCP or UDP checksum, if present, for a change 
+ * covered by the IPv4 pseudoheader. 
+ */
+static void
+pseudoheader_adjust__(ppe_packet_t* ppep, uint32_t old_sum, uint32_t new_sum)
+{
+    if(ppep->headers[PPE_HEADER_TCP].start) {
+        checksum_adjust__(ppe_fieldp_get(ppep, PPE_FIELD_TCP_CHECKSUM), 
+                          old_sum, new_sum, 0); 
+    }
+    else if(ppep->headers[PPE_HEADER_UDP].start) {
+        checksum_adjust__(ppe_fieldp_get(ppep, PPE_FIELD_UDP_CHECKSUM), 
+                          old_sum, new_sum, 1); 
+    }
+}
+
+static int
+field_rewrite__(ppe_packet_t* ppep, const ppe_field_info_t* fi, 
+                uint32_t sv, uint8_t* wsv)
+{
+    uint8_t* header = ppep->headers[fi->header].start; 
+    uint8_t old[REWRITE_BYTES_MAX]; 
+    uint32_t old_sum, new_sum; 
+    int start, end; 
+    int rv; 
+
+    if(header == NULL) {
+        /* The field does not exist in the packet. */
+        return -1; 
+    }
+
+    /* The bytes holding the field, widened to whole 16 bit words */
+    start = fi->offset_bytes & ~1; 
+    end = (fi->offset_bytes + (fi->size_bits + 7)/8 + 1) & ~1; 
+    if(end - start > (int)sizeof(old)) {
+        return -1; 
+    }
+    PPE_MEMCPY(old, header+start, end-start); 
+
+    if(wsv) {
+        rv = ppe_wide_field_info_set_header(header, fi, wsv); 
+    }
+    else {
+        rv = ppe_field_info_set_header(header, fi, sv); 
+    }
+    if(rv < 0) {
+        return rv; 
+    }
+
+    old_sum = sum16__(old, end-start); 
+    new_sum = sum16__(header+start, end-start); 
+
+    switch(fi->header)
+        {
+        case PPE_HEADER_IP4:
+            {
+                if(fi->field != PPE_FIELD_IP4_CHECKSUM) {
+                    checksum_adjust__(ppe_fieldp_get(ppep, PPE_FIELD_IP4_CHECKSUM), 
+                                      old_sum, new_sum, 0); 
+                }
+                if(fi->field == PPE_FIELD_IP4_SRC_ADDR || 
+                   fi->field == PPE_FIELD_IP4_DST_ADDR) {
+                    pseudoheader_adjust__(ppep, old_sum, new_sum); 
+                }
+                break; 
+            }
+        case PPE_HEADER_TCP:
+            {
+                if(fi->field != PPE_FIELD_TCP_CHECKSUM) {
+                    checksum_adjust__(ppe_fieldp_get(ppep, PPE_FIELD_TCP_CHECKSUM), 
+                                      old_sum, new_sum, 0); 
+                }
+                break; 
+            }
+        case PPE_HEADER_UDP:
+            {
+                if(fi->field != PPE_FIELD_UDP_CHECKSUM) {
+                    checksum_adjust__(ppe_fieldp_get(ppep, PPE_FIELD_UDP_CHECKSUM), 
+                                      old_sum, new_sum, 1); 
+                }
+                if(fi->field == PPE_FIELD_UDP_LENGTH) {
+                    /* The length is in the pseudoheader too */
+                    pseudoheader_adjust__(ppep, old_sum, new_sum); 
+                }
+                break; 
+            }
+        default:
+            /* Not covered by any checksum we maintain */
+            break; 
+        }
+    return 0; 
+}
+
+int
+ppe_field_rewrite(ppe_packet_t* ppep, ppe_field_t field, uint32_t sv)
+{
+    return field_rewrite__(ppep, ppe_field_info_get(field), sv, NULL); 
+}
+
+int
+ppe_wide_field_rewrite(ppe_packet_t* ppep, ppe_field_t field, uint8_t* sv)
+{
+    return field_rewrite__(ppep, ppe_field_info_get(field), 0, sv); 
+}
@@ -23,7 +23,10 @@
 
 #include <PPE/uCli/ppe_utm.h>
 #include <uCli/ucli_argparse.h>
+#include <OS/os_time.h>
+#include <murmur/murmur.h>
 #include "ppe_util.h"
+#include <stdio.h>
 
 
 /**
@@ -271,6 +274,25 @@ ppe_ucli_utm__set__(ucli_context_t* uc)
     return UCLI_STATUS_OK; 
 }
 
+static ucli_status_t
+ppe_ucli_utm__rewrite__(ucli_context_t* uc)
+{
+    int data; 
+    ppe_field_info_t* fi; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "rewrite", 2, 
+                      "Set a packet field and incrementally update its checksums."); 
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "{ppe_field_info}i", &fi, &data); 
+    PPE_FIELD32_OR_RETURN(uc, fi->size_bits); 
+    PPE_FIELD_EXISTS_OR_RETURN(uc, fi->field); 
+    if(ppe_field_rewrite(&ppec->ppep, fi->field, data) < 0) {
+        return ucli_e_internal(uc, "ppe_field_rewrite(%{ppe_field})", fi->field); 
+    }
+    return UCLI_STATUS_OK; 
+}
+
 static ucli_status_t
 ppe_ucli_utm__get__(ucli_context_t* uc)
 {
@@ -540,6 +562,24 @@ ppe_ucli_utm__dfk__(ucli_context_t* uc)
         }
     }
 
+    /* The compiled plan must produce the same key */
+    {
+        ppe_dfk_plan_t plan; 
+        uint8_t key[PPE_CONFIG_DFK_PLAN_SIZE_MAX]; 
+        uint32_t mask; 
+
+        if(ppe_dfk_plan_compile(&plan, fields, AIM_ARRAYSIZE(fields)) != dfk.size) {
+            rv = ucli_error(uc, "plan size is %d, dfk size is %d", plan.size, dfk.size); 
+            goto dfk_error; 
+        }
+        ppe_dfk_plan_extract(&plan, &ppec->ppep, key, &mask); 
+        if(mask != dfk.mask || PPE_MEMCMP(key, dfk.data, dfk.size)) {
+            rv = ucli_error(uc, "plan key=%{data} mask=0x%x, dfk mask=0x%x", 
+                            key, plan.size, mask, dfk.mask); 
+            goto dfk_error; 
+        }
+    }
+
     aim_free(verify_data); 
     ppe_dfk_destroy(&dfk); 
     return UCLI_STATUS_OK; 
@@ -642,6 +682,323 @@ ppe_ucli_utm__rwall__(ucli_context_t* uc)
     return rv; 
 }
 
+/*
+ * Parse every packet with ppe_parse() and then with ppe_parse_batch(), 
+ * verify that both produce the same headers, and report the rates. 
+ */
+static ucli_status_t
+ppe_utm_parse_rate__(ucli_context_t* uc, ppe_packet_t* packets, int count, 
+                     int iterations)
+{
+    uint32_t* masks = aim_zmalloc(sizeof(*masks)*count); 
+    uint64_t start, end; 
+    double seconds; 
+    int i, j; 
+    int rv = UCLI_STATUS_OK; 
+
+    for(i = 0; i < count; i++) {
+        ppe_parse(packets+i); 
+        masks[i] = packets[i].header_mask; 
+    }
+    if(ppe_parse_batch(packets, count) != count) {
+        rv = ucli_error(uc, "ppe_parse_batch() did not parse all packets."); 
+        goto done; 
+    }
+    for(i = 0; i < count; i++) {
+        if(packets[i].header_mask != masks[i]) {
+            rv = ucli_error(uc, "packet %d: batch header mask 0x%x, expected 0x%x", 
+                            i, packets[i].header_mask, masks[i]); 
+            goto done; 
+        }
+    }
+
+    start = os_time_thread(); 
+    for(j = 0; j < iterations; j++) {
+        for(i = 0; i < count; i++) {
+            ppe_parse(packets+i); 
+        }
+    }
+    end = os_time_thread(); 
+    seconds = (end - start) / (1000.0*1000); 
+    ucli_printf(uc, "ppe_parse:       %d packets in %f seconds (%f packets/sec)\n", 
+                count*iterations, seconds, (count*iterations)/seconds); 
+
+    start = os_time_thread(); 
+    for(j = 0; j < iterations; j++) {
+        ppe_parse_batch(packets, count); 
+    }
+    end = os_time_thread(); 
+    seconds = (end - start) / (1000.0*1000); 
+    ucli_printf(uc, "ppe_parse_batch: %d packets in %f seconds (%f packets/sec)\n", 
+                count*iterations, seconds, (count*iterations)/seconds); 
+
+ done:
+    aim_free(masks); 
+    return rv; 
+}
+
+/*
+ * Synthetic traffic mix used when no trace is available. 
+ */
+static const char* ppe_utm_parse_templates__[] = 
+    {
+        /* IP4/TCP */
+        "000000000001000000000002080045000028000040004006000"
+        "00a0000010a000002dead0050000000010000000050022000000000000", 
+        /* 802.1Q/IP4/UDP */
+        "0000000000010000000000028100006408004500001c000040004011000"
+        "00a0000010a0000020035003500080000", 
+        /* IP4/ICMP */
+        "000000000001000000000002080045000024000040004001000"
+        "00a0000010a0000020800000000010001", 
+        /* IP6/TCP */
+        "00000000000100000000000286dd6000000000140640fe8000000000000000"
+        "00000000000001fe800000000000000000000000000002dead0050000000010"
+        "000000050022000000000000", 
+        /* ARP */
+        "ffffffffffff0000000000020806000108000604000100000000000"
+        "20a000001000000000000a000002", 
+        /* LLC/SNAP/IP4/TCP */
+        "0000000000010000000000020032aaaa030000000800450000280000400040060"
+        "0000a0000010a000002dead0050000000010000000050022000000000000", 
+    }; 
+
+#define PPE_UTM_PARSE_SLOT 256
+/* Any prime which does not divide the packet count */
+#define PPE_UTM_PARSE_STRIDE 7919
+
+static int
+ppe_utm_hex__(const char* hex, uint8_t* data, int size)
+{
+    int len = 0; 
+    unsigned int b; 
+    while(len < size && hex[0] && hex[1] && sscanf(hex, "%2x", &b) == 1) {
+        data[len++] = b; 
+        hex += 2; 
+    }
+    return len; 
+}
+
+/*
+ * Build 'count' packets from the synthetic traffic mix. Packet buffers 
+ * are allocated in a shuffled order so consecutive packets do not share 
+ * cache lines, as with a real buffer pool. 
+ */
+static ppe_packet_t*
+ppe_utm_packets_build__(int count, uint8_t** rdata)
+{
+    int i; 
+    int templates = AIM_ARRAYSIZE(ppe_utm_parse_templates__); 
+    uint8_t* data = aim_zmalloc(count * PPE_UTM_PARSE_SLOT); 
+    ppe_packet_t* packets = aim_zmalloc(sizeof(*packets)*count); 
+
+    for(i = 0; i < count; i++) {
+        uint8_t* p = data + ((i * PPE_UTM_PARSE_STRIDE) % count) * PPE_UTM_PARSE_SLOT; 
+        int size = ppe_utm_hex__(ppe_utm_parse_templates__[i % templates], 
+                                 p, PPE_UTM_PARSE_SLOT); 
+        ppe_packet_init(packets+i, p, size); 
+    }
+    *rdata = data; 
+    return packets; 
+}
+
+static ucli_status_t
+ppe_ucli_utm__parse_rate__(ucli_context_t* uc)
+{
+    int count, iterations; 
+    uint8_t* data; 
+    ppe_packet_t* packets; 
+    ucli_status_t rv; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "parse-rate", 2, 
+                      "$summary#Measure the parse rate over a synthetic traffic mix."
+                      "$args#<packets> <iterations>"); 
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "ii", &count, &iterations); 
+    if(count <= 0 || iterations <= 0) {
+        return ucli_error(uc, "packets and iterations must be positive."); 
+    }
+
+    packets = ppe_utm_packets_build__(count, &data); 
+    rv = ppe_utm_parse_rate__(uc, packets, count, iterations); 
+    aim_free(packets); 
+    aim_free(data); 
+    return rv; 
+}
+
+static ucli_status_t
+ppe_ucli_utm__dfk_rate__(ucli_context_t* uc)
+{
+    static const ppe_field_t fields[] = {
+        PPE_FIELD_IP4_SRC_ADDR, PPE_FIELD_IP4_DST_ADDR, PPE_FIELD_IP4_PROTOCOL, 
+        PPE_FIELD_L4_SRC_PORT, PPE_FIELD_L4_DST_PORT
+    }; 
+    int count, iterations; 
+    uint8_t* data; 
+    ppe_packet_t* packets; 
+    ppe_dfk_t dfk; 
+    ppe_dfk_plan_t plan; 
+    uint8_t key[PPE_CONFIG_DFK_PLAN_SIZE_MAX]; 
+    uint32_t* hashes; 
+    uint32_t sum = 0; 
+    uint64_t start, end; 
+    double seconds; 
+    int i, j; 
+    int rv = UCLI_STATUS_OK; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "dfk-rate", 2, 
+                      "$summary#Compare 5-tuple key hashing with ppe_packet_dfk() and a compiled plan."
+                      "$args#<packets> <iterations>"); 
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "ii", &count, &iterations); 
+    if(count <= 0 || iterations <= 0) {
+        return ucli_error(uc, "packets and iterations must be positive."); 
+    }
+
+    packets = ppe_utm_packets_build__(count, &data); 
+    ppe_parse_batch(packets, count); 
+    ppe_dfk_init(&dfk, (ppe_field_t*)fields, AIM_ARRAYSIZE(fields)); 
+    ppe_dfk_plan_compile(&plan, fields, AIM_ARRAYSIZE(fields)); 
+    hashes = aim_zmalloc(sizeof(*hashes)*count); 
+
+    for(i = 0; i < count; i++) {
+        ppe_packet_dfk(packets+i, &dfk); 
+        hashes[i] = murmur_hash(dfk.data, dfk.size, 0); 
+        if(ppe_dfk_plan_hash(&plan, packets+i, key, 0) != hashes[i]) {
+            rv = ucli_error(uc, "packet %d: plan hash does not match the dfk hash.", i); 
+            goto done; 
+        }
+    }
+
+    start = os_time_thread(); 
+    for(j = 0; j < iterations; j++) {
+        for(i = 0; i < count; i++) {
+            ppe_packet_dfk(packets+i, &dfk); 
+            sum += murmur_hash(dfk.data, dfk.size, 0); 
+        }
+    }
+    end = os_time_thread(); 
+    seconds = (end - start) / (1000.0*1000); 
+    ucli_printf(uc, "ppe_packet_dfk:    %d keys in %f seconds (%f keys/sec)\n", 
+                count*iterations, seconds, (count*iterations)/seconds); 
+
+    start = os_time_thread(); 
+    for(j = 0; j < iterations; j++) {
+        for(i = 0; i < count; i++) {
+            sum += ppe_dfk_plan_hash(&plan, packets+i, key, 0); 
+        }
+    }
+    end = os_time_thread(); 
+    seconds = (end - start) / (1000.0*1000); 
+    ucli_printf(uc, "ppe_dfk_plan_hash: %d keys in %f seconds (%f keys/sec)\n", 
+                count*iterations, seconds, (count*iterations)/seconds); 
+    AIM_REFERENCE(sum); 
+
+ done:
+    aim_free(hashes); 
+    ppe_dfk_destroy(&dfk); 
+    aim_free(packets); 
+    aim_free(data); 
+    return rv; 
+}
+
+static ucli_status_t
+ppe_ucli_utm__parse_pcap__(ucli_context_t* uc)
+{
+    char* filename; 
+    int iterations; 
+    FILE* fp; 
+    uint32_t hdr[6]; 
+    uint32_t rec[4]; 
+    int swap; 
+    int count = 0; 
+    int max = 0; 
+    ppe_packet_t* packets = NULL; 
+    ucli_status_t rv; 
+    int i; 
+
+    UCLI_COMMAND_INFO(uc, 
+                      "parse-pcap", 2, 
+                      "$summary#Measure the parse rate over an ethernet pcap trace."
+                      "$args#<file> <iterations>"); 
+
+    UCLI_ARGPARSE_OR_RETURN(uc, "si", &filename, &iterations); 
+
+    if( (fp = fopen(filename, "rb")) == NULL) {
+        return ucli_error(uc, "could not open %s", filename); 
+    }
+
+    if(fread(hdr, sizeof(hdr), 1, fp) != 1) {
+        fclose(fp); 
+        return ucli_error(uc, "%s: truncated pcap header", filename); 
+    }
+    /* Microsecond or nanosecond timestamps, either byte order */
+    if(hdr[0] == 0xa1b2c3d4 || hdr[0] == 0xa1b23c4d) {
+        swap = 0; 
+    }
+    else if(hdr[0] == 0xd4c3b2a1 || hdr[0] == 0x4d3cb2a1) {
+        swap = 1; 
+    }
+    else {
+        fclose(fp); 
+        return ucli_error(uc, "%s: not a pcap file", filename); 
+    }
+    if( (swap ? __builtin_bswap32(hdr[5]) : hdr[5]) != 1) {
+        fclose(fp); 
+        return ucli_error(uc, "%s: not an ethernet trace", filename); 
+    }
+
+    while(fread(rec, sizeof(rec), 1, fp) == 1) {
+        uint32_t size = swap ? __builtin_bswap32(rec[2]) : rec[2]; 
+        uint8_t* data; 
+
+        if(size > 0x40000) {
+            break; 
+        }
+        data = aim_zmalloc(size ? size : 1); 
+        if(fread(data, 1, size, fp) != size) {
+            aim_free(data); 
+            break; 
+        }
+        if(count == max) {
+            ppe_packet_t* grown; 
+            max = (max) ? max*2 : 1024; 
+            grown = aim_zmalloc(sizeof(*packets)*max); 
+            if(packets) {
+                PPE_MEMCPY(grown, packets, sizeof(*packets)*count); 
+                aim_free(packets); 
+            }
+            packets = grown; 
+        }
+        ppe_packet_init(packets+count, data, size); 
+        count++; 
+    }
+    fclose(fp); 
+
+    if(count == 0) {
+        return ucli_error(uc, "%s: no packets", filename); 
+    }
+
+    /* Runts are not parseable, and are excluded from the batch */
+    for(i = 0; i < count; i++) {
+        if(packets[i].size < 14) {
+            aim_free(packets[i].data); 
+            packets[i--] = packets[--count]; 
+        }
+    }
+
+    ucli_printf(uc, "%s: %d packets\n", filename, count); 
+    rv = ppe_utm_parse_rate__(uc, packets, count, iterations); 
+
+    for(i = 0; i < count; i++) {
+        aim_free(packets[i].data); 
+    }
+    aim_free(packets); 
+    return rv; 
+}
+
 /* <auto.ucli.handlers.start> */
 /******************************************************************************
  *
@@ -658,6 +1015,7 @@ static ucli_command_handler_f ppe_ucli_utm_handlers__[] =
     ppe_ucli_utm__format__,
     ppe_ucli_utm__fdump__,
     ppe_ucli_utm__set__,
+    ppe_ucli_utm__rewrite__,
     ppe_ucli_utm__get__,
     ppe_ucli_utm__dump__,
     ppe_ucli_utm__data__,
@@ -667,6 +1025,9 @@ static ucli_command_handler_f ppe_ucli_utm_handlers__[] =
     ppe_ucli_utm__listf__,
     ppe_ucli_utm__dfk__,
     ppe_ucli_utm__rwall__,
+    ppe_ucli_utm__parse_rate__,
+    ppe_ucli_utm__parse_pcap__,
+    ppe_ucli_utm__dfk_rate__,
     NULL
 };
 /******************************************************************************/
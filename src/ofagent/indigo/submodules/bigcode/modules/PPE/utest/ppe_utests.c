@@ -282,6 +282,42 @@ ucli_block_t ppe_utests[] =
       "check UDP_CHECKSUM == 0xb129", 
     },
   },
+  {
+    "udp-checksum-odd", 
+    {
+      "data 00def01234560023456789ab08004500001d000100004011f97bc0a80001c0a8000210e100500009c856a5", 
+      "set UDP_CHECKSUM 0x1111", 
+      "update", 
+      "check UDP_CHECKSUM == 0xc856", 
+    },
+  },
+  {
+    "rewrite-tcp", 
+    {
+      "data FF.FF.FF.FF.FF.FF.00.00.00.00.00.01.08.00.45.00.00.28.00.01.00.00.40.06.7C.CD.7F.00.00.01.7F.00.00.01.00.14.00.50.00.00.00.00.00.00.00.00.50.02.20.00.91.7C.00.00", 
+      "rewrite IP4_TTL 0x3f", 
+      "rewrite IP4_SRC_ADDR 0x0a000001", 
+      "rewrite TCP_DST_PORT 0x1f90", 
+      "check IP4_CHECKSUM == 0xf2cd", 
+      "check TCP_CHECKSUM == 0xe73c", 
+      "update", 
+      "check IP4_CHECKSUM == 0xf2cd", 
+      "check TCP_CHECKSUM == 0xe73c", 
+    },
+  },
+  {
+    "rewrite-udp", 
+    {
+      "data 00def01234560023456789ab080045000056000100004011f942c0a80001c0a8000210e100500042b12944444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444444", 
+      "rewrite IP4_DST_ADDR 0xc0a80063", 
+      "rewrite UDP_SRC_PORT 0x1234", 
+      "check IP4_CHECKSUM == 0xf8e1", 
+      "check UDP_CHECKSUM == 0xaf75", 
+      "update", 
+      "check IP4_CHECKSUM == 0xf8e1", 
+      "check UDP_CHECKSUM == 0xaf75", 
+    },
+  },
   {
     "llc", 
     {
@@ -375,6 +411,38 @@ ucli_block_t ppe_utests[] =
       "check TCP_SRC_PORT == 0xDEAD", 
     },
   },
+  {
+    "IP6_UDP", 
+    {
+      "data {000000000001}{000000000002}{86DD}{60000000}{0008}{11}{40}{FE800000000000000000000000000001}{FE800000000000000000000000000002}{1234}{5678}{0008}{0000}", 
+      "check IP6_NEXT_HEADER == 0x11", 
+      "check UDP_SRC_PORT == 0x1234", 
+      "check L4_DST_PORT == 0x5678", 
+      "missing TCP_SRC_PORT", 
+      "missing IP4_VERSION", 
+    },
+  },
+  {
+    "IP4_BAD_IHL", 
+    {
+      "data {000000000001}{000000000002}{0800}{44112233}{44556677}{8806AABB}{CCDDEEFF}{10160101}{DEAD}{BEEF}", 
+      "check IP4_VERSION == 4", 
+      "missing TCP_SRC_PORT", 
+      "missing L4_SRC_PORT", 
+    },
+  },
+  {
+    "parse-rate-1000", 
+    {
+      "parse-rate 1000 100", 
+    },
+  },
+  {
+    "dfk-rate-1000", 
+    {
+      "dfk-rate 1000 100", 
+    },
+  },
   { (void*)0 }
 };
 int ppe_utests_count = sizeof(ppe_utests)/sizeof(ppe_utests[0]); 
@@ -92,6 +92,14 @@ int vpi_ref(vpi_t vpi);
  */
 int vpi_unref(vpi_t vpi); 
 
+/** A packet passed to vpi_send_batch() or returned by vpi_recv_batch(). */
+typedef struct vpi_frame_s {
+    /** Packet data. */
+    uint8_t* data; 
+    /** Packet size. */
+    uint32_t size; 
+} vpi_frame_t; 
+
 /**
  * @brief Send a packet on a VPI 
  * @param vpi The VPI object. 
@@ -100,6 +108,19 @@ int vpi_unref(vpi_t vpi);
  */
 int vpi_send(vpi_t vpi, uint8_t* data, uint32_t size); 
 
+/**
+ * @brief Send a batch of packets on a VPI. 
+ * @param vpi The VPI object. 
+ * @param frames The packets. 
+ * @param count The number of packets. 
+ *
+ * @note Interfaces without native batch support send the packets
+ * @note one at a time. 
+ *
+ * @returns The number of packets sent, or < 0 if none could be sent. 
+ */
+int vpi_send_batch(vpi_t vpi, vpi_frame_t* frames, int count); 
+
 
 /**************************************************************************//**
  *
@@ -125,6 +146,30 @@ int vpi_send(vpi_t vpi, uint8_t* data, uint32_t size);
 int vpi_recv(vpi_t vpi, uint8_t* data, uint32_t size, int block); 
 
 
+/**
+ * @brief Recv a batch of packets on a VPI without copying them. 
+ * @param vpi The VPI object. 
+ * @param frames Receives the packets. 
+ * @param count The maximum number of packets to return. 
+ * @param block Whether to block until at least one packet is received. 
+ *
+ * @note The frames point into memory owned by the VPI (e.g. the
+ * @note PACKET_MMAP ring of a veth interface) and remain valid until
+ * @note vpi_recv_release() or the next vpi_recv_batch() on this VPI. 
+ * @note Interfaces without native batch support return at most one
+ * @note packet per call. 
+ *
+ * @returns The number of frames received. 
+ */
+int vpi_recv_batch(vpi_t vpi, vpi_frame_t* frames, int count, int block); 
+
+/**
+ * @brief Release the frames returned by the last vpi_recv_batch(). 
+ * @param vpi The VPI object. 
+ */
+void vpi_recv_release(vpi_t vpi); 
+
+
 /**
  * @brief Drain any packets currently queued on the VPI. 
  * @param vpi The VPI object. 
@@ -434,6 +479,31 @@ int vpi_sendrecv_listeners_drop(vpi_t vpi);
  */
 void vpi_show(vpi_t vpi, aim_pvs_t* pvs); 
 
+#if VPI_CONFIG_INCLUDE_INTERFACE_QUEUE == 1
+
+/** Counters for a queue interface packet queue. */
+typedef struct vpi_queue_stats_s {
+    /** Packets queued. */
+    uint64_t enqueued; 
+    /** Packets received from the queue. */
+    uint64_t dequeued; 
+    /** Packets dropped because the queue was full. */
+    uint64_t drops; 
+    /** Packets currently queued. */
+    uint32_t depth; 
+    /** Largest depth seen. */
+    uint32_t depth_max; 
+} vpi_queue_stats_t; 
+
+/**
+ * @brief Get the counters of a queue interface packet queue. 
+ * @param name The queue name, as given in 'queue|SEND|RECV' specs. 
+ * @param stats Receives the counters. 
+ */
+int vpi_queue_stats_get(const char* name, vpi_queue_stats_t* stats); 
+
+#endif
+
 #if VPI_CONFIG_INCLUDE_BRIDGING == 1
 
 /** Handle to a VPI bridge instance. */
@@ -464,6 +534,37 @@ int vpi_bridge_stop(vpi_bridge_t br);
  */
 int vpi_bridge_destroy(vpi_bridge_t br); 
 
+/** Forwarding counters for one direction of a bridge. */
+typedef struct vpi_bridge_direction_stats_s {
+    /** Packets forwarded. */
+    uint64_t packets; 
+    /** Bytes forwarded. */
+    uint64_t bytes; 
+    /** Receive or send failures. */
+    uint64_t errors; 
+    /** Times the receiving descriptor was reported ready. */
+    uint64_t wakeups; 
+    /** Wakeups or polls that forwarded at least one packet. */
+    uint64_t batches; 
+    /** Sum over packets of the time from wakeup to send completion. */
+    uint64_t latency_ns_total; 
+    /** Largest time from wakeup to send completion. */
+    uint64_t latency_ns_max; 
+} vpi_bridge_direction_stats_t; 
+
+/** Bridge counters. */
+typedef struct vpi_bridge_stats_s {
+    vpi_bridge_direction_stats_t v1_to_v2; 
+    vpi_bridge_direction_stats_t v2_to_v1; 
+} vpi_bridge_stats_t; 
+
+/**
+ * @brief Get the forwarding counters of a bridge. 
+ * @param br The bridge. 
+ * @param stats Receives the counters. 
+ */
+int vpi_bridge_stats_get(vpi_bridge_t br, vpi_bridge_stats_t* stats); 
+
 #endif
 
 #endif /* __VPI_H__ */
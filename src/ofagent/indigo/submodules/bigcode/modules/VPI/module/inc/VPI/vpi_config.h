@@ -178,6 +178,66 @@
 #define VPI_CONFIG_INCLUDE_INTERFACE_QUEUE VPI_CONFIG_INCLUDE_INTERFACE_DEFAULT
 #endif
 
+/**
+ * VPI_CONFIG_VETH_RING_BLOCK_SIZE
+ *
+ * Size of each PACKET_MMAP ring block for veth interfaces in ring mode. Must be a multiple of the page size. */
+
+
+#ifndef VPI_CONFIG_VETH_RING_BLOCK_SIZE
+#define VPI_CONFIG_VETH_RING_BLOCK_SIZE (1 << 18)
+#endif
+
+/**
+ * VPI_CONFIG_VETH_RING_BLOCK_COUNT
+ *
+ * Number of blocks in each of the veth RX and TX rings. */
+
+
+#ifndef VPI_CONFIG_VETH_RING_BLOCK_COUNT
+#define VPI_CONFIG_VETH_RING_BLOCK_COUNT 16
+#endif
+
+/**
+ * VPI_CONFIG_VETH_RING_FRAME_SIZE
+ *
+ * Size of each veth TX ring frame. Larger packets are sent with sendto(). */
+
+
+#ifndef VPI_CONFIG_VETH_RING_FRAME_SIZE
+#define VPI_CONFIG_VETH_RING_FRAME_SIZE 2048
+#endif
+
+/**
+ * VPI_CONFIG_VETH_RING_RETIRE_MS
+ *
+ * Timeout before the kernel hands a partially filled veth RX block to userspace. */
+
+
+#ifndef VPI_CONFIG_VETH_RING_RETIRE_MS
+#define VPI_CONFIG_VETH_RING_RETIRE_MS 1
+#endif
+
+/**
+ * VPI_CONFIG_QUEUE_DEPTH
+ *
+ * Packets held by each queue interface packet queue. Must be a power of two. */
+
+
+#ifndef VPI_CONFIG_QUEUE_DEPTH
+#define VPI_CONFIG_QUEUE_DEPTH 256
+#endif
+
+/**
+ * VPI_CONFIG_QUEUE_SLOT_SIZE
+ *
+ * Preallocated size of each queue slot. Slots grow to fit larger packets. */
+
+
+#ifndef VPI_CONFIG_QUEUE_SLOT_SIZE
+#define VPI_CONFIG_QUEUE_SLOT_SIZE 2048
+#endif
+
 /**
  * VPI_CONFIG_INCLUDE_BRIDGING
  *
@@ -188,6 +248,26 @@
 #define VPI_CONFIG_INCLUDE_BRIDGING 1
 #endif
 
+/**
+ * VPI_CONFIG_BRIDGE_BATCH
+ *
+ * Maximum packets a bridge forwards from one side per wakeup. */
+
+
+#ifndef VPI_CONFIG_BRIDGE_BATCH
+#define VPI_CONFIG_BRIDGE_BATCH 32
+#endif
+
+/**
+ * VPI_CONFIG_BRIDGE_POLL_MS
+ *
+ * Poll interval for bridged VPIs without a descriptor. */
+
+
+#ifndef VPI_CONFIG_BRIDGE_POLL_MS
+#define VPI_CONFIG_BRIDGE_POLL_MS 1
+#endif
+
 /**
  * VPI_CONFIG_PORTING_STDLIB
  *
@@ -228,6 +308,16 @@
 #define VPI_CONFIG_MAX_PACKET 10000
 #endif
 
+/**
+ * VPI_CONFIG_BATCH_MAX
+ *
+ * Maximum packets passed to an interface in one send_batch or recv_batch call. */
+
+
+#ifndef VPI_CONFIG_BATCH_MAX
+#define VPI_CONFIG_BATCH_MAX 32
+#endif
+
 /**
  * VPI_CONFIG_CREATE_SPEC_MAX
  *
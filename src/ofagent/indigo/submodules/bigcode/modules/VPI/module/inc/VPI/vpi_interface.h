@@ -74,6 +74,16 @@ struct vpi_interface_s {
      * Send a packet on this interface. 
      */
     int (*send)(vpi_interface_t* vi, unsigned char* data, int len); 
+
+    /**
+     * Send up to 'count' packets [Optional]. 
+     * Each packet is sent as headers[i] (if headers is not NULL)
+     * followed by frames[i]. headers is only passed to interfaces
+     * with VPI_INTERFACE_FLAG_PROTOCOL set. 
+     * Returns the number of packets sent. 
+     */
+    int (*send_batch)(vpi_interface_t* vi, vpi_frame_t* headers, 
+                      vpi_frame_t* frames, int count); 
     
     /**
      * Recv a packet on this interface (blocking)
@@ -85,6 +95,18 @@ struct vpi_interface_s {
      */
     int (*recv_ready)(vpi_interface_t* vi); 
 
+    /**
+     * Recv up to 'count' packets without copying [Optional]. 
+     * 'count' is at most VPI_CONFIG_BATCH_MAX. 
+     * Blocks until at least one packet is available. The frames
+     * reference interface memory and stay valid until the next
+     * recv_batch() or recv_release(). 
+     */
+    int (*recv_batch)(vpi_interface_t* vi, vpi_frame_t* frames, int count); 
+
+    /** Release the frames returned by recv_batch() [Optional] */
+    void (*recv_release)(vpi_interface_t* vi); 
+
 
     /**
      * Returns the descriptor for this channel, if applicable. 
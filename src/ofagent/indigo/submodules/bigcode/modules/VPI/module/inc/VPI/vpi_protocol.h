@@ -81,6 +81,17 @@ vpi_protocol_msg_create(vpi_header_t* hdr, uint8_t* data, int size);
 void
 vpi_packet_free(vpi_packet_t* p); 
 
+/**
+ * @brief Build the header of a PACKET message in place. 
+ * @param wire Receives the header, in network byte order. 
+ * @param data_size The size of the packet data that follows it. 
+ *
+ * @note This lets senders put the header and the packet data in
+ * @note separate buffers instead of calling vpi_protocol_msg_create(). 
+ */
+void
+vpi_protocol_packet_hdr_build(vpi_header_t* wire, int data_size); 
+
 /**
  * @brief Parse an incoming byte stream as a VPI protocol message. 
  * @param msg The message stream. 
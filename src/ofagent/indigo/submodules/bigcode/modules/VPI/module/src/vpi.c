@@ -540,6 +540,52 @@ vpi_send_list__(biglist_locked_t* ll, uint8_t* data, uint32_t len, int flag)
  *
  *
  *****************************************************************************/
+/*
+ * Send a PACKET protocol message without allocating it. 
+ */
+static int
+vpi_send_protocol__(vpi_t vpi, uint8_t* data, uint32_t len)
+{
+    vpi_header_t wire; 
+
+    if(vpi->interface->send_batch) {
+        /* Header and data go out as one message from separate buffers */
+        vpi_frame_t header; 
+        vpi_frame_t frame; 
+        int rv; 
+
+        vpi_protocol_packet_hdr_build(&wire, len); 
+        header.data = (uint8_t*)&wire; 
+        header.size = sizeof(wire); 
+        frame.data = data; 
+        frame.size = len; 
+        rv = vpi->interface->send_batch(vpi->interface, &header, &frame, 1); 
+        return (rv == 1) ? (int)(sizeof(wire) + len) : -1; 
+    }
+
+    if(len <= VPI_CONFIG_MAX_PACKET) {
+        uint8_t msg[sizeof(vpi_header_t) + VPI_CONFIG_MAX_PACKET]; 
+
+        vpi_protocol_packet_hdr_build((vpi_header_t*)msg, len); 
+        VPI_MEMCPY(msg + sizeof(vpi_header_t), data, len); 
+        return vpi->interface->send(vpi->interface, msg, 
+                                    sizeof(vpi_header_t) + len); 
+    }
+    else {
+        vpi_packet_t* p; 
+        int rv; 
+
+        VPI_MEMSET(&wire, 0, sizeof(wire)); 
+        wire.opcode = VPI_PROTOCOL_OPCODE_PACKET; 
+        if((p = vpi_protocol_msg_create(&wire, data, len)) == NULL) {
+            return -1; 
+        }
+        rv = vpi->interface->send(vpi->interface, p->data, p->size); 
+        vpi_packet_free(p); 
+        return rv; 
+    }
+}
+
 int 
 vpi_send(vpi_t vpi, uint8_t* data, uint32_t len)
 {
@@ -556,24 +602,13 @@ vpi_send(vpi_t vpi, uint8_t* data, uint32_t len)
 
             if(vpi->interface->flags & VPI_INTERFACE_FLAG_PROTOCOL) {
 
-                vpi_packet_t* p = NULL; 
-                vpi_header_t hdr; 
-                
                 VPI_INFO(vpi, "Protocol Send."); 
 
                 /*
                  * This VPI interface implementation supports
                  * the VPI protocol. 
                  */
-
-                VPI_MEMSET(&hdr, 0, sizeof(hdr)); 
-                hdr.opcode = VPI_PROTOCOL_OPCODE_PACKET; 
-                hdr.payload_size = len; 
-                hdr.sequence_number = 0; 
-                
-                p = vpi_protocol_msg_create(&hdr, data, len); 
-                rv = vpi->interface->send(vpi->interface, p->data, p->size); 
-                vpi_packet_free(p); 
+                rv = vpi_send_protocol__(vpi, data, len); 
             }
             else {
                 
@@ -605,6 +640,81 @@ vpi_send(vpi_t vpi, uint8_t* data, uint32_t len)
     }
 }
 
+/**************************************************************************//**
+ *
+ * Send a batch of packets on a VPI 
+ *
+ *
+ *****************************************************************************/
+static int
+vpi_send_batch__(vpi_t vpi, vpi_frame_t* frames, int count)
+{
+    vpi_header_t wire[VPI_CONFIG_BATCH_MAX]; 
+    vpi_frame_t headers[VPI_CONFIG_BATCH_MAX]; 
+    vpi_frame_t* hp = NULL; 
+    int sent = 0; 
+    int i, n, rv; 
+
+    while(sent < count) {
+        n = count - sent; 
+        if(n > VPI_CONFIG_BATCH_MAX) {
+            n = VPI_CONFIG_BATCH_MAX; 
+        }
+
+        if(vpi->interface->flags & VPI_INTERFACE_FLAG_PROTOCOL) {
+            /* Headers live in their own buffers, ahead of each frame */
+            for(i = 0; i < n; i++) {
+                vpi_protocol_packet_hdr_build(&wire[i], frames[sent+i].size); 
+                headers[i].data = (uint8_t*)&wire[i]; 
+                headers[i].size = sizeof(wire[i]); 
+            }
+            hp = headers; 
+        }
+
+        rv = vpi->interface->send_batch(vpi->interface, hp, 
+                                        frames + sent, n); 
+        if(rv <= 0) {
+            break; 
+        }
+        sent += rv; 
+        if(rv < n) {
+            break; 
+        }
+    }
+    return sent; 
+}
+
+int
+vpi_send_batch(vpi_t vpi, vpi_frame_t* frames, int count)
+{
+    int sent = 0; 
+    int i; 
+
+    if(vpi == NULL || frames == NULL || count < 0) {
+        return -1; 
+    }
+
+    if(vpi->interface->send_batch == NULL || 
+       AIM_LOG_CUSTOM_ENABLED(VPI_LOG_FLAG_SEND) || 
+       vpi->send_listeners->list || vpi->sendrecv_listeners->list) {
+        /*
+         * No native batch support, or every packet needs
+         * per-packet processing anyway. 
+         */
+        for(i = 0; i < count; i++) {
+            if(vpi_send(vpi, frames[i].data, frames[i].size) < 0) {
+                break; 
+            }
+            sent++; 
+        }
+    }
+    else {
+        sent = vpi_send_batch__(vpi, frames, count); 
+    }
+
+    return (sent == 0 && count > 0) ? -1 : sent; 
+}
+
 /**************************************************************************//**
  *
  * Send an ioctl message on interfaces that support it. 
@@ -838,6 +948,118 @@ vpi_recv(vpi_t vpi, uint8_t* data, uint32_t len, int block)
     }
 }
 
+/**************************************************************************//**
+ *
+ * Receive a batch of packets on a VPI without copying. 
+ *
+ *
+ *****************************************************************************/
+static int
+vpi_recv_batch_single__(vpi_t vpi, vpi_frame_t* frames, int block)
+{
+    int rv; 
+
+    /*
+     * The interface can only copy packets out one at a time. 
+     * Receive into our own buffer so the caller still gets a frame. 
+     */
+    if(vpi->batch_buffer == NULL) {
+        vpi->batch_buffer = aim_zmalloc(VPI_CONFIG_MAX_PACKET); 
+        if(vpi->batch_buffer == NULL) {
+            VPI_ERROR(vpi, "batch buffer allocation failed."); 
+            return -1; 
+        }
+    }
+
+    rv = vpi_recv(vpi, vpi->batch_buffer, VPI_CONFIG_MAX_PACKET, block); 
+    if(rv <= 0) {
+        return rv; 
+    }
+    frames[0].data = vpi->batch_buffer; 
+    frames[0].size = rv; 
+    return 1; 
+}
+
+int
+vpi_recv_batch(vpi_t vpi, vpi_frame_t* frames, int count, int block)
+{
+    int rv; 
+    int i, n; 
+
+    if(vpi == NULL || frames == NULL || count <= 0) {
+        return -1; 
+    }
+
+    if(vpi->interface->recv_batch == NULL) {
+        return vpi_recv_batch_single__(vpi, frames, block); 
+    }
+
+    if(block == 0 && vpi->interface->recv_ready(vpi->interface) == 0) {
+        /* No data, don't block */
+        return 0; 
+    }
+
+    if(count > VPI_CONFIG_BATCH_MAX) {
+        count = VPI_CONFIG_BATCH_MAX; 
+    }
+    rv = vpi->interface->recv_batch(vpi->interface, frames, count); 
+    if(rv <= 0) {
+        return rv; 
+    }
+
+    if(vpi->interface->flags & VPI_INTERFACE_FLAG_PROTOCOL) {
+        /*
+         * Strip the protocol header in place. Control messages are
+         * handled here and removed from the batch. 
+         */
+        for(i = 0, n = 0; i < rv; i++) {
+            vpi_packet_t packet; 
+            vpi_header_t hdr; 
+
+            if(vpi_protocol_msg_parse(frames[i].data, frames[i].size, 
+                                      &hdr, &packet) < 0) {
+                VPI_ERROR(vpi, "Protocol packet error."); 
+                continue; 
+            }
+            if(hdr.opcode == VPI_PROTOCOL_OPCODE_PACKET) {
+                frames[n].data = packet.data; 
+                frames[n].size = packet.size; 
+                n++; 
+            }
+            else {
+                vpi_handle_ioctl__(vpi, &hdr, &packet); 
+            }
+        }
+        rv = n; 
+    }
+
+    for(i = 0; i < rv; i++) {
+        if(vpi->recv_listeners->list) {
+            vpi_send_list__(vpi->recv_listeners, frames[i].data, 
+                            frames[i].size, VPI_INTERFACE_FLAG_RECV_LISTENING); 
+        }
+        if(vpi->sendrecv_listeners->list) {
+            vpi_send_list__(vpi->sendrecv_listeners, frames[i].data, 
+                            frames[i].size, VPI_INTERFACE_FLAG_RECV_LISTENING); 
+        }
+        if(AIM_LOG_CUSTOM_ENABLED(VPI_LOG_FLAG_RECV)) { 
+            char* s = aim_bytes_to_string(frames[i].data, frames[i].size, 0); 
+            VPI_LOG_RECV(vpi, "%s", s); 
+            AIM_FREE(s); 
+        }
+    }
+
+    return rv; 
+}
+
+void
+vpi_recv_release(vpi_t vpi)
+{
+    if(vpi && vpi->interface->recv_release) {
+        vpi->interface->recv_release(vpi->interface); 
+    }
+}
+
 int
 vpi_drain(vpi_t vpi)
 {
@@ -916,6 +1138,7 @@ vpi_destroy__(vpi_t vpi)
                                 (biglist_free_f)vpi_destroy__); 
         biglist_locked_free_all(vpi->sendrecv_listeners, 
                                 (biglist_free_f)vpi_destroy__); 
+        aim_free(vpi->batch_buffer); 
         aim_free(vpi); 
     }
     return 0; 
@@ -29,57 +29,267 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/*
+ * All bridges are serviced by a single engine thread waiting in
+ * epoll_wait() on the descriptors of every bridged VPI.
+ *
+ * Each bridge has two ends, one per direction. An end whose VPI has a
+ * descriptor is registered with epoll and drained (up to
+ * VPI_CONFIG_BRIDGE_BATCH packets) when it becomes readable. Ends
+ * without a descriptor (queue, loopback) are polled each time the
+ * engine wakes up, and while any exist epoll_wait() times out after
+ * VPI_CONFIG_BRIDGE_POLL_MS.
+ *
+ * The engine lock is held while packets are forwarded, so once
+ * vpi_bridge_stop() returns the engine no longer references the bridge.
+ * Starting and stopping bridges is further serialized by the control
+ * lock, which the engine thread never takes, so the thread can be
+ * joined without racing a concurrent start.
+ */
+
+typedef struct vpi_bridge_end_s {
+    struct vpi_bridge_s* bridge;
+    vpi_t from;
+    vpi_t to;
+    int fd;
+    vpi_bridge_direction_stats_t* stats;
+} vpi_bridge_end_t;
 
 struct vpi_bridge_s {
     
     vpi_t v1; 
     vpi_t v2; 
-    
-    pthread_t thread; 
-    volatile int running; 
-    volatile int terminate; 
+
+    vpi_bridge_end_t ends[2];
+    vpi_bridge_stats_t stats;
+
+    /* Linked on the engine's active list while running */
+    struct vpi_bridge_s* next;
+    int running; 
 };
 
-static int
-bridge_interface__(vpi_t from, vpi_t to, unsigned char* pkt, int size)
+static struct {
+    pthread_mutex_t ctl_lock;
+    pthread_mutex_t lock;
+    pthread_t thread;
+    int thread_running;
+    int terminate;
+    int epfd;
+    int wakefd;
+
+    /* Bumped whenever an end is removed so stale epoll events are dropped */
+    uint64_t generation;
+
+    struct vpi_bridge_s* bridges;
+    int polled_ends;
+} engine__ = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, 0, 0, 0, -1, -1, 0, NULL, 0 };
+
+static uint64_t
+now_ns__(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+engine_wake__(void)
 {
-    int rv = 0;
-    size = vpi_recv(from, pkt, size, 0); 
-    if(size > 0) {
-        VPI_MINFO("Recv packet from '%s' sending to '%s' (%d bytes)", 
-                 vpi_name_get(from), vpi_name_get(to), size); 
-        if((rv = vpi_send(to, pkt, size)) < 0) {
-            VPI_MERROR("Send failed %d", rv); 
-            return rv; 
+    uint64_t x = 1;
+    if(write(engine__.wakefd, &x, sizeof(x)) < 0) {
+        /* Already signalled */
+    }
+}
+
+/*
+ * Forward up to VPI_CONFIG_BRIDGE_BATCH packets from one end.
+ * Latency is measured from the wakeup to the completion of each send.
+ */
+static void
+bridge_end_forward__(vpi_bridge_end_t* end, uint64_t wake_ns)
+{
+    vpi_bridge_direction_stats_t* stats = end->stats;
+    vpi_frame_t frames[VPI_CONFIG_BRIDGE_BATCH];
+    int count = 0;
+    int n, i, sent;
+
+    /*
+     * Frames are sent straight from the receiving VPI's buffers
+     * (e.g. a veth RX ring) as one batch, and released afterwards.
+     */
+    while(count < VPI_CONFIG_BRIDGE_BATCH) {
+        n = vpi_recv_batch(end->from, frames, 
+                           VPI_CONFIG_BRIDGE_BATCH - count, 0);
+        if(n <= 0) {
+            if(n < 0) {
+                stats->errors++;
+            }
+            break;
+        }
+        VPI_MINFO("Recv %d packets from '%s' sending to '%s'", n, 
+                  vpi_name_get(end->from), vpi_name_get(end->to)); 
+        sent = vpi_send_batch(end->to, frames, n);
+        if(sent < n) {
+            VPI_MERROR("Send failed"); 
+            stats->errors += n - ((sent > 0) ? sent : 0);
         }
+        for(i = 0; i < sent; i++) {
+            stats->bytes += frames[i].size;
+        }
+        vpi_recv_release(end->from);
+
+        if(sent > 0) {
+            uint64_t latency = now_ns__() - wake_ns;
+            stats->packets += sent;
+            stats->latency_ns_total += latency * sent;
+            if(latency > stats->latency_ns_max) {
+                stats->latency_ns_max = latency;
+            }
+        }
+        count += n;
+    }
+
+    if(count > 0) {
+        stats->batches++;
     }
-    return rv; 
 }
 
 static void* 
-bridge_thread__(void* data)
+bridge_engine_thread__(void* data)
 {
-    vpi_bridge_t bridge = (vpi_bridge_t)(data); 
-    unsigned char* pkt = aim_zmalloc(VPI_CONFIG_MAX_PACKET); 
-    
-    if(pkt == NULL) {
-        VPI_MERROR("packet allocation for bridge failed."); 
-        bridge->running = 0; 
-        return NULL; 
-    }
+    struct epoll_event events[VPI_CONFIG_BRIDGE_BATCH];
+    int n, i;
+
+    AIM_REFERENCE(data);
+
+    for(;;) {
+        uint64_t generation;
+        uint64_t wake_ns;
+        int timeout;
+        struct vpi_bridge_s* b;
+
+        pthread_mutex_lock(&engine__.lock);
+        if(engine__.terminate) {
+            pthread_mutex_unlock(&engine__.lock);
+            break;
+        }
+        generation = engine__.generation;
+        timeout = engine__.polled_ends ? VPI_CONFIG_BRIDGE_POLL_MS : -1;
+        pthread_mutex_unlock(&engine__.lock);
+
+        n = epoll_wait(engine__.epfd, events, AIM_ARRAYSIZE(events), timeout);
+        if(n < 0 && errno != EINTR) {
+            VPI_MERROR("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+        wake_ns = now_ns__();
+
+        pthread_mutex_lock(&engine__.lock);
+
+        for(i = 0; i < n; i++) {
+            vpi_bridge_end_t* end = events[i].data.ptr;
+            if(end == NULL) {
+                uint64_t x;
+                if(read(engine__.wakefd, &x, sizeof(x)) < 0) {
+                    /* Nothing pending */
+                }
+                continue;
+            }
+            if(generation != engine__.generation) {
+                /* An end was removed while waiting; this one may be gone */
+                continue;
+            }
+            end->stats->wakeups++;
+            bridge_end_forward__(end, wake_ns);
+        }
 
-    bridge->running = 1; 
-    while(!bridge->terminate) {
-        bridge_interface__(bridge->v1, bridge->v2, pkt, VPI_CONFIG_MAX_PACKET); 
-        bridge_interface__(bridge->v2, bridge->v1, pkt, VPI_CONFIG_MAX_PACKET); 
-        AIM_USLEEP(1); 
+        for(b = engine__.bridges; b; b = b->next) {
+            int e;
+            for(e = 0; e < 2; e++) {
+                if(b->ends[e].fd <= 0) {
+                    bridge_end_forward__(&b->ends[e], wake_ns);
+                }
+            }
+        }
+
+        pthread_mutex_unlock(&engine__.lock);
     }
-    bridge->running = 0; 
-    aim_free(pkt); 
+
     return NULL; 
 }
 
+/* Called with the engine lock held */
+static int
+engine_start__(void)
+{
+    struct epoll_event ev;
+
+    if(engine__.thread_running) {
+        return 0;
+    }
+
+    if((engine__.epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        VPI_MERROR("epoll_create1 failed: %s", strerror(errno));
+        return -1;
+    }
+    if((engine__.wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+        VPI_MERROR("eventfd failed: %s", strerror(errno));
+        close(engine__.epfd);
+        return -1;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(engine__.epfd, EPOLL_CTL_ADD, engine__.wakefd, &ev);
+
+    engine__.terminate = 0;
+    if(pthread_create(&engine__.thread, NULL, bridge_engine_thread__, 
+                      NULL) != 0) {
+        VPI_MERROR("bridge thread creation failed.");    
+        close(engine__.wakefd);
+        close(engine__.epfd);
+        return -1; 
+    }
+    engine__.thread_running = 1;
+    return 0;
+}
+
+/*
+ * Called with the control lock but not the engine lock held; stops the
+ * thread if no bridge is left
+ */
+static void
+engine_stop_if_idle__(void)
+{
+    pthread_t thread;
+
+    pthread_mutex_lock(&engine__.lock);
+    if(!engine__.thread_running || engine__.bridges != NULL) {
+        pthread_mutex_unlock(&engine__.lock);
+        return;
+    }
+    engine__.terminate = 1;
+    engine__.thread_running = 0;
+    thread = engine__.thread;
+    engine_wake__();
+    pthread_mutex_unlock(&engine__.lock);
+
+    VPI_MTRACE("joining bridge thread..."); 
+    pthread_join(thread, NULL);
+    VPI_MTRACE("bridge thread has terminated."); 
+
+    close(engine__.wakefd);
+    close(engine__.epfd);
+    engine__.wakefd = -1;
+    engine__.epfd = -1;
+}
+
 vpi_bridge_t 
 vpi_bridge_create(vpi_t v1, vpi_t v2)
 {
@@ -95,11 +305,19 @@ vpi_bridge_create(vpi_t v1, vpi_t v2)
     
     b->v1 = v1; 
     b->v2 = v2;         
-    b->terminate = 0; 
 
-    if(pthread_create(&b->thread, NULL, bridge_thread__, 
-                      b) < 0) {
-        VPI_MERROR("bridge thread creation failed.");    
+    b->ends[0].bridge = b;
+    b->ends[0].from = v1;
+    b->ends[0].to = v2;
+    b->ends[0].stats = &b->stats.v1_to_v2;
+    b->ends[1].bridge = b;
+    b->ends[1].from = v2;
+    b->ends[1].to = v1;
+    b->ends[1].stats = &b->stats.v2_to_v1;
+
+    /* Bridges forward as soon as they are created */
+    if(vpi_bridge_start(b) < 0) {
+        aim_free(b);
         return NULL; 
     }
     return b; 
@@ -108,20 +326,96 @@ vpi_bridge_create(vpi_t v1, vpi_t v2)
 int
 vpi_bridge_start(vpi_bridge_t v)
 {
-    AIM_REFERENCE(v); 
+    int e;
+
+    pthread_mutex_lock(&engine__.ctl_lock);
+    pthread_mutex_lock(&engine__.lock);
+
+    if(v->running) {
+        pthread_mutex_unlock(&engine__.lock);
+        pthread_mutex_unlock(&engine__.ctl_lock);
+        return 0;
+    }
+
+    if(engine_start__() < 0) {
+        pthread_mutex_unlock(&engine__.lock);
+        pthread_mutex_unlock(&engine__.ctl_lock);
+        return -1;
+    }
+
+    for(e = 0; e < 2; e++) {
+        vpi_bridge_end_t* end = &v->ends[e];
+        end->fd = vpi_descriptor_get(end->from);
+        if(end->fd > 0) {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.ptr = end;
+            if(epoll_ctl(engine__.epfd, EPOLL_CTL_ADD, end->fd, &ev) < 0) {
+                /* e.g. the same descriptor is already bridged; poll instead */
+                VPI_MWARN("epoll_ctl(%s) failed: %s, polling instead", 
+                          vpi_name_get(end->from), strerror(errno));
+                end->fd = -1;
+            }
+        }
+        if(end->fd <= 0) {
+            engine__.polled_ends++;
+        }
+    }
+
+    v->next = engine__.bridges;
+    engine__.bridges = v;
+    v->running = 1;
+
+    /* Recompute the epoll_wait timeout */
+    engine_wake__();
+    pthread_mutex_unlock(&engine__.lock);
+    pthread_mutex_unlock(&engine__.ctl_lock);
     return 0; 
 }
+
 int
 vpi_bridge_stop(vpi_bridge_t v)
 {
-    if(v->running) {
-        v->terminate = 1; 
-        VPI_MTRACE("joining bridge thread..."); 
-        pthread_join(v->thread, NULL); 
-        VPI_MTRACE("bridge thread has terminated."); 
+    struct vpi_bridge_s** p;
+    int e;
+
+    pthread_mutex_lock(&engine__.ctl_lock);
+    pthread_mutex_lock(&engine__.lock);
+
+    if(!v->running) {
+        pthread_mutex_unlock(&engine__.lock);
+        pthread_mutex_unlock(&engine__.ctl_lock);
+        return 0;
     }
-    return 0; 
+
+    for(e = 0; e < 2; e++) {
+        vpi_bridge_end_t* end = &v->ends[e];
+        if(end->fd > 0) {
+            epoll_ctl(engine__.epfd, EPOLL_CTL_DEL, end->fd, NULL);
+        }
+        else {
+            engine__.polled_ends--;
+        }
+    }
+    engine__.generation++;
+
+    for(p = &engine__.bridges; *p; p = &(*p)->next) {
+        if(*p == v) {
+            *p = v->next;
+            break;
+        }
+    }
+    v->next = NULL;
+    v->running = 0;
+
+    pthread_mutex_unlock(&engine__.lock);
+
+    engine_stop_if_idle__();
+    pthread_mutex_unlock(&engine__.ctl_lock);
+    return 0;
 }
+
 int
 vpi_bridge_destroy(vpi_bridge_t v)
 {
@@ -129,6 +423,18 @@ vpi_bridge_destroy(vpi_bridge_t v)
     aim_free(v); 
     return 0; 
 }
+
+int
+vpi_bridge_stats_get(vpi_bridge_t v, vpi_bridge_stats_t* stats)
+{
+    if(v == NULL || stats == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&engine__.lock);
+    *stats = v->stats;
+    pthread_mutex_unlock(&engine__.lock);
+    return 0;
+}
     
     
     
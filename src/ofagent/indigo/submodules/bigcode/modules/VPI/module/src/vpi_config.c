@@ -94,11 +94,51 @@ vpi_config_settings_t vpi_config_settings[] =
 #else
 { VPI_CONFIG_INCLUDE_INTERFACE_QUEUE(__vpi_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef VPI_CONFIG_VETH_RING_BLOCK_SIZE
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_VETH_RING_BLOCK_SIZE), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_VETH_RING_BLOCK_SIZE) },
+#else
+{ VPI_CONFIG_VETH_RING_BLOCK_SIZE(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_VETH_RING_BLOCK_COUNT
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_VETH_RING_BLOCK_COUNT), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_VETH_RING_BLOCK_COUNT) },
+#else
+{ VPI_CONFIG_VETH_RING_BLOCK_COUNT(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_VETH_RING_FRAME_SIZE
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_VETH_RING_FRAME_SIZE), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_VETH_RING_FRAME_SIZE) },
+#else
+{ VPI_CONFIG_VETH_RING_FRAME_SIZE(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_VETH_RING_RETIRE_MS
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_VETH_RING_RETIRE_MS), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_VETH_RING_RETIRE_MS) },
+#else
+{ VPI_CONFIG_VETH_RING_RETIRE_MS(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_QUEUE_DEPTH
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_QUEUE_DEPTH), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_QUEUE_DEPTH) },
+#else
+{ VPI_CONFIG_QUEUE_DEPTH(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_QUEUE_SLOT_SIZE
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_QUEUE_SLOT_SIZE), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_QUEUE_SLOT_SIZE) },
+#else
+{ VPI_CONFIG_QUEUE_SLOT_SIZE(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef VPI_CONFIG_INCLUDE_BRIDGING
     { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_INCLUDE_BRIDGING), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_INCLUDE_BRIDGING) },
 #else
 { VPI_CONFIG_INCLUDE_BRIDGING(__vpi_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef VPI_CONFIG_BRIDGE_BATCH
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_BRIDGE_BATCH), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_BRIDGE_BATCH) },
+#else
+{ VPI_CONFIG_BRIDGE_BATCH(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef VPI_CONFIG_BRIDGE_POLL_MS
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_BRIDGE_POLL_MS), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_BRIDGE_POLL_MS) },
+#else
+{ VPI_CONFIG_BRIDGE_POLL_MS(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef VPI_CONFIG_PORTING_STDLIB
     { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_PORTING_STDLIB), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_PORTING_STDLIB) },
 #else
@@ -119,6 +159,11 @@ vpi_config_settings_t vpi_config_settings[] =
 #else
 { VPI_CONFIG_MAX_PACKET(__vpi_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef VPI_CONFIG_BATCH_MAX
+    { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_BATCH_MAX), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_BATCH_MAX) },
+#else
+{ VPI_CONFIG_BATCH_MAX(__vpi_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef VPI_CONFIG_CREATE_SPEC_MAX
     { __vpi_config_STRINGIFY_NAME(VPI_CONFIG_CREATE_SPEC_MAX), __vpi_config_STRINGIFY_VALUE(VPI_CONFIG_CREATE_SPEC_MAX) },
 #else
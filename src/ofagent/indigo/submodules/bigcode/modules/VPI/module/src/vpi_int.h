@@ -54,6 +54,9 @@ struct vpi_s {
 
     int ref_count; 
 
+    /* Receive buffer for vpi_recv_batch() on non-batching interfaces */
+    uint8_t* batch_buffer; 
+
     uint32_t flags; 
 };
 
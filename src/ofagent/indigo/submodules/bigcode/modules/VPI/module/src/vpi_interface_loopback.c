@@ -27,6 +27,7 @@
 #include "vpi_interface_loopback.h"
 
 #include <BigList/biglist.h>
+#include <BigList/biglist_deque.h>
 
 #include <unistd.h>
 #include <semaphore.h>
@@ -97,7 +98,7 @@ typedef struct vpi_interface_loopback_s {
  *****************************************************************************/
     const char* log_string; 
 
-    biglist_t* packet_list; 
+    biglist_deque_t packet_list; 
 
     sem_t lock; 
 
@@ -155,6 +156,7 @@ vpi_loopback_interface_create(vpi_interface_t** vi, char* args[], int flags,
     nvi->interface.destroy = vpi_loopback_interface_destroy; 
 
     sem_init(&nvi->lock, 0, 1); 
+    biglist_deque_init(&nvi->packet_list); 
     
     *vi = (vpi_interface_t*)nvi; 
     return 0; 
@@ -168,7 +170,10 @@ vpi_loopback_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
     if(rv) {
         VPI_INFO(vi, "send: data=%p size=%d", data, len); 
         sem_wait(&vi->lock); 
-        vi->packet_list = biglist_append((biglist_t*)vi->packet_list, rv); 
+        if(biglist_deque_push_tail(&vi->packet_list, rv) == NULL) {
+            loopback_packet__Free(rv); 
+            rv = NULL; 
+        }
         sem_post(&vi->lock); 
     }
     return (rv) ? 0 : -1;
@@ -180,12 +185,11 @@ vpi_loopback_interface_recv(vpi_interface_t* _vi, unsigned char* data, int len)
     vpi_loopback_packet_t* rv; 
 
     VICAST(vi, _vi); 
-    while(vi->packet_list == NULL) { 
+    while(vi->packet_list.head == NULL) { 
         AIM_USLEEP(250000); 
     }
     sem_wait(&vi->lock); 
-    rv = (vpi_loopback_packet_t*)vi->packet_list->data; 
-    vi->packet_list = biglist_remove((biglist_t*)vi->packet_list, rv); 
+    rv = (vpi_loopback_packet_t*)biglist_deque_pop_head(&vi->packet_list); 
     sem_post(&vi->lock); 
 
     if(len > rv->size) {
@@ -201,18 +205,18 @@ int
 vpi_loopback_interface_recv_ready(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
-    return vi->packet_list != NULL; 
+    return vi->packet_list.head != NULL; 
 }
 
 int
 vpi_loopback_interface_destroy(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
-    biglist_t* ble; 
-    for(ble = vi->packet_list; ble; ble = biglist_next(ble)) {
-        loopback_packet__Free((vpi_loopback_packet_t*)ble->data); 
+    vpi_loopback_packet_t* p; 
+    while((p = biglist_deque_pop_head(&vi->packet_list))) {
+        loopback_packet__Free(p); 
     }
-    biglist_free(vi->packet_list); 
+    biglist_deque_denit(&vi->packet_list); 
     aim_free(vi); 
     return 0; 
 }
@@ -26,78 +26,94 @@
 
 #include "vpi_interface_queue.h"
 
-#include <OS/os_sem.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 
 static const char* queue_interface_docstring__ = 
     "----------------------------------------------------\n"
     "VPI Interface: QUEUE \n"
     "----------------------------------------------------\n"
+    "\n"
+    "VPI endpoints connected through in-process packet queues.\n"
+    "\n"
+    "Create format:\n"
+    "    'queue|SENDQUEUE|RECVQUEUE[|spsc]'\n"
+    "\n"
+    "     Example:\n"
+    "     'queue|1|2' and 'queue|2|1'\n"
+    "\n"
+    "     Queues are bounded rings of VPI_CONFIG_QUEUE_DEPTH packets;\n"
+    "     packets sent to a full queue are dropped. Queues allow any\n"
+    "     number of senders and receivers unless created with the\n"
+    "     'spsc' option, which limits them to one of each.\n"
     "\n";
 
+AIM_STATIC_ASSERT(queue_depth, 
+                  (VPI_CONFIG_QUEUE_DEPTH & (VPI_CONFIG_QUEUE_DEPTH - 1)) == 0); 
 
 
 /**************************************************************************//**
  *
- * Packet container management. 
- * These are stored in the packet queues. 
+ * Packet queue management. 
  *
- *****************************************************************************/
-typedef struct vpi_qpacket_s { 
-    char* data; 
-    int size; 
-} vpi_qpacket_t; 
-
-static vpi_qpacket_t*
-qpacket_alloc__(unsigned char* data, int size)
-{
-    vpi_qpacket_t* qp = aim_zmalloc(sizeof(*qp)); 
-    qp->data = aim_memdup(data, size); 
-    qp->size = size; 
-    return qp;
-}
-static void
-qpacket_free__(vpi_qpacket_t* qp)
-{
-    if(qp) { 
-        if(qp->data) { 
-            aim_free(qp->data); 
-        }
-        aim_free(qp); 
-    }
-}
-
-/**************************************************************************//**
+ * Each queue is a bounded ring of preallocated packet slots. Every slot
+ * carries a sequence number telling whose turn it is: a slot at
+ * position 'pos' may be filled when its sequence is 'pos' and drained
+ * when it is 'pos + 1'. Producers and consumers claim positions by
+ * advancing 'tail' and 'head'; in MPMC queues the claim is a CAS, in
+ * SPSC queues each index has a single owner and is simply stored. 
  *
- * Packet queue management. 
- * Each VPI instance has a read queue and a write queue. 
+ * 'depth' is bumped after a packet is published. The producer that
+ * takes it from zero writes the queue eventfd, which is the receiving
+ * VPI's descriptor; receivers clear it when they find the queue empty. 
  *
  *****************************************************************************/
+typedef struct vpi_qslot_s { 
+    uint64_t seq; 
+    uint8_t* data; 
+    int size; 
+    int capacity; 
+} vpi_qslot_t; 
+
 typedef struct vpi_pq_s { 
     /** The name of this queue */
     const char* name; 
-    
-    /** Queue Management lock. */
-    os_sem_t mlock; 
 
-    /** 
-     * Packets available semaphore. 
-     * Do not take while holding the management lock. 
-     */
-    os_sem_t packets_available; 
+    /** Single producer/single consumer queue */
+    int spsc; 
     
-    /** The actual packet queue */
-    biglist_t* list; 
-    
-    /** Packet history queue (TBD) */
-    biglist_t* history_list; 
+    /** Producer and consumer indexes, kept on separate cache lines */
+    uint64_t tail __attribute__((aligned(64))); 
+    uint64_t head __attribute__((aligned(64))); 
+
+    /** Published packets not yet consumed */
+    int depth __attribute__((aligned(64))); 
+
+    /** Signalled when the queue goes from empty to non-empty */
+    int efd; 
+
+    /** Packet slots */
+    vpi_qslot_t slots[VPI_CONFIG_QUEUE_DEPTH]; 
+
+    /** Statistics */
+    vpi_queue_stats_t stats; 
 
     /** Reference count. Queues are shared between 
      * VPI endpoint instances. 
      */
     int refcount; 
 
+    /** Attached senders and receivers */
+    int producers; 
+    int consumers; 
+
 } vpi_pq_t; 
 
+#define PQ_MASK (VPI_CONFIG_QUEUE_DEPTH - 1)
+
 
 /** Global list of all active packet queues. */
 static biglist_locked_t* pq_list__ = NULL; 
@@ -113,11 +129,11 @@ pq_find_locked__(const char* name)
 
     BIGLIST_FOREACH_DATA(ble, pq_list__->list, vpi_pq_t*, pq) { 
         if(!VPI_STRCMP(name, pq->name)) { 
-            break; 
+            return pq; 
         }
     }
 
-    return pq; 
+    return NULL; 
 }
 
 /**
@@ -125,13 +141,29 @@ pq_find_locked__(const char* name)
  * pq_list__ must be locked prior to this call. 
  */
 vpi_pq_t*
-pq_alloc_locked__(const char* name)
+pq_alloc_locked__(const char* name, int spsc)
 {
     vpi_pq_t* pq = aim_zmalloc(sizeof(*pq)); 
+    int i; 
+
+    if(pq == NULL) {
+        return NULL; 
+    }
     
+    if((pq->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+        VPI_MERROR("eventfd() failed: %s", strerror(errno)); 
+        aim_free(pq); 
+        return NULL; 
+    }
+
+    for(i = 0; i < VPI_CONFIG_QUEUE_DEPTH; i++) {
+        pq->slots[i].seq = i; 
+        pq->slots[i].data = aim_zmalloc(VPI_CONFIG_QUEUE_SLOT_SIZE); 
+        pq->slots[i].capacity = VPI_CONFIG_QUEUE_SLOT_SIZE; 
+    }
+
     pq->name = aim_strdup(name); 
-    pq->mlock = os_sem_create(1); 
-    pq->packets_available = os_sem_create(0);
+    pq->spsc = spsc; 
     pq->refcount = 0;
     
     pq_list__->list = biglist_prepend(pq_list__->list, pq); 
@@ -145,13 +177,16 @@ pq_alloc_locked__(const char* name)
 void    
 pq_destroy__(vpi_pq_t* pq)
 {
+    int i; 
+
     pq->refcount--; 
     if(pq->refcount <= 0) { 
         biglist_locked_remove(pq_list__, pq); 
         aim_free((char*)pq->name);
-        os_sem_destroy(pq->mlock); 
-        os_sem_destroy(pq->packets_available); 
-        biglist_free_all(pq->list, (biglist_free_f)qpacket_free__); 
+        close(pq->efd); 
+        for(i = 0; i < VPI_CONFIG_QUEUE_DEPTH; i++) {
+            aim_free(pq->slots[i].data); 
+        }
         aim_free(pq); 
     }
 }
@@ -160,7 +195,7 @@ pq_destroy__(vpi_pq_t* pq)
  * Find or create the given packet queue. 
  */
 vpi_pq_t* 
-queue_find__(const char* name, int alloc)
+queue_find__(const char* name, int alloc, int spsc)
 {
     vpi_pq_t* pq; 
     
@@ -168,13 +203,196 @@ queue_find__(const char* name, int alloc)
     
     pq = pq_find_locked__(name); 
     if(pq == NULL && alloc) { 
-        pq = pq_alloc_locked__(name); 
+        pq = pq_alloc_locked__(name, spsc); 
     }
     
     biglist_unlock(pq_list__); 
     return pq; 
 }
 
+/**
+ * Claim the slot at the tail of the queue for writing. 
+ * Returns NULL if the queue is full. 
+ */
+static vpi_qslot_t*
+pq_claim_tail__(vpi_pq_t* q, uint64_t* ppos)
+{
+    uint64_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED); 
+    vpi_qslot_t* slot; 
+    int64_t dif; 
+
+    for(;;) {
+        slot = &q->slots[pos & PQ_MASK]; 
+        dif = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos); 
+        if(dif == 0) {
+            if(q->spsc) {
+                __atomic_store_n(&q->tail, pos + 1, __ATOMIC_RELAXED); 
+                break; 
+            }
+            if(__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1, 
+                                           __ATOMIC_RELAXED, 
+                                           __ATOMIC_RELAXED)) {
+                break; 
+            }
+        }
+        else if(dif < 0) {
+            return NULL; 
+        }
+        else {
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED); 
+        }
+    }
+    *ppos = pos; 
+    return slot; 
+}
+
+/**
+ * Claim the slot at the head of the queue for reading. 
+ * Returns NULL if the queue is empty. 
+ */
+static vpi_qslot_t*
+pq_claim_head__(vpi_pq_t* q, uint64_t* ppos)
+{
+    uint64_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED); 
+    vpi_qslot_t* slot; 
+    int64_t dif; 
+
+    for(;;) {
+        slot = &q->slots[pos & PQ_MASK]; 
+        dif = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - 
+                        (pos + 1)); 
+        if(dif == 0) {
+            if(q->spsc) {
+                __atomic_store_n(&q->head, pos + 1, __ATOMIC_RELAXED); 
+                break; 
+            }
+            if(__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1, 
+                                           __ATOMIC_RELAXED, 
+                                           __ATOMIC_RELAXED)) {
+                break; 
+            }
+        }
+        else if(dif < 0) {
+            return NULL; 
+        }
+        else {
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED); 
+        }
+    }
+    *ppos = pos; 
+    return slot; 
+}
+
+/** Hand a drained slot back to the producers */
+static void
+pq_release_head__(vpi_pq_t* q, uint64_t pos)
+{
+    __atomic_store_n(&q->slots[pos & PQ_MASK].seq, pos + PQ_MASK + 1, 
+                     __ATOMIC_RELEASE); 
+}
+
+/**
+ * Copy a packet into the queue without signalling. 
+ * Returns 0 or -1 if it was dropped. 
+ */
+static int
+pq_put__(vpi_pq_t* q, unsigned char* data, int size)
+{
+    vpi_qslot_t* slot; 
+    uint64_t pos; 
+
+    if((slot = pq_claim_tail__(q, &pos)) == NULL) {
+        __atomic_add_fetch(&q->stats.drops, 1, __ATOMIC_RELAXED); 
+        return -1; 
+    }
+
+    if(size > slot->capacity) {
+        /* The slot is ours until published, so it can grow */
+        uint8_t* data = aim_zmalloc(size); 
+        if(data == NULL) {
+            /* Publish an empty packet rather than wedge the ring */
+            size = 0; 
+        }
+        else {
+            aim_free(slot->data); 
+            slot->data = data; 
+            slot->capacity = size; 
+        }
+    }
+    VPI_MEMCPY(slot->data, data, size); 
+    slot->size = size; 
+
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE); 
+    __atomic_add_fetch(&q->stats.enqueued, 1, __ATOMIC_RELAXED); 
+    return 0; 
+}
+
+/** Account for 'count' published packets and wake a sleeping receiver */
+static void
+pq_published__(vpi_pq_t* q, int count)
+{
+    uint64_t one = 1; 
+    int prev = __atomic_fetch_add(&q->depth, count, __ATOMIC_SEQ_CST); 
+    int depth = prev + count; 
+    uint32_t max = __atomic_load_n(&q->stats.depth_max, __ATOMIC_RELAXED); 
+
+    while(depth > (int)max && 
+          !__atomic_compare_exchange_n(&q->stats.depth_max, &max, depth, 1, 
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        ; 
+    }
+
+    if(prev <= 0 && depth > 0) {
+        if(write(q->efd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            VPI_MERROR("eventfd write failed: %s", strerror(errno)); 
+        }
+    }
+}
+
+/** Account for 'count' consumed packets */
+static void
+pq_consumed__(vpi_pq_t* q, int count)
+{
+    __atomic_sub_fetch(&q->depth, count, __ATOMIC_SEQ_CST); 
+    __atomic_add_fetch(&q->stats.dequeued, count, __ATOMIC_RELAXED); 
+}
+
+/**
+ * Whether packets are queued. Clears the eventfd when the queue is
+ * found empty so the descriptor only polls readable with data queued. 
+ */
+static int
+pq_ready__(vpi_pq_t* q)
+{
+    uint64_t value; 
+
+    if(__atomic_load_n(&q->depth, __ATOMIC_SEQ_CST) > 0) {
+        return 1; 
+    }
+    if(read(q->efd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        VPI_MERROR("eventfd read failed: %s", strerror(errno)); 
+    }
+    /* A producer may have published after the check above */
+    return __atomic_load_n(&q->depth, __ATOMIC_SEQ_CST) > 0; 
+}
+
+/** Block until the queue may have packets */
+static void
+pq_wait__(vpi_pq_t* q)
+{
+    struct pollfd pfd; 
+
+    while(!pq_ready__(q)) {
+        pfd.fd = q->efd; 
+        pfd.events = POLLIN; 
+        pfd.revents = 0; 
+        if(poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            VPI_MERROR("poll() failed: %s", strerror(errno)); 
+            return; 
+        }
+    }
+}
+
 
 /**************************************************************************//**
  *
@@ -207,6 +425,10 @@ typedef struct vpi_interface_queue_s {
     /** Our Write Queue */
     vpi_pq_t* wq; 
 
+    /** Read queue positions handed out by recv_batch */
+    uint64_t held[VPI_CONFIG_BATCH_MAX]; 
+    int held_count; 
+
 } vpi_interface_queue_t; 
 
 
@@ -221,63 +443,97 @@ vpi_queue_interface_register(void)
                                   NULL, queue_interface_docstring__); 
 }       
 
-void
-pq_append__(vpi_pq_t* q, vpi_qpacket_t* qp)
+int 
+vpi_queue_interface_send(vpi_interface_t* _vi, unsigned char* data, int size)
 {
-    os_sem_take(q->mlock); 
-    q->list = biglist_append(q->list, qp); 
-    os_sem_give(q->mlock);
-    os_sem_give(q->packets_available); 
+    VICAST(vi, _vi); 
+    if(pq_put__(vi->wq, data, size) < 0) {
+        VPI_INFO(vi, "queue '%s' full, packet dropped", vi->wq->name); 
+        return -1; 
+    }
+    pq_published__(vi->wq, 1); 
+    return size; 
 }
 
-vpi_qpacket_t* 
-pq_unshift__(vpi_pq_t* q)
+int
+vpi_queue_interface_send_batch(vpi_interface_t* _vi, vpi_frame_t* headers, 
+                               vpi_frame_t* frames, int count)
 {
-    vpi_qpacket_t* rv = NULL; 
-    os_sem_take(q->mlock); 
-    if(q->list) { 
-        rv = (vpi_qpacket_t*)(q->list->data); 
-        q->list = biglist_remove_link_free(q->list, q->list); 
+    VICAST(vi, _vi); 
+    int sent; 
+
+    /* Raw interface -- never given protocol headers */
+    AIM_REFERENCE(headers); 
+
+    /* Stop at the first drop; the queue is full */
+    for(sent = 0; sent < count; sent++) {
+        if(pq_put__(vi->wq, frames[sent].data, frames[sent].size) < 0) {
+            break; 
+        }
     }
-    os_sem_give(q->mlock); 
-    return rv; 
+    if(sent) {
+        pq_published__(vi->wq, sent); 
+    }
+    return sent; 
 }
 
-int 
-vpi_queue_interface_send(vpi_interface_t* _vi, unsigned char* data, int size)
+void
+vpi_queue_interface_recv_release(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
-    pq_append__(vi->wq, qpacket_alloc__(data, size)); 
-    return size; 
+    int i; 
+
+    for(i = 0; i < vi->held_count; i++) {
+        pq_release_head__(vi->rq, vi->held[i]); 
+    }
+    vi->held_count = 0; 
+}
+
+int
+vpi_queue_interface_recv_batch(vpi_interface_t* _vi, vpi_frame_t* frames, 
+                               int count)
+{
+    VICAST(vi, _vi); 
+    vpi_qslot_t* slot; 
+    int n = 0; 
+
+    vpi_queue_interface_recv_release(_vi); 
+    if(count > VPI_CONFIG_BATCH_MAX) {
+        count = VPI_CONFIG_BATCH_MAX; 
+    }
+
+    while(n == 0) {
+        while(n < count && 
+              (slot = pq_claim_head__(vi->rq, &vi->held[n])) != NULL) {
+            frames[n].data = slot->data; 
+            frames[n].size = slot->size; 
+            n++; 
+        }
+        if(n == 0) {
+            pq_wait__(vi->rq); 
+        }
+    }
+    vi->held_count = n; 
+    pq_consumed__(vi->rq, n); 
+    return n; 
 }
 
 int
 vpi_queue_interface_recv(vpi_interface_t* _vi, unsigned char* data, int size)
 {
     VICAST(vi, _vi);
-    vpi_qpacket_t* qpacket = NULL; 
+    vpi_qslot_t* slot; 
+    uint64_t pos; 
     int rv; 
 
-    do { 
-        /** A packet must be available. */
-        os_sem_take(vi->rq->packets_available);
-        
-        qpacket = pq_unshift__(vi->rq); 
-        
-        /** 
-         * We don't expect multiple queue readers, so the qp pointer
-         * should never be NULL at this point. 
-         *
-         * Treat this as a bug for now.
-         */
-        if(qpacket == NULL) { 
-            AIM_LOG_ERROR(vi, "packet semaphore was signalled but packet was missing."); 
-        }
-    } while(qpacket == NULL); 
+    while((slot = pq_claim_head__(vi->rq, &pos)) == NULL) {
+        pq_wait__(vi->rq); 
+    }
         
-    rv = aim_imin(size, qpacket->size); 
-    VPI_MEMCPY(data, qpacket->data, rv); 
-    qpacket_free__(qpacket); 
+    rv = aim_imin(size, slot->size); 
+    VPI_MEMCPY(data, slot->data, rv); 
+    pq_release_head__(vi->rq, pos); 
+    pq_consumed__(vi->rq, 1); 
     return rv; 
 }
 
@@ -285,7 +541,14 @@ int
 vpi_queue_interface_recv_ready(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
-    return vi->rq->list != NULL;
+    return pq_ready__(vi->rq); 
+}
+
+int
+vpi_queue_interface_descriptor(vpi_interface_t* _vi)
+{
+    VICAST(vi, _vi); 
+    return vi->rq->efd; 
 }
 
 int
@@ -294,6 +557,7 @@ vpi_queue_interface_create(vpi_interface_t** vi, char* args[], int flags,
 {
     vpi_interface_queue_t* nvi = aim_zmalloc(sizeof(*nvi)); 
     char** arg = args; 
+    int spsc; 
 
     AIM_REFERENCE(flags); 
 
@@ -321,29 +585,51 @@ vpi_queue_interface_create(vpi_interface_t** vi, char* args[], int flags,
         aim_free(nvi); 
         return -1; 
     }
+    spsc = (arg[2] && !VPI_STRCMP(arg[2], "spsc")); 
     
     /* 
      * The first arguement is the send queue. 
      * The second argument is the recv queue; 
      */
-    nvi->wq = queue_find__(*arg, 1); 
+    nvi->wq = queue_find__(arg[0], 1, spsc); 
+    nvi->rq = queue_find__(arg[1], 1, spsc); 
+    if(nvi->wq == NULL || nvi->rq == NULL) {
+        VPI_ERROR(nvi, "queue allocation failed."); 
+        goto vpi_queue_interface_create_Error; 
+    }
     nvi->wq->refcount++; 
-    arg++; 
-
-    nvi->rq = queue_find__(*arg, 1); 
     nvi->rq->refcount++; 
-    arg++; 
+
+    if((nvi->wq->spsc && nvi->wq->producers > 0) || 
+       (nvi->rq->spsc && nvi->rq->consumers > 0)) {
+        VPI_ERROR(nvi, "single producer/consumer queue is already in use."); 
+        pq_destroy__(nvi->wq); 
+        pq_destroy__(nvi->rq); 
+        goto vpi_queue_interface_create_Error; 
+    }
+    nvi->wq->producers++; 
+    nvi->rq->consumers++; 
 
     /** Other arguments ignored */
     nvi->interface.send = vpi_queue_interface_send;
+    nvi->interface.send_batch = vpi_queue_interface_send_batch; 
     nvi->interface.recv = vpi_queue_interface_recv;
     nvi->interface.recv_ready = vpi_queue_interface_recv_ready;
+    nvi->interface.recv_batch = vpi_queue_interface_recv_batch; 
+    nvi->interface.recv_release = vpi_queue_interface_recv_release; 
     nvi->interface.destroy = vpi_queue_interface_destroy; 
-    /* todo -- support eventfd */
-    nvi->interface.descriptor = NULL;
+    nvi->interface.descriptor = vpi_queue_interface_descriptor;
 
     *vi = (vpi_interface_t*)nvi; 
     return 0; 
+
+ vpi_queue_interface_create_Error:
+    aim_free(nvi); 
+    if(pq_list__->list == NULL) { 
+        biglist_locked_free(pq_list__); 
+        pq_list__ = NULL; 
+    }
+    return -1; 
 }
     
 int
@@ -351,6 +637,9 @@ vpi_queue_interface_destroy(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
 
+    vpi_queue_interface_recv_release(_vi); 
+    vi->wq->producers--; 
+    vi->rq->consumers--; 
     pq_destroy__(vi->wq); 
     pq_destroy__(vi->rq); 
 
@@ -366,4 +655,25 @@ vpi_queue_interface_destroy(vpi_interface_t* _vi)
     return 0; 
 }
 
+int
+vpi_queue_stats_get(const char* name, vpi_queue_stats_t* stats)
+{
+    vpi_pq_t* pq; 
+    int rv = -1; 
+
+    if(pq_list__ == NULL || stats == NULL) {
+        return -1; 
+    }
+
+    biglist_lock(pq_list__); 
+    if((pq = pq_find_locked__(name)) != NULL) {
+        *stats = pq->stats; 
+        stats->depth = aim_imax(0, __atomic_load_n(&pq->depth, 
+                                                   __ATOMIC_RELAXED)); 
+        rv = 0; 
+    }
+    biglist_unlock(pq_list__); 
+    return rv; 
+}
+
 #endif /* INCLUDE_INTERFACE_QUEUE */
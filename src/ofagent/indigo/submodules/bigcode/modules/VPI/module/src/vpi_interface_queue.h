@@ -30,6 +30,15 @@ int vpi_queue_interface_create(vpi_interface_t** nvi, char* args[],
 
 int vpi_queue_interface_send(vpi_interface_t* vi, unsigned char* data, 
                             int len); 
+int vpi_queue_interface_send_batch(vpi_interface_t* vi, vpi_frame_t* headers, 
+                                   vpi_frame_t* frames, int count); 
+int vpi_queue_interface_recv(vpi_interface_t* vi, unsigned char* data, 
+                             int len); 
+int vpi_queue_interface_recv_ready(vpi_interface_t* vi); 
+int vpi_queue_interface_recv_batch(vpi_interface_t* vi, vpi_frame_t* frames, 
+                                   int count); 
+void vpi_queue_interface_recv_release(vpi_interface_t* vi); 
+int vpi_queue_interface_descriptor(vpi_interface_t* vi); 
 
 int vpi_queue_interface_destroy(vpi_interface_t* vi); 
 
@@ -34,6 +34,7 @@
 #include <sys/socket.h>  
 #include <sys/select.h>
 #include <sys/un.h>  
+#include <sys/uio.h>  
 #include <netinet/in.h>  
 #include <arpa/inet.h>  
 #include <netdb.h>
@@ -244,6 +245,7 @@ vpi_tcp_interface_create(vpi_interface_t** vi,
 
         /* Send interface is ready to go */
         nvi->interface.send = vpi_tcp_interface_send;
+        nvi->interface.send_batch = vpi_tcp_interface_send_batch; 
         vpi_free_ip_endpoint(&send_endpoint); 
     }
 
@@ -397,13 +399,47 @@ vpi_tcp_interface_recv_ready(vpi_interface_t* _vi)
     return descriptor_ready__(vi->listen_fd, 0); 
 }
 
-int
-vpi_tcp_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
+/*
+ * Write all of the given buffers, resuming after short writes. 
+ */
+static int
+writev_all__(int fd, struct iovec* iov, int iovcnt)
 {
-    VICAST(vi, _vi); 
+    ssize_t rv; 
+
+    while(iovcnt > 0) {
+        if( (rv = writev(fd, iov, iovcnt)) < 0) {
+            if(errno == EINTR) {
+                continue; 
+            }
+            return -1; 
+        }
+        while(iovcnt > 0 && (size_t)rv >= iov->iov_len) {
+            rv -= iov->iov_len; 
+            iov++; 
+            iovcnt--; 
+        }
+        if(iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + rv; 
+            iov->iov_len -= rv; 
+        }
+    }
+    return 0; 
+}
+
+/*
+ * Send one packet on its own connection. The length prefix and the
+ * packet buffers go out in a single writev(). 
+ */
+static int
+send_packet__(vpi_interface_tcp_t* vi, struct iovec* iov, int iovcnt)
+{
+    struct iovec msg[3]; 
     int rv; 
     int fd; 
     int net_len; 
+    int len = 0; 
+    int i; 
     
     VPI_TRACE(vi, "creating socket."); 
     /* Create a new socket for this transmit */
@@ -422,19 +458,19 @@ vpi_tcp_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
         close(fd); 
         return -1; 
     }
-    VPI_TRACE(vi, "Connected. Writing %d", len); 
 
-    /* Write the total packet size */
-    net_len = htonl(len); 
-    if( (rv = write(fd, &net_len, 4)) != 4) {
-        VPI_ERROR(vi, "write() failed: %s", strerror(errno)); 
-        close(fd); 
-        return -1; 
+    /* The total packet size, followed by the packet data */
+    for(i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len; 
+        msg[i+1] = iov[i]; 
     }
-    VPI_TRACE(vi, "writing packet data"); 
-    /* Write the packet data */
-    if( (rv = write(fd, data, len)) != len) {
-        VPI_ERROR(vi, "write() return %d: %s", rv, strerror(errno)); 
+    net_len = htonl(len); 
+    msg[0].iov_base = &net_len; 
+    msg[0].iov_len = 4; 
+
+    VPI_TRACE(vi, "Connected. Writing %d", len); 
+    if(writev_all__(fd, msg, iovcnt+1) < 0) {
+        VPI_ERROR(vi, "writev() failed: %s", strerror(errno)); 
         close(fd); 
         return -1; 
     }
@@ -443,6 +479,43 @@ vpi_tcp_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
     return len; 
 }
 
+int
+vpi_tcp_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
+{
+    VICAST(vi, _vi); 
+    struct iovec iov; 
+
+    iov.iov_base = data; 
+    iov.iov_len = len; 
+    return send_packet__(vi, &iov, 1); 
+}
+
+int
+vpi_tcp_interface_send_batch(vpi_interface_t* _vi, vpi_frame_t* headers, 
+                             vpi_frame_t* frames, int count)
+{
+    VICAST(vi, _vi); 
+    struct iovec iov[2]; 
+    int i, n; 
+
+    /* The receiver accepts one packet per connection */
+    for(i = 0; i < count; i++) {
+        n = 0; 
+        if(headers) {
+            iov[n].iov_base = headers[i].data; 
+            iov[n].iov_len = headers[i].size; 
+            n++; 
+        }
+        iov[n].iov_base = frames[i].data; 
+        iov[n].iov_len = frames[i].size; 
+        n++; 
+        if(send_packet__(vi, iov, n) < 0) {
+            break; 
+        }
+    }
+    return (i == 0 && count > 0) ? -1 : i; 
+}
+
 int
 vpi_tcp_interface_destroy(vpi_interface_t* _vi)
 {       
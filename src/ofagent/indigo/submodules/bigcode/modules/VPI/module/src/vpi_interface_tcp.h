@@ -46,6 +46,8 @@ int vpi_tcp_interface_connect_start(vpi_interface_t* vi);
 int vpi_tcp_interface_connect_ready(vpi_interface_t* vi); 
 int vpi_tcp_interface_connect_finish(vpi_interface_t* vi); 
 int vpi_tcp_interface_send(vpi_interface_t* vi, unsigned char* data, int len); 
+int vpi_tcp_interface_send_batch(vpi_interface_t* vi, vpi_frame_t* headers, 
+                                 vpi_frame_t* frames, int count); 
 int vpi_tcp_interface_recv(vpi_interface_t* vi, unsigned char* data, int len); 
 int vpi_tcp_interface_recv_ready(vpi_interface_t* vi);
 int vpi_tcp_interface_descriptor(vpi_interface_t* vi); 
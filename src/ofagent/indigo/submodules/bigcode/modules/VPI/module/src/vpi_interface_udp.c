@@ -35,6 +35,7 @@
 #include <sys/stat.h>  
 #include <sys/socket.h>  
 #include <sys/un.h>  
+#include <sys/uio.h>  
 #include <netinet/in.h>  
 #include <arpa/inet.h>  
 #include <netdb.h>
@@ -108,6 +109,9 @@ typedef struct vpi_interface_udp_s {
     /* Our recv sequence number */
     int rx_count; 
 
+    /* Receive buffers for recv_batch, allocated on first use */
+    uint8_t* rx_buffers; 
+
 } vpi_interface_udp_t; 
 
 
@@ -180,6 +184,108 @@ recvfrom__(vpi_interface_udp_t* vi, char* data, int len)
     return rv; 
 }
 
+/**************************************************************************//**
+ *
+ * Send a batch of packets to our peer with one sendmmsg()
+ *
+ *
+ *****************************************************************************/
+static int
+sendmmsg__(vpi_interface_udp_t* vi, vpi_frame_t* headers, 
+           vpi_frame_t* frames, int count)
+{
+    struct mmsghdr msgs[VPI_CONFIG_BATCH_MAX]; 
+    struct iovec iov[VPI_CONFIG_BATCH_MAX][2]; 
+    int i, rv; 
+
+    if(count > VPI_CONFIG_BATCH_MAX) {
+        count = VPI_CONFIG_BATCH_MAX; 
+    }
+
+    VPI_MEMSET(msgs, 0, sizeof(msgs[0]) * count); 
+    for(i = 0; i < count; i++) {
+        int n = 0; 
+        if(headers) {
+            iov[i][n].iov_base = headers[i].data; 
+            iov[i][n].iov_len = headers[i].size; 
+            n++; 
+        }
+        iov[i][n].iov_base = frames[i].data; 
+        iov[i][n].iov_len = frames[i].size; 
+        n++; 
+
+        msgs[i].msg_hdr.msg_name = &vi->sa_remote; 
+        msgs[i].msg_hdr.msg_namelen = sizeof(vi->sa_remote); 
+        msgs[i].msg_hdr.msg_iov = iov[i]; 
+        msgs[i].msg_hdr.msg_iovlen = n; 
+    }
+
+    rv = sendmmsg(vi->fd, msgs, count, 0); 
+    VPI_TRACE(vi, "sendmmsg(%d) = %d", count, rv); 
+    if(rv < 0) {
+        VPI_ERROR(vi, "sendmmsg() failed: %s", strerror(errno)); 
+    }
+    return rv; 
+}
+
+/**************************************************************************//**
+ *
+ * Recv a batch of packets with one recvmmsg()
+ *
+ *
+ *****************************************************************************/
+
+/* Room for the largest protocol message */
+#define UDP_RX_BUFFER_SIZE (VPI_CONFIG_MAX_PACKET + sizeof(vpi_header_t))
+
+static int
+recvmmsg__(vpi_interface_udp_t* vi, vpi_frame_t* frames, int count)
+{
+    struct mmsghdr msgs[VPI_CONFIG_BATCH_MAX]; 
+    struct iovec iov[VPI_CONFIG_BATCH_MAX]; 
+    struct sockaddr_in sa[VPI_CONFIG_BATCH_MAX]; 
+    int i, rv; 
+
+    if(vi->rx_buffers == NULL) {
+        vi->rx_buffers = aim_zmalloc(UDP_RX_BUFFER_SIZE * VPI_CONFIG_BATCH_MAX); 
+        if(vi->rx_buffers == NULL) {
+            VPI_ERROR(vi, "receive buffer allocation failed."); 
+            return -1; 
+        }
+    }
+    if(count > VPI_CONFIG_BATCH_MAX) {
+        count = VPI_CONFIG_BATCH_MAX; 
+    }
+
+    VPI_MEMSET(msgs, 0, sizeof(msgs[0]) * count); 
+    for(i = 0; i < count; i++) {
+        iov[i].iov_base = vi->rx_buffers + i * UDP_RX_BUFFER_SIZE; 
+        iov[i].iov_len = UDP_RX_BUFFER_SIZE; 
+        msgs[i].msg_hdr.msg_name = &sa[i]; 
+        msgs[i].msg_hdr.msg_namelen = sizeof(sa[i]); 
+        msgs[i].msg_hdr.msg_iov = &iov[i]; 
+        msgs[i].msg_hdr.msg_iovlen = 1; 
+    }
+
+    /* Block for the first packet only */
+    rv = recvmmsg(vi->fd, msgs, count, MSG_WAITFORONE, NULL); 
+    VPI_TRACE(vi, "recvmmsg(%d) = %d", count, rv); 
+    if(rv < 0) {
+        VPI_ERROR(vi, "recvmmsg() failed: %s", strerror(errno)); 
+        return -1; 
+    }
+
+    for(i = 0; i < rv; i++) {
+        frames[i].data = iov[i].iov_base; 
+        frames[i].size = msgs[i].msg_len; 
+    }
+    if(rv > 0) {
+        /* Replies to ioctls go to the most recent sender */
+        vi->sa_recv = sa[rv-1]; 
+    }
+    return rv; 
+}
+
 int
 vpi_udp_interface_create(vpi_interface_t** vi, 
                          char* args[], int flags, 
@@ -318,6 +424,7 @@ vpi_udp_interface_create(vpi_interface_t** vi,
         /* Recv interface is ready to go */
         nvi->interface.recv = vpi_udp_interface_recv; 
         nvi->interface.recv_ready = vpi_udp_interface_recv_ready; 
+        nvi->interface.recv_batch = vpi_udp_interface_recv_batch; 
     }
 
     if(send_endpoint) {
@@ -331,6 +438,7 @@ vpi_udp_interface_create(vpi_interface_t** vi,
 
         /* Send interface is ready to go */
         nvi->interface.send = vpi_udp_interface_send; 
+        nvi->interface.send_batch = vpi_udp_interface_send_batch; 
     }
             
     if(recv_endpoint && send_endpoint) {
@@ -410,11 +518,28 @@ vpi_udp_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
     return rv;
 }
 
+int
+vpi_udp_interface_send_batch(vpi_interface_t* _vi, vpi_frame_t* headers, 
+                             vpi_frame_t* frames, int count)
+{
+    VICAST(vi, _vi); 
+    return sendmmsg__(vi, headers, frames, count); 
+}
+
+int
+vpi_udp_interface_recv_batch(vpi_interface_t* _vi, vpi_frame_t* frames, 
+                             int count)
+{
+    VICAST(vi, _vi); 
+    return recvmmsg__(vi, frames, count); 
+}
+
 int
 vpi_udp_interface_destroy(vpi_interface_t* _vi)
 {       
     VICAST(vi, _vi); 
     if(vi) {
+        aim_free(vi->rx_buffers); 
         if(vi->fd > 0) {
             if(vi->close_fd) {
                 close(vi->fd); 
@@ -43,8 +43,12 @@ int vpi_udp_interface_create(vpi_interface_t** nvi, char* args[], int flags,
  * Interface vectors. These would not normally be called directly. 
  */
 int vpi_udp_interface_send(vpi_interface_t* vi, unsigned char* data, int len); 
+int vpi_udp_interface_send_batch(vpi_interface_t* vi, vpi_frame_t* headers, 
+                                 vpi_frame_t* frames, int count); 
 int vpi_udp_interface_recv(vpi_interface_t* vi, unsigned char* data, int len); 
 int vpi_udp_interface_recv_ready(vpi_interface_t* vi);
+int vpi_udp_interface_recv_batch(vpi_interface_t* vi, vpi_frame_t* frames, 
+                                 int count); 
 int vpi_udp_interface_descriptor(vpi_interface_t* vi); 
 int vpi_udp_interface_disconnect(vpi_interface_t* vi); 
 int vpi_udp_interface_destroy(vpi_interface_t* vi); 
@@ -49,6 +49,9 @@
 #include <linux/sockios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <errno.h>
 
 static const char* veth_interface_docstring__ = 
@@ -59,10 +62,15 @@ static const char* veth_interface_docstring__ =
     "VPI endpoints using VETH interfaces.\n"
     "\n"
     "Create format:\n"
-    "    'veth|INTERFACE'\n"
+    "    'veth|INTERFACE[|ring]'\n"
     "\n"
     "     Example:\n"
     "     'veth|veth0'\n"
+    "     'veth|veth0|ring'\n"
+    "\n"
+    "     The 'ring' option moves packets through TPACKET_V3\n"
+    "     memory mapped RX and TX rings instead of one system\n"
+    "     call per packet.\n"
     "\n"
     "\n";
 
@@ -93,6 +101,24 @@ typedef struct vpi_interface_veth_s {
 
     /* Interface name */
     char interface_name[IFNAMSIZ]; 
+
+    /* PACKET_MMAP rings, if created with the 'ring' option */
+    int ring; 
+    uint8_t* ring_map; 
+    size_t ring_map_size; 
+    struct tpacket_req3 rx_req; 
+    struct tpacket_req3 tx_req; 
+    uint8_t* rx_ring; 
+    uint8_t* tx_ring; 
+
+    /* RX block being read and the packets not yet handed out */
+    unsigned int rx_block; 
+    int rx_block_held; 
+    unsigned int rx_left; 
+    struct tpacket3_hdr* rx_pkt; 
+
+    /* Next TX frame to fill */
+    unsigned int tx_frame; 
     
 
 } vpi_interface_veth_t; 
@@ -133,6 +159,45 @@ sendto__(vpi_interface_veth_t* vi, char* data, int len)
     return 0; 
 }
 
+/**************************************************************************//**
+ *
+ * Send a batch of packets on our socket with one sendmmsg(). 
+ *
+ *
+ *****************************************************************************/
+static int
+sendmmsg__(vpi_interface_veth_t* vi, vpi_frame_t* frames, int count)
+{
+    struct sockaddr_ll sockaddr; 
+    struct mmsghdr msgs[VPI_CONFIG_BATCH_MAX]; 
+    struct iovec iov[VPI_CONFIG_BATCH_MAX]; 
+    int i, rv; 
+
+    if(count > VPI_CONFIG_BATCH_MAX) {
+        count = VPI_CONFIG_BATCH_MAX; 
+    }
+
+    VPI_MEMSET(&sockaddr, 0, sizeof(sockaddr)); 
+    sockaddr.sll_family  = AF_PACKET;
+    sockaddr.sll_ifindex = vi->ifindex;
+
+    VPI_MEMSET(msgs, 0, sizeof(msgs[0]) * count); 
+    for(i = 0; i < count; i++) {
+        iov[i].iov_base = frames[i].data; 
+        iov[i].iov_len = frames[i].size; 
+        msgs[i].msg_hdr.msg_name = &sockaddr; 
+        msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr); 
+        msgs[i].msg_hdr.msg_iov = &iov[i]; 
+        msgs[i].msg_hdr.msg_iovlen = 1; 
+    }
+
+    if((rv = sendmmsg(vi->fd, msgs, count, 0)) < 0) {
+        VPI_ERROR(vi, "sendmmsg() failed: %s", strerror(errno)); 
+        return -1; 
+    }
+    return rv; 
+}
+
 /**************************************************************************//**
  *
  * Receive packet data on our socket. Assumes no fragmentation. 
@@ -153,6 +218,244 @@ read__(vpi_interface_veth_t* vi, char* data, int len)
     return rv; 
 }
 
+/**************************************************************************//**
+ *
+ * PACKET_MMAP (TPACKET_V3) ring support. 
+ *
+ * The RX ring is a set of blocks the kernel fills with packets and
+ * hands over whole. Frames returned by recv_batch point straight into
+ * the current block, which goes back to the kernel once every packet
+ * in it has been handed out and released. 
+ *
+ * The TX ring is a set of fixed size frames. A send fills the next
+ * frame and asks the kernel to transmit everything pending. 
+ *
+ *****************************************************************************/
+
+/* Offset of packet data in a TX frame when PACKET_TX_HAS_OFF is not set */
+#define VETH_TX_DATA_OFFSET (TPACKET3_HDRLEN - sizeof(struct sockaddr_ll))
+
+static struct tpacket_block_desc*
+ring_rx_block__(vpi_interface_veth_t* vi, unsigned int block)
+{
+    return (struct tpacket_block_desc*)
+        (vi->rx_ring + block * vi->rx_req.tp_block_size); 
+}
+
+static struct tpacket3_hdr*
+ring_tx_frame__(vpi_interface_veth_t* vi, unsigned int frame)
+{
+    unsigned int per_block = vi->tx_req.tp_block_size / vi->tx_req.tp_frame_size; 
+    return (struct tpacket3_hdr*)
+        (vi->tx_ring + (frame / per_block) * vi->tx_req.tp_block_size + 
+         (frame % per_block) * vi->tx_req.tp_frame_size); 
+}
+
+static int
+ring_setup__(vpi_interface_veth_t* vi)
+{
+    int version = TPACKET_V3; 
+    size_t rx_size, tx_size; 
+
+    if(setsockopt(vi->fd, SOL_PACKET, PACKET_VERSION, 
+                  &version, sizeof(version)) < 0) {
+        VPI_ERROR(vi, "PACKET_VERSION failed: %s", strerror(errno)); 
+        return -1; 
+    }
+
+    vi->rx_req.tp_block_size = VPI_CONFIG_VETH_RING_BLOCK_SIZE; 
+    vi->rx_req.tp_block_nr = VPI_CONFIG_VETH_RING_BLOCK_COUNT; 
+    vi->rx_req.tp_frame_size = VPI_CONFIG_VETH_RING_FRAME_SIZE; 
+    vi->rx_req.tp_frame_nr = VPI_CONFIG_VETH_RING_BLOCK_COUNT * 
+        (VPI_CONFIG_VETH_RING_BLOCK_SIZE / VPI_CONFIG_VETH_RING_FRAME_SIZE); 
+    vi->rx_req.tp_retire_blk_tov = VPI_CONFIG_VETH_RING_RETIRE_MS; 
+
+    if(setsockopt(vi->fd, SOL_PACKET, PACKET_RX_RING, 
+                  &vi->rx_req, sizeof(vi->rx_req)) < 0) {
+        VPI_ERROR(vi, "PACKET_RX_RING failed: %s", strerror(errno)); 
+        return -1; 
+    }
+
+    /* The TX ring takes the same geometry without the RX-only options */
+    vi->tx_req = vi->rx_req; 
+    vi->tx_req.tp_retire_blk_tov = 0; 
+
+    if(setsockopt(vi->fd, SOL_PACKET, PACKET_TX_RING, 
+                  &vi->tx_req, sizeof(vi->tx_req)) < 0) {
+        VPI_ERROR(vi, "PACKET_TX_RING failed: %s", strerror(errno)); 
+        return -1; 
+    }
+
+    rx_size = (size_t)vi->rx_req.tp_block_size * vi->rx_req.tp_block_nr; 
+    tx_size = (size_t)vi->tx_req.tp_block_size * vi->tx_req.tp_block_nr; 
+    vi->ring_map_size = rx_size + tx_size; 
+    vi->ring_map = mmap(NULL, vi->ring_map_size, PROT_READ | PROT_WRITE, 
+                        MAP_SHARED, vi->fd, 0); 
+    if(vi->ring_map == MAP_FAILED) {
+        VPI_ERROR(vi, "mmap() failed: %s", strerror(errno)); 
+        vi->ring_map = NULL; 
+        return -1; 
+    }
+
+    /* The kernel maps the RX ring first, followed by the TX ring */
+    vi->rx_ring = vi->ring_map; 
+    vi->tx_ring = vi->ring_map + rx_size; 
+    vi->ring = 1; 
+    return 0; 
+}
+
+/* Give the current RX block back once all of its packets are consumed */
+static void
+ring_rx_release__(vpi_interface_veth_t* vi)
+{
+    if(vi->rx_block_held && vi->rx_left == 0) {
+        struct tpacket_block_desc* pbd = ring_rx_block__(vi, vi->rx_block); 
+        __sync_synchronize(); 
+        pbd->hdr.bh1.block_status = TP_STATUS_KERNEL; 
+        vi->rx_block = (vi->rx_block + 1) % vi->rx_req.tp_block_nr; 
+        vi->rx_block_held = 0; 
+    }
+}
+
+static int
+ring_rx_ready__(vpi_interface_veth_t* vi)
+{
+    if(vi->rx_left) {
+        return 1; 
+    }
+    ring_rx_release__(vi); 
+    return (ring_rx_block__(vi, vi->rx_block)->hdr.bh1.block_status & 
+            TP_STATUS_USER) ? 1 : 0; 
+}
+
+static int
+ring_recv_batch__(vpi_interface_veth_t* vi, vpi_frame_t* frames, int count)
+{
+    int n = 0; 
+
+    ring_rx_release__(vi); 
+
+    while(vi->rx_left == 0) {
+        struct tpacket_block_desc* pbd = ring_rx_block__(vi, vi->rx_block); 
+
+        if(!(pbd->hdr.bh1.block_status & TP_STATUS_USER)) {
+            struct pollfd pfd; 
+            pfd.fd = vi->fd; 
+            pfd.events = POLLIN | POLLERR; 
+            pfd.revents = 0; 
+            if(poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                VPI_ERROR(vi, "poll() failed: %s", strerror(errno)); 
+                return -1; 
+            }
+            continue; 
+        }
+        __sync_synchronize(); 
+
+        vi->rx_block_held = 1; 
+        vi->rx_left = pbd->hdr.bh1.num_pkts; 
+        vi->rx_pkt = (struct tpacket3_hdr*)
+            ((uint8_t*)pbd + pbd->hdr.bh1.offset_to_first_pkt); 
+
+        /* An empty block can be returned right away */
+        ring_rx_release__(vi); 
+    }
+
+    while(n < count && vi->rx_left) {
+        frames[n].data = (uint8_t*)vi->rx_pkt + vi->rx_pkt->tp_mac; 
+        frames[n].size = vi->rx_pkt->tp_snaplen; 
+        n++; 
+        vi->rx_left--; 
+        vi->rx_pkt = (struct tpacket3_hdr*)
+            ((uint8_t*)vi->rx_pkt + vi->rx_pkt->tp_next_offset); 
+    }
+
+    VPI_INFO(vi, "%d packets received", n); 
+    return n; 
+}
+
+/*
+ * Ask the kernel to transmit all frames marked for sending. With 'wait'
+ * this also waits for the frames to be released back to us. 
+ */
+static int
+ring_tx_flush__(vpi_interface_veth_t* vi, int wait)
+{
+    if(send(vi->fd, NULL, 0, wait ? 0 : MSG_DONTWAIT) < 0 && 
+       (wait || (errno != EAGAIN && errno != ENOBUFS))) {
+        VPI_ERROR(vi, "send() failed: %s", strerror(errno)); 
+        return -1; 
+    }
+    return 0; 
+}
+
+/* Queue one packet in the TX ring without flushing */
+static int
+ring_tx_queue__(vpi_interface_veth_t* vi, char* data, int len)
+{
+    struct tpacket3_hdr* hdr = ring_tx_frame__(vi, vi->tx_frame); 
+
+    while(hdr->tp_status != TP_STATUS_AVAILABLE) {
+        if(hdr->tp_status & TP_STATUS_WRONG_FORMAT) {
+            VPI_ERROR(vi, "TX ring frame %d rejected by the kernel", 
+                      vi->tx_frame); 
+            hdr->tp_status = TP_STATUS_AVAILABLE; 
+            break; 
+        }
+        /* Ring is full. Let the kernel drain it. */
+        if(ring_tx_flush__(vi, 1) < 0) {
+            return -1; 
+        }
+    }
+
+    VPI_MEMCPY((uint8_t*)hdr + VETH_TX_DATA_OFFSET, data, len); 
+    hdr->tp_len = len; 
+    hdr->tp_snaplen = len; 
+    hdr->tp_next_offset = 0; 
+    __sync_synchronize(); 
+    hdr->tp_status = TP_STATUS_SEND_REQUEST; 
+
+    vi->tx_frame = (vi->tx_frame + 1) % vi->tx_req.tp_frame_nr; 
+    return 0; 
+}
+
+static int
+ring_send__(vpi_interface_veth_t* vi, char* data, int len)
+{
+    if(len > (int)(vi->tx_req.tp_frame_size - VETH_TX_DATA_OFFSET)) {
+        /* Does not fit in a ring frame */
+        return sendto__(vi, data, len); 
+    }
+    if(ring_tx_queue__(vi, data, len) < 0) {
+        return -1; 
+    }
+    return ring_tx_flush__(vi, 0); 
+}
+
+/* Queue the whole batch in the TX ring and kick the kernel once */
+static int
+ring_send_batch__(vpi_interface_veth_t* vi, vpi_frame_t* frames, int count)
+{
+    int i; 
+
+    for(i = 0; i < count; i++) {
+        int rv; 
+        if((int)frames[i].size > 
+           (int)(vi->tx_req.tp_frame_size - VETH_TX_DATA_OFFSET)) {
+            rv = sendto__(vi, (char*)frames[i].data, frames[i].size); 
+        }
+        else {
+            rv = ring_tx_queue__(vi, (char*)frames[i].data, frames[i].size); 
+        }
+        if(rv < 0) {
+            break; 
+        }
+    }
+    if(ring_tx_flush__(vi, 0) < 0) {
+        return -1; 
+    }
+    return i; 
+}
+
 /**************************************************************************//**
  *
  *
@@ -216,6 +519,16 @@ vpi_veth_interface_create(vpi_interface_t** vi, char* args[], int flags,
 
     VPI_INFO(nvi, "ifndex is %d", nvi->ifindex);
 
+    if(arg[1] && !VPI_STRCMP(arg[1], "ring")) {
+        if(ring_setup__(nvi) < 0) {
+            close(nvi->fd); 
+            aim_free(nvi); 
+            return -1; 
+        }
+        VPI_INFO(nvi, "using %d x %d byte rings", 
+                 nvi->rx_req.tp_block_nr, nvi->rx_req.tp_block_size); 
+    }
+
     VPI_MEMSET(&sockaddr, 0, sizeof(sockaddr)); 
     sockaddr.sll_family=AF_PACKET; 
     sockaddr.sll_protocol = htons(ETH_P_ALL); 
@@ -227,8 +540,13 @@ vpi_veth_interface_create(vpi_interface_t** vi, char* args[], int flags,
     }
 
     nvi->interface.send = vpi_veth_interface_send;
+    nvi->interface.send_batch = vpi_veth_interface_send_batch; 
     nvi->interface.recv = vpi_veth_interface_recv; 
     nvi->interface.recv_ready = vpi_veth_interface_recv_ready; 
+    if(nvi->ring) {
+        nvi->interface.recv_batch = vpi_veth_interface_recv_batch; 
+        nvi->interface.recv_release = vpi_veth_interface_recv_release; 
+    }
     nvi->interface.destroy = vpi_veth_interface_destroy; 
     nvi->interface.descriptor = vpi_veth_interface_descriptor; 
 
@@ -240,22 +558,70 @@ int
 vpi_veth_interface_send(vpi_interface_t* _vi, unsigned char* data, int len)
 {
     VICAST(vi, _vi); 
+    if(vi->ring) {
+        return ring_send__(vi, (char*)data, len); 
+    }
     return sendto__(vi, (char*)data, len); 
 }
 
+int
+vpi_veth_interface_send_batch(vpi_interface_t* _vi, vpi_frame_t* headers, 
+                              vpi_frame_t* frames, int count)
+{
+    VICAST(vi, _vi); 
+
+    /* Raw interface -- never given protocol headers */
+    AIM_REFERENCE(headers); 
+
+    if(vi->ring) {
+        return ring_send_batch__(vi, frames, count); 
+    }
+    return sendmmsg__(vi, frames, count); 
+}
+
 int
 vpi_veth_interface_recv(vpi_interface_t* _vi, unsigned char* data, int len)
 {
     VICAST(vi, _vi); 
+    if(vi->ring) {
+        vpi_frame_t frame; 
+        if(ring_recv_batch__(vi, &frame, 1) <= 0) {
+            return -1; 
+        }
+        if((int)frame.size > len) {
+            frame.size = len; 
+        }
+        VPI_MEMCPY(data, frame.data, frame.size); 
+        ring_rx_release__(vi); 
+        return frame.size; 
+    }
     return read__(vi, (char*)data, len); 
 }
 
+int
+vpi_veth_interface_recv_batch(vpi_interface_t* _vi, vpi_frame_t* frames, 
+                              int count)
+{
+    VICAST(vi, _vi); 
+    return ring_recv_batch__(vi, frames, count); 
+}
+
+void
+vpi_veth_interface_recv_release(vpi_interface_t* _vi)
+{
+    VICAST(vi, _vi); 
+    ring_rx_release__(vi); 
+}
+
 int
 vpi_veth_interface_recv_ready(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
     fd_set rfds; 
     struct timeval tv; 
+    if(vi->ring) {
+        return ring_rx_ready__(vi); 
+    }
     FD_ZERO(&rfds); 
     FD_SET(vi->fd, &rfds); 
     tv.tv_sec = 0;
@@ -274,6 +640,9 @@ int
 vpi_veth_interface_destroy(vpi_interface_t* _vi)
 {
     VICAST(vi, _vi); 
+    if(vi->ring_map) {
+        munmap(vi->ring_map, vi->ring_map_size); 
+    }
     close(vi->fd); 
     aim_free(vi); 
     return 0; 
@@ -38,8 +38,13 @@ int vpi_veth_interface_create(vpi_interface_t** nvi, char* args[], int flags,
  * Interface vectors. These would not normally be called directly. 
  */
 int vpi_veth_interface_send(vpi_interface_t* vi, unsigned char* data, int len); 
+int vpi_veth_interface_send_batch(vpi_interface_t* vi, vpi_frame_t* headers, 
+                                  vpi_frame_t* frames, int count); 
 int vpi_veth_interface_recv(vpi_interface_t* vi, unsigned char* data, int len); 
 int vpi_veth_interface_recv_ready(vpi_interface_t* vi); 
+int vpi_veth_interface_recv_batch(vpi_interface_t* vi, vpi_frame_t* frames, 
+                                  int count); 
+void vpi_veth_interface_recv_release(vpi_interface_t* vi); 
 int vpi_veth_interface_descriptor(vpi_interface_t* vi); 
 int vpi_veth_interface_destroy(vpi_interface_t* vi); 
 
@@ -90,6 +90,18 @@ vpi_packet_free(vpi_packet_t* p)
     }
 }
 
+void
+vpi_protocol_packet_hdr_build(vpi_header_t* wire, int data_size)
+{
+    vpi_header_t hdr; 
+
+    VPI_MEMSET(&hdr, 0, sizeof(hdr)); 
+    hdr.opcode = VPI_PROTOCOL_OPCODE_PACKET; 
+    hdr.payload_size = data_size; 
+    hdr.message_size = data_size + sizeof(hdr); 
+    vpi_hdr_htonl__(wire, &hdr); 
+}
+
 
 int
 vpi_protocol_msg_parse(uint8_t* msg, unsigned int msg_size, 
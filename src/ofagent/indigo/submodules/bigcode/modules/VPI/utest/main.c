@@ -38,6 +38,11 @@ vpi_testcase_t vpi_testcases[] =
             "queue|1|2", 
             "queue|2|1", 
         }, 
+        {
+            "queue|spsc", 
+            "queue|3|4|spsc", 
+            "queue|4|3|spsc", 
+        }, 
 #endif
 #if VPI_CONFIG_INCLUDE_INTERFACE_TCP == 1
         {
@@ -144,6 +149,16 @@ vpi_bridge_testcase_t vpi_bridge_testcases[] =
         },
 #endif
 
+#if VPI_CONFIG_INCLUDE_INTERFACE_QUEUE == 1
+        {
+            "QUEUE bridge", 
+            "queue|b1|b2", 
+            "queue|b2|b1", 
+            "queue|b3|b4|spsc", 
+            "queue|b4|b3|spsc", 
+        },
+#endif
+
 #if VPI_CONFIG_INCLUDE_INTERFACE_VETH == 1
         {
             "VETH bridge", 
@@ -152,6 +167,13 @@ vpi_bridge_testcase_t vpi_bridge_testcases[] =
             "veth|vpi-veth2", 
             "veth|vpi-veth3"
         },
+        {
+            "VETH ring bridge", 
+            "veth|vpi-veth0|ring", 
+            "veth|vpi-veth1|ring", 
+            "veth|vpi-veth2|ring", 
+            "veth|vpi-veth3|ring"
+        },
 #endif
 
 #if VPI_CONFIG_INCLUDE_INTERFACE_UDP == 1 && VPI_CONFIG_INCLUDE_INTERFACE_VETH == 1
@@ -274,6 +296,122 @@ loopback_test__(void)
 
 #endif /* VPI_CONFIG_INCLUDE_INTERFACE_LOOPBACK */
 
+#if VPI_CONFIG_INCLUDE_INTERFACE_QUEUE == 1
+
+static int
+queue_test__(void)
+{
+    unsigned char data[64]; 
+    vpi_queue_stats_t stats; 
+    vpi_t tx = NULL; 
+    vpi_t rx = NULL; 
+    int i; 
+
+    if( (tx = vpi_create("queue|q1|q2|spsc")) == NULL || 
+        (rx = vpi_create("queue|q2|q1|spsc")) == NULL) {
+        VPI_MERROR("queue create failed."); 
+        goto queue_test__error; 
+    }
+
+    /* A second receiver on a single consumer queue is refused */
+    if(vpi_create("queue|q3|q1") != NULL) {
+        VPI_MERROR("second spsc consumer was allowed."); 
+        goto queue_test__error; 
+    }
+
+    memset(data, 0x11, sizeof(data)); 
+    for(i = 0; i < VPI_CONFIG_QUEUE_DEPTH + 10; i++) {
+        vpi_send(tx, data, sizeof(data)); 
+    }
+    if(vpi_queue_stats_get("q1", &stats) < 0 || 
+       stats.enqueued != VPI_CONFIG_QUEUE_DEPTH || stats.drops != 10 || 
+       stats.depth != VPI_CONFIG_QUEUE_DEPTH || 
+       stats.depth_max != VPI_CONFIG_QUEUE_DEPTH) {
+        VPI_MERROR("unexpected full queue stats."); 
+        goto queue_test__error; 
+    }
+
+    if(vpi_drain(rx) != VPI_CONFIG_QUEUE_DEPTH) {
+        VPI_MERROR("queue drain failed."); 
+        goto queue_test__error; 
+    }
+    if(vpi_queue_stats_get("q1", &stats) < 0 || stats.depth != 0 || 
+       stats.dequeued != VPI_CONFIG_QUEUE_DEPTH) {
+        VPI_MERROR("unexpected drained queue stats."); 
+        goto queue_test__error; 
+    }
+
+    vpi_destroy(rx); 
+    vpi_destroy(tx); 
+    return 0; 
+
+ queue_test__error:
+    vpi_destroy(rx); 
+    vpi_destroy(tx); 
+    return -1; 
+}
+
+#endif /* VPI_CONFIG_INCLUDE_INTERFACE_QUEUE */
+
+#if VPI_CONFIG_INCLUDE_INTERFACE_UDP == 1
+
+static int
+batch_test__(void)
+{
+    unsigned char data[10][100]; 
+    vpi_frame_t frames[10]; 
+    vpi_t tx = NULL; 
+    vpi_t rx = NULL; 
+    int i, rv, received = 0; 
+
+    if( (tx = vpi_create("udp|send:127.0.0.1:37011")) == NULL || 
+        (rx = vpi_create("udp|recv:127.0.0.1:37011")) == NULL) {
+        VPI_MERROR("batch create failed."); 
+        goto batch_test__error; 
+    }
+
+    for(i = 0; i < 10; i++) {
+        memset(data[i], i, sizeof(data[i])); 
+        frames[i].data = data[i]; 
+        frames[i].size = sizeof(data[i]) - i; 
+    }
+    if( (rv = vpi_send_batch(tx, frames, 10)) != 10) {
+        VPI_ERROR(tx, "send batch returned %d.", rv); 
+        goto batch_test__error; 
+    }
+
+    while(received < 10) {
+        if( (rv = vpi_recv_batch(rx, frames, 10 - received, 1)) <= 0) {
+            VPI_ERROR(rx, "recv batch returned %d.", rv); 
+            goto batch_test__error; 
+        }
+        for(i = 0; i < rv; i++, received++) {
+            if(frames[i].size != sizeof(data[0]) - received || 
+               memcmp(frames[i].data, data[received], frames[i].size) != 0) {
+                VPI_ERROR(rx, "recv batch packet %d mismatch.", received); 
+                goto batch_test__error; 
+            }
+        }
+        vpi_recv_release(rx); 
+    }
+
+    if( (rv = vpi_recv_batch(rx, frames, 10, 0)) != 0) {
+        VPI_ERROR(rx, "Extra packets."); 
+        goto batch_test__error; 
+    }
+
+    vpi_destroy(rx); 
+    vpi_destroy(tx); 
+    return 0; 
+
+ batch_test__error:
+    vpi_destroy(rx); 
+    vpi_destroy(tx); 
+    return -1; 
+}
+
+#endif /* VPI_CONFIG_INCLUDE_INTERFACE_UDP */
+
 void
 makeveths__(void)
 {
@@ -373,6 +511,44 @@ main(int argc, char* argv[])
     }                
 #endif
 
+/**************************************************************************//**
+ *
+ * Throughput Benchmarks
+ *
+ *
+ *****************************************************************************/
+    if(argc > 1 && !strcmp(argv[1], "benchmark")) {
+        vpi_benchmark_t* bm; 
+        for(bm = vpi_benchmarks; bm->description; bm++) {
+            test_count++; 
+            if(vpi_benchmark_run(bm) < 0) {
+                fail_count++; 
+            }
+        }
+    }
+
+#if VPI_CONFIG_INCLUDE_INTERFACE_QUEUE == 1
+    {
+        if(argc == 1 || strstr("queue", argv[1])) {
+            test_count++; 
+            if(queue_test__() < 0) {
+                fail_count++; 
+            }
+        }
+    }
+#endif
+
+#if VPI_CONFIG_INCLUDE_INTERFACE_UDP == 1
+    {
+        if(argc == 1 || strstr("batch", argv[1])) {
+            test_count++; 
+            if(batch_test__() < 0) {
+                fail_count++; 
+            }
+        }
+    }
+#endif
+
     /* Loopback Test */
     printf("\n*** Results, VPI loopback: %d PASSED, %d FAILED, %d TOTAL\n\n",
            test_count-fail_count, fail_count, test_count); 
@@ -0,0 +1,235 @@
+/****************************************************************
+ * 
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ ***************************************************************/
+
+
+#include "vpi_utests.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sched.h>
+
+#define VPI_LOG_PREFIX1 ".utest"
+#define VPI_LOG_PREFIX2 ".benchmark"
+#include "vpi_log.h"
+
+/*
+ * Throughput benchmarks. A sender thread pushes packets into one VPI as
+ * fast as it can while the receiver drains the peer, either one packet
+ * at a time through vpi_send()/vpi_recv() or in batches through
+ * vpi_send_batch()/vpi_recv_batch().
+ * Packets the receiver cannot keep up with are dropped by the kernel,
+ * so the delivered rate and the loss are reported. Benchmarks with a
+ * window keep at most that many packets in flight instead. Run with the
+ * 'benchmark' argument.
+ */
+
+#define BENCHMARK_PACKETS 500000
+#define BENCHMARK_BATCH 64
+#define BENCHMARK_PACKET_SIZE 64
+#define BENCHMARK_IDLE_MS 200
+
+vpi_benchmark_t vpi_benchmarks[] = 
+    {
+#if VPI_CONFIG_INCLUDE_INTERFACE_VETH == 1
+        {
+            "VETH copy", 
+            "veth|vpi-veth4", 
+            "veth|vpi-veth5", 
+            0, 0, 
+        }, 
+        {
+            "VETH ring", 
+            "veth|vpi-veth4|ring", 
+            "veth|vpi-veth5|ring", 
+            1, 0, 
+        }, 
+#endif
+#if VPI_CONFIG_INCLUDE_INTERFACE_QUEUE == 1
+        {
+            "QUEUE copy", 
+            "queue|bm1|bm2", 
+            "queue|bm2|bm1", 
+            0, VPI_CONFIG_QUEUE_DEPTH, 
+        }, 
+        {
+            "QUEUE spsc batch", 
+            "queue|bm3|bm4|spsc", 
+            "queue|bm4|bm3|spsc", 
+            1, VPI_CONFIG_QUEUE_DEPTH, 
+        }, 
+#endif
+#if VPI_CONFIG_INCLUDE_INTERFACE_UDP == 1
+        {
+            "UDP copy", 
+            "udp|send:127.0.0.1:37001", 
+            "udp|recv:127.0.0.1:37001", 
+            0, 0, 
+        }, 
+        {
+            "UDP batch", 
+            "udp|send:127.0.0.1:37001", 
+            "udp|recv:127.0.0.1:37001", 
+            1, 0, 
+        }, 
+#endif
+        {
+            NULL
+        }, 
+    }; 
+
+typedef struct benchmark_sender_s {
+    vpi_benchmark_t* bm; 
+    vpi_t vpi; 
+    volatile int sent; 
+    volatile int received; 
+    volatile int done; 
+} benchmark_sender_t; 
+
+static uint64_t
+now_ns__(void)
+{
+    struct timespec ts; 
+    clock_gettime(CLOCK_MONOTONIC, &ts); 
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec; 
+}
+
+static void*
+benchmark_sender__(void* arg)
+{
+    benchmark_sender_t* sender = (benchmark_sender_t*)arg; 
+    uint8_t packet[BENCHMARK_PACKET_SIZE]; 
+    vpi_frame_t frames[BENCHMARK_BATCH]; 
+    int i; 
+
+    /* Broadcast frames so nothing on the peer filters them */
+    memset(packet, 0, sizeof(packet)); 
+    memset(packet, 0xFF, 6); 
+    packet[6] = 0x02; 
+    packet[12] = 0x88; 
+    packet[13] = 0xB5; 
+
+    for(i = 0; i < BENCHMARK_BATCH; i++) {
+        frames[i].data = packet; 
+        frames[i].size = sizeof(packet); 
+    }
+
+    /* Packets a full queue refuses count as sent and lost */
+    while(sender->sent < BENCHMARK_PACKETS) {
+        if(sender->bm->window && 
+           sender->sent - sender->received + BENCHMARK_BATCH > sender->bm->window) {
+            sched_yield(); 
+            continue; 
+        }
+        if(sender->bm->batch) {
+            vpi_send_batch(sender->vpi, frames, BENCHMARK_BATCH); 
+            sender->sent += BENCHMARK_BATCH; 
+        }
+        else {
+            vpi_send(sender->vpi, packet, sizeof(packet)); 
+            sender->sent++; 
+        }
+    }
+    sender->done = 1; 
+    return NULL; 
+}
+
+/* Receive whatever is ready, returning the number of packets */
+static int
+benchmark_recv__(vpi_benchmark_t* bm, vpi_t rx, uint8_t* buffer)
+{
+    int rv; 
+
+    if(bm->batch) {
+        vpi_frame_t frames[BENCHMARK_BATCH]; 
+        rv = vpi_recv_batch(rx, frames, BENCHMARK_BATCH, 0); 
+        vpi_recv_release(rx); 
+        return rv; 
+    }
+    rv = vpi_recv(rx, buffer, VPI_CONFIG_MAX_PACKET, 0); 
+    return (rv > 0) ? 1 : rv; 
+}
+
+int
+vpi_benchmark_run(vpi_benchmark_t* bm)
+{
+    static uint8_t buffer[VPI_CONFIG_MAX_PACKET]; 
+    benchmark_sender_t sender; 
+    pthread_t thread; 
+    vpi_t rx = NULL; 
+    struct pollfd pfd; 
+    uint64_t start, last; 
+    int rv = -1; 
+    int n; 
+
+    memset(&sender, 0, sizeof(sender)); 
+    sender.bm = bm; 
+    if((sender.vpi = vpi_create(bm->tx_spec)) == NULL || 
+       (rx = vpi_create(bm->rx_spec)) == NULL) {
+        VPI_MERROR("%s: vpi_create() failed.", bm->description); 
+        goto benchmark_error; 
+    }
+    vpi_drain(rx); 
+
+    start = last = now_ns__(); 
+    if(pthread_create(&thread, NULL, benchmark_sender__, &sender) != 0) {
+        VPI_MERROR("%s: thread creation failed.", bm->description); 
+        goto benchmark_error; 
+    }
+
+    /*
+     * Sleep until packets arrive, then drain them. Stop once the
+     * sender is done and the link has gone quiet. 
+     */
+    pfd.fd = vpi_descriptor_get(rx); 
+    pfd.events = POLLIN; 
+    for(;;) {
+        pfd.revents = 0; 
+        if(poll(&pfd, 1, BENCHMARK_IDLE_MS) == 0 && sender.done) {
+            n = 0; 
+            break; 
+        }
+        while((n = benchmark_recv__(bm, rx, buffer)) > 0) {
+            sender.received += n; 
+            last = now_ns__(); 
+        }
+        if(n < 0) {
+            VPI_MERROR("%s: recv failed.", bm->description); 
+            break; 
+        }
+    }
+    pthread_join(thread, NULL); 
+
+    printf("%s: %d sent, %d received (%d%% lost) in %llu us, %llu pps\n", 
+           bm->description, sender.sent, sender.received, 
+           (sender.received < sender.sent) ? 
+               (sender.sent - sender.received) * 100 / sender.sent : 0, 
+           (unsigned long long)((last - start) / 1000), 
+           (unsigned long long)((last > start) ? 
+                (uint64_t)sender.received * 1000000000ULL / (last - start) : 0)); 
+
+    rv = (n >= 0 && sender.sent >= BENCHMARK_PACKETS && 
+          sender.received > 0) ? 0 : -1; 
+
+ benchmark_error:
+    vpi_destroy(rx); 
+    vpi_destroy(sender.vpi); 
+    return rv; 
+}
@@ -235,6 +235,7 @@ vpi_blocking_bridge_testcase_run__(vpi_bridge_testcase_t* testcase)
     vpi_t bridge1 = vpi_create(testcase->b1); 
     vpi_bridge_t b = vpi_bridge_create(bridge0, bridge1); 
     vpi_testcase_t t; 
+    vpi_bridge_stats_t stats; 
     int rv; 
 
     memset(&t, 0, sizeof(t)); 
@@ -244,6 +245,14 @@ vpi_blocking_bridge_testcase_run__(vpi_bridge_testcase_t* testcase)
     t.spec_server = testcase->e1; 
     vpi_bridge_start(b); 
     rv = vpi_blocking_testcase_run(&t); 
+    if(rv == 0) {
+        /* The echo traffic must have crossed the bridge both ways */
+        vpi_bridge_stats_get(b, &stats); 
+        if(stats.v1_to_v2.packets == 0 || stats.v2_to_v1.packets == 0) {
+            printf("%s: bridge forwarded no packets\n", testcase->description); 
+            rv = -1; 
+        }
+    }
     vpi_bridge_stop(b); 
     vpi_bridge_destroy(b); 
     return rv; 
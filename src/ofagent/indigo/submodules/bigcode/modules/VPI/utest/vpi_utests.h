@@ -54,12 +54,32 @@ typedef struct vpi_bridge_testcase_s {
 } vpi_bridge_testcase_t; 
 
 
+/**************************************************************************//**
+ *
+ * Throughput from one VPI endpoint to its peer. 
+ *
+ *
+ *****************************************************************************/
+
+typedef struct vpi_benchmark_s {
+    const char* description; 
+    const char* tx_spec; 
+    const char* rx_spec; 
+    /* Use vpi_send_batch()/vpi_recv_batch() instead of vpi_send()/vpi_recv() */
+    int batch; 
+    /* Packets the sender may have in flight, 0 for no limit */
+    int window; 
+} vpi_benchmark_t; 
+
+
 extern vpi_testcase_t vpi_testcases[]; 
 extern vpi_bridge_testcase_t vpi_bridge_testcases[]; 
+extern vpi_benchmark_t vpi_benchmarks[]; 
 
 extern int vpi_blocking_testcase_run(vpi_testcase_t* testcase); 
 extern int vpi_blocking_bridge_testcase_run(vpi_bridge_testcase_t* testcase); 
 extern int vpi_non_blocking_testcase_run(vpi_testcase_t* testcase); 
+extern int vpi_benchmark_run(vpi_benchmark_t* benchmark); 
 extern int vpi_blocking_bridge_testcase_run(vpi_bridge_testcase_t* testcase); 
 
 #endif /* __VPI_UTESTS_H__ */
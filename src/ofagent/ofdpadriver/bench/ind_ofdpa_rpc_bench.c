@@ -0,0 +1,269 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_rpc_bench.c
+*
+* @purpose      Benchmark pipelined flow adds against libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Makes a burst of flow adds through indigo_fwd_flow_create()
+*               and runs the socket manager until every one is reported
+*               done, first synchronously and then with the OF-DPA
+*               workers, and reports the flow add rate of each.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+static int benchDone;
+static int benchFailed;
+
+/* Asynchronous messages go nowhere here */
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  of_port_status_delete(of_port_status);
+}
+
+indigo_error_t indigo_core_packet_in(of_packet_in_t *packet_in)
+{
+  of_packet_in_delete(packet_in);
+  return INDIGO_ERROR_NONE;
+}
+
+void indigo_core_flow_removed(indigo_fi_flow_removed_t reason,
+                              indigo_fi_flow_stats_t *flow_stats)
+{
+}
+
+void indigo_core_flow_create_callback(indigo_error_t result, indigo_cookie_t flow_id)
+{
+  benchDone++;
+  benchFailed += (result != INDIGO_ERROR_NONE);
+}
+
+indigo_error_t indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
+{
+  of_object_delete(obj);
+  return INDIGO_ERROR_NONE;
+}
+
+static uint64_t benchNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/* An ACL flow per TCP port, so every add is new */
+static of_flow_add_t *benchFlowAddNew(uint16_t tcpDst)
+{
+  of_flow_add_t *flowAdd;
+  of_match_t match;
+
+  flowAdd = of_flow_add_new(OF_VERSION_1_3);
+  if (flowAdd == NULL)
+  {
+    fprintf(stderr, "of_flow_add_new failed\n");
+    exit(1);
+  }
+
+  memset(&match, 0, sizeof(match));
+  match.version = OF_VERSION_1_3;
+  match.fields.eth_type = ETH_P_IP;
+  OF_MATCH_MASK_ETH_TYPE_EXACT_SET(&match);
+  match.fields.ip_proto = IPPROTO_TCP;
+  OF_MATCH_MASK_IP_PROTO_EXACT_SET(&match);
+  match.fields.tcp_dst = tcpDst;
+  OF_MATCH_MASK_TCP_DST_EXACT_SET(&match);
+
+  of_flow_add_table_id_set(flowAdd, OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+  of_flow_add_priority_set(flowAdd, 1000);
+  if (of_flow_add_match_set(flowAdd, &match) < 0)
+  {
+    fprintf(stderr, "of_flow_add_match_set failed\n");
+    exit(1);
+  }
+
+  return flowAdd;
+}
+
+/* Flow adds per second, from the first create until the last is done */
+static double benchFlowAdds(of_flow_add_t **flowAdds, int count)
+{
+  indigo_fi_flow_stats_t flowStats;
+  indigo_error_t err;
+  uint64_t start, elapsed;
+  uint8_t tableId;
+  int i;
+
+  benchDone = 0;
+  benchFailed = 0;
+
+  start = benchNow();
+  for (i = 0; i < count; i++)
+  {
+    err = indigo_fwd_flow_create((indigo_cookie_t)i + 1, flowAdds[i], &tableId);
+    if (err != INDIGO_ERROR_PENDING)
+    {
+      indigo_core_flow_create_callback(err, (indigo_cookie_t)i + 1);
+    }
+  }
+  while (benchDone < count)
+  {
+    ind_soc_select_and_run(1);
+  }
+  elapsed = benchNow() - start;
+
+  if (benchFailed != 0)
+  {
+    fprintf(stderr, "%d of %d flow adds failed\n", benchFailed, count);
+    exit(1);
+  }
+
+  /* Removed, untimed, so the next run adds them again */
+  for (i = 0; i < count; i++)
+  {
+    (void)indigo_fwd_flow_delete((indigo_cookie_t)i + 1, &flowStats);
+  }
+
+  return (double)count * 1000000 / (elapsed ? elapsed : 1);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-l latency_us] [-n flows] [-w window]\n", prog);
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  static const uint32_t workerCounts[] = { 0, 1, 2, 4, 8 };
+  ind_soc_config_t socConfig = { 0 };
+  ind_ofdpa_rpc_config_t rpcConfig;
+  ind_ofdpa_rpc_counters_t counters;
+  of_flow_add_t **flowAdds;
+  const char *latency = "50";
+  int count = 2000;
+  int window = 64;
+  double rate, syncRate = 0;
+  uint32_t i;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "l:n:w:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'l': latency = optarg; break;
+      case 'n': count = atoi(optarg); break;
+      case 'w': window = atoi(optarg); break;
+      default: usage(argv[0]);
+    }
+  }
+  if ((count <= 0) || (count > 65535) || (window <= 0))
+  {
+    usage(argv[0]);
+  }
+
+  setenv("OFDPA_MOCK_LATENCY_US", latency, 1);
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+
+  if (ofdpaClientInitialize("ind_ofdpa_rpc_bench") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the socket manager\n");
+    return 1;
+  }
+  if (ind_ofdpa_table_stats_init() != INDIGO_ERROR_NONE)
+  {
+    fprintf(stderr, "Failed to read the flow tables\n");
+    return 1;
+  }
+
+  flowAdds = calloc(count, sizeof(*flowAdds));
+  if (flowAdds == NULL)
+  {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+  for (i = 0; i < (uint32_t)count; i++)
+  {
+    flowAdds[i] = benchFlowAddNew(i + 1);
+  }
+
+  printf("latency %s us, %d flow adds, window %d\n", latency, count, window);
+  printf("  %-8s %12s %8s %12s %12s\n", "workers", "adds/s", "speedup", "window full", "in flight");
+  for (i = 0; i < sizeof(workerCounts) / sizeof(workerCounts[0]); i++)
+  {
+    rpcConfig.workers = workerCounts[i];
+    rpcConfig.window = window;
+    if (ind_ofdpa_rpc_init(&rpcConfig) != INDIGO_ERROR_NONE)
+    {
+      fprintf(stderr, "Failed to start %u workers\n", workerCounts[i]);
+      return 1;
+    }
+
+    rate = benchFlowAdds(flowAdds, count);
+    if (workerCounts[i] == 0)
+    {
+      syncRate = rate;
+    }
+
+    memset(&counters, 0, sizeof(counters));
+    if (ind_ofdpa_rpc_enabled())
+    {
+      ind_ofdpa_rpc_counters_get(&counters);
+    }
+    ind_ofdpa_rpc_finish();
+
+    printf("  %-8u %12.0f %7.1fx %12llu %12u\n", workerCounts[i], rate, rate / syncRate,
+           (unsigned long long)counters.windowFull, counters.inFlightMax);
+  }
+
+  for (i = 0; i < (uint32_t)count; i++)
+  {
+    of_flow_add_delete(flowAdds[i]);
+  }
+  free(flowAdds);
+
+  ind_ofdpa_table_stats_finish();
+  ind_soc_finish();
+  return 0;
+}
@@ -0,0 +1,212 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_stats_bench.c
+*
+* @purpose      Benchmark port and queue stats requests against
+*               libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Times indigo_port_stats_get() and
+*               indigo_port_queue_stats_get() for all ports, first with
+*               the stats cache disabled and then with it refreshed by
+*               the SocketManager, and reports the OF-DPA calls each
+*               request made.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <indigo/port_manager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+/* Defined by ind_ofdpa_fwd.c, which is not linked; used by of_match.c */
+ind_ofdpa_fields_t ind_ofdpa_match_fields_bitmask;
+
+/* Port status messages go nowhere here */
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  of_port_status_delete(of_port_status);
+}
+
+typedef struct benchResult_s
+{
+  double   usec;      /* mean request latency */
+  double   calls;     /* mean OF-DPA calls per request */
+} benchResult_t;
+
+static uint64_t benchNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void benchPortStats(int iterations, benchResult_t *result)
+{
+  of_port_stats_request_t *request;
+  of_port_stats_reply_t *reply;
+  uint64_t start;
+  int i;
+
+  request = of_port_stats_request_new(OF_VERSION_1_3);
+  of_port_stats_request_port_no_set(request, OF_PORT_DEST_NONE_BY_VERSION(OF_VERSION_1_3));
+
+  ofdpaMockCallCountClear();
+  start = benchNow();
+  for (i = 0; i < iterations; i++)
+  {
+    if (indigo_port_stats_get(request, &reply) != INDIGO_ERROR_NONE)
+    {
+      fprintf(stderr, "indigo_port_stats_get failed\n");
+      exit(1);
+    }
+    of_port_stats_reply_delete(reply);
+  }
+  result->usec = (double)(benchNow() - start) / iterations;
+  result->calls = (double)ofdpaMockCallCountGet(NULL) / iterations;
+
+  of_port_stats_request_delete(request);
+}
+
+static void benchQueueStats(int iterations, benchResult_t *result)
+{
+  of_queue_stats_request_t *request;
+  of_queue_stats_reply_t *reply;
+  uint64_t start;
+  int i;
+
+  request = of_queue_stats_request_new(OF_VERSION_1_3);
+  of_queue_stats_request_port_no_set(request, OF_PORT_DEST_WILDCARD_BY_VERSION(OF_VERSION_1_3));
+  of_queue_stats_request_queue_id_set(request, OF_QUEUE_ALL_BY_VERSION(OF_VERSION_1_3));
+
+  ofdpaMockCallCountClear();
+  start = benchNow();
+  for (i = 0; i < iterations; i++)
+  {
+    if (indigo_port_queue_stats_get(request, &reply) != INDIGO_ERROR_NONE)
+    {
+      fprintf(stderr, "indigo_port_queue_stats_get failed\n");
+      exit(1);
+    }
+    of_queue_stats_reply_delete(reply);
+  }
+  result->usec = (double)(benchNow() - start) / iterations;
+  result->calls = (double)ofdpaMockCallCountGet(NULL) / iterations;
+
+  of_queue_stats_request_delete(request);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "usage: %s [-p ports] [-q queues] [-l latency_us] [-n iterations] [-i interval_ms]\n",
+          prog);
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+  ind_ofdpa_port_stats_cache_counters_t counters;
+  benchResult_t portDirect, portCached, queueDirect, queueCached;
+  const char *ports = "32";
+  const char *queues = "8";
+  const char *latency = "50";
+  int iterations = 20;
+  int intervalMs = 1000;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "p:q:l:n:i:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'p': ports = optarg; break;
+      case 'q': queues = optarg; break;
+      case 'l': latency = optarg; break;
+      case 'n': iterations = atoi(optarg); break;
+      case 'i': intervalMs = atoi(optarg); break;
+      default: usage(argv[0]);
+    }
+  }
+  if ((iterations <= 0) || (intervalMs <= 0))
+  {
+    usage(argv[0]);
+  }
+
+  /* The mock reads its shape from the environment when initialized */
+  setenv("OFDPA_MOCK_PORTS", ports, 1);
+  setenv("OFDPA_MOCK_QUEUES", queues, 1);
+  setenv("OFDPA_MOCK_LATENCY_US", latency, 1);
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+
+  if (ofdpaClientInitialize("ind_ofdpa_stats_bench") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the socket manager\n");
+    return 1;
+  }
+
+  /* Without the cache, every request goes to OF-DPA */
+  benchPortStats(iterations, &portDirect);
+  benchQueueStats(iterations, &queueDirect);
+
+  if (ind_ofdpa_port_stats_cache_init(intervalMs) != INDIGO_ERROR_NONE)
+  {
+    fprintf(stderr, "Failed to start the stats cache\n");
+    return 1;
+  }
+  do
+  {
+    ind_soc_select_and_run(10);
+    ind_ofdpa_port_stats_cache_counters_get(&counters);
+  } while (counters.refreshes == 0);
+
+  benchPortStats(iterations, &portCached);
+  benchQueueStats(iterations, &queueCached);
+  ind_ofdpa_port_stats_cache_counters_get(&counters);
+
+  printf("ports %s queues %s latency %s us\n", ports, queues, latency);
+  printf("  port stats   direct %10.1f us %6.0f calls   cached %8.1f us %6.0f calls\n",
+         portDirect.usec, portDirect.calls, portCached.usec, portCached.calls);
+  printf("  queue stats  direct %10.1f us %6.0f calls   cached %8.1f us %6.0f calls\n",
+         queueDirect.usec, queueDirect.calls, queueCached.usec, queueCached.calls);
+  printf("  refresh pass %10.1f us, %llu port hits, %llu queue hits\n",
+         (double)counters.lastRefreshUsec,
+         (unsigned long long)counters.hits, (unsigned long long)counters.queueHits);
+
+  ind_ofdpa_port_stats_cache_finish();
+  ind_soc_finish();
+  return 0;
+}
@@ -168,8 +168,177 @@ typedef enum ind_ofdpa_fields_s
 extern ind_ofdpa_fields_t ind_ofdpa_match_fields_bitmask;
 indigo_error_t indigoConvertOfdpaRv(OFDPA_ERROR_t result);
 
+indigo_error_t ind_ofdpa_flow_add_translate(uint64_t flow_id, of_flow_add_t *flow_add,
+                                            ofdpaFlowEntry_t *flow);
+
 void ind_ofdpa_port_event_receive(void);
+indigo_error_t ind_ofdpa_port_desc_cache_init(void);
+void ind_ofdpa_port_desc_cache_finish(void);
+void ind_ofdpa_port_desc_cache_remove(uint32_t port);
 void ind_ofdpa_flow_event_receive(void);
 void ind_ofdpa_pkt_receive(void);
 
+extern indTableNameList_t tableNameList[];
+extern const uint32_t tableNameListSize;
+
+typedef struct ind_ofdpa_reconcile_stats_s
+{
+  uint32_t hwFlows;           /* flows found in OF-DPA tables */
+  uint32_t tablesInSync;      /* tables whose digests matched */
+  uint32_t orphanFlows;       /* OF-DPA flows unknown to or differing from Indigo, deleted */
+  uint32_t staleFlows;        /* Indigo flows missing from or differing in OF-DPA, removed */
+  uint32_t hwGroups;          /* groups found in OF-DPA */
+  uint32_t orphanGroups;      /* OF-DPA groups unknown to Indigo, deleted */
+  uint32_t staleGroups;       /* Indigo groups missing from OF-DPA, removed */
+} ind_ofdpa_reconcile_stats_t;
+
+indigo_error_t ind_ofdpa_reconcile(ind_ofdpa_reconcile_stats_t *stats);
+
+
 
+typedef struct ind_ofdpa_port_stats_cache_counters_s
+{
+  uint64_t hits;              /* requests answered from the cache */
+  uint64_t misses;            /* requests that fetched from OF-DPA inline */
+  uint64_t refreshes;         /* completed refresh passes */
+  uint64_t refreshRpcs;       /* port and queue stats calls made by refresh */
+  uint64_t refreshErrors;     /* of those, calls that failed */
+  uint64_t refreshOverruns;   /* timer ticks skipped, pass still running */
+  uint64_t queueHits;         /* queue requests answered from the cache */
+  uint64_t queueMisses;       /* queue requests that fetched inline */
+  uint64_t numQueuesRpcs;     /* ofdpaNumQueuesGet calls, refresh or not */
+  uint64_t lastRefreshUsec;   /* duration of the last pass */
+  uint64_t totalRefreshUsec;  /* duration of all passes */
+} ind_ofdpa_port_stats_cache_counters_t;
+
+/* A refreshMs of 0 leaves the cache disabled */
+indigo_error_t ind_ofdpa_port_stats_cache_init(uint32_t refreshMs);
+void ind_ofdpa_port_stats_cache_finish(void);
+indigo_error_t ind_ofdpa_port_stats_cache_get(uint32_t port, ofdpaPortStats_t *stats,
+                                              uint32_t *ageMs);
+indigo_error_t ind_ofdpa_port_stats_cache_next_get(uint32_t port, uint32_t *nextPort);
+indigo_error_t ind_ofdpa_queue_stats_cache_num_get(uint32_t port, uint32_t *numQueues);
+indigo_error_t ind_ofdpa_queue_stats_cache_get(uint32_t port, uint32_t queueId,
+                                               ofdpaPortQueueStats_t *stats, uint32_t *ageMs);
+void ind_ofdpa_port_stats_cache_port_invalidate(uint32_t port);
+void ind_ofdpa_port_stats_cache_counters_get(ind_ofdpa_port_stats_cache_counters_t *counters);
+
+typedef struct ind_ofdpa_port_status_config_s
+{
+  uint32_t windowMs;          /* merge a port's events for this long */
+  uint32_t dampHalfLifeMs;    /* flap penalty half-life, 0 disables damping */
+} ind_ofdpa_port_status_config_t;
+
+typedef struct ind_ofdpa_port_status_counters_s
+{
+  uint64_t received;          /* OF-DPA port events */
+  uint64_t merged;            /* events folded into a pending status */
+  uint64_t suppressed;        /* state changes seen while damped */
+  uint64_t sent;              /* port status messages sent */
+  uint64_t damped;            /* times a port started being damped */
+  uint64_t dropped;           /* ports added and deleted within a window */
+} ind_ofdpa_port_status_counters_t;
+
+void ind_ofdpa_port_status_config_set(const ind_ofdpa_port_status_config_t *config);
+void ind_ofdpa_port_status_event(uint32_t port, uint32_t eventMask);
+void ind_ofdpa_port_status_flush(void);
+void ind_ofdpa_port_status_send(uint32_t port, uint8_t reason);
+void ind_ofdpa_port_status_counters_get(ind_ofdpa_port_status_counters_t *counters);
+void ind_ofdpa_port_status_finish(void);
+
+typedef struct ind_ofdpa_flow_expiry_counters_s
+{
+  uint64_t events;            /* flow expiry events read from OF-DPA */
+  uint64_t reported;          /* expired flows reported to the state manager */
+  uint64_t slices;            /* expiry task time slices */
+} ind_ofdpa_flow_expiry_counters_t;
+
+void ind_ofdpa_flow_expiry_counters_get(ind_ofdpa_flow_expiry_counters_t *counters);
+
+/* Made on a worker thread, and then done on the event loop */
+typedef void (*ind_ofdpa_rpc_call_f)(void *arg);
+typedef void (*ind_ofdpa_rpc_done_f)(void *arg);
+
+typedef struct ind_ofdpa_rpc_config_s
+{
+  uint32_t workers;           /* worker threads; 0 keeps calls synchronous */
+  uint32_t window;            /* calls queued or running at most */
+} ind_ofdpa_rpc_config_t;
+
+typedef struct ind_ofdpa_rpc_counters_s
+{
+  uint64_t submitted;         /* calls handed to the workers */
+  uint64_t completed;         /* done functions run */
+  uint64_t windowFull;        /* submits that waited for a free slot */
+  uint64_t fences;
+  uint64_t fenceWaits;        /* fences that waited for calls in flight */
+  uint32_t inFlightMax;
+} ind_ofdpa_rpc_counters_t;
+
+indigo_error_t ind_ofdpa_rpc_init(const ind_ofdpa_rpc_config_t *config);
+void ind_ofdpa_rpc_finish(void);
+int ind_ofdpa_rpc_enabled(void);
+indigo_error_t ind_ofdpa_rpc_submit(ind_ofdpa_rpc_call_f call, ind_ofdpa_rpc_done_f done, void *arg);
+void ind_ofdpa_rpc_fence(void);
+void ind_ofdpa_rpc_counters_get(ind_ofdpa_rpc_counters_t *counters);
+
+/* Experimenter messages handled by the driver */
+#define IND_OFDPA_EXPERIMENTER_ID          0x001018   /* Broadcom OUI */
+#define IND_OFDPA_EXP_TABLE_STATS_REQUEST  1
+#define IND_OFDPA_EXP_TABLE_STATS_REPLY    2
+
+typedef enum
+{
+  IND_OFDPA_FLOW_MOD_ADD,
+  IND_OFDPA_FLOW_MOD_MODIFY,
+  IND_OFDPA_FLOW_MOD_DELETE
+} ind_ofdpa_flow_mod_t;
+
+typedef struct ind_ofdpa_table_stats_s
+{
+  uint32_t numEntries;          /* flows in the table */
+  uint32_t maxEntries;          /* table capacity */
+  uint64_t flowAdds;            /* flow mods made by the agent */
+  uint64_t flowAddFailures;
+  uint64_t flowModifies;
+  uint64_t flowModifyFailures;
+  uint64_t flowDeletes;
+  uint64_t flowDeleteFailures;
+  uint64_t flowsRemoved;        /* flows expired or removed by reconcile */
+  uint64_t rpcs;                /* OF-DPA flow mod calls */
+  uint64_t rpcUsecTotal;        /* time spent in them */
+  uint64_t rpcUsecMax;
+} ind_ofdpa_table_stats_t;
+
+indigo_error_t ind_ofdpa_table_stats_init(void);
+void ind_ofdpa_table_stats_finish(void);
+indigo_error_t ind_ofdpa_table_stats_get(OFDPA_FLOW_TABLE_ID_t tableId,
+                                         ind_ofdpa_table_stats_t *stats);
+void ind_ofdpa_table_stats_flow_mod(OFDPA_FLOW_TABLE_ID_t tableId, ind_ofdpa_flow_mod_t op,
+                                    OFDPA_ERROR_t ofdpa_rv, uint64_t usec);
+void ind_ofdpa_table_stats_flow_removed(OFDPA_FLOW_TABLE_ID_t tableId);
+indigo_error_t ind_ofdpa_table_stats_encode(of_octets_t *data);
+uint64_t ind_ofdpa_stats_time_usec(void);
+
+#define IND_OFDPA_INSTRUCTION(type) (1u << (type))
+#define IND_OFDPA_ACTION(type)      (1u << (type))
+
+#define IND_OFDPA_TABLE_CAPS_NEXT_TABLES_MAX 2
+
+/* What a flow table accepts, as the flow mod translation enforces it */
+typedef struct ind_ofdpa_table_caps_s
+{
+  OFDPA_FLOW_TABLE_ID_t tableId;
+  uint32_t              match;         /* ind_ofdpa_fields_t accepted */
+  uint32_t              masked;        /* of those, taking any mask */
+  uint32_t              wildcards;     /* of those, that may be left out */
+  uint32_t              instructions;  /* IND_OFDPA_INSTRUCTION() bits */
+  uint32_t              actions;       /* IND_OFDPA_ACTION() bits */
+  uint32_t              setFields;     /* ind_ofdpa_fields_t set-field writes */
+  uint32_t              nextTableCount;
+  OFDPA_FLOW_TABLE_ID_t nextTables[IND_OFDPA_TABLE_CAPS_NEXT_TABLES_MAX];
+} ind_ofdpa_table_caps_t;
+
+const ind_ofdpa_table_caps_t *ind_ofdpa_table_caps_get(OFDPA_FLOW_TABLE_ID_t tableId);
+indigo_error_t ind_ofdpa_table_features_init(void);
+void ind_ofdpa_table_features_finish(void);
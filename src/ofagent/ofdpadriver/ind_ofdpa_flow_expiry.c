@@ -0,0 +1,191 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_flow_expiry.c
+*
+* @purpose      Time sliced processing of OF-DPA flow expiry events
+*
+* @component    OF-DPA
+*
+* @comments     A flow event notification only starts a SocketManager
+*               task. The task reads expiry events from every flow
+*               table into a queue, a batch at a time, and reports each
+*               expired flow to the state manager, yielding whenever
+*               the socket manager asks. Flow removed messages made in
+*               one slice wait in the connection output queues until
+*               the task yields, and then go out in one write per
+*               controller.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <string.h>
+#include <indigo/of_state_manager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Events read from OF-DPA before the queue is drained */
+#define IND_OFDPA_FLOW_EXPIRY_BATCH 256
+
+typedef struct ind_ofdpa_flow_expiry_event_s
+{
+  uint64_t                 cookie;
+  OFDPA_FLOW_TABLE_ID_t    tableId;
+  indigo_fi_flow_removed_t reason;
+} ind_ofdpa_flow_expiry_event_t;
+
+typedef struct ind_ofdpa_flow_expiry_s
+{
+  int      running;       /* task registered */
+  int      reading;       /* tables may still hold events */
+  uint32_t table;         /* tableNameList index being read */
+
+  ind_ofdpa_flow_expiry_event_t queue[IND_OFDPA_FLOW_EXPIRY_BATCH];
+  uint32_t head;
+  uint32_t count;
+
+  ind_ofdpa_flow_expiry_counters_t counters;
+} ind_ofdpa_flow_expiry_t;
+
+static ind_ofdpa_flow_expiry_t ind_ofdpa_flow_expiry;
+
+/* Read one event from the current table into the queue; returns 0 once
+   every table is empty */
+static int ind_ofdpa_flow_expiry_read(ind_ofdpa_flow_expiry_t *expiry)
+{
+  ofdpaFlowEvent_t flowEventData;
+  ind_ofdpa_flow_expiry_event_t *event;
+
+  while (expiry->table < tableNameListSize)
+  {
+    memset(&flowEventData, 0, sizeof(flowEventData));
+    flowEventData.flowMatch.tableId = tableNameList[expiry->table].type;
+
+    if (ofdpaFlowEventNextGet(&flowEventData) == OFDPA_E_NONE)
+    {
+      event = &expiry->queue[(expiry->head + expiry->count) % IND_OFDPA_FLOW_EXPIRY_BATCH];
+      event->cookie = flowEventData.flowMatch.cookie;
+      event->tableId = flowEventData.flowMatch.tableId;
+      if (flowEventData.eventMask & OFDPA_FLOW_EVENT_HARD_TIMEOUT)
+      {
+        LOG_INFO("Received flow event on hard timeout.");
+        event->reason = INDIGO_FLOW_REMOVED_HARD_TIMEOUT;
+      }
+      else
+      {
+        LOG_INFO("Received flow event on idle timeout.");
+        event->reason = INDIGO_FLOW_REMOVED_IDLE_TIMEOUT;
+      }
+      expiry->count++;
+      expiry->counters.events++;
+      return 1;
+    }
+    expiry->table++;
+  }
+
+  return 0;
+}
+
+static void ind_ofdpa_flow_expiry_report(ind_ofdpa_flow_expiry_t *expiry)
+{
+  ind_ofdpa_flow_expiry_event_t *event = &expiry->queue[expiry->head];
+  indigo_fi_flow_stats_t flowStats;
+
+  /* OF-DPA has already removed the flow, so its final counters are
+     gone; report them as unavailable rather than ask for them */
+  memset(&flowStats, 0, sizeof(flowStats));
+  flowStats.flow_id = event->cookie;
+  flowStats.packets = (uint64_t)-1;
+  flowStats.bytes = (uint64_t)-1;
+
+  ind_ofdpa_table_stats_flow_removed(event->tableId);
+  indigo_core_flow_removed(event->reason, &flowStats);
+
+  expiry->head = (expiry->head + 1) % IND_OFDPA_FLOW_EXPIRY_BATCH;
+  expiry->count--;
+  expiry->counters.reported++;
+}
+
+static ind_soc_task_status_t ind_ofdpa_flow_expiry_task(void *cookie)
+{
+  ind_ofdpa_flow_expiry_t *expiry = &ind_ofdpa_flow_expiry;
+
+  expiry->counters.slices++;
+
+  do
+  {
+    /* Fill the queue, then drain it */
+    if (expiry->reading && (expiry->count < IND_OFDPA_FLOW_EXPIRY_BATCH))
+    {
+      if (ind_ofdpa_flow_expiry_read(expiry))
+      {
+        continue;
+      }
+      expiry->reading = 0;
+    }
+
+    if (expiry->count == 0)
+    {
+      expiry->running = 0;
+      return IND_SOC_TASK_FINISHED;
+    }
+
+    ind_ofdpa_flow_expiry_report(expiry);
+
+    /* A drained queue is refilled from the tables */
+    if ((expiry->count == 0) && (expiry->table < tableNameListSize))
+    {
+      expiry->reading = 1;
+    }
+  } while (!ind_soc_should_yield());
+
+  return IND_SOC_TASK_CONTINUE;
+}
+
+void ind_ofdpa_flow_event_receive(void)
+{
+  ind_ofdpa_flow_expiry_t *expiry = &ind_ofdpa_flow_expiry;
+
+  LOG_TRACE("Reading Flow Events");
+
+  /* Start over from the first table; a running task picks this up */
+  expiry->reading = 1;
+  expiry->table = 0;
+
+  if (expiry->running)
+  {
+    return;
+  }
+
+  if (ind_soc_task_register(ind_ofdpa_flow_expiry_task, NULL,
+                            IND_SOC_DEFAULT_PRIORITY) != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to start flow expiry task.");
+    return;
+  }
+  expiry->running = 1;
+}
+
+void ind_ofdpa_flow_expiry_counters_get(ind_ofdpa_flow_expiry_counters_t *counters)
+{
+  *counters = ind_ofdpa_flow_expiry.counters;
+}
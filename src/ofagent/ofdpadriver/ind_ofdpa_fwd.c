@@ -35,6 +35,7 @@
 #include <indigo/forwarding.h>
 #include <ind_ofdpa_log.h>
 #include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
 #include <indigo/fi.h>
 #include <OFStateManager/ofstatemanager.h>
 #include <linux/if_ether.h>
@@ -67,6 +68,8 @@ indTableNameList_t tableNameList[] =
 
 #define TABLE_NAME_LIST_SIZE (sizeof(tableNameList)/sizeof(tableNameList[0]))
 
+const uint32_t tableNameListSize = TABLE_NAME_LIST_SIZE;
+
 static indigo_error_t ind_ofdpa_match_fields_prerequisite_validate(const of_match_t *match, OFDPA_FLOW_TABLE_ID_t tableId)
 {
   indigo_error_t err = INDIGO_ERROR_NONE;
@@ -1389,44 +1392,78 @@ indigo_error_t indigo_fwd_forwarding_features_get(of_features_reply_t *features_
 }
 
 
-indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
-                                      of_flow_add_t *flow_add,
-                                      uint8_t *table_id)
+/* A flow add made on an OF-DPA worker */
+typedef struct ind_ofdpa_flow_add_s
 {
-  indigo_error_t err = INDIGO_ERROR_NONE;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  indigo_cookie_t  flowId;
   ofdpaFlowEntry_t flow;
-  ofdpaFlowEntryStats_t  flowStats;
+  OFDPA_ERROR_t    ofdpa_rv;
+  uint64_t         usec;
+} ind_ofdpa_flow_add_t;
+
+static void ind_ofdpa_flow_add_call(void *arg)
+{
+  ind_ofdpa_flow_add_t *flowAdd = arg;
+  uint64_t start;
+
+  start = ind_ofdpa_stats_time_usec();
+  flowAdd->ofdpa_rv = ofdpaFlowAdd(&flowAdd->flow);
+  flowAdd->usec = ind_ofdpa_stats_time_usec() - start;
+}
+
+static void ind_ofdpa_flow_add_done(void *arg)
+{
+  ind_ofdpa_flow_add_t *flowAdd = arg;
+
+  ind_ofdpa_table_stats_flow_mod(flowAdd->flow.tableId, IND_OFDPA_FLOW_MOD_ADD,
+                                 flowAdd->ofdpa_rv, flowAdd->usec);
+  if (flowAdd->ofdpa_rv != OFDPA_E_NONE)
+  {
+    LOG_ERROR("Failed to add flow. (ofdpa_rv = %d)", flowAdd->ofdpa_rv);
+  }
+  else
+  {
+    LOG_INFO("Flow added successfully. (ofdpa_rv = %d)", flowAdd->ofdpa_rv);
+  }
+
+  indigo_core_flow_create_callback(indigoConvertOfdpaRv(flowAdd->ofdpa_rv), flowAdd->flowId);
+  INDIGO_MEM_FREE(flowAdd);
+}
+
+/* The OF-DPA flow entry a flow add creates */
+indigo_error_t ind_ofdpa_flow_add_translate(indigo_cookie_t flow_id,
+                                            of_flow_add_t *flow_add,
+                                            ofdpaFlowEntry_t *flow)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
   uint16_t priority;
   uint16_t idle_timeout, hard_timeout; 
+  uint8_t table_id;
   of_match_t of_match;
 
-  LOG_TRACE("Flow create called");
-
   if (flow_add->version < OF_VERSION_1_3) 
   {
     LOG_INFO("OpenFlow version 0x%x unsupported", flow_add->version);
     return INDIGO_ERROR_VERSION;
   }
 
-  memset(&flowStats, 0, sizeof(flowStats));
-  memset(&flow, 0, sizeof(flow));
+  memset(flow, 0, sizeof(*flow));
     
-  flow.cookie = flow_id;
+  flow->cookie = flow_id;
 
   /* Get the Flow Table ID */
-  of_flow_add_table_id_get(flow_add, table_id);
-  flow.tableId = (uint32_t)*table_id;
+  of_flow_add_table_id_get(flow_add, &table_id);
+  flow->tableId = (uint32_t)table_id;
 
   /* ofdpa Flow priority */
   of_flow_add_priority_get(flow_add, &priority);
-  flow.priority = (uint32_t)priority;
+  flow->priority = (uint32_t)priority;
 
   /* Get the idle time and hard time */
   (void)of_flow_modify_idle_timeout_get((of_flow_modify_t *)flow_add, &idle_timeout);
   (void)of_flow_modify_hard_timeout_get((of_flow_modify_t *)flow_add, &hard_timeout);
-  flow.idle_time = (uint32_t)idle_timeout;
-  flow.hard_time = (uint32_t)hard_timeout;
+  flow->idle_time = (uint32_t)idle_timeout;
+  flow->hard_time = (uint32_t)hard_timeout;
 
   memset(&of_match, 0, sizeof(of_match));
   ind_ofdpa_match_fields_bitmask = 0; /* Set the bit mask to 0 before being set in of_flow_add_match_get() */
@@ -1437,7 +1474,7 @@ indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
   }
 
   /* Get the match fields and masks from LOCI match structure */
-  err = ind_ofdpa_match_fields_masks_get(&of_match, &flow);
+  err = ind_ofdpa_match_fields_masks_get(&of_match, flow);
   if (err != INDIGO_ERROR_NONE)
   {
     LOG_INFO("Error getting match fields and masks. (err = %d)", err);
@@ -1445,15 +1482,59 @@ indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
   }
   
   /* Get the instructions set from the LOCI flow add object */
-  err = ind_ofdpa_instructions_get(flow_add, &flow); 
+  err = ind_ofdpa_instructions_get(flow_add, flow); 
   if (err != INDIGO_ERROR_NONE)
   {
     LOG_ERROR("Failed to get flow instructions. (err = %d)", err);
     return err; 
   }
 
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
+                                      of_flow_add_t *flow_add,
+                                      uint8_t *table_id)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  ind_ofdpa_flow_add_t *flowAdd;
+  ofdpaFlowEntry_t flow;
+  uint64_t start;
+
+  LOG_TRACE("Flow create called");
+
+  err = ind_ofdpa_flow_add_translate(flow_id, flow_add, &flow);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return err;
+  }
+  *table_id = (uint8_t)flow.tableId;
+
+  /* Hand the add to the workers; the state manager hears of it later */
+  if (ind_ofdpa_rpc_enabled())
+  {
+    flowAdd = INDIGO_MEM_ALLOC(sizeof(*flowAdd));
+    if (flowAdd != NULL)
+    {
+      flowAdd->flowId = flow_id;
+      flowAdd->flow = flow;
+      if (ind_ofdpa_rpc_submit(ind_ofdpa_flow_add_call, ind_ofdpa_flow_add_done,
+                               flowAdd) == INDIGO_ERROR_NONE)
+      {
+        return INDIGO_ERROR_PENDING;
+      }
+      INDIGO_MEM_FREE(flowAdd);
+    }
+    LOG_INFO("Failed to queue flow add; adding it synchronously.");
+    ind_ofdpa_rpc_fence();
+  }
+
   /* Submit the changes to ofdpa */
+  start = ind_ofdpa_stats_time_usec();
   ofdpa_rv = ofdpaFlowAdd(&flow);
+  ind_ofdpa_table_stats_flow_mod(flow.tableId, IND_OFDPA_FLOW_MOD_ADD, ofdpa_rv,
+                                 ind_ofdpa_stats_time_usec() - start);
   if (ofdpa_rv != OFDPA_E_NONE)
   {
     LOG_ERROR("Failed to add flow. (ofdpa_rv = %d)", ofdpa_rv);
@@ -1475,9 +1556,13 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
   ofdpaFlowEntryStats_t flowStats;
   OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;  
   of_match_t of_match;
+  uint64_t start;
 
   LOG_TRACE("Flow modify called");	
 
+  /* Wait for the add of this flow, if it is still in flight */
+  ind_ofdpa_rpc_fence();
+
   if (flow_modify->version < OF_VERSION_1_3)
   {
     LOG_ERROR("OpenFlow version 0x%x unsupported", flow_modify->version);
@@ -1528,7 +1613,10 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
   } 
 
   /* Submit the changes to ofdpa */
+  start = ind_ofdpa_stats_time_usec();
   ofdpa_rv = ofdpaFlowModify(&flow);
+  ind_ofdpa_table_stats_flow_mod(flow.tableId, IND_OFDPA_FLOW_MOD_MODIFY, ofdpa_rv,
+                                 ind_ofdpa_stats_time_usec() - start);
   if (ofdpa_rv!= OFDPA_E_NONE)
   {
     LOG_ERROR("Failed to modify flow. (ofdpa_rv = %d)", ofdpa_rv);
@@ -1547,10 +1635,14 @@ indigo_error_t indigo_fwd_flow_delete(indigo_cookie_t flow_id,
   ofdpaFlowEntry_t flow;
   ofdpaFlowEntryStats_t flowStats;
   OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  uint64_t start;
 
 
   LOG_TRACE("Flow delete called");
 
+  /* Wait for the add of this flow, if it is still in flight */
+  ind_ofdpa_rpc_fence();
+
   memset(&flow, 0, sizeof(flow));
   memset(&flowStats, 0, sizeof(flowStats));
 	
@@ -1575,7 +1667,10 @@ indigo_error_t indigo_fwd_flow_delete(indigo_cookie_t flow_id,
   flow_stats->duration_ns = (flowStats.durationSec)*(IND_OFDPA_NANO_SEC); /* Convert to nano seconds*/
 
   /* Delete the flow entry */
+  start = ind_ofdpa_stats_time_usec();
   ofdpa_rv = ofdpaFlowByCookieDelete(flow_id);
+  ind_ofdpa_table_stats_flow_mod(flow.tableId, IND_OFDPA_FLOW_MOD_DELETE, ofdpa_rv,
+                                 ind_ofdpa_stats_time_usec() - start);
   if (ofdpa_rv != OFDPA_E_NONE)
   {
     LOG_INFO("Failed to delete flow. (ofdpa_rv = %d)", ofdpa_rv);
@@ -1595,6 +1690,9 @@ indigo_error_t indigo_fwd_flow_stats_get(indigo_cookie_t flow_id,
   ofdpaFlowEntry_t flow;
   ofdpaFlowEntryStats_t flowStats;
 
+  /* The flow may still be in flight */
+  ind_ofdpa_rpc_fence();
+
   memset(&flow, 0, sizeof(flow));
   memset(&flowStats, 0, sizeof(flowStats));
 
@@ -1632,10 +1730,10 @@ indigo_error_t indigo_fwd_table_stats_get(of_table_stats_request_t *table_stats_
                                           of_table_stats_reply_t **table_stats_reply)
 {
   of_version_t version = table_stats_request->version;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  indigo_error_t err = INDIGO_ERROR_NONE;
   uint32_t xid;
   uint32_t i;
-  ofdpaFlowTableInfo_t tableInfo;
+  ind_ofdpa_table_stats_t tableStats;
   of_table_stats_entry_t entry[1];
   of_table_stats_reply_t *reply;
   
@@ -1667,27 +1765,29 @@ indigo_error_t indigo_fwd_table_stats_get(of_table_stats_request_t *table_stats_
     of_table_stats_entry_init(entry, version, -1, 1);
     (void) of_list_table_stats_entry_append_bind(list, entry);
 
-    ofdpa_rv = ofdpaFlowTableInfoGet(tableNameList[i].type, &tableInfo);
-    if (ofdpa_rv != OFDPA_E_NONE)
+    /* Kept current from flow mods; no OF-DPA call once loaded */
+    err = ind_ofdpa_table_stats_get(tableNameList[i].type, &tableStats);
+    if (err != INDIGO_ERROR_NONE)
     {
-      LOG_INFO("Error getting flow table info. (ofdpa_rv = %d)", ofdpa_rv);
-      return (indigoConvertOfdpaRv(ofdpa_rv));
+      LOG_INFO("Error getting flow table stats. (err = %d)", err);
+      of_table_stats_reply_delete(reply);
+      *table_stats_reply = NULL;
+      return err;
     }
 
     /* Table Id */
     of_table_stats_entry_table_id_set(entry, tableNameList[i].type);
 
     /* Number of entries in the table */
-    of_table_stats_entry_active_count_set(entry, tableInfo.numEntries);
-
-    /* Number of packets looked up in table. */
-    of_table_stats_entry_lookup_count_set(entry, 0);
+    of_table_stats_entry_active_count_set(entry, tableStats.numEntries);
 
-    /* Number of packets that hit table. */
-    of_table_stats_entry_matched_count_set(entry, 0);
+    /* OF-DPA does not count lookups or matches per table; counters
+       that are not available are all ones */
+    of_table_stats_entry_lookup_count_set(entry, (uint64_t)-1);
+    of_table_stats_entry_matched_count_set(entry, (uint64_t)-1);
   }
 
-  return (indigoConvertOfdpaRv(ofdpa_rv));
+  return err;
 }
 
 indigo_error_t indigo_fwd_packet_out(of_packet_out_t *packet_out)
@@ -1742,8 +1842,50 @@ indigo_error_t indigo_fwd_packet_out(of_packet_out_t *packet_out)
 indigo_error_t indigo_fwd_experimenter(of_experimenter_t *experimenter,
                                        indigo_cxn_id_t cxn_id)
 {
-  LOG_INFO("indigo_fwd_experimenter() unsupported.");
-  return INDIGO_ERROR_NOT_SUPPORTED;
+  of_experimenter_t *reply;
+  indigo_error_t err;
+  of_octets_t data;
+  uint32_t experimenterId, subtype, xid;
+
+  of_experimenter_experimenter_get(experimenter, &experimenterId);
+  of_experimenter_subtype_get(experimenter, &subtype);
+
+  if ((experimenterId != IND_OFDPA_EXPERIMENTER_ID) ||
+      (subtype != IND_OFDPA_EXP_TABLE_STATS_REQUEST))
+  {
+    LOG_INFO("indigo_fwd_experimenter() unsupported.");
+    return INDIGO_ERROR_NOT_SUPPORTED;
+  }
+
+  err = ind_ofdpa_table_stats_encode(&data);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Error encoding table stats. (err = %d)", err);
+    return err;
+  }
+
+  reply = of_experimenter_new(experimenter->version);
+  if (reply == NULL)
+  {
+    LOG_ERROR("Error allocating memory");
+    INDIGO_MEM_FREE(data.data);
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  of_experimenter_xid_get(experimenter, &xid);
+  of_experimenter_xid_set(reply, xid);
+  of_experimenter_experimenter_set(reply, IND_OFDPA_EXPERIMENTER_ID);
+  of_experimenter_subtype_set(reply, IND_OFDPA_EXP_TABLE_STATS_REPLY);
+  if (of_experimenter_data_set(reply, &data) < 0)
+  {
+    LOG_ERROR("Error setting table stats data");
+    of_experimenter_delete(reply);
+    INDIGO_MEM_FREE(data.data);
+    return INDIGO_ERROR_UNKNOWN;
+  }
+  INDIGO_MEM_FREE(data.data);
+
+  return indigo_cxn_send_controller_message(cxn_id, reply);
 }
 
 indigo_error_t indigo_fwd_expiration_enable_set(int is_enabled)
@@ -1758,33 +1900,6 @@ indigo_error_t indigo_fwd_expiration_enable_get(int *is_enabled)
   return INDIGO_ERROR_NOT_SUPPORTED;
 }
 
-void ind_ofdpa_flow_event_receive(void)
-{
-  ofdpaFlowEvent_t flowEventData;
-
-  LOG_TRACE("Reading Flow Events");
-
-  memset(&flowEventData, 0, sizeof(flowEventData));
-  flowEventData.flowMatch.tableId = OFDPA_FLOW_TABLE_ID_VLAN;
-
-  while (ofdpaFlowEventNextGet(&flowEventData) == OFDPA_E_NONE)
-  {
-    if (flowEventData.eventMask & OFDPA_FLOW_EVENT_HARD_TIMEOUT)
-    {
-      LOG_INFO("Received flow event on hard timeout.");
-      ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
-                                   INDIGO_FLOW_REMOVED_HARD_TIMEOUT);
-    }
-    else
-    {
-      LOG_INFO("Received flow event on idle timeout.");
-      ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
-                                   INDIGO_FLOW_REMOVED_IDLE_TIMEOUT);
-    }
-  }
-  return;
-}
-
 static void ind_ofdpa_key_to_match(uint32_t portNum, of_match_t *match)
 {
   memset(match, 0, sizeof(*match));
@@ -31,6 +31,8 @@
 **********************************************************************/
 
 #include <indigo/forwarding.h>
+#include <indigo/memory.h>
+#include <AIM/aim_list.h>
 #include <ind_ofdpa_util.h>
 #include <ind_ofdpa_log.h>
 
@@ -136,217 +138,507 @@ ind_ofdpa_translate_group_actions(of_list_action_t *actions,
     return INDIGO_ERROR_NONE;
 }
 
+/* Translate one OpenFlow bucket into an OF-DPA bucket entry for group_type */
 static indigo_error_t
-ind_ofdpa_translate_group_buckets(uint32_t group_id, 
-                                  of_list_bucket_t *of_buckets,
-                                  uint16_t command)
+ind_ofdpa_translate_group_bucket(uint32_t group_id,
+                                 uint32_t group_type,
+                                 of_bucket_t *of_bucket,
+                                 ofdpaGroupBucketEntry_t *group_bucket_entry)
 {
   indigo_error_t err;
-  uint16_t bucket_index = 0;
   of_list_action_t of_actions;
-  of_bucket_t of_bucket;
   ind_ofdpa_group_bucket_t group_bucket;
-  int rv;
-  uint32_t group_type;
   uint32_t group_action_bitmap = 0;
-  ofdpaGroupEntry_t group_entry;
-  ofdpaGroupBucketEntry_t group_bucket_entry;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_FAIL;
-  int group_added = 0;
 
-  OF_LIST_BUCKET_ITER(of_buckets, &of_bucket, rv) 
-  {
-    of_bucket_actions_bind(&of_bucket, &of_actions);
+  of_bucket_actions_bind(of_bucket, &of_actions);
 
-    memset(&group_bucket, 0, sizeof(group_bucket));
+  memset(&group_bucket, 0, sizeof(group_bucket));
 
-    err = ind_ofdpa_translate_group_actions(
-        &of_actions, &group_bucket, &group_action_bitmap);
-    if (err < 0) 
-    {
-      LOG_ERROR("Error in translating group actions");
-      if (group_added == 1) 
-      {
-        /* Delete the added group */
-        (void)ofdpaGroupDelete(group_id);
-      }
-      return err;
-    }
+  err = ind_ofdpa_translate_group_actions(
+      &of_actions, &group_bucket, &group_action_bitmap);
+  if (err < 0) 
+  {
+    LOG_ERROR("Error in translating group actions");
+    return err;
+  }
 
-    ofdpaGroupTypeGet(group_id, &group_type);
+  /* Zeroed so entries can be compared with memcmp */
+  memset(group_bucket_entry, 0, sizeof(*group_bucket_entry));
+  group_bucket_entry->groupId = group_id;
 
-    memset(&group_bucket_entry, 0, sizeof(group_bucket_entry));
-    group_bucket_entry.groupId = group_id;
-    group_bucket_entry.bucketIndex = bucket_index;
+  err = INDIGO_ERROR_NONE;
 
-    err = INDIGO_ERROR_NONE;
+  switch (group_type)
+  {
+    case OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE:
+      if((group_action_bitmap | IND_OFDPA_L2INTERFACE_BITMAP) != IND_OFDPA_L2INTERFACE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
+        break;
+      }
+      group_bucket_entry->bucketData.l2Interface.outputPort = group_bucket.outputPort;
+      group_bucket_entry->bucketData.l2Interface.popVlanTag = group_bucket.popVlanTag;
 
-    switch (group_type)
-    {
-      case OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE:
-        if((group_action_bitmap | IND_OFDPA_L2INTERFACE_BITMAP) != IND_OFDPA_L2INTERFACE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
-        group_bucket_entry.bucketData.l2Interface.outputPort = group_bucket.outputPort;
-        group_bucket_entry.bucketData.l2Interface.popVlanTag = group_bucket.popVlanTag;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L2_REWRITE:
+      if((group_action_bitmap | IND_OFDPA_L2REWRITE_BITMAP) != IND_OFDPA_L2REWRITE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_REWRITE:
-        if((group_action_bitmap | IND_OFDPA_L2REWRITE_BITMAP) != IND_OFDPA_L2REWRITE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l2Rewrite.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l2Rewrite.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l2Rewrite.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l2Rewrite.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l2Rewrite.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l2Rewrite.srcMac));
+      memcpy(&group_bucket_entry->bucketData.l2Rewrite.dstMac,
+             &group_bucket.dstMac, sizeof(group_bucket_entry->bucketData.l2Rewrite.dstMac));
 
-        memcpy(&group_bucket_entry.bucketData.l2Rewrite.dstMac,
-               &group_bucket.dstMac, sizeof(group_bucket_entry.bucketData.l2Rewrite.dstMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST:
+      if((group_action_bitmap | IND_OFDPA_L3UNICAST_BITMAP) != IND_OFDPA_L3UNICAST_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST:
-        if((group_action_bitmap | IND_OFDPA_L3UNICAST_BITMAP) != IND_OFDPA_L3UNICAST_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l3Unicast.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l3Unicast.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l3Unicast.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l3Unicast.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Unicast.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l3Unicast.srcMac));
+      memcpy(&group_bucket_entry->bucketData.l3Unicast.dstMac,
+             &group_bucket.dstMac, sizeof(group_bucket_entry->bucketData.l3Unicast.dstMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Unicast.dstMac,
-               &group_bucket.dstMac, sizeof(group_bucket_entry.bucketData.l3Unicast.dstMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L3_INTERFACE:
+      if((group_action_bitmap | IND_OFDPA_L3INTERFACE_BITMAP) != IND_OFDPA_L3INTERFACE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L3_INTERFACE:
-        if((group_action_bitmap | IND_OFDPA_L3INTERFACE_BITMAP) != IND_OFDPA_L3INTERFACE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l3Interface.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l3Interface.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l3Interface.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l3Interface.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Interface.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l3Interface.srcMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY:
+      if((group_action_bitmap | IND_OFDPA_L2OVERLAY_BITMAP) != IND_OFDPA_L2OVERLAY_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY:
-        if((group_action_bitmap | IND_OFDPA_L2OVERLAY_BITMAP) != IND_OFDPA_L2OVERLAY_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l2Overlay.outputPort = group_bucket.outputPort;
+      break;
 
-        group_bucket_entry.bucketData.l2Overlay.outputPort = group_bucket.outputPort;
+    case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
+      if((group_action_bitmap | IND_OFDPA_REFGROUP) != IND_OFDPA_REFGROUP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
-      case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
-      case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
-      case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
-        if((group_action_bitmap | IND_OFDPA_REFGROUP) != IND_OFDPA_REFGROUP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
-        break;
+    default:
+      err = INDIGO_ERROR_PARAM;
+      LOG_ERROR("Invalid Group Type");
+      break;
+  }
 
-      default:
-        err = INDIGO_ERROR_PARAM;
-        LOG_ERROR("Invalid Group Type");
-        break;
-    }
+  if (err == INDIGO_ERROR_COMPAT)
+  {
+    LOG_ERROR("Incompatible fields for Group Type");
+  }
 
-    if (err != INDIGO_ERROR_NONE)
+  return err;
+}
+
+/*
+ * Translate a whole OpenFlow bucket list. Bucket indexes are assigned
+ * in list order. On success *entries is allocated by this function and
+ * must be freed by the caller.
+ */
+static indigo_error_t
+ind_ofdpa_translate_group_buckets(uint32_t group_id,
+                                  uint32_t group_type,
+                                  of_list_bucket_t *of_buckets,
+                                  ofdpaGroupBucketEntry_t **entries,
+                                  uint32_t *count)
+{
+  indigo_error_t err;
+  of_bucket_t of_bucket;
+  ofdpaGroupBucketEntry_t *bucket_entries = NULL;
+  uint32_t bucket_count = 0;
+  uint32_t bucket_slots = 0;
+  int rv;
+
+  OF_LIST_BUCKET_ITER(of_buckets, &of_bucket, rv) 
+  {
+    if (bucket_count == bucket_slots)
     {
-      if (err == INDIGO_ERROR_COMPAT)
+      ofdpaGroupBucketEntry_t *tmp;
+
+      bucket_slots = bucket_slots ? bucket_slots * 2 : 8;
+      tmp = INDIGO_MEM_ALLOC(bucket_slots * sizeof(*tmp));
+      if (tmp == NULL)
+      {
+        INDIGO_MEM_FREE(bucket_entries);
+        return INDIGO_ERROR_RESOURCE;
+      }
+      if (bucket_count > 0)
       {
-        LOG_ERROR("Incompatible fields for Group Type");
+        INDIGO_MEM_COPY(tmp, bucket_entries, bucket_count * sizeof(*tmp));
       }
-      if (group_added == 1) 
+      INDIGO_MEM_FREE(bucket_entries);
+      bucket_entries = tmp;
+    }
+
+    err = ind_ofdpa_translate_group_bucket(group_id, group_type, &of_bucket,
+                                           &bucket_entries[bucket_count]);
+    if (err != INDIGO_ERROR_NONE)
+    {
+      INDIGO_MEM_FREE(bucket_entries);
+      return err;
+    }
+    bucket_entries[bucket_count].bucketIndex = bucket_count;
+    bucket_count++;
+  }
+
+  *entries = bucket_entries;
+  *count = bucket_count;
+  return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Shadow of the buckets programmed for each group
+ *
+ * OF-DPA addresses buckets by index. After an incremental modify the
+ * index of a bucket no longer matches its position in the OpenFlow
+ * bucket list, so the driver remembers what it programmed at each index
+ * in order to diff a new bucket list against it.
+ */
+
+#define IND_OFDPA_GROUP_HASH_SIZE 1024
+
+typedef struct ind_ofdpa_group_s
+{
+  list_links_t             links;
+  uint32_t                 groupId;
+  uint32_t                 groupType;
+  uint32_t                 bucketCount;
+  ofdpaGroupBucketEntry_t *buckets;
+} ind_ofdpa_group_t;
+
+static list_head_t ind_ofdpa_group_hash[IND_OFDPA_GROUP_HASH_SIZE];
+static int ind_ofdpa_group_hash_init = 0;
+
+static list_head_t *ind_ofdpa_group_hash_bucket(uint32_t group_id)
+{
+  int i;
+
+  if (!ind_ofdpa_group_hash_init)
+  {
+    for (i = 0; i < IND_OFDPA_GROUP_HASH_SIZE; i++)
+    {
+      list_init(&ind_ofdpa_group_hash[i]);
+    }
+    ind_ofdpa_group_hash_init = 1;
+  }
+
+  /* Fold the group type bits into the VLAN/port/index bits */
+  return &ind_ofdpa_group_hash[(group_id ^ (group_id >> 16) ^ (group_id >> 28)) %
+                               IND_OFDPA_GROUP_HASH_SIZE];
+}
+
+static ind_ofdpa_group_t *ind_ofdpa_group_find(uint32_t group_id)
+{
+  list_links_t *cur;
+
+  LIST_FOREACH(ind_ofdpa_group_hash_bucket(group_id), cur)
+  {
+    ind_ofdpa_group_t *group = container_of(cur, links, ind_ofdpa_group_t);
+    if (group->groupId == group_id)
+    {
+      return group;
+    }
+  }
+
+  return NULL;
+}
+
+static void ind_ofdpa_group_forget(uint32_t group_id)
+{
+  ind_ofdpa_group_t *group = ind_ofdpa_group_find(group_id);
+
+  if (group != NULL)
+  {
+    list_remove(&group->links);
+    INDIGO_MEM_FREE(group->buckets);
+    INDIGO_MEM_FREE(group);
+  }
+}
+
+/* Takes ownership of buckets */
+static void ind_ofdpa_group_remember(uint32_t group_id, uint32_t group_type,
+                                     ofdpaGroupBucketEntry_t *buckets,
+                                     uint32_t bucket_count)
+{
+  ind_ofdpa_group_t *group = ind_ofdpa_group_find(group_id);
+
+  if (group == NULL)
+  {
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL)
+    {
+      /* Next modify falls back to rewriting every bucket */
+      INDIGO_MEM_FREE(buckets);
+      return;
+    }
+    group->groupId = group_id;
+    list_push(ind_ofdpa_group_hash_bucket(group_id), &group->links);
+  }
+  else
+  {
+    INDIGO_MEM_FREE(group->buckets);
+  }
+
+  group->groupType = group_type;
+  group->buckets = buckets;
+  group->bucketCount = bucket_count;
+}
+
+static int ind_ofdpa_group_bucket_equal(ofdpaGroupBucketEntry_t *a,
+                                        ofdpaGroupBucketEntry_t *b)
+{
+  return a->referenceGroupId == b->referenceGroupId &&
+    !memcmp(&a->bucketData, &b->bucketData, sizeof(a->bucketData));
+}
+
+/* Group types whose buckets are an unordered set of references */
+static int ind_ofdpa_group_type_multi_bucket(uint32_t group_type)
+{
+  switch (group_type)
+  {
+    case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/*
+ * Whether index is taken by an old bucket not yet deleted or by a
+ * bucket already placed in new_buckets[]
+ */
+static int ind_ofdpa_group_index_in_use(ofdpaGroupBucketEntry_t *old_buckets,
+                                        uint8_t *old_used,
+                                        uint32_t old_count,
+                                        ofdpaGroupBucketEntry_t *new_buckets,
+                                        uint8_t *new_done,
+                                        uint32_t new_count,
+                                        uint32_t index)
+{
+  uint32_t i, j;
+
+  for (i = 0; i < old_count; i++)
+  {
+    if (!old_used[i] && old_buckets[i].bucketIndex == index)
+    {
+      return 1;
+    }
+  }
+  for (j = 0; j < new_count; j++)
+  {
+    if (new_done[j] && new_buckets[j].bucketIndex == index)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Bring the buckets of a group from old_buckets to new_buckets with
+ * the fewest OF-DPA calls.
+ *
+ * New buckets identical to a programmed bucket keep that bucket's
+ * index. A changed bucket with the same reference group is modified in
+ * place. Everything else is added at a free index and the leftover old
+ * buckets are deleted. Multi-bucket groups add before deleting so that
+ * an ECMP or flood group never transiently loses all of its members;
+ * single-bucket groups delete first since they only hold one bucket.
+ *
+ * On return new_buckets[] carries the index each bucket was programmed at.
+ */
+static indigo_error_t
+ind_ofdpa_group_buckets_update(uint32_t group_id, uint32_t group_type,
+                               ofdpaGroupBucketEntry_t *old_buckets,
+                               uint32_t old_count,
+                               ofdpaGroupBucketEntry_t *new_buckets,
+                               uint32_t new_count)
+{
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  uint8_t *old_used = NULL;
+  uint8_t *new_done = NULL;
+  uint32_t next_index = 0;
+  uint32_t i, j;
+  int multi = ind_ofdpa_group_type_multi_bucket(group_type);
+  int pass;
+
+  if (old_count > 0)
+  {
+    old_used = INDIGO_MEM_ALLOC(old_count);
+  }
+  if (new_count > 0)
+  {
+    new_done = INDIGO_MEM_ALLOC(new_count);
+  }
+  if ((old_count > 0 && old_used == NULL) ||
+      (new_count > 0 && new_done == NULL))
+  {
+    INDIGO_MEM_FREE(old_used);
+    INDIGO_MEM_FREE(new_done);
+    return INDIGO_ERROR_RESOURCE;
+  }
+  if (old_count > 0)
+  {
+    INDIGO_MEM_SET(old_used, 0, old_count);
+  }
+  if (new_count > 0)
+  {
+    INDIGO_MEM_SET(new_done, 0, new_count);
+  }
+
+  /* Unchanged buckets keep their index */
+  for (j = 0; j < new_count; j++)
+  {
+    for (i = 0; i < old_count; i++)
+    {
+      if (!old_used[i] &&
+          ind_ofdpa_group_bucket_equal(&old_buckets[i], &new_buckets[j]))
       {
-        /* Delete the added group */
-        (void)ofdpaGroupDelete(group_id);
+        old_used[i] = 1;
+        new_done[j] = 1;
+        new_buckets[j].bucketIndex = old_buckets[i].bucketIndex;
+        break;
       }
-      return err; 
     }
+  }
 
-    if (command == OF_GROUP_ADD) 
+  /* Changed buckets that keep their reference group are modified in place */
+  for (j = 0; j < new_count; j++)
+  {
+    if (new_done[j])
     {
-      if (bucket_index == 0)
+      continue;
+    }
+    for (i = 0; i < old_count; i++)
+    {
+      if (!old_used[i] &&
+          old_buckets[i].referenceGroupId == new_buckets[j].referenceGroupId)
       {
-        /* First Bucket; Add Group first*/
-        group_entry.groupId = group_id;
-        ofdpa_rv = ofdpaGroupAdd(&group_entry);
+        new_buckets[j].bucketIndex = old_buckets[i].bucketIndex;
+        ofdpa_rv = ofdpaGroupBucketEntryModify(&new_buckets[j]);
         if (ofdpa_rv != OFDPA_E_NONE)
         {
-          LOG_ERROR("Error in adding Group, rv=%d",ofdpa_rv);
-          break;
+          LOG_ERROR("Error in modifying Group bucket, rv=%d", ofdpa_rv);
+          goto done;
         }
-        group_added = 1;
+        old_used[i] = 1;
+        new_done[j] = 1;
+        break;
       }
     }
-    else /* OF_GROUP_MODIFY */
+  }
+
+  /*
+   * Pass 0 adds (multi-bucket) or deletes (single-bucket), pass 1 the
+   * other. Added buckets take the lowest free index, skipping those of
+   * old buckets still waiting to be deleted.
+   */
+  for (pass = 0; pass < 2; pass++)
+  {
+    if ((pass == 0) == (multi != 0))
     {
-      if (bucket_index == 0)
+      for (j = 0; j < new_count; j++)
       {
-        /* First Bucket; Delete all buckets first */
-        ofdpa_rv = ofdpaGroupBucketsDeleteAll(group_id);
+        if (new_done[j])
+        {
+          continue;
+        }
+        while (ind_ofdpa_group_index_in_use(old_buckets, old_used, old_count,
+                                            new_buckets, new_done, new_count,
+                                            next_index))
+        {
+          next_index++;
+        }
+        new_buckets[j].bucketIndex = next_index++;
+        ofdpa_rv = ofdpaGroupBucketEntryAdd(&new_buckets[j]);
         if (ofdpa_rv != OFDPA_E_NONE)
         {
-          LOG_ERROR("Error in deleting Group buckets, rv=%d",ofdpa_rv);
-          break;
+          LOG_ERROR("Error in adding Group bucket, rv=%d", ofdpa_rv);
+          goto done;
         }
+        new_done[j] = 1;
       }
     }
-
-    ofdpa_rv = ofdpaGroupBucketEntryAdd(&group_bucket_entry);
-    if (ofdpa_rv != OFDPA_E_NONE)
+    else
     {
-      LOG_ERROR("Error in adding Group bucket, rv=%d",ofdpa_rv);
-      if (group_added == 1) 
-      {
-        /* Delete the added group */
-        (void)ofdpaGroupDelete(group_id);
-      }
-      else /* OF_GROUP_MODIFY */
+      for (i = 0; i < old_count; i++)
       {
-        /* Need to clean up and delete Group here as well.
-           Will be done by the caller as the Group also needs to
-           be deleted from the Indigo database. */
+        if (old_used[i])
+        {
+          continue;
+        }
+        ofdpa_rv = ofdpaGroupBucketEntryDelete(group_id, old_buckets[i].bucketIndex);
+        if (ofdpa_rv != OFDPA_E_NONE)
+        {
+          LOG_ERROR("Error in deleting Group bucket, rv=%d", ofdpa_rv);
+          goto done;
+        }
+        old_used[i] = 1;
       }
-      break;
     }
-
-    bucket_index++;
   }
 
+done:
+  INDIGO_MEM_FREE(old_used);
+  INDIGO_MEM_FREE(new_done);
   return indigoConvertOfdpaRv(ofdpa_rv);
 }
 
 indigo_error_t indigo_fwd_group_add(uint32_t id, uint8_t group_type, of_list_bucket_t *buckets)
 {
   indigo_error_t err;
+  uint32_t ofdpa_group_type;
+  ofdpaGroupEntry_t group_entry;
+  ofdpaGroupBucketEntry_t *bucket_entries = NULL;
+  uint32_t bucket_count = 0;
+  uint32_t i;
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_FAIL;
 
   if ((group_type != OF_GROUP_TYPE_INDIRECT) &&
       (group_type != OF_GROUP_TYPE_ALL)) 
@@ -354,16 +646,120 @@ indigo_error_t indigo_fwd_group_add(uint32_t id, uint8_t group_type, of_list_buc
     return INDIGO_ERROR_NOT_SUPPORTED;
   }
 
-  err = ind_ofdpa_translate_group_buckets(id, buckets, OF_GROUP_ADD);
+  /* Flow adds in flight may refer to groups */
+  ind_ofdpa_rpc_fence();
 
-  return err;
+  ofdpaGroupTypeGet(id, &ofdpa_group_type);
+
+  err = ind_ofdpa_translate_group_buckets(id, ofdpa_group_type, buckets,
+                                          &bucket_entries, &bucket_count);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return err;
+  }
+
+  /* Buckets are validated before anything is programmed */
+  for (i = 0; i < bucket_count; i++)
+  {
+    if (i == 0)
+    {
+      /* First Bucket; Add Group first*/
+      memset(&group_entry, 0, sizeof(group_entry));
+      group_entry.groupId = id;
+      ofdpa_rv = ofdpaGroupAdd(&group_entry);
+      if (ofdpa_rv != OFDPA_E_NONE)
+      {
+        LOG_ERROR("Error in adding Group, rv=%d",ofdpa_rv);
+        break;
+      }
+    }
+
+    ofdpa_rv = ofdpaGroupBucketEntryAdd(&bucket_entries[i]);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      LOG_ERROR("Error in adding Group bucket, rv=%d",ofdpa_rv);
+      /* Delete the added group */
+      (void)ofdpaGroupDelete(id);
+      break;
+    }
+  }
+
+  if (ofdpa_rv == OFDPA_E_NONE)
+  {
+    ind_ofdpa_group_remember(id, ofdpa_group_type, bucket_entries, bucket_count);
+  }
+  else
+  {
+    INDIGO_MEM_FREE(bucket_entries);
+  }
+
+  return indigoConvertOfdpaRv(ofdpa_rv);
 }
 
 indigo_error_t indigo_fwd_group_modify(uint32_t id, of_list_bucket_t *buckets)
 {
   indigo_error_t err;
+  ind_ofdpa_group_t *group;
+  uint32_t ofdpa_group_type;
+  ofdpaGroupBucketEntry_t *bucket_entries = NULL;
+  uint32_t bucket_count = 0;
+  uint32_t i;
+  OFDPA_ERROR_t ofdpa_rv;
 
-  err = ind_ofdpa_translate_group_buckets(id, buckets, OF_GROUP_MODIFY);
+  ind_ofdpa_rpc_fence();
+
+  group = ind_ofdpa_group_find(id);
+  if (group != NULL)
+  {
+    ofdpa_group_type = group->groupType;
+  }
+  else
+  {
+    ofdpaGroupTypeGet(id, &ofdpa_group_type);
+  }
+
+  err = ind_ofdpa_translate_group_buckets(id, ofdpa_group_type, buckets,
+                                          &bucket_entries, &bucket_count);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return err;
+  }
+
+  if (group != NULL)
+  {
+    err = ind_ofdpa_group_buckets_update(id, ofdpa_group_type,
+                                         group->buckets, group->bucketCount,
+                                         bucket_entries, bucket_count);
+  }
+  else
+  {
+    /* Nothing known about the programmed buckets; rewrite them all */
+    ofdpa_rv = ofdpaGroupBucketsDeleteAll(id);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      LOG_ERROR("Error in deleting Group buckets, rv=%d",ofdpa_rv);
+    }
+    for (i = 0; i < bucket_count && ofdpa_rv == OFDPA_E_NONE; i++)
+    {
+      ofdpa_rv = ofdpaGroupBucketEntryAdd(&bucket_entries[i]);
+      if (ofdpa_rv != OFDPA_E_NONE)
+      {
+        LOG_ERROR("Error in adding Group bucket, rv=%d",ofdpa_rv);
+      }
+    }
+    err = indigoConvertOfdpaRv(ofdpa_rv);
+  }
+
+  if (err == INDIGO_ERROR_NONE)
+  {
+    ind_ofdpa_group_remember(id, ofdpa_group_type, bucket_entries, bucket_count);
+  }
+  else
+  {
+    /* Hardware state is partially updated; the caller deletes the group */
+    INDIGO_MEM_FREE(bucket_entries);
+    ind_ofdpa_group_forget(id);
+  }
 
   return err;
 }
@@ -376,9 +772,16 @@ void indigo_fwd_group_delete(uint32_t id)
 {
   OFDPA_ERROR_t ofdpa_rv;
 
+  ind_ofdpa_rpc_fence();
+
   ofdpa_rv = ofdpaGroupDelete(id);
 
   LOG_INFO("Group Delete returned %d",ofdpa_rv);
+
+  if (ofdpa_rv == OFDPA_E_NONE)
+  {
+    ind_ofdpa_group_forget(id);
+  }
   
 #ifdef OFDPA_FIXUP
   return indigoConvertOfdpaRv(ofdpa_rv);
@@ -392,6 +795,9 @@ void indigo_fwd_group_stats_get(uint32_t id, of_group_stats_entry_t *entry)
   OFDPA_ERROR_t ofdpa_rv;
   ofdpaGroupEntryStats_t groupStats;
 
+  /* The reference count includes flows still in flight */
+  ind_ofdpa_rpc_fence();
+
   memset(&groupStats, 0, sizeof(groupStats));
   ofdpa_rv = ofdpaGroupStatsGet(id, &groupStats);
 
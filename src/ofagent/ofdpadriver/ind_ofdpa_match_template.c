@@ -0,0 +1,357 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_match_template.c
+*
+* @purpose      Flow mod match validation ahead of the flow table
+*
+* @component    OF-DPA
+*
+* @comments     Each flow table's capabilities, as advertised in its
+*               table features, are compiled once into a template of
+*               field bitmaps: the fields allowed, the fields required
+*               and the fields that must be matched exactly. A flow add
+*               is checked against its table's template, and against
+*               the OpenFlow prerequisites of the fields it matches,
+*               with a few bitwise operations on a field bitmap built
+*               from the masks of the match itself. A bad match is
+*               refused before the state manager adds the flow to its
+*               table; the checks made by the flow mod translation stay
+*               in place behind this one.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stddef.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Protocol context a match establishes for the fields that need it */
+#define IND_OFDPA_MATCH_CTX_IPV4    (1u << 0)
+#define IND_OFDPA_MATCH_CTX_IPV6    (1u << 1)
+#define IND_OFDPA_MATCH_CTX_IP      (IND_OFDPA_MATCH_CTX_IPV4 | IND_OFDPA_MATCH_CTX_IPV6)
+#define IND_OFDPA_MATCH_CTX_VLAN    (1u << 2)
+#define IND_OFDPA_MATCH_CTX_TCP     (1u << 3)
+#define IND_OFDPA_MATCH_CTX_UDP     (1u << 4)
+#define IND_OFDPA_MATCH_CTX_SCTP    (1u << 5)
+#define IND_OFDPA_MATCH_CTX_ICMPV4  (1u << 6)
+#define IND_OFDPA_MATCH_CTX_ICMPV6  (1u << 7)
+
+/* Fields whose masks are inspected for tables that take them exact only */
+#define IND_OFDPA_MATCH_EXACT_CHECKED (IND_OFDPA_PORT | IND_OFDPA_ETHER_TYPE | \
+                                       IND_OFDPA_VLANID | IND_OFDPA_DSTMAC | \
+                                       IND_OFDPA_IPV4_SRC | IND_OFDPA_IPV4_DST | \
+                                       IND_OFDPA_IPV6_SRC | IND_OFDPA_IPV6_DST | \
+                                       IND_OFDPA_TUNNEL_ID)
+
+#define IND_OFDPA_MATCH_TEMPLATE_TABLES 256
+
+typedef struct ind_ofdpa_match_template_s
+{
+  uint8_t  valid;             /* table known to the driver */
+  uint32_t allowed;           /* fields the table matches on */
+  uint32_t required;          /* fields that may not be left out */
+  uint32_t exact;             /* fields that may not be masked */
+} ind_ofdpa_match_template_t;
+
+/* Fields and the context any one of which they need */
+typedef struct ind_ofdpa_match_prereq_s
+{
+  uint32_t fields;
+  uint32_t context;
+} ind_ofdpa_match_prereq_t;
+
+static const ind_ofdpa_match_prereq_t ind_ofdpa_match_prereqs[] =
+{
+  {IND_OFDPA_IPV4_SRC | IND_OFDPA_IPV4_DST,                    IND_OFDPA_MATCH_CTX_IPV4},
+  {IND_OFDPA_IPV6_SRC | IND_OFDPA_IPV6_DST |
+   IND_OFDPA_IPV6_FLOW_LABEL,                                  IND_OFDPA_MATCH_CTX_IPV6},
+  {IND_OFDPA_IP_DSCP | IND_OFDPA_IP_ECN | IND_OFDPA_IP_PROTO,  IND_OFDPA_MATCH_CTX_IP},
+  {IND_OFDPA_VLAN_PCP,                                         IND_OFDPA_MATCH_CTX_VLAN},
+  {IND_OFDPA_TCP_L4_SRC_PORT | IND_OFDPA_TCP_L4_DST_PORT,      IND_OFDPA_MATCH_CTX_TCP},
+  {IND_OFDPA_UDP_L4_SRC_PORT | IND_OFDPA_UDP_L4_DST_PORT,      IND_OFDPA_MATCH_CTX_UDP},
+  {IND_OFDPA_SCTP_L4_SRC_PORT | IND_OFDPA_SCTP_L4_DST_PORT,    IND_OFDPA_MATCH_CTX_SCTP},
+  {IND_OFDPA_ICMPV4_TYPE | IND_OFDPA_ICMPV4_CODE,              IND_OFDPA_MATCH_CTX_ICMPV4},
+  {IND_OFDPA_ICMPV6_TYPE | IND_OFDPA_ICMPV6_CODE,              IND_OFDPA_MATCH_CTX_ICMPV6}
+};
+
+#define IND_OFDPA_MATCH_PREREQS_SIZE (sizeof(ind_ofdpa_match_prereqs)/sizeof(ind_ofdpa_match_prereqs[0]))
+
+/* Where each field's mask lies in the match */
+typedef struct ind_ofdpa_match_mask_s
+{
+  uint32_t field;
+  uint16_t offset;
+  uint16_t size;
+} ind_ofdpa_match_mask_t;
+
+#define IND_OFDPA_MATCH_MASK(_field, _member) \
+  {_field, offsetof(of_match_fields_t, _member), sizeof(((of_match_fields_t *)0)->_member)}
+
+static const ind_ofdpa_match_mask_t ind_ofdpa_match_masks[] =
+{
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_PORT,             in_port),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_DSTMAC,           eth_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_SRCMAC,           eth_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_ETHER_TYPE,       eth_type),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_VLANID,           vlan_vid),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_VLAN_PCP,         vlan_pcp),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IP_DSCP,          ip_dscp),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IP_ECN,           ip_ecn),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IP_PROTO,         ip_proto),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV4_SRC,         ipv4_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV4_DST,         ipv4_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_TCP_L4_SRC_PORT,  tcp_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_TCP_L4_DST_PORT,  tcp_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_UDP_L4_SRC_PORT,  udp_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_UDP_L4_DST_PORT,  udp_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_SCTP_L4_SRC_PORT, sctp_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_SCTP_L4_DST_PORT, sctp_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_ICMPV4_TYPE,      icmpv4_type),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_ICMPV4_CODE,      icmpv4_code),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV4_ARP_SPA,     arp_spa),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV6_SRC,         ipv6_src),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV6_DST,         ipv6_dst),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_IPV6_FLOW_LABEL,  ipv6_flabel),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_ICMPV6_TYPE,      icmpv6_type),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_ICMPV6_CODE,      icmpv6_code),
+  IND_OFDPA_MATCH_MASK(IND_OFDPA_TUNNEL_ID,        tunnel_id)
+};
+
+#define IND_OFDPA_MATCH_MASKS_SIZE (sizeof(ind_ofdpa_match_masks)/sizeof(ind_ofdpa_match_masks[0]))
+
+/* All the fields that have a prerequisite */
+static uint32_t ind_ofdpa_match_prereq_fields;
+
+static ind_ofdpa_match_template_t ind_ofdpa_match_templates[IND_OFDPA_MATCH_TEMPLATE_TABLES];
+static int ind_ofdpa_match_templates_compiled;
+
+static void ind_ofdpa_match_templates_compile(void)
+{
+  const ind_ofdpa_table_caps_t *caps;
+  ind_ofdpa_match_template_t *template;
+  uint32_t i;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    caps = ind_ofdpa_table_caps_get(tableNameList[i].type);
+    if ((caps == NULL) || (caps->tableId >= IND_OFDPA_MATCH_TEMPLATE_TABLES))
+    {
+      continue;
+    }
+
+    template = &ind_ofdpa_match_templates[caps->tableId];
+    template->allowed = caps->match;
+    template->required = caps->match & ~caps->wildcards;
+    template->exact = caps->match & ~caps->masked & IND_OFDPA_MATCH_EXACT_CHECKED;
+    template->valid = 1;
+  }
+
+  for (i = 0; i < IND_OFDPA_MATCH_PREREQS_SIZE; i++)
+  {
+    ind_ofdpa_match_prereq_fields |= ind_ofdpa_match_prereqs[i].fields;
+  }
+
+  ind_ofdpa_match_templates_compiled = 1;
+}
+
+static uint32_t ind_ofdpa_match_context_get(const of_match_t *match)
+{
+  uint32_t context = 0;
+
+  switch (match->fields.eth_type)
+  {
+    case ETH_P_IP:
+      context |= IND_OFDPA_MATCH_CTX_IPV4;
+      break;
+    case ETH_P_IPV6:
+      context |= IND_OFDPA_MATCH_CTX_IPV6;
+      break;
+    default:
+      break;
+  }
+
+  switch (match->fields.ip_proto)
+  {
+    case IPPROTO_TCP:
+      context |= IND_OFDPA_MATCH_CTX_TCP;
+      break;
+    case IPPROTO_UDP:
+      context |= IND_OFDPA_MATCH_CTX_UDP;
+      break;
+    case IPPROTO_SCTP:
+      context |= IND_OFDPA_MATCH_CTX_SCTP;
+      break;
+    case IPPROTO_ICMP:
+      context |= IND_OFDPA_MATCH_CTX_ICMPV4;
+      break;
+    case IPPROTO_ICMPV6:
+      context |= IND_OFDPA_MATCH_CTX_ICMPV6;
+      break;
+    default:
+      break;
+  }
+
+  /* As in the flow mod translation, a VLAN is present when a VID is */
+  if (match->fields.vlan_vid & OFDPA_VID_EXACT_MASK)
+  {
+    context |= IND_OFDPA_MATCH_CTX_VLAN;
+  }
+
+  return context;
+}
+
+/* Fields the match does not wildcard entirely */
+static uint32_t ind_ofdpa_match_present_get(const of_match_t *match)
+{
+  const uint8_t *mask;
+  uint32_t present = 0;
+  uint32_t i, j;
+
+  for (i = 0; i < IND_OFDPA_MATCH_MASKS_SIZE; i++)
+  {
+    mask = (const uint8_t *)&match->masks + ind_ofdpa_match_masks[i].offset;
+    for (j = 0; j < ind_ofdpa_match_masks[i].size; j++)
+    {
+      if (mask[j] != 0)
+      {
+        present |= ind_ofdpa_match_masks[i].field;
+        break;
+      }
+    }
+  }
+
+  return present;
+}
+
+/* Fields among those given whose masks are not exact */
+static uint32_t ind_ofdpa_match_masked_get(const of_match_t *match, uint32_t fields)
+{
+  uint32_t masked = 0;
+
+  if ((fields & IND_OFDPA_PORT) && !OF_MATCH_MASK_IN_PORT_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_PORT;
+  }
+  if ((fields & IND_OFDPA_ETHER_TYPE) && !OF_MATCH_MASK_ETH_TYPE_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_ETHER_TYPE;
+  }
+  /* Only the present bit and the VID are matched */
+  if ((fields & IND_OFDPA_VLANID) &&
+      ((match->masks.vlan_vid & (OFDPA_VID_PRESENT | OFDPA_VID_EXACT_MASK)) !=
+       (OFDPA_VID_PRESENT | OFDPA_VID_EXACT_MASK)))
+  {
+    masked |= IND_OFDPA_VLANID;
+  }
+  if ((fields & IND_OFDPA_DSTMAC) && !OF_MATCH_MASK_ETH_DST_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_DSTMAC;
+  }
+  if ((fields & IND_OFDPA_IPV4_SRC) && !OF_MATCH_MASK_IPV4_SRC_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_IPV4_SRC;
+  }
+  if ((fields & IND_OFDPA_IPV4_DST) && !OF_MATCH_MASK_IPV4_DST_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_IPV4_DST;
+  }
+  if ((fields & IND_OFDPA_IPV6_SRC) && !OF_MATCH_MASK_IPV6_SRC_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_IPV6_SRC;
+  }
+  if ((fields & IND_OFDPA_IPV6_DST) && !OF_MATCH_MASK_IPV6_DST_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_IPV6_DST;
+  }
+  if ((fields & IND_OFDPA_TUNNEL_ID) && !OF_MATCH_MASK_TUNNEL_ID_EXACT_TEST(match))
+  {
+    masked |= IND_OFDPA_TUNNEL_ID;
+  }
+
+  return masked;
+}
+
+indigo_error_t indigo_fwd_flow_match_validate(uint8_t table_id, of_match_t *match,
+                                              uint16_t *bad_match_code)
+{
+  const ind_ofdpa_match_template_t *template;
+  uint32_t present;
+  uint32_t context;
+  uint32_t i;
+
+  if (!ind_ofdpa_match_templates_compiled)
+  {
+    ind_ofdpa_match_templates_compile();
+  }
+
+  /* Tables the driver does not know are refused by the translation */
+  template = &ind_ofdpa_match_templates[table_id];
+  if (!template->valid || (match->version < OF_VERSION_1_3))
+  {
+    return INDIGO_ERROR_NONE;
+  }
+
+  present = ind_ofdpa_match_present_get(match);
+  if (present & ~template->allowed)
+  {
+    LOG_INFO("Match fields 0x%x not supported in table %d.",
+             present & ~template->allowed, table_id);
+    *bad_match_code = OF_MATCH_FAILED_BAD_FIELD_BY_VERSION(match->version);
+    return INDIGO_ERROR_COMPAT;
+  }
+
+  if (template->required & ~present)
+  {
+    LOG_INFO("Match fields 0x%x required in table %d.",
+             template->required & ~present, table_id);
+    *bad_match_code = OF_MATCH_FAILED_BAD_WILDCARDS_BY_VERSION(match->version);
+    return INDIGO_ERROR_COMPAT;
+  }
+
+  if ((present & template->exact) &&
+      ind_ofdpa_match_masked_get(match, present & template->exact))
+  {
+    LOG_INFO("Masked match field not supported in table %d.", table_id);
+    *bad_match_code = OF_MATCH_FAILED_BAD_MASK_BY_VERSION(match->version);
+    return INDIGO_ERROR_COMPAT;
+  }
+
+  if (present & ind_ofdpa_match_prereq_fields)
+  {
+    context = ind_ofdpa_match_context_get(match);
+    for (i = 0; i < IND_OFDPA_MATCH_PREREQS_SIZE; i++)
+    {
+      if ((present & ind_ofdpa_match_prereqs[i].fields) &&
+          !(context & ind_ofdpa_match_prereqs[i].context))
+      {
+        LOG_INFO("Prerequisite missing for match fields 0x%x.",
+                 present & ind_ofdpa_match_prereqs[i].fields);
+        *bad_match_code = OF_MATCH_FAILED_BAD_PREREQ_BY_VERSION(match->version);
+        return INDIGO_ERROR_COMPAT;
+      }
+    }
+  }
+
+  return INDIGO_ERROR_NONE;
+}
@@ -35,6 +35,7 @@
 #include <ind_ofdpa_util.h>
 #include <ind_ofdpa_log.h>
 #include <indigo/error.h>
+#include <indigo/memory.h>
 #include <loci/of_match.h>
 #include <loci/loci.h>
 #include <ofdpa_api.h>
@@ -99,8 +100,9 @@ static indigo_error_t ind_ofdpa_queue_config_queue_set(of_packet_queue_t *of_pac
 
 static indigo_error_t ind_ofdpa_port_stats_set(uint32_t port, of_list_port_stats_entry_t *list)
 {
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE; 
+  indigo_error_t err = INDIGO_ERROR_NONE;
   ofdpaPortStats_t portStats;
+  uint32_t ageMs = 0;
   of_port_stats_entry_t entry[1];
 
   of_port_stats_entry_init(entry, list->version, -1, 1);
@@ -111,12 +113,13 @@ static indigo_error_t ind_ofdpa_port_stats_set(uint32_t port, of_list_port_stats
   }
 
   memset(&portStats, 0, sizeof(portStats));
-  ofdpa_rv = ofdpaPortStatsGet(port, &portStats);
-  if (ofdpa_rv != OFDPA_E_NONE)
+  err = ind_ofdpa_port_stats_cache_get(port, &portStats, &ageMs);
+  if (err != INDIGO_ERROR_NONE)
   {
     LOG_ERROR("Failed to get stats on port %d.", port);
-    return (indigoConvertOfdpaRv(ofdpa_rv));
+    return err;
   }
+  LOG_TRACE("Port %d stats are %u ms old.", port, ageMs);
 
   of_port_stats_entry_port_no_set(entry, port);
   of_port_stats_entry_rx_packets_set(entry, portStats.rx_packets);
@@ -132,7 +135,7 @@ static indigo_error_t ind_ofdpa_port_stats_set(uint32_t port, of_list_port_stats
   of_port_stats_entry_rx_crc_err_set(entry, portStats.rx_crc_err);
   of_port_stats_entry_collisions_set(entry, portStats.collisions);
 
-  return (indigoConvertOfdpaRv(ofdpa_rv));
+  return INDIGO_ERROR_NONE;
 }
 
 static indigo_error_t ind_ofdpa_queue_stats_set(of_port_no_t port, 
@@ -141,7 +144,6 @@ static indigo_error_t ind_ofdpa_queue_stats_set(of_port_no_t port,
 {
   indigo_error_t err = INDIGO_ERROR_NONE;
   ofdpaPortQueueStats_t queueStats;
-  OFDPA_ERROR_t	ofdpa_rv = OFDPA_E_NONE;
   uint32_t numQueues;
   uint32_t queueId;
   uint32_t all_queues = 0;
@@ -159,11 +161,11 @@ static indigo_error_t ind_ofdpa_queue_stats_set(of_port_no_t port,
     queueId = req_of_port_queue_id;
   }  
 
-  ofdpa_rv = ofdpaNumQueuesGet(port, &numQueues);
-  if (ofdpa_rv != OFDPA_E_NONE)
+  err = ind_ofdpa_queue_stats_cache_num_get(port, &numQueues);
+  if (err != INDIGO_ERROR_NONE)
   {
-    LOG_ERROR("Failed to get no. of port queues. (ofdpa_rv = %d)", ofdpa_rv);
-    return (indigoConvertOfdpaRv(ofdpa_rv));
+    LOG_ERROR("Failed to get no. of port queues. (err = %d)", err);
+    return err;
   }
 
   if (queueId >= numQueues)
@@ -180,11 +182,10 @@ static indigo_error_t ind_ofdpa_queue_stats_set(of_port_no_t port,
       LOG_ERROR("Too many queue stats replies.");
       return INDIGO_ERROR_RESOURCE;
     }
-    ofdpa_rv = ofdpaQueueStatsGet(port, queueId, &queueStats);
-    if (ofdpa_rv != OFDPA_E_NONE)
+    err = ind_ofdpa_queue_stats_cache_get(port, queueId, &queueStats, NULL);
+    if (err != INDIGO_ERROR_NONE)
     {
       LOG_ERROR("Failed to queue stats for port %d on queue %d.", port, queueId);
-      err = indigoConvertOfdpaRv(ofdpa_rv);
       break;
     }
     of_queue_stats_entry_port_no_set(entry, port);
@@ -261,6 +262,7 @@ static indigo_error_t ind_ofdpa_port_desc_set(of_port_no_t port, of_port_desc_t
   of_port_desc_port_no_set(of_port_desc, port);
 
   /* Port MAC */
+  memset(&mac, 0, sizeof(mac));
   ofdpa_rv = ofdpaPortMacGet(port, &mac);
   if (ofdpa_rv != OFDPA_E_NONE)
   {
@@ -325,6 +327,203 @@ static indigo_error_t ind_ofdpa_port_desc_set(of_port_no_t port, of_port_desc_t
   return INDIGO_ERROR_NONE;
 }
 
+/* Port descriptions in wire form, sorted by port. Replies copy these
+   instead of querying OF-DPA for every port; port events and port mods
+   rebuild the entry of the port they change. A deleted port is left out
+   of replies but keeps its entry until its status has been sent. */
+typedef struct ind_ofdpa_port_desc_entry_s
+{
+  uint32_t        port;
+  of_port_desc_t *desc;
+  int             deleted;
+} ind_ofdpa_port_desc_entry_t;
+
+static ind_ofdpa_port_desc_entry_t *ind_ofdpa_port_desc_cache;
+static uint32_t ind_ofdpa_port_desc_cache_count;
+static uint32_t ind_ofdpa_port_desc_cache_slots;
+static int      ind_ofdpa_port_desc_cache_valid;
+
+/* Binary search; returns the index of port or where it would be inserted */
+static uint32_t ind_ofdpa_port_desc_cache_index(uint32_t port)
+{
+  uint32_t lo = 0, hi = ind_ofdpa_port_desc_cache_count;
+
+  while (lo < hi)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+
+    if (ind_ofdpa_port_desc_cache[mid].port < port)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static of_port_desc_t *ind_ofdpa_port_desc_cache_find(uint32_t port)
+{
+  uint32_t i = ind_ofdpa_port_desc_cache_index(port);
+
+  if ((i < ind_ofdpa_port_desc_cache_count) && (ind_ofdpa_port_desc_cache[i].port == port))
+  {
+    return ind_ofdpa_port_desc_cache[i].desc;
+  }
+  return NULL;
+}
+
+/* Keep a copy of the port's description, replacing any older one */
+static indigo_error_t ind_ofdpa_port_desc_cache_store(uint32_t port, of_port_desc_t *of_port_desc)
+{
+  ind_ofdpa_port_desc_entry_t *entry;
+  of_port_desc_t *desc;
+  uint32_t i;
+
+  desc = of_object_dup(of_port_desc);
+  if (desc == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  i = ind_ofdpa_port_desc_cache_index(port);
+  if ((i < ind_ofdpa_port_desc_cache_count) && (ind_ofdpa_port_desc_cache[i].port == port))
+  {
+    of_port_desc_delete(ind_ofdpa_port_desc_cache[i].desc);
+    ind_ofdpa_port_desc_cache[i].desc = desc;
+    ind_ofdpa_port_desc_cache[i].deleted = 0;
+    return INDIGO_ERROR_NONE;
+  }
+
+  if (ind_ofdpa_port_desc_cache_count == ind_ofdpa_port_desc_cache_slots)
+  {
+    uint32_t slots = ind_ofdpa_port_desc_cache_slots ? ind_ofdpa_port_desc_cache_slots * 2 : 64;
+    ind_ofdpa_port_desc_entry_t *entries = INDIGO_MEM_ALLOC(slots * sizeof(*entries));
+
+    if (entries == NULL)
+    {
+      of_port_desc_delete(desc);
+      return INDIGO_ERROR_RESOURCE;
+    }
+    if (ind_ofdpa_port_desc_cache_count > 0)
+    {
+      INDIGO_MEM_COPY(entries, ind_ofdpa_port_desc_cache,
+                      ind_ofdpa_port_desc_cache_count * sizeof(*entries));
+    }
+    INDIGO_MEM_FREE(ind_ofdpa_port_desc_cache);
+    ind_ofdpa_port_desc_cache = entries;
+    ind_ofdpa_port_desc_cache_slots = slots;
+  }
+
+  entry = &ind_ofdpa_port_desc_cache[i];
+  if (i < ind_ofdpa_port_desc_cache_count)
+  {
+    memmove(entry + 1, entry, (ind_ofdpa_port_desc_cache_count - i) * sizeof(*entry));
+  }
+  ind_ofdpa_port_desc_cache_count++;
+
+  entry->port = port;
+  entry->desc = desc;
+  entry->deleted = 0;
+  return INDIGO_ERROR_NONE;
+}
+
+/* Leave a deleted port out of replies; its status still needs the entry */
+static void ind_ofdpa_port_desc_cache_hide(uint32_t port)
+{
+  uint32_t i = ind_ofdpa_port_desc_cache_index(port);
+
+  if ((i < ind_ofdpa_port_desc_cache_count) && (ind_ofdpa_port_desc_cache[i].port == port))
+  {
+    ind_ofdpa_port_desc_cache[i].deleted = 1;
+  }
+}
+
+void ind_ofdpa_port_desc_cache_remove(uint32_t port)
+{
+  uint32_t i = ind_ofdpa_port_desc_cache_index(port);
+
+  if ((i < ind_ofdpa_port_desc_cache_count) && (ind_ofdpa_port_desc_cache[i].port == port))
+  {
+    of_port_desc_delete(ind_ofdpa_port_desc_cache[i].desc);
+    ind_ofdpa_port_desc_cache_count--;
+    memmove(&ind_ofdpa_port_desc_cache[i], &ind_ofdpa_port_desc_cache[i + 1],
+            (ind_ofdpa_port_desc_cache_count - i) * sizeof(ind_ofdpa_port_desc_cache[0]));
+  }
+}
+
+void ind_ofdpa_port_desc_cache_finish(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < ind_ofdpa_port_desc_cache_count; i++)
+  {
+    of_port_desc_delete(ind_ofdpa_port_desc_cache[i].desc);
+  }
+  INDIGO_MEM_FREE(ind_ofdpa_port_desc_cache);
+  ind_ofdpa_port_desc_cache = NULL;
+  ind_ofdpa_port_desc_cache_count = 0;
+  ind_ofdpa_port_desc_cache_slots = 0;
+  ind_ofdpa_port_desc_cache_valid = 0;
+}
+
+/* A port missing from the cache would vanish from replies, so any
+   failure to cache a port sends all requests back to OF-DPA */
+static void ind_ofdpa_port_desc_cache_fail(uint32_t port)
+{
+  LOG_ERROR("Failed to cache description of port %d; port cache disabled.", port);
+  ind_ofdpa_port_desc_cache_finish();
+}
+
+/* Rebuild the port's cached description from OF-DPA */
+static void ind_ofdpa_port_desc_cache_update(uint32_t port)
+{
+  of_port_desc_t *of_port_desc;
+
+  if (!ind_ofdpa_port_desc_cache_valid)
+  {
+    return;
+  }
+
+  of_port_desc = of_port_desc_new(ofagent_of_version);
+  if (of_port_desc == NULL)
+  {
+    ind_ofdpa_port_desc_cache_fail(port);
+    return;
+  }
+
+  if ((ind_ofdpa_port_desc_set(port, of_port_desc) != INDIGO_ERROR_NONE) ||
+      (ind_ofdpa_port_desc_cache_store(port, of_port_desc) != INDIGO_ERROR_NONE))
+  {
+    ind_ofdpa_port_desc_cache_fail(port);
+  }
+  of_port_desc_delete(of_port_desc);
+}
+
+indigo_error_t ind_ofdpa_port_desc_cache_init(void)
+{
+  uint32_t port = 0, nextPort = 0;
+
+  ind_ofdpa_port_desc_cache_finish();
+  ind_ofdpa_port_desc_cache_valid = 1;
+
+  while (ofdpaPortNextGet(port, &nextPort) == OFDPA_E_NONE)
+  {
+    ind_ofdpa_port_desc_cache_update(nextPort);
+    if (!ind_ofdpa_port_desc_cache_valid)
+    {
+      return INDIGO_ERROR_RESOURCE;
+    }
+    port = nextPort;
+  }
+
+  LOG_INFO("Cached descriptions of %u ports.", ind_ofdpa_port_desc_cache_count);
+  return INDIGO_ERROR_NONE;
+}
+
 indigo_error_t indigo_port_features_get(of_features_reply_t *features)
 {
   indigo_error_t      err             = INDIGO_ERROR_NONE;
@@ -361,7 +560,29 @@ indigo_error_t indigo_port_features_get(of_features_reply_t *features)
     return INDIGO_ERROR_RESOURCE;
   } 
 
-  ofdpa_rv = ofdpaPortNextGet(port, &nextPort);
+  if (ind_ofdpa_port_desc_cache_valid && (features->version == ofagent_of_version))
+  {
+    uint32_t i;
+
+    for (i = 0; i < ind_ofdpa_port_desc_cache_count; i++)
+    {
+      if (ind_ofdpa_port_desc_cache[i].deleted)
+      {
+        continue;
+      }
+      if (of_list_port_desc_append(of_list_port_desc, ind_ofdpa_port_desc_cache[i].desc) < 0)
+      {
+        LOG_ERROR("of_list_port_desc_append() failed");
+        err = INDIGO_ERROR_UNKNOWN;
+        break;
+      }
+    }
+    ofdpa_rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    ofdpa_rv = ofdpaPortNextGet(port, &nextPort);
+  }
   while(ofdpa_rv == OFDPA_E_NONE) 
   {
     err = ind_ofdpa_port_features_set(nextPort, of_port_desc);
@@ -404,6 +625,28 @@ indigo_error_t indigo_port_desc_stats_get(of_port_desc_stats_reply_t *port_desc_
     return INDIGO_ERROR_VERSION;
   }
 
+  /* Copy the cached wire form of each port straight into the reply */
+  if (ind_ofdpa_port_desc_cache_valid && (port_desc_stats_reply->version == ofagent_of_version))
+  {
+    of_list_port_desc_t list;
+    uint32_t i;
+
+    of_port_desc_stats_reply_entries_bind(port_desc_stats_reply, &list);
+    for (i = 0; i < ind_ofdpa_port_desc_cache_count; i++)
+    {
+      if (ind_ofdpa_port_desc_cache[i].deleted)
+      {
+        continue;
+      }
+      if (of_list_port_desc_append(&list, ind_ofdpa_port_desc_cache[i].desc) < 0)
+      {
+        LOG_ERROR("of_list_port_desc_append() failed");
+        return INDIGO_ERROR_UNKNOWN;
+      }
+    }
+    return INDIGO_ERROR_NONE;
+  }
+
   /* Allocates memory for of_port_desc */
   of_port_desc = of_port_desc_new(port_desc_stats_reply->version);
   if (of_port_desc == NULL)
@@ -505,6 +748,8 @@ indigo_error_t indigo_port_modify(of_port_mod_t *port_mod)
     LOG_ERROR("Failed to set advertise features on port %d. (ofdpa_rv = %d)", of_port_no, ofdpa_rv);
     return (indigoConvertOfdpaRv(ofdpa_rv));
   }
+
+  ind_ofdpa_port_desc_cache_update(of_port_no);
     
   return INDIGO_ERROR_NONE;
 }
@@ -513,7 +758,6 @@ indigo_error_t indigo_port_stats_get(of_port_stats_request_t *port_stats_request
                                      of_port_stats_reply_t **port_stats_reply)
 {
   indigo_error_t err = INDIGO_ERROR_NONE;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
   of_port_no_t req_of_port_num;
   of_port_stats_reply_t *reply;
   int dump_all = 0;
@@ -545,12 +789,13 @@ indigo_error_t indigo_port_stats_get(of_port_stats_request_t *port_stats_request
   of_port_stats_request_port_no_get(port_stats_request, &req_of_port_num);
   if (req_of_port_num == OF_PORT_DEST_NONE_BY_VERSION(port_stats_request->version)) 
   {
-    ofdpa_rv = ofdpaPortNextGet(0, &port);
-    if (ofdpa_rv != OFDPA_E_NONE)
+    /* Walk the cached port list; it avoids an RPC per port */
+    err = ind_ofdpa_port_stats_cache_next_get(0, &port);
+    if (err != INDIGO_ERROR_NONE)
     {
       LOG_ERROR("Failed to get first port.");
       of_port_stats_reply_delete(*port_stats_reply);
-      return indigoConvertOfdpaRv(ofdpa_rv) ;
+      return err;
     }
 
     /* dump the stats of all the ports */
@@ -575,7 +820,7 @@ indigo_error_t indigo_port_stats_get(of_port_stats_request_t *port_stats_request
       break;
     }
 
-  }while((ofdpaPortNextGet(port, &port) == OFDPA_E_NONE));
+  }while((ind_ofdpa_port_stats_cache_next_get(port, &port) == INDIGO_ERROR_NONE));
 
   /* Free the reply message only on failure.
      Reply message is freed by the caller on success */ 
@@ -668,11 +913,10 @@ indigo_error_t indigo_port_queue_config_get(of_queue_get_config_request_t *queue
     {
       of_queue_get_config_reply_port_set(*queue_config_reply, port);
       /* Set the of_packet_queue struct elements */
-      ofdpa_rv = ofdpaNumQueuesGet(port, &numQueues);
-      if (ofdpa_rv != OFDPA_E_NONE)
+      err = ind_ofdpa_queue_stats_cache_num_get(port, &numQueues);
+      if (err != INDIGO_ERROR_NONE)
       {
-        LOG_ERROR("Error getting maximum queues supported on port %d. (ofdpa_rv = %d)", port, ofdpa_rv);
-        err = indigoConvertOfdpaRv(ofdpa_rv);
+        LOG_ERROR("Error getting maximum queues supported on port %d. (err = %d)", port, err);
         break;
       }
       for (queueId = 0; queueId < numQueues; queueId++)
@@ -713,7 +957,6 @@ indigo_error_t indigo_port_queue_stats_get(of_queue_stats_request_t *queue_stats
                                            of_queue_stats_reply_t **queue_stats_reply)
 {
   indigo_error_t err = INDIGO_ERROR_NONE;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
   of_queue_stats_reply_t *reply;
   uint32_t req_of_port_queue_id; 
   of_port_no_t req_of_port_num;
@@ -753,12 +996,12 @@ indigo_error_t indigo_port_queue_stats_get(of_queue_stats_request_t *queue_stats
   if (req_of_port_num == OF_PORT_DEST_WILDCARD_BY_VERSION(queue_stats_request->version))
   {
     /* Get the first port if the queue stats message is for all the ports*/
-    ofdpa_rv = ofdpaPortNextGet(0, &port);
-    if (ofdpa_rv != OFDPA_E_NONE)
+    err = ind_ofdpa_port_stats_cache_next_get(0, &port);
+    if (err != INDIGO_ERROR_NONE)
     {
-      LOG_ERROR("Failed to get first port. (ofdpa_rv = %d)", ofdpa_rv);
+      LOG_ERROR("Failed to get first port. (err = %d)", err);
       of_queue_stats_reply_delete(*queue_stats_reply);
-      return (indigoConvertOfdpaRv(ofdpa_rv));
+      return err;
     } 
     all_ports = 1;
   } 
@@ -782,7 +1025,7 @@ indigo_error_t indigo_port_queue_stats_get(of_queue_stats_request_t *queue_stats
       break;
     }
 
-  }while(ofdpaPortNextGet(port, &port) == OFDPA_E_NONE);
+  }while(ind_ofdpa_port_stats_cache_next_get(port, &port) == INDIGO_ERROR_NONE);
 
   /* Free the reply message only on failure.
      Reply message is freed by the caller on success */
@@ -861,67 +1104,96 @@ indigo_error_t indigo_port_packet_emit_group(uint32_t group_id,
   return INDIGO_ERROR_NOT_SUPPORTED;
 }
 
-void
-ind_ofdpa_port_event_receive(void)
+/* Build the port's description, bring the port cache up to date and
+   send one port status message to the controllers */
+void ind_ofdpa_port_status_send(uint32_t port, uint8_t reason)
 {
   of_port_desc_t   *of_port_desc   = 0;
   of_port_status_t *of_port_status = 0;
-  ofdpaPortEvent_t portEventData;
-  int reason = 0;
-
-  LOG_TRACE("Reading Port Events");
 
-  memset(&portEventData, 0, sizeof(portEventData));
-  while (ofdpaPortEventNextGet(&portEventData) == OFDPA_E_NONE)
+  /* A deleted port can no longer be queried; report what was cached */
+  if ((reason == OF_PORT_CHANGE_REASON_DELETE) &&
+      (ind_ofdpa_port_desc_cache_find(port) != NULL))
+  {
+    of_port_desc = of_object_dup(ind_ofdpa_port_desc_cache_find(port));
+    if (of_port_desc == 0)
+    {
+      LOG_ERROR("of_object_dup() failed");
+      return;
+    }
+  }
+  else
   {
-    LOG_INFO("client_event: retrieved port event: port no = %d, eventMask = 0x%x, state = %d\n",
-           portEventData.portNum, portEventData.eventMask, portEventData.state);
-
     of_port_desc = of_port_desc_new(ofagent_of_version);
     if (of_port_desc == 0) 
     {
       LOG_ERROR("of_port_desc_new() failed");
-      break;
+      return;
     }
 
-    if ((ind_ofdpa_port_desc_set(portEventData.portNum, of_port_desc)) < 0)
+    if ((ind_ofdpa_port_desc_set(port, of_port_desc)) < 0)
     {
       LOG_ERROR("ind_ofdpa_port_desc_set() failed");
-      break;
+      of_port_desc_delete(of_port_desc);
+      return;
     }
+  }
 
-    of_port_status = of_port_status_new(ofagent_of_version);
-    if (of_port_status == 0) 
-    {
-      LOG_ERROR("of_port_status_new() failed");
-      break;
-    }
+  if (reason == OF_PORT_CHANGE_REASON_DELETE)
+  {
+    ind_ofdpa_port_desc_cache_remove(port);
+  }
+  else if (ind_ofdpa_port_desc_cache_valid &&
+           (ind_ofdpa_port_desc_cache_store(port, of_port_desc) != INDIGO_ERROR_NONE))
+  {
+    ind_ofdpa_port_desc_cache_fail(port);
+  }
 
-    if (portEventData.eventMask & OFDPA_EVENT_PORT_CREATE)
-    {
-      reason = OF_PORT_CHANGE_REASON_ADD;
-    }
-    else if (portEventData.eventMask & OFDPA_EVENT_PORT_DELETE)
+  of_port_status = of_port_status_new(ofagent_of_version);
+  if (of_port_status == 0) 
+  {
+    LOG_ERROR("of_port_status_new() failed");
+    of_port_desc_delete(of_port_desc);
+    return;
+  }
+
+  of_port_status_reason_set(of_port_status, reason);
+  of_port_status_desc_set(of_port_status, of_port_desc);
+  of_port_desc_delete(of_port_desc);
+
+  indigo_core_port_status_update(of_port_status);
+}
+
+void
+ind_ofdpa_port_event_receive(void)
+{
+  ofdpaPortEvent_t portEventData;
+
+  LOG_TRACE("Reading Port Events");
+
+  memset(&portEventData, 0, sizeof(portEventData));
+  while (ofdpaPortEventNextGet(&portEventData) == OFDPA_E_NONE)
+  {
+    LOG_INFO("client_event: retrieved port event: port no = %d, eventMask = 0x%x, state = %d\n",
+           portEventData.portNum, portEventData.eventMask, portEventData.state);
+
+    ind_ofdpa_port_stats_cache_port_invalidate(portEventData.portNum);
+
+    /* Port desc replies see the change now, not when its status is sent */
+    if (portEventData.eventMask & OFDPA_EVENT_PORT_DELETE)
     {
-      reason = OF_PORT_CHANGE_REASON_DELETE;
+      ind_ofdpa_port_desc_cache_hide(portEventData.portNum);
     }
-    else if (portEventData.eventMask & OFDPA_EVENT_PORT_STATE)
+    else
     {
-      reason = OF_PORT_CHANGE_REASON_MODIFY;
+      ind_ofdpa_port_desc_cache_update(portEventData.portNum);
     }
 
-    of_port_status_reason_set(of_port_status, reason);
-    of_port_status_desc_set(of_port_status, of_port_desc);
-    of_port_desc_delete(of_port_desc);
-
-    indigo_core_port_status_update(of_port_status);
-
-    of_port_desc   = 0;     /* No longer owned */
-    of_port_status = 0;     /* No longer owned */
+    /* Merged with other events of the port and sent when its window ends */
+    ind_ofdpa_port_status_event(portEventData.portNum, portEventData.eventMask);
   }
 
-   if (of_port_desc)    of_port_desc_delete(of_port_desc);
-   if (of_port_status)  of_port_status_delete(of_port_status);
+  ind_ofdpa_port_status_flush();
   return;
 }
 
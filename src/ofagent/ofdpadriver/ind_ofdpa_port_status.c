@@ -0,0 +1,410 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_port_status.c
+*
+* @purpose      Port status coalescing and flap damping
+*
+* @component    OF-DPA
+*
+* @comments     OF-DPA port events are merged per port. The first event
+*               of a port opens a window; when it closes, one port
+*               status describing the port as it is then goes to the
+*               controllers. With damping on, each link state change
+*               adds to a per-port penalty that halves every half-life.
+*               A port whose penalty passes the suppress level sends no
+*               state changes until it decays below the reuse level.
+*               Port add and delete are never held back by damping.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <string.h>
+#include <indigo/memory.h>
+#include <indigo/time.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Flap penalties, as in BGP route flap damping */
+#define IND_OFDPA_PORT_FLAP_PENALTY     1000
+#define IND_OFDPA_PORT_FLAP_SUPPRESS    2000
+#define IND_OFDPA_PORT_FLAP_REUSE       750
+#define IND_OFDPA_PORT_FLAP_MAX         12000
+
+/* How often held ports are checked when there is no window */
+#define IND_OFDPA_PORT_DAMP_TICK_MS     100
+
+typedef struct ind_ofdpa_port_status_entry_s
+{
+  uint32_t      port;
+  uint32_t      pending;        /* OFDPA_EVENT_PORT_* since the last status */
+  uint32_t      firstChange;    /* first and last of CREATE/DELETE seen */
+  uint32_t      lastChange;
+  indigo_time_t due;            /* when the window closes */
+  uint32_t      penalty;        /* flap penalty as of penaltyTime */
+  indigo_time_t penaltyTime;
+  int           suppressed;
+} ind_ofdpa_port_status_entry_t;
+
+static ind_ofdpa_port_status_config_t ind_ofdpa_port_status_config;
+static ind_ofdpa_port_status_counters_t ind_ofdpa_port_status_counters;
+
+static ind_ofdpa_port_status_entry_t *ind_ofdpa_port_status_table;  /* sorted by port */
+static uint32_t ind_ofdpa_port_status_count;
+static uint32_t ind_ofdpa_port_status_slots;
+static int      ind_ofdpa_port_status_timer_armed;
+
+static void ind_ofdpa_port_status_timer(void *cookie);
+
+static uint32_t ind_ofdpa_port_status_index(uint32_t port)
+{
+  uint32_t lo = 0, hi = ind_ofdpa_port_status_count;
+
+  while (lo < hi)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+
+    if (ind_ofdpa_port_status_table[mid].port < port)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static ind_ofdpa_port_status_entry_t *ind_ofdpa_port_status_entry_get(uint32_t port)
+{
+  ind_ofdpa_port_status_entry_t *entry;
+  uint32_t i = ind_ofdpa_port_status_index(port);
+
+  if ((i < ind_ofdpa_port_status_count) && (ind_ofdpa_port_status_table[i].port == port))
+  {
+    return &ind_ofdpa_port_status_table[i];
+  }
+
+  if (ind_ofdpa_port_status_count == ind_ofdpa_port_status_slots)
+  {
+    uint32_t slots = ind_ofdpa_port_status_slots ? ind_ofdpa_port_status_slots * 2 : 64;
+    ind_ofdpa_port_status_entry_t *table = INDIGO_MEM_ALLOC(slots * sizeof(*table));
+
+    if (table == NULL)
+    {
+      return NULL;
+    }
+    if (ind_ofdpa_port_status_count > 0)
+    {
+      INDIGO_MEM_COPY(table, ind_ofdpa_port_status_table,
+                      ind_ofdpa_port_status_count * sizeof(*table));
+    }
+    INDIGO_MEM_FREE(ind_ofdpa_port_status_table);
+    ind_ofdpa_port_status_table = table;
+    ind_ofdpa_port_status_slots = slots;
+  }
+
+  entry = &ind_ofdpa_port_status_table[i];
+  if (i < ind_ofdpa_port_status_count)
+  {
+    memmove(entry + 1, entry, (ind_ofdpa_port_status_count - i) * sizeof(*entry));
+  }
+  ind_ofdpa_port_status_count++;
+
+  memset(entry, 0, sizeof(*entry));
+  entry->port = port;
+  return entry;
+}
+
+/* Drop the entry of a port that is gone, penalty and all */
+static void ind_ofdpa_port_status_entry_remove(uint32_t i)
+{
+  ind_ofdpa_port_status_count--;
+  memmove(&ind_ofdpa_port_status_table[i], &ind_ofdpa_port_status_table[i + 1],
+          (ind_ofdpa_port_status_count - i) * sizeof(ind_ofdpa_port_status_table[0]));
+}
+
+/* Decay the penalty to now: halve it per half-life, and approximate
+   2^-x for the part of a half-life left over by 1 - x/2 */
+static uint32_t ind_ofdpa_port_penalty_get(ind_ofdpa_port_status_entry_t *entry, indigo_time_t now)
+{
+  uint32_t halfLife = ind_ofdpa_port_status_config.dampHalfLifeMs;
+  uint64_t elapsed, halves, rest;
+  uint64_t penalty = entry->penalty;
+
+  if ((penalty == 0) || (halfLife == 0) || (now <= entry->penaltyTime))
+  {
+    return entry->penalty;
+  }
+
+  elapsed = now - entry->penaltyTime;
+  halves = elapsed / halfLife;
+  rest = elapsed % halfLife;
+
+  penalty = (halves >= 32) ? 0 : (penalty >> halves);
+  penalty -= (penalty * rest) / (2 * halfLife);
+
+  entry->penalty = (uint32_t)penalty;
+  entry->penaltyTime = now;
+  return entry->penalty;
+}
+
+/* Merged reason for the events pending on a port, or -1 if nothing
+   needs to be sent */
+static int ind_ofdpa_port_status_reason(ind_ofdpa_port_status_entry_t *entry)
+{
+  if (entry->lastChange == OFDPA_EVENT_PORT_DELETE)
+  {
+    /* A port that came and went within one window was never reported */
+    return (entry->firstChange == OFDPA_EVENT_PORT_CREATE) ? -1 : OF_PORT_CHANGE_REASON_DELETE;
+  }
+  if (entry->lastChange == OFDPA_EVENT_PORT_CREATE)
+  {
+    /* Deleted and recreated: the controller still knows the port */
+    return (entry->firstChange == OFDPA_EVENT_PORT_DELETE) ?
+      OF_PORT_CHANGE_REASON_MODIFY : OF_PORT_CHANGE_REASON_ADD;
+  }
+  return OF_PORT_CHANGE_REASON_MODIFY;
+}
+
+/* Send the port's pending status if its window is over and damping
+   allows; returns 1 if the port still has something pending, and -1
+   if the port is gone and its entry can be dropped */
+static int ind_ofdpa_port_status_entry_flush(ind_ofdpa_port_status_entry_t *entry,
+                                             indigo_time_t now, int force)
+{
+  int reason, gone;
+
+  if (entry->pending == 0)
+  {
+    return 0;
+  }
+  if (!force && (now < entry->due))
+  {
+    return 1;
+  }
+
+  if (entry->suppressed)
+  {
+    if (ind_ofdpa_port_penalty_get(entry, now) < IND_OFDPA_PORT_FLAP_REUSE)
+    {
+      LOG_INFO("Port %d no longer damped.", entry->port);
+      entry->suppressed = 0;
+    }
+    else if ((entry->lastChange == 0) && !force)
+    {
+      /* Only state changes pending; hold them */
+      return 1;
+    }
+  }
+
+  gone = (entry->lastChange == OFDPA_EVENT_PORT_DELETE);
+  reason = ind_ofdpa_port_status_reason(entry);
+  if (reason < 0)
+  {
+    ind_ofdpa_port_status_counters.dropped++;
+    ind_ofdpa_port_desc_cache_remove(entry->port);
+  }
+  else
+  {
+    ind_ofdpa_port_status_counters.sent++;
+    ind_ofdpa_port_status_send(entry->port, (uint8_t)reason);
+  }
+
+  entry->pending = 0;
+  entry->firstChange = 0;
+  entry->lastChange = 0;
+  return gone ? -1 : 0;
+}
+
+static void ind_ofdpa_port_status_timer_set(int ms)
+{
+  if (ms < 1)
+  {
+    ms = 1;
+  }
+  if (ind_soc_timer_event_register(ind_ofdpa_port_status_timer, NULL, ms) != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to register port status timer.");
+    return;
+  }
+  ind_ofdpa_port_status_timer_armed = 1;
+}
+
+/* Send what is due; rearm the timer for the next window to close */
+static void ind_ofdpa_port_status_run(void)
+{
+  indigo_time_t now = INDIGO_CURRENT_TIME;
+  indigo_time_t next = 0;
+  int held = 0;
+  uint32_t i = 0;
+  int rc;
+
+  while (i < ind_ofdpa_port_status_count)
+  {
+    ind_ofdpa_port_status_entry_t *entry = &ind_ofdpa_port_status_table[i];
+
+    rc = ind_ofdpa_port_status_entry_flush(entry, now, 0);
+    if (rc < 0)
+    {
+      ind_ofdpa_port_status_entry_remove(i);
+      continue;
+    }
+    if (rc > 0)
+    {
+      if (now < entry->due)
+      {
+        if ((next == 0) || (entry->due < next))
+        {
+          next = entry->due;
+        }
+      }
+      else
+      {
+        held = 1;
+      }
+    }
+    i++;
+  }
+
+  if (next != 0)
+  {
+    ind_ofdpa_port_status_timer_set(INDIGO_TIME_DIFF_ms(now, next));
+  }
+  else if (held)
+  {
+    ind_ofdpa_port_status_timer_set(IND_OFDPA_PORT_DAMP_TICK_MS);
+  }
+  else if (ind_ofdpa_port_status_timer_armed)
+  {
+    ind_soc_timer_event_unregister(ind_ofdpa_port_status_timer, NULL);
+    ind_ofdpa_port_status_timer_armed = 0;
+  }
+}
+
+static void ind_ofdpa_port_status_timer(void *cookie)
+{
+  ind_ofdpa_port_status_run();
+}
+
+void ind_ofdpa_port_status_event(uint32_t port, uint32_t eventMask)
+{
+  ind_ofdpa_port_status_entry_t *entry;
+  indigo_time_t now = INDIGO_CURRENT_TIME;
+  uint32_t change;
+
+  ind_ofdpa_port_status_counters.received++;
+
+  entry = ind_ofdpa_port_status_entry_get(port);
+  if (entry == NULL)
+  {
+    /* No memory to merge in; report the event on its own */
+    LOG_ERROR("Failed to allocate port status entry for port %d.", port);
+    ind_ofdpa_port_status_counters.sent++;
+    ind_ofdpa_port_status_send(port, (eventMask & OFDPA_EVENT_PORT_CREATE) ? OF_PORT_CHANGE_REASON_ADD :
+                               (eventMask & OFDPA_EVENT_PORT_DELETE) ? OF_PORT_CHANGE_REASON_DELETE :
+                               OF_PORT_CHANGE_REASON_MODIFY);
+    return;
+  }
+
+  if (entry->pending != 0)
+  {
+    ind_ofdpa_port_status_counters.merged++;
+  }
+  else
+  {
+    entry->due = now + ind_ofdpa_port_status_config.windowMs;
+  }
+  entry->pending |= eventMask;
+
+  /* One event carrying both is reported as an add, as before */
+  change = (eventMask & OFDPA_EVENT_PORT_CREATE) ? OFDPA_EVENT_PORT_CREATE :
+           (eventMask & OFDPA_EVENT_PORT_DELETE);
+  if (change != 0)
+  {
+    if (entry->firstChange == 0)
+    {
+      entry->firstChange = change;
+    }
+    entry->lastChange = change;
+  }
+
+  if ((eventMask & OFDPA_EVENT_PORT_STATE) && (ind_ofdpa_port_status_config.dampHalfLifeMs != 0))
+  {
+    uint32_t penalty = ind_ofdpa_port_penalty_get(entry, now) + IND_OFDPA_PORT_FLAP_PENALTY;
+
+    entry->penalty = (penalty > IND_OFDPA_PORT_FLAP_MAX) ? IND_OFDPA_PORT_FLAP_MAX : penalty;
+    entry->penaltyTime = now;
+
+    if (entry->suppressed)
+    {
+      ind_ofdpa_port_status_counters.suppressed++;
+    }
+    else if (entry->penalty > IND_OFDPA_PORT_FLAP_SUPPRESS)
+    {
+      LOG_INFO("Port %d is flapping; damping its status.", port);
+      entry->suppressed = 1;
+      ind_ofdpa_port_status_counters.damped++;
+      ind_ofdpa_port_status_counters.suppressed++;
+    }
+  }
+}
+
+void ind_ofdpa_port_status_flush(void)
+{
+  ind_ofdpa_port_status_run();
+}
+
+void ind_ofdpa_port_status_config_set(const ind_ofdpa_port_status_config_t *config)
+{
+  ind_ofdpa_port_status_config = *config;
+}
+
+void ind_ofdpa_port_status_counters_get(ind_ofdpa_port_status_counters_t *counters)
+{
+  *counters = ind_ofdpa_port_status_counters;
+}
+
+void ind_ofdpa_port_status_finish(void)
+{
+  indigo_time_t now = INDIGO_CURRENT_TIME;
+  uint32_t i;
+
+  /* Controllers should not be left with a stale view of any port */
+  for (i = 0; i < ind_ofdpa_port_status_count; i++)
+  {
+    ind_ofdpa_port_status_entry_flush(&ind_ofdpa_port_status_table[i], now, 1);
+  }
+
+  if (ind_ofdpa_port_status_timer_armed)
+  {
+    ind_soc_timer_event_unregister(ind_ofdpa_port_status_timer, NULL);
+    ind_ofdpa_port_status_timer_armed = 0;
+  }
+
+  INDIGO_MEM_FREE(ind_ofdpa_port_status_table);
+  ind_ofdpa_port_status_table = NULL;
+  ind_ofdpa_port_status_count = 0;
+  ind_ofdpa_port_status_slots = 0;
+}
@@ -0,0 +1,398 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_reconcile.c
+*
+* @purpose      Reconcile the Indigo flow and group tables with OF-DPA
+*
+* @component    OF-DPA
+*
+* @comments     Flows are matched by cookie, which the driver sets to
+*               the Indigo flow id when the flow is added, then by a
+*               hash of their table, priority, match and instructions.
+*               Cookie 0 is never used by Indigo and is left alone. Flow
+*               ids carry a generation picked when the agent starts, so
+*               flows an earlier run left behind never share a cookie
+*               with current ones and are deleted as orphans.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdlib.h>
+#include <murmur/murmur.h>
+#include <indigo/memory.h>
+#include <indigo/forwarding.h>
+#include <OFStateManager/ofstatemanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Passes over orphan groups; each pass frees groups referenced by the last */
+#define IND_OFDPA_RECONCILE_GROUP_PASSES 4
+
+/* A flow cookie with the hash of the flow's content, or a group id */
+typedef struct ind_ofdpa_id_s
+{
+  uint64_t id;
+  uint64_t hash;
+} ind_ofdpa_id_t;
+
+typedef struct ind_ofdpa_id_set_s
+{
+  ind_ofdpa_id_t *ids;
+  uint32_t        count;
+  uint32_t        slots;
+} ind_ofdpa_id_set_t;
+
+static indigo_error_t ind_ofdpa_id_set_add(ind_ofdpa_id_set_t *set, uint64_t id, uint64_t hash)
+{
+  if (set->count == set->slots)
+  {
+    uint32_t slots = set->slots ? set->slots * 2 : 256;
+    ind_ofdpa_id_t *ids = INDIGO_MEM_ALLOC(slots * sizeof(*ids));
+
+    if (ids == NULL)
+    {
+      return INDIGO_ERROR_RESOURCE;
+    }
+    if (set->count > 0)
+    {
+      INDIGO_MEM_COPY(ids, set->ids, set->count * sizeof(*ids));
+    }
+    INDIGO_MEM_FREE(set->ids);
+    set->ids = ids;
+    set->slots = slots;
+  }
+
+  set->ids[set->count].id = id;
+  set->ids[set->count].hash = hash;
+  set->count++;
+  return INDIGO_ERROR_NONE;
+}
+
+static int ind_ofdpa_id_compare(const void *a, const void *b)
+{
+  uint64_t x = ((const ind_ofdpa_id_t *)a)->id;
+  uint64_t y = ((const ind_ofdpa_id_t *)b)->id;
+
+  return (x > y) - (x < y);
+}
+
+static void ind_ofdpa_id_set_sort(ind_ofdpa_id_set_t *set)
+{
+  if (set->count > 1)
+  {
+    qsort(set->ids, set->count, sizeof(*set->ids), ind_ofdpa_id_compare);
+  }
+}
+
+static ind_ofdpa_id_t *ind_ofdpa_id_set_find(ind_ofdpa_id_set_t *set, uint64_t id)
+{
+  ind_ofdpa_id_t key = { id, 0 };
+
+  if (set->count == 0)
+  {
+    return NULL;
+  }
+  return bsearch(&key, set->ids, set->count, sizeof(*set->ids), ind_ofdpa_id_compare);
+}
+
+/* ind_core_present_f over a sorted set */
+static int ind_ofdpa_id_set_present(uint64_t id, void *cookie)
+{
+  return ind_ofdpa_id_set_find(cookie, id) != NULL;
+}
+
+/* ind_core_flow_present_f over a sorted set of cookies */
+static int ind_ofdpa_flow_set_present(indigo_flow_id_t id, uint64_t hash, void *cookie)
+{
+  ind_ofdpa_id_t *flow = ind_ofdpa_id_set_find(cookie, id);
+
+  return (flow != NULL) && (flow->hash == hash);
+}
+
+/* Hash of what a flow does: its table, priority, match and instructions */
+static uint64_t ind_ofdpa_flow_hash(const ofdpaFlowEntry_t *flow)
+{
+  uint32_t key[2] = { flow->tableId, flow->priority };
+  uint32_t size;
+  uint64_t hash;
+
+  switch (flow->tableId)
+  {
+    case OFDPA_FLOW_TABLE_ID_INGRESS_PORT:
+      size = sizeof(flow->flowData.ingressPortFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_VLAN:
+      size = sizeof(flow->flowData.vlanFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_TERMINATION_MAC:
+      size = sizeof(flow->flowData.terminationMacFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_BRIDGING:
+      size = sizeof(flow->flowData.bridgingFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING:
+      size = sizeof(flow->flowData.unicastRoutingFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_MULTICAST_ROUTING:
+      size = sizeof(flow->flowData.multicastRoutingFlowEntry);
+      break;
+    case OFDPA_FLOW_TABLE_ID_ACL_POLICY:
+      size = sizeof(flow->flowData.policyAclFlowEntry);
+      break;
+    default:
+      size = sizeof(flow->flowData);
+      break;
+  }
+
+  hash = murmur_hash(key, sizeof(key), 0);
+  return ((uint64_t)murmur_hash(&flow->flowData, size, hash) << 32) |
+    murmur_hash(&flow->flowData, size, ~hash);
+}
+
+/* ind_core_flow_hash_f: the flow the add would make in OF-DPA */
+static uint64_t ind_ofdpa_flow_add_hash(of_flow_add_t *flow_add)
+{
+  ofdpaFlowEntry_t flow;
+
+  if (ind_ofdpa_flow_add_translate(0, flow_add, &flow) != INDIGO_ERROR_NONE)
+  {
+    return 0;
+  }
+  return ind_ofdpa_flow_hash(&flow);
+}
+
+static void ind_ofdpa_id_set_cleanup(ind_ofdpa_id_set_t *set)
+{
+  INDIGO_MEM_FREE(set->ids);
+  memset(set, 0, sizeof(*set));
+}
+
+/*
+ * Reconcile one flow table. The OF-DPA table is walked once to build a
+ * digest of its cookies and flow contents; if it matches the Indigo
+ * digest for the table nothing else is done, otherwise only flows in
+ * the differing leaves are looked up on either side. A flow whose
+ * content differs is removed from Indigo first, so its OF-DPA copy is
+ * then deleted as an orphan.
+ */
+static indigo_error_t
+ind_ofdpa_reconcile_flow_table(OFDPA_FLOW_TABLE_ID_t tableId,
+                               ind_ofdpa_reconcile_stats_t *stats)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
+  ind_core_flow_digest_t hw_digest, sw_digest;
+  ind_ofdpa_id_set_t cookies;
+  ofdpaFlowEntry_t flow, nextFlow;
+  uint64_t leaf_mask = 0;
+  uint64_t hash;
+  uint32_t i;
+
+  memset(&hw_digest, 0, sizeof(hw_digest));
+  memset(&cookies, 0, sizeof(cookies));
+
+  ofdpaFlowEntryInit(tableId, &flow);
+  while (ofdpaFlowNextGet(&flow, &nextFlow) == OFDPA_E_NONE)
+  {
+    flow = nextFlow;
+    stats->hwFlows++;
+    if (flow.cookie == 0)
+    {
+      continue;
+    }
+    hash = ind_ofdpa_flow_hash(&flow);
+    ind_core_flow_digest_add(&hw_digest, flow.cookie, hash);
+    err = ind_ofdpa_id_set_add(&cookies, flow.cookie, hash);
+    if (err != INDIGO_ERROR_NONE)
+    {
+      goto done;
+    }
+  }
+  ind_core_flow_digest_finish(&hw_digest);
+
+  ind_core_flow_digest_get(tableId, ind_ofdpa_flow_add_hash, &sw_digest);
+
+  if (hw_digest.count == sw_digest.count && hw_digest.root == sw_digest.root)
+  {
+    LOG_TRACE("Table %d in sync, %u flows, digest 0x%llx",
+              tableId, hw_digest.count, (unsigned long long)hw_digest.root);
+    stats->tablesInSync++;
+    goto done;
+  }
+
+  for (i = 0; i < IND_CORE_FLOW_DIGEST_LEAVES; i++)
+  {
+    if (hw_digest.leaves[i] != sw_digest.leaves[i])
+    {
+      leaf_mask |= 1ULL << i;
+    }
+  }
+
+  LOG_INFO("Table %d out of sync: %u flows in OF-DPA, %u in Indigo, leaf mask 0x%llx",
+           tableId, hw_digest.count, sw_digest.count, (unsigned long long)leaf_mask);
+
+  /* Indigo flows OF-DPA no longer holds, or holds differently */
+  ind_ofdpa_id_set_sort(&cookies);
+  stats->staleFlows += ind_core_flow_reconcile(tableId, leaf_mask,
+                                               ind_ofdpa_flow_add_hash,
+                                               ind_ofdpa_flow_set_present,
+                                               &cookies);
+
+  /* OF-DPA flows the controller does not know about, as it stands */
+  for (i = 0; i < cookies.count; i++)
+  {
+    uint64_t cookie = cookies.ids[i].id;
+
+    if (!(leaf_mask & (1ULL << ind_core_flow_digest_leaf(cookie))) ||
+        ind_core_flow_id_present(cookie))
+    {
+      continue;
+    }
+    if (ofdpaFlowByCookieDelete(cookie) == OFDPA_E_NONE)
+    {
+      LOG_INFO("Deleted orphan flow, cookie 0x%llx", (unsigned long long)cookie);
+      ind_ofdpa_table_stats_flow_removed(tableId);
+      stats->orphanFlows++;
+    }
+    else
+    {
+      LOG_ERROR("Failed to delete orphan flow, cookie 0x%llx",
+                (unsigned long long)cookie);
+    }
+  }
+
+done:
+  ind_ofdpa_id_set_cleanup(&cookies);
+  return err;
+}
+
+static indigo_error_t
+ind_ofdpa_reconcile_groups(ind_ofdpa_reconcile_stats_t *stats)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
+  ind_ofdpa_id_set_t groups, orphans;
+  ofdpaGroupEntry_t nextGroup;
+  uint32_t groupId = 0;
+  uint32_t i;
+  int pass;
+
+  memset(&groups, 0, sizeof(groups));
+  memset(&orphans, 0, sizeof(orphans));
+
+  while (ofdpaGroupNextGet(groupId, &nextGroup) == OFDPA_E_NONE)
+  {
+    groupId = nextGroup.groupId;
+    stats->hwGroups++;
+    err = ind_ofdpa_id_set_add(&groups, groupId, 0);
+    if (err == INDIGO_ERROR_NONE && !ind_core_group_id_present(groupId))
+    {
+      err = ind_ofdpa_id_set_add(&orphans, groupId, 0);
+    }
+    if (err != INDIGO_ERROR_NONE)
+    {
+      goto done;
+    }
+  }
+
+  /*
+   * A group cannot be deleted while another group references it. Retry
+   * the ones refused, kept at the front of the set, until a pass makes
+   * no progress.
+   */
+  for (pass = 0; pass < IND_OFDPA_RECONCILE_GROUP_PASSES && orphans.count > 0; pass++)
+  {
+    uint32_t kept = 0;
+
+    for (i = 0; i < orphans.count; i++)
+    {
+      if (ofdpaGroupDelete((uint32_t)orphans.ids[i].id) == OFDPA_E_NONE)
+      {
+        LOG_INFO("Deleted orphan group 0x%x", (uint32_t)orphans.ids[i].id);
+      }
+      else
+      {
+        orphans.ids[kept++] = orphans.ids[i];
+      }
+    }
+    stats->orphanGroups += orphans.count - kept;
+    if (kept == orphans.count)
+    {
+      break;
+    }
+    orphans.count = kept;
+  }
+  if (orphans.count > 0)
+  {
+    LOG_ERROR("%u orphan groups could not be deleted", orphans.count);
+  }
+
+  ind_ofdpa_id_set_sort(&groups);
+  stats->staleGroups += ind_core_group_reconcile(ind_ofdpa_id_set_present, &groups);
+
+done:
+  ind_ofdpa_id_set_cleanup(&groups);
+  ind_ofdpa_id_set_cleanup(&orphans);
+  return err;
+}
+
+/*
+ * Bring the Indigo flow and group tables and OF-DPA into agreement.
+ *
+ * Orphan flows are deleted before orphan groups since they may reference
+ * them. Stale Indigo entries are dropped without touching OF-DPA, with a
+ * flow-removed message for flows that asked for one, so the controller
+ * only has to re-push what is actually missing.
+ */
+indigo_error_t ind_ofdpa_reconcile(ind_ofdpa_reconcile_stats_t *stats)
+{
+  indigo_error_t err;
+  uint32_t i;
+
+  /* Compare against OF-DPA once every queued flow add is made and reported */
+  ind_ofdpa_rpc_fence();
+
+  memset(stats, 0, sizeof(*stats));
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    err = ind_ofdpa_reconcile_flow_table(tableNameList[i].type, stats);
+    if (err != INDIGO_ERROR_NONE)
+    {
+      LOG_ERROR("Failed to reconcile table %s", tableNameList[i].name);
+      return err;
+    }
+  }
+
+  err = ind_ofdpa_reconcile_groups(stats);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to reconcile groups");
+    return err;
+  }
+
+  LOG_INFO("Reconciled %u flows (%u of %u tables in sync, %u orphan, %u stale), "
+           "%u groups (%u orphan, %u stale)",
+           stats->hwFlows, stats->tablesInSync, tableNameListSize,
+           stats->orphanFlows, stats->staleFlows,
+           stats->hwGroups, stats->orphanGroups, stats->staleGroups);
+
+  return INDIGO_ERROR_NONE;
+}
@@ -0,0 +1,373 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_rpc.c
+*
+* @purpose      Pipelined OF-DPA calls on a pool of worker threads
+*
+* @component    OF-DPA
+*
+* @comments     A submitted call is queued to the workers, which make the
+*               blocking OF-DPA call and queue the call as done. An
+*               eventfd registered with the socket manager then runs its
+*               done function on the event loop, in the order the calls
+*               finished. At most window calls are queued or running;
+*               a submit beyond that waits for a worker to finish one.
+*
+*               Calls that must see the result of earlier ones, such as
+*               a flow modify after a flow add, fence first: the fence
+*               waits until every call submitted has been made, then runs
+*               their done functions, so the errors of earlier flow adds
+*               reach the controller ahead of anything the caller sends.
+*               Callers walking the flow table skip the flows whose adds
+*               are still pending, the only ones a done function removes.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <indigo/memory.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+#define IND_OFDPA_RPC_WORKERS_MAX 64
+
+typedef struct ind_ofdpa_rpc_op_s
+{
+  struct ind_ofdpa_rpc_op_s *next;
+  ind_ofdpa_rpc_call_f       call;
+  ind_ofdpa_rpc_done_f       done;
+  void                      *arg;
+} ind_ofdpa_rpc_op_t;
+
+typedef struct ind_ofdpa_rpc_queue_s
+{
+  ind_ofdpa_rpc_op_t *head;
+  ind_ofdpa_rpc_op_t *tail;
+} ind_ofdpa_rpc_queue_t;
+
+typedef struct ind_ofdpa_rpc_s
+{
+  int                    running;
+  int                    stopping;
+  int                    eventFd;
+  uint32_t               window;
+  uint32_t               workerCount;
+  pthread_t              workers[IND_OFDPA_RPC_WORKERS_MAX];
+
+  pthread_mutex_t        lock;
+  pthread_cond_t         work;       /* a call was queued, or stopping */
+  pthread_cond_t         slot;       /* a call was made */
+  ind_ofdpa_rpc_queue_t  pending;    /* waiting for a worker */
+  ind_ofdpa_rpc_queue_t  done;       /* waiting for the event loop */
+  uint32_t               inFlight;   /* submitted and not yet made */
+
+  ind_ofdpa_rpc_counters_t counters;
+} ind_ofdpa_rpc_t;
+
+static ind_ofdpa_rpc_t ind_ofdpa_rpc =
+{
+  .eventFd = -1,
+  .lock    = PTHREAD_MUTEX_INITIALIZER,
+  .work    = PTHREAD_COND_INITIALIZER,
+  .slot    = PTHREAD_COND_INITIALIZER,
+};
+
+static void ind_ofdpa_rpc_queue_push(ind_ofdpa_rpc_queue_t *queue, ind_ofdpa_rpc_op_t *op)
+{
+  op->next = NULL;
+  if (queue->tail != NULL)
+  {
+    queue->tail->next = op;
+  }
+  else
+  {
+    queue->head = op;
+  }
+  queue->tail = op;
+}
+
+static ind_ofdpa_rpc_op_t *ind_ofdpa_rpc_queue_pop(ind_ofdpa_rpc_queue_t *queue)
+{
+  ind_ofdpa_rpc_op_t *op = queue->head;
+
+  if (op != NULL)
+  {
+    queue->head = op->next;
+    if (queue->head == NULL)
+    {
+      queue->tail = NULL;
+    }
+  }
+  return op;
+}
+
+static void *ind_ofdpa_rpc_worker(void *cookie)
+{
+  ind_ofdpa_rpc_t *rpc = cookie;
+  ind_ofdpa_rpc_op_t *op;
+  uint64_t one = 1;
+
+  pthread_mutex_lock(&rpc->lock);
+  for (;;)
+  {
+    while (!rpc->stopping && (rpc->pending.head == NULL))
+    {
+      pthread_cond_wait(&rpc->work, &rpc->lock);
+    }
+
+    /* Queued calls are still made when stopping */
+    op = ind_ofdpa_rpc_queue_pop(&rpc->pending);
+    if (op == NULL)
+    {
+      break;
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    op->call(op->arg);
+
+    pthread_mutex_lock(&rpc->lock);
+    ind_ofdpa_rpc_queue_push(&rpc->done, op);
+    rpc->inFlight--;
+    pthread_cond_broadcast(&rpc->slot);
+
+    if (write(rpc->eventFd, &one, sizeof(one)) < 0)
+    {
+      /* The counter only fails to overflow; the event is already pending */
+    }
+  }
+  pthread_mutex_unlock(&rpc->lock);
+
+  return NULL;
+}
+
+/* Run the done functions of the calls made so far */
+static void ind_ofdpa_rpc_deliver(ind_ofdpa_rpc_t *rpc)
+{
+  ind_ofdpa_rpc_queue_t done;
+  ind_ofdpa_rpc_op_t *op;
+
+  pthread_mutex_lock(&rpc->lock);
+  done = rpc->done;
+  memset(&rpc->done, 0, sizeof(rpc->done));
+  pthread_mutex_unlock(&rpc->lock);
+
+  while ((op = ind_ofdpa_rpc_queue_pop(&done)) != NULL)
+  {
+    op->done(op->arg);
+    rpc->counters.completed++;
+    INDIGO_MEM_FREE(op);
+  }
+}
+
+static void ind_ofdpa_rpc_event_ready(int socket_id, void *cookie,
+                                      int read_ready, int write_ready, int error_seen)
+{
+  ind_ofdpa_rpc_t *rpc = cookie;
+  uint64_t count;
+
+  if (read(rpc->eventFd, &count, sizeof(count)) < 0)
+  {
+    if (errno != EAGAIN)
+    {
+      LOG_ERROR("Failed to read OF-DPA call completions. (errno = %d)", errno);
+    }
+  }
+
+  ind_ofdpa_rpc_deliver(rpc);
+}
+
+indigo_error_t ind_ofdpa_rpc_init(const ind_ofdpa_rpc_config_t *config)
+{
+  ind_ofdpa_rpc_t *rpc = &ind_ofdpa_rpc;
+  uint32_t i;
+  int rc;
+
+  if (rpc->running)
+  {
+    return INDIGO_ERROR_NONE;
+  }
+
+  /* No workers keeps every call synchronous */
+  if ((config->workers == 0) || (config->window == 0))
+  {
+    LOG_INFO("OF-DPA calls are synchronous");
+    return INDIGO_ERROR_NONE;
+  }
+  if (config->workers > IND_OFDPA_RPC_WORKERS_MAX)
+  {
+    LOG_ERROR("Too many OF-DPA workers: %u (max %u)",
+              config->workers, IND_OFDPA_RPC_WORKERS_MAX);
+    return INDIGO_ERROR_PARAM;
+  }
+
+  rpc->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (rpc->eventFd < 0)
+  {
+    LOG_ERROR("Failed to allocate eventfd. (errno = %d)", errno);
+    return INDIGO_ERROR_RESOURCE;
+  }
+  if (ind_soc_socket_register(rpc->eventFd, ind_ofdpa_rpc_event_ready, rpc) != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to register OF-DPA completion eventfd.");
+    close(rpc->eventFd);
+    rpc->eventFd = -1;
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  memset(&rpc->counters, 0, sizeof(rpc->counters));
+  rpc->stopping = 0;
+  rpc->window = config->window;
+  rpc->workerCount = 0;
+  for (i = 0; i < config->workers; i++)
+  {
+    rc = pthread_create(&rpc->workers[i], NULL, ind_ofdpa_rpc_worker, rpc);
+    if (rc != 0)
+    {
+      LOG_ERROR("Failed to start OF-DPA worker %u. (rc = %d)", i, rc);
+      break;
+    }
+    rpc->workerCount++;
+  }
+  rpc->running = 1;
+
+  if (rpc->workerCount == 0)
+  {
+    ind_ofdpa_rpc_finish();
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  LOG_INFO("OF-DPA calls pipelined on %u workers, window %u",
+           rpc->workerCount, rpc->window);
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_rpc_finish(void)
+{
+  ind_ofdpa_rpc_t *rpc = &ind_ofdpa_rpc;
+  uint32_t i;
+
+  if (!rpc->running)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&rpc->lock);
+  rpc->stopping = 1;
+  pthread_cond_broadcast(&rpc->work);
+  pthread_mutex_unlock(&rpc->lock);
+
+  for (i = 0; i < rpc->workerCount; i++)
+  {
+    pthread_join(rpc->workers[i], NULL);
+  }
+  rpc->workerCount = 0;
+  rpc->running = 0;
+
+  /* Every call has been made; report the last of them */
+  ind_ofdpa_rpc_deliver(rpc);
+
+  ind_soc_socket_unregister(rpc->eventFd);
+  close(rpc->eventFd);
+  rpc->eventFd = -1;
+}
+
+int ind_ofdpa_rpc_enabled(void)
+{
+  return ind_ofdpa_rpc.running && !ind_ofdpa_rpc.stopping;
+}
+
+indigo_error_t ind_ofdpa_rpc_submit(ind_ofdpa_rpc_call_f call, ind_ofdpa_rpc_done_f done, void *arg)
+{
+  ind_ofdpa_rpc_t *rpc = &ind_ofdpa_rpc;
+  ind_ofdpa_rpc_op_t *op;
+
+  if (!ind_ofdpa_rpc_enabled())
+  {
+    return INDIGO_ERROR_NOT_READY;
+  }
+
+  op = INDIGO_MEM_ALLOC(sizeof(*op));
+  if (op == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+  op->call = call;
+  op->done = done;
+  op->arg = arg;
+
+  pthread_mutex_lock(&rpc->lock);
+  if (rpc->inFlight >= rpc->window)
+  {
+    rpc->counters.windowFull++;
+    while (rpc->inFlight >= rpc->window)
+    {
+      pthread_cond_wait(&rpc->slot, &rpc->lock);
+    }
+  }
+  ind_ofdpa_rpc_queue_push(&rpc->pending, op);
+  rpc->inFlight++;
+  if (rpc->inFlight > rpc->counters.inFlightMax)
+  {
+    rpc->counters.inFlightMax = rpc->inFlight;
+  }
+  rpc->counters.submitted++;
+  pthread_cond_signal(&rpc->work);
+  pthread_mutex_unlock(&rpc->lock);
+
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_rpc_fence(void)
+{
+  ind_ofdpa_rpc_t *rpc = &ind_ofdpa_rpc;
+
+  if (!rpc->running)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&rpc->lock);
+  rpc->counters.fences++;
+  if (rpc->inFlight != 0)
+  {
+    rpc->counters.fenceWaits++;
+    while (rpc->inFlight != 0)
+    {
+      pthread_cond_wait(&rpc->slot, &rpc->lock);
+    }
+  }
+  pthread_mutex_unlock(&rpc->lock);
+
+  ind_ofdpa_rpc_deliver(rpc);
+}
+
+void ind_ofdpa_rpc_counters_get(ind_ofdpa_rpc_counters_t *counters)
+{
+  pthread_mutex_lock(&ind_ofdpa_rpc.lock);
+  *counters = ind_ofdpa_rpc.counters;
+  pthread_mutex_unlock(&ind_ofdpa_rpc.lock);
+}
@@ -0,0 +1,609 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_stats.c
+*
+* @purpose      Statistics caches for the OF-DPA driver
+*
+* @component    OF-DPA
+*
+* @comments     Port counters are fetched from OF-DPA by a SocketManager
+*               task that a timer starts every refresh interval. The
+*               task visits a few ports per slice and yields, so the
+*               controller's multipart requests are answered from memory
+*               instead of making one RPC per port.
+*
+*               Queue counters ride on the same pass, one queue per
+*               step. A port's queue count is read once and kept until
+*               a port event invalidates it.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <time.h>
+#include <indigo/memory.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Entries older than this many refresh intervals are fetched inline */
+#define IND_OFDPA_STATS_MAX_AGE_INTERVALS 4
+
+/* Refresh work runs behind the controller and OF-DPA sockets */
+#define IND_OFDPA_STATS_TASK_PRIORITY (IND_SOC_DEFAULT_PRIORITY - 1)
+
+typedef struct ind_ofdpa_queue_stats_entry_s
+{
+  uint64_t              updated;    /* 0 until first fetched */
+  ofdpaPortQueueStats_t stats;
+} ind_ofdpa_queue_stats_entry_t;
+
+typedef struct ind_ofdpa_port_stats_entry_s
+{
+  uint32_t         port;
+  uint32_t         pass;      /* refresh pass that last saw the port */
+  uint64_t         updated;   /* ind_ofdpa_stats_time_usec() of the fetch */
+  ofdpaPortStats_t stats;
+
+  int              queuesValid;   /* numQueues is current */
+  uint32_t         numQueues;
+  ind_ofdpa_queue_stats_entry_t *queues;
+} ind_ofdpa_port_stats_entry_t;
+
+typedef struct ind_ofdpa_port_stats_cache_s
+{
+  int                           enabled;
+  uint32_t                      refreshMs;
+  ind_ofdpa_port_stats_entry_t *entries;    /* sorted by port */
+  uint32_t                      count;
+  uint32_t                      slots;
+
+  /* State of the refresh pass in progress */
+  int                           running;
+  uint32_t                      pass;
+  uint32_t                      cursor;     /* last port refreshed */
+  uint32_t                      cursorQueue;  /* next queue of cursor */
+  uint32_t                      cursorQueues; /* queues of cursor */
+  uint64_t                      passStart;
+
+  ind_ofdpa_port_stats_cache_counters_t counters;
+} ind_ofdpa_port_stats_cache_t;
+
+static ind_ofdpa_port_stats_cache_t ind_ofdpa_port_stats_cache;
+
+uint64_t ind_ofdpa_stats_time_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static int ind_ofdpa_stats_fresh(uint64_t updated, uint64_t now)
+{
+  uint64_t maxAgeUsec = (uint64_t)ind_ofdpa_port_stats_cache.refreshMs * 1000 *
+                        IND_OFDPA_STATS_MAX_AGE_INTERVALS;
+
+  return (updated != 0) && (now - updated <= maxAgeUsec);
+}
+
+/* Binary search; returns the index of port or where it would be inserted */
+static uint32_t ind_ofdpa_port_stats_index(uint32_t port)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  uint32_t lo = 0, hi = cache->count;
+
+  while (lo < hi)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+
+    if (cache->entries[mid].port < port)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static ind_ofdpa_port_stats_entry_t *ind_ofdpa_port_stats_find(uint32_t port)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  uint32_t i = ind_ofdpa_port_stats_index(port);
+
+  if ((i < cache->count) && (cache->entries[i].port == port))
+  {
+    return &cache->entries[i];
+  }
+  return NULL;
+}
+
+static ind_ofdpa_port_stats_entry_t *ind_ofdpa_port_stats_insert(uint32_t port)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  ind_ofdpa_port_stats_entry_t *entry;
+  uint32_t i = ind_ofdpa_port_stats_index(port);
+
+  if ((i < cache->count) && (cache->entries[i].port == port))
+  {
+    return &cache->entries[i];
+  }
+
+  if (cache->count == cache->slots)
+  {
+    uint32_t slots = cache->slots ? cache->slots * 2 : 64;
+    ind_ofdpa_port_stats_entry_t *entries = INDIGO_MEM_ALLOC(slots * sizeof(*entries));
+
+    if (entries == NULL)
+    {
+      return NULL;
+    }
+    if (cache->count > 0)
+    {
+      INDIGO_MEM_COPY(entries, cache->entries, cache->count * sizeof(*entries));
+    }
+    INDIGO_MEM_FREE(cache->entries);
+    cache->entries = entries;
+    cache->slots = slots;
+  }
+
+  /* Ports arrive in ascending order, so this is normally an append */
+  if (i < cache->count)
+  {
+    memmove(&cache->entries[i + 1], &cache->entries[i],
+            (cache->count - i) * sizeof(*entry));
+  }
+  cache->count++;
+
+  entry = &cache->entries[i];
+  memset(entry, 0, sizeof(*entry));
+  entry->port = port;
+  return entry;
+}
+
+/* Drop ports that the finished pass did not see; they were deleted */
+static void ind_ofdpa_port_stats_prune(uint32_t pass)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  uint32_t i, j = 0;
+
+  for (i = 0; i < cache->count; i++)
+  {
+    if (cache->entries[i].pass == pass)
+    {
+      if (i != j)
+      {
+        cache->entries[j] = cache->entries[i];
+      }
+      j++;
+    }
+    else
+    {
+      INDIGO_MEM_FREE(cache->entries[i].queues);
+    }
+  }
+  cache->count = j;
+}
+
+static indigo_error_t ind_ofdpa_port_queues_set(ind_ofdpa_port_stats_entry_t *entry,
+                                                uint32_t numQueues)
+{
+  ind_ofdpa_queue_stats_entry_t *queues = NULL;
+
+  if (numQueues > 0)
+  {
+    queues = INDIGO_MEM_ALLOC(numQueues * sizeof(*queues));
+    if (queues == NULL)
+    {
+      return INDIGO_ERROR_RESOURCE;
+    }
+    memset(queues, 0, numQueues * sizeof(*queues));
+  }
+
+  INDIGO_MEM_FREE(entry->queues);
+  entry->queues = queues;
+  entry->numQueues = numQueues;
+  entry->queuesValid = 1;
+  return INDIGO_ERROR_NONE;
+}
+
+/* Read the port's queue count unless it is known and no port event has
+   changed it since */
+static indigo_error_t ind_ofdpa_port_queues_load(ind_ofdpa_port_stats_entry_t *entry)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  OFDPA_ERROR_t ofdpa_rv;
+  uint32_t numQueues;
+
+  if (entry->queuesValid)
+  {
+    return INDIGO_ERROR_NONE;
+  }
+
+  cache->counters.numQueuesRpcs++;
+  ofdpa_rv = ofdpaNumQueuesGet(entry->port, &numQueues);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    return indigoConvertOfdpaRv(ofdpa_rv);
+  }
+
+  return ind_ofdpa_port_queues_set(entry, numQueues);
+}
+
+static ind_soc_task_status_t ind_ofdpa_port_stats_refresh_task(void *cookie)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  ind_ofdpa_port_stats_entry_t *entry;
+  ofdpaPortStats_t stats;
+  ofdpaPortQueueStats_t queueStats;
+  uint32_t port, queueId;
+
+  if (!cache->enabled)
+  {
+    cache->running = 0;
+    return IND_SOC_TASK_FINISHED;
+  }
+
+  do
+  {
+    /* One queue of the current port per step */
+    if (cache->cursorQueue < cache->cursorQueues)
+    {
+      queueId = cache->cursorQueue++;
+
+      memset(&queueStats, 0, sizeof(queueStats));
+      cache->counters.refreshRpcs++;
+      if (ofdpaQueueStatsGet(cache->cursor, queueId, &queueStats) != OFDPA_E_NONE)
+      {
+        cache->counters.refreshErrors++;
+        continue;
+      }
+
+      /* A port event may have resized the queues since the port step */
+      entry = ind_ofdpa_port_stats_find(cache->cursor);
+      if ((entry != NULL) && entry->queuesValid && (queueId < entry->numQueues))
+      {
+        entry->queues[queueId].stats = queueStats;
+        entry->queues[queueId].updated = ind_ofdpa_stats_time_usec();
+      }
+      continue;
+    }
+
+    if (ofdpaPortNextGet(cache->cursor, &port) != OFDPA_E_NONE)
+    {
+      uint64_t usec = ind_ofdpa_stats_time_usec() - cache->passStart;
+
+      ind_ofdpa_port_stats_prune(cache->pass);
+      cache->counters.refreshes++;
+      cache->counters.lastRefreshUsec = usec;
+      cache->counters.totalRefreshUsec += usec;
+      cache->running = 0;
+
+      LOG_TRACE("Port stats refresh pass %u: %u ports in %llu us",
+                cache->pass, cache->count, (unsigned long long)usec);
+      return IND_SOC_TASK_FINISHED;
+    }
+    cache->cursor = port;
+    cache->cursorQueue = 0;
+    cache->cursorQueues = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    cache->counters.refreshRpcs++;
+    if (ofdpaPortStatsGet(port, &stats) != OFDPA_E_NONE)
+    {
+      /*
+       * The port still exists, so keep its entry past the prune. The old
+       * counters age, and a request fetches inline once they are stale.
+       */
+      cache->counters.refreshErrors++;
+      entry = ind_ofdpa_port_stats_find(port);
+      if (entry != NULL)
+      {
+        entry->pass = cache->pass;
+      }
+      continue;
+    }
+
+    entry = ind_ofdpa_port_stats_insert(port);
+    if (entry == NULL)
+    {
+      LOG_ERROR("Failed to allocate port stats cache entry for port %d.", port);
+      continue;
+    }
+    entry->stats = stats;
+    entry->updated = ind_ofdpa_stats_time_usec();
+    entry->pass = cache->pass;
+
+    if (ind_ofdpa_port_queues_load(entry) == INDIGO_ERROR_NONE)
+    {
+      cache->cursorQueues = entry->numQueues;
+    }
+    else
+    {
+      cache->counters.refreshErrors++;
+    }
+  } while (!ind_soc_should_yield());
+
+  return IND_SOC_TASK_CONTINUE;
+}
+
+static void ind_ofdpa_port_stats_refresh_timer(void *cookie)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+
+  /* A pass that overruns the interval is left to finish */
+  if (cache->running)
+  {
+    cache->counters.refreshOverruns++;
+    return;
+  }
+
+  cache->pass++;
+  cache->cursor = 0;
+  cache->cursorQueue = 0;
+  cache->cursorQueues = 0;
+  cache->passStart = ind_ofdpa_stats_time_usec();
+
+  if (ind_soc_task_register(ind_ofdpa_port_stats_refresh_task, NULL,
+                            IND_OFDPA_STATS_TASK_PRIORITY) != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to start port stats refresh.");
+    return;
+  }
+  cache->running = 1;
+}
+
+indigo_error_t ind_ofdpa_port_stats_cache_init(uint32_t refreshMs)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  indigo_error_t err;
+
+  if (refreshMs == 0)
+  {
+    /* Cache disabled; every request goes to OF-DPA */
+    return INDIGO_ERROR_NONE;
+  }
+
+  err = ind_soc_timer_event_register(ind_ofdpa_port_stats_refresh_timer, NULL, refreshMs);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to register port stats refresh timer. (err = %d)", err);
+    return err;
+  }
+
+  cache->refreshMs = refreshMs;
+  cache->enabled = 1;
+
+  /* Fill the cache now rather than one interval from now */
+  ind_ofdpa_port_stats_refresh_timer(NULL);
+
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_port_stats_cache_finish(void)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+
+  if (!cache->enabled)
+  {
+    return;
+  }
+
+  ind_soc_timer_event_unregister(ind_ofdpa_port_stats_refresh_timer, NULL);
+
+  /* A running task sees enabled == 0 and finishes on its next slice */
+  cache->enabled = 0;
+
+  /* No entry carries the next pass number, so every entry is freed */
+  ind_ofdpa_port_stats_prune(cache->pass + 1);
+  cache->slots = 0;
+  INDIGO_MEM_FREE(cache->entries);
+  cache->entries = NULL;
+}
+
+indigo_error_t ind_ofdpa_port_stats_cache_get(uint32_t port, ofdpaPortStats_t *stats,
+                                              uint32_t *ageMs)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  ind_ofdpa_port_stats_entry_t *entry;
+  OFDPA_ERROR_t ofdpa_rv;
+  uint64_t now;
+
+  if (!cache->enabled)
+  {
+    if (ageMs != NULL)
+    {
+      *ageMs = 0;
+    }
+    return indigoConvertOfdpaRv(ofdpaPortStatsGet(port, stats));
+  }
+
+  now = ind_ofdpa_stats_time_usec();
+  entry = ind_ofdpa_port_stats_find(port);
+  if ((entry != NULL) && ind_ofdpa_stats_fresh(entry->updated, now))
+  {
+    cache->counters.hits++;
+    *stats = entry->stats;
+    if (ageMs != NULL)
+    {
+      *ageMs = (uint32_t)((now - entry->updated) / 1000);
+    }
+    return INDIGO_ERROR_NONE;
+  }
+
+  /* New port, or the refresh has fallen behind; fetch and keep the result */
+  cache->counters.misses++;
+  ofdpa_rv = ofdpaPortStatsGet(port, stats);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    return indigoConvertOfdpaRv(ofdpa_rv);
+  }
+
+  entry = ind_ofdpa_port_stats_insert(port);
+  if (entry != NULL)
+  {
+    entry->stats = *stats;
+    entry->updated = now;
+    entry->pass = cache->pass;
+  }
+  if (ageMs != NULL)
+  {
+    *ageMs = 0;
+  }
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t ind_ofdpa_queue_stats_cache_num_get(uint32_t port, uint32_t *numQueues)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  ind_ofdpa_port_stats_entry_t *entry;
+  indigo_error_t err;
+
+  if (!cache->enabled)
+  {
+    return indigoConvertOfdpaRv(ofdpaNumQueuesGet(port, numQueues));
+  }
+
+  entry = ind_ofdpa_port_stats_find(port);
+  if (entry == NULL)
+  {
+    /* Check the port exists before giving it an entry */
+    cache->counters.numQueuesRpcs++;
+    err = indigoConvertOfdpaRv(ofdpaNumQueuesGet(port, numQueues));
+    if (err != INDIGO_ERROR_NONE)
+    {
+      return err;
+    }
+
+    entry = ind_ofdpa_port_stats_insert(port);
+    if (entry != NULL)
+    {
+      entry->pass = cache->pass;
+      ind_ofdpa_port_queues_set(entry, *numQueues);
+    }
+    return INDIGO_ERROR_NONE;
+  }
+
+  err = ind_ofdpa_port_queues_load(entry);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return err;
+  }
+
+  *numQueues = entry->numQueues;
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t ind_ofdpa_queue_stats_cache_get(uint32_t port, uint32_t queueId,
+                                               ofdpaPortQueueStats_t *stats, uint32_t *ageMs)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  ind_ofdpa_port_stats_entry_t *entry;
+  ind_ofdpa_queue_stats_entry_t *queue = NULL;
+  OFDPA_ERROR_t ofdpa_rv;
+  uint64_t now;
+
+  if (ageMs != NULL)
+  {
+    *ageMs = 0;
+  }
+
+  if (!cache->enabled)
+  {
+    return indigoConvertOfdpaRv(ofdpaQueueStatsGet(port, queueId, stats));
+  }
+
+  now = ind_ofdpa_stats_time_usec();
+  entry = ind_ofdpa_port_stats_find(port);
+  if ((entry != NULL) && entry->queuesValid && (queueId < entry->numQueues))
+  {
+    queue = &entry->queues[queueId];
+    if (ind_ofdpa_stats_fresh(queue->updated, now))
+    {
+      cache->counters.queueHits++;
+      *stats = queue->stats;
+      if (ageMs != NULL)
+      {
+        *ageMs = (uint32_t)((now - queue->updated) / 1000);
+      }
+      return INDIGO_ERROR_NONE;
+    }
+  }
+
+  cache->counters.queueMisses++;
+  ofdpa_rv = ofdpaQueueStatsGet(port, queueId, stats);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    return indigoConvertOfdpaRv(ofdpa_rv);
+  }
+
+  if (queue != NULL)
+  {
+    queue->stats = *stats;
+    queue->updated = now;
+  }
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_port_stats_cache_port_invalidate(uint32_t port)
+{
+  ind_ofdpa_port_stats_entry_t *entry = ind_ofdpa_port_stats_find(port);
+
+  /* The queues are re-read on the next refresh or request */
+  if (entry != NULL)
+  {
+    entry->queuesValid = 0;
+  }
+}
+
+indigo_error_t ind_ofdpa_port_stats_cache_next_get(uint32_t port, uint32_t *nextPort)
+{
+  ind_ofdpa_port_stats_cache_t *cache = &ind_ofdpa_port_stats_cache;
+  uint32_t i;
+
+  /* Until the first pass completes the port list may be partial */
+  if (!cache->enabled || (cache->counters.refreshes == 0))
+  {
+    return indigoConvertOfdpaRv(ofdpaPortNextGet(port, nextPort));
+  }
+
+  i = ind_ofdpa_port_stats_index(port);
+  if ((i < cache->count) && (cache->entries[i].port == port))
+  {
+    i++;
+  }
+  if (i >= cache->count)
+  {
+    return INDIGO_ERROR_NOT_FOUND;
+  }
+
+  *nextPort = cache->entries[i].port;
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_port_stats_cache_counters_get(ind_ofdpa_port_stats_cache_counters_t *counters)
+{
+  *counters = ind_ofdpa_port_stats_cache.counters;
+}
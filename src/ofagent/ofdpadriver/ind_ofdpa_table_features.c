@@ -0,0 +1,485 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_table_features.c
+*
+* @purpose      OpenFlow 1.3 table features of the OF-DPA pipeline
+*
+* @component    OF-DPA
+*
+* @comments     Each flow table's capabilities are the ones the flow mod
+*               translation in ind_ofdpa_fwd.c enforces: the match
+*               fields come from the IND_OFDPA_*_FLOW_MATCH_BITMAP masks
+*               that ind_ofdpa_match_fields_masks_get() checks, and the
+*               instructions, actions and set-fields from the per table
+*               cases of ind_ofdpa_instructions_get() and
+*               ind_ofdpa_translate_openflow_actions(). Actions the
+*               translation accepts but does not program are left out.
+*
+*               The reply is encoded once and each request is answered
+*               with a copy carrying the request's xid.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <string.h>
+#include <indigo/memory.h>
+#include <indigo/forwarding.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Match fields OF-DPA accepts but ignores or rejects */
+#define IND_OFDPA_UNSUPPORTED_MATCH_BITMAP (IND_OFDPA_IPV4_ARP_SPA | IND_OFDPA_IP_ECN)
+
+/* OpenFlow 1.3 table features entry before its properties */
+#define IND_OFDPA_TABLE_FEATURES_LEN 64
+#define IND_OFDPA_TABLE_FEATURES_NAME_LEN 32
+
+static const ind_ofdpa_table_caps_t ind_ofdpa_table_caps[] =
+{
+  {
+    OFDPA_FLOW_TABLE_ID_INGRESS_PORT,
+    IND_OFDPA_ING_PORT_FLOW_MATCH_BITMAP,
+    0,
+    IND_OFDPA_PORT,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    0,
+    0,
+    1, {OFDPA_FLOW_TABLE_ID_VLAN}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_VLAN,
+    IND_OFDPA_VLAN_FLOW_MATCH_BITMAP,
+    IND_OFDPA_VLANID,
+    IND_OFDPA_VLANID,           /* left out, matches untagged frames */
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_SET_FIELD),
+    IND_OFDPA_VLANID,
+    1, {OFDPA_FLOW_TABLE_ID_TERMINATION_MAC}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_TERMINATION_MAC,
+    IND_OFDPA_TERM_MAC_FLOW_MATCH_BITMAP,
+    IND_OFDPA_PORT | IND_OFDPA_DSTMAC | IND_OFDPA_VLANID,
+    IND_OFDPA_PORT | IND_OFDPA_VLANID,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_OUTPUT),
+    0,
+    2, {OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING, OFDPA_FLOW_TABLE_ID_MULTICAST_ROUTING}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING,
+    IND_OFDPA_UCAST_ROUTING_FLOW_MATCH_BITMAP,
+    IND_OFDPA_IPV4_DST | IND_OFDPA_IPV6_DST,
+    IND_OFDPA_IPV4_DST | IND_OFDPA_IPV6_DST,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_GROUP),
+    0,
+    1, {OFDPA_FLOW_TABLE_ID_ACL_POLICY}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_MULTICAST_ROUTING,
+    IND_OFDPA_MCAST_ROUTING_FLOW_MATCH_BITMAP,
+    IND_OFDPA_IPV4_SRC | IND_OFDPA_IPV6_SRC,
+    IND_OFDPA_VLANID | IND_OFDPA_IPV4_SRC | IND_OFDPA_IPV4_DST |
+    IND_OFDPA_IPV6_SRC | IND_OFDPA_IPV6_DST,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_GROUP),
+    0,
+    1, {OFDPA_FLOW_TABLE_ID_ACL_POLICY}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_BRIDGING,
+    IND_OFDPA_BRIDGING_FLOW_MATCH_BITMAP,
+    IND_OFDPA_DSTMAC,
+    IND_OFDPA_VLANID | IND_OFDPA_TUNNEL_ID | IND_OFDPA_DSTMAC,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_OUTPUT) | IND_OFDPA_ACTION(OF_ACTION_TYPE_GROUP),
+    0,
+    1, {OFDPA_FLOW_TABLE_ID_ACL_POLICY}
+  },
+  {
+    OFDPA_FLOW_TABLE_ID_ACL_POLICY,
+    IND_OFDPA_ACL_POLICY_FLOW_MATCH_BITMAP & ~IND_OFDPA_UNSUPPORTED_MATCH_BITMAP,
+    IND_OFDPA_ACL_POLICY_FLOW_MATCH_BITMAP &
+      ~(IND_OFDPA_UNSUPPORTED_MATCH_BITMAP | IND_OFDPA_ETHER_TYPE | IND_OFDPA_TUNNEL_ID),
+    IND_OFDPA_ACL_POLICY_FLOW_MATCH_BITMAP & ~IND_OFDPA_UNSUPPORTED_MATCH_BITMAP,
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS) |
+    IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_CLEAR_ACTIONS),
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_OUTPUT) | IND_OFDPA_ACTION(OF_ACTION_TYPE_GROUP) |
+    IND_OFDPA_ACTION(OF_ACTION_TYPE_SET_QUEUE) | IND_OFDPA_ACTION(OF_ACTION_TYPE_SET_FIELD),
+    IND_OFDPA_VLAN_PCP | IND_OFDPA_IP_DSCP,
+    0, {0}
+  }
+};
+
+#define IND_OFDPA_TABLE_CAPS_SIZE (sizeof(ind_ofdpa_table_caps)/sizeof(ind_ofdpa_table_caps[0]))
+
+const ind_ofdpa_table_caps_t *ind_ofdpa_table_caps_get(OFDPA_FLOW_TABLE_ID_t tableId)
+{
+  uint32_t i;
+
+  for (i = 0; i < IND_OFDPA_TABLE_CAPS_SIZE; i++)
+  {
+    if (ind_ofdpa_table_caps[i].tableId == tableId)
+    {
+      return &ind_ofdpa_table_caps[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* OXM field number and value length of each match field */
+typedef struct ind_ofdpa_oxm_field_s
+{
+  ind_ofdpa_fields_t field;
+  uint8_t            oxmField;
+  uint8_t            length;
+} ind_ofdpa_oxm_field_t;
+
+static const ind_ofdpa_oxm_field_t ind_ofdpa_oxm_fields[] =
+{
+  {IND_OFDPA_PORT,             0, 4},   /* OFPXMT_OFB_IN_PORT */
+  {IND_OFDPA_DSTMAC,           3, 6},   /* OFPXMT_OFB_ETH_DST */
+  {IND_OFDPA_SRCMAC,           4, 6},   /* OFPXMT_OFB_ETH_SRC */
+  {IND_OFDPA_ETHER_TYPE,       5, 2},   /* OFPXMT_OFB_ETH_TYPE */
+  {IND_OFDPA_VLANID,           6, 2},   /* OFPXMT_OFB_VLAN_VID */
+  {IND_OFDPA_VLAN_PCP,         7, 1},   /* OFPXMT_OFB_VLAN_PCP */
+  {IND_OFDPA_IP_DSCP,          8, 1},   /* OFPXMT_OFB_IP_DSCP */
+  {IND_OFDPA_IP_ECN,           9, 1},   /* OFPXMT_OFB_IP_ECN */
+  {IND_OFDPA_IP_PROTO,        10, 1},   /* OFPXMT_OFB_IP_PROTO */
+  {IND_OFDPA_IPV4_SRC,        11, 4},   /* OFPXMT_OFB_IPV4_SRC */
+  {IND_OFDPA_IPV4_DST,        12, 4},   /* OFPXMT_OFB_IPV4_DST */
+  {IND_OFDPA_TCP_L4_SRC_PORT, 13, 2},   /* OFPXMT_OFB_TCP_SRC */
+  {IND_OFDPA_TCP_L4_DST_PORT, 14, 2},   /* OFPXMT_OFB_TCP_DST */
+  {IND_OFDPA_UDP_L4_SRC_PORT, 15, 2},   /* OFPXMT_OFB_UDP_SRC */
+  {IND_OFDPA_UDP_L4_DST_PORT, 16, 2},   /* OFPXMT_OFB_UDP_DST */
+  {IND_OFDPA_SCTP_L4_SRC_PORT, 17, 2},  /* OFPXMT_OFB_SCTP_SRC */
+  {IND_OFDPA_SCTP_L4_DST_PORT, 18, 2},  /* OFPXMT_OFB_SCTP_DST */
+  {IND_OFDPA_ICMPV4_TYPE,     19, 1},   /* OFPXMT_OFB_ICMPV4_TYPE */
+  {IND_OFDPA_ICMPV4_CODE,     20, 1},   /* OFPXMT_OFB_ICMPV4_CODE */
+  {IND_OFDPA_IPV4_ARP_SPA,    22, 4},   /* OFPXMT_OFB_ARP_SPA */
+  {IND_OFDPA_IPV6_SRC,        26, 16},  /* OFPXMT_OFB_IPV6_SRC */
+  {IND_OFDPA_IPV6_DST,        27, 16},  /* OFPXMT_OFB_IPV6_DST */
+  {IND_OFDPA_IPV6_FLOW_LABEL, 28, 4},   /* OFPXMT_OFB_IPV6_FLABEL */
+  {IND_OFDPA_ICMPV6_TYPE,     29, 1},   /* OFPXMT_OFB_ICMPV6_TYPE */
+  {IND_OFDPA_ICMPV6_CODE,     30, 1},   /* OFPXMT_OFB_ICMPV6_CODE */
+  {IND_OFDPA_TUNNEL_ID,       38, 8}    /* OFPXMT_OFB_TUNNEL_ID */
+};
+
+#define IND_OFDPA_OXM_FIELDS_SIZE (sizeof(ind_ofdpa_oxm_fields)/sizeof(ind_ofdpa_oxm_fields[0]))
+
+typedef struct ind_ofdpa_table_features_buf_s
+{
+  uint8_t  *data;
+  uint32_t  len;
+  uint32_t  size;
+  int       overflow;
+} ind_ofdpa_table_features_buf_t;
+
+/* Encoded table features stats reply with a zero xid */
+static uint8_t  *ind_ofdpa_table_features;
+static uint32_t  ind_ofdpa_table_features_len;
+
+static uint8_t *ind_ofdpa_table_features_reserve(ind_ofdpa_table_features_buf_t *buf, uint32_t bytes)
+{
+  uint8_t *p;
+
+  if (buf->len + bytes > buf->size)
+  {
+    buf->overflow = 1;
+    return NULL;
+  }
+
+  p = buf->data + buf->len;
+  memset(p, 0, bytes);
+  buf->len += bytes;
+  return p;
+}
+
+static void ind_ofdpa_table_features_put16(ind_ofdpa_table_features_buf_t *buf, uint16_t value)
+{
+  uint8_t *p = ind_ofdpa_table_features_reserve(buf, 2);
+
+  if (p != NULL)
+  {
+    p[0] = value >> 8;
+    p[1] = value;
+  }
+}
+
+static void ind_ofdpa_table_features_put32(ind_ofdpa_table_features_buf_t *buf, uint32_t value)
+{
+  ind_ofdpa_table_features_put16(buf, value >> 16);
+  ind_ofdpa_table_features_put16(buf, value);
+}
+
+/* Patch a length written earlier as zero */
+static void ind_ofdpa_table_features_len_set(ind_ofdpa_table_features_buf_t *buf,
+                                             uint32_t offset, uint16_t value)
+{
+  if (!buf->overflow)
+  {
+    buf->data[offset] = value >> 8;
+    buf->data[offset + 1] = value;
+  }
+}
+
+static uint32_t ind_ofdpa_table_features_prop_start(ind_ofdpa_table_features_buf_t *buf, uint16_t type)
+{
+  uint32_t offset = buf->len;
+
+  ind_ofdpa_table_features_put16(buf, type);
+  ind_ofdpa_table_features_put16(buf, 0);
+  return offset;
+}
+
+/* The property length leaves out the padding to 8 bytes */
+static void ind_ofdpa_table_features_prop_end(ind_ofdpa_table_features_buf_t *buf, uint32_t offset)
+{
+  ind_ofdpa_table_features_len_set(buf, offset + 2, buf->len - offset);
+  (void)ind_ofdpa_table_features_reserve(buf, (8 - (buf->len % 8)) % 8);
+}
+
+/* Instruction or action ids: a type and the 4 byte header length */
+static void ind_ofdpa_table_features_ids_put(ind_ofdpa_table_features_buf_t *buf,
+                                             uint16_t propType, uint32_t types)
+{
+  uint32_t offset = ind_ofdpa_table_features_prop_start(buf, propType);
+  uint32_t type;
+
+  for (type = 0; type < 32; type++)
+  {
+    if (types & (1u << type))
+    {
+      ind_ofdpa_table_features_put16(buf, type);
+      ind_ofdpa_table_features_put16(buf, 4);
+    }
+  }
+  ind_ofdpa_table_features_prop_end(buf, offset);
+}
+
+static void ind_ofdpa_table_features_oxms_put(ind_ofdpa_table_features_buf_t *buf, uint16_t propType,
+                                              uint32_t fields, uint32_t masked)
+{
+  uint32_t offset = ind_ofdpa_table_features_prop_start(buf, propType);
+  const ind_ofdpa_oxm_field_t *oxm;
+  uint32_t header;
+  uint32_t i;
+
+  for (i = 0; i < IND_OFDPA_OXM_FIELDS_SIZE; i++)
+  {
+    oxm = &ind_ofdpa_oxm_fields[i];
+    if (!(fields & oxm->field))
+    {
+      continue;
+    }
+
+    header = (OF_OXM_CLASS_OPENFLOW_BASIC << 16) | (oxm->oxmField << 9);
+    if (masked & oxm->field)
+    {
+      header |= (1 << 8) | (2 * oxm->length);
+    }
+    else
+    {
+      header |= oxm->length;
+    }
+    ind_ofdpa_table_features_put32(buf, header);
+  }
+  ind_ofdpa_table_features_prop_end(buf, offset);
+}
+
+static void ind_ofdpa_table_features_table_put(ind_ofdpa_table_features_buf_t *buf,
+                                               const ind_ofdpa_table_caps_t *caps)
+{
+  ind_ofdpa_table_stats_t stats;
+  uint32_t offset = buf->len;
+  uint32_t propOffset;
+  uint8_t *p;
+  uint32_t i;
+
+  memset(&stats, 0, sizeof(stats));
+  (void)ind_ofdpa_table_stats_get(caps->tableId, &stats);
+
+  p = ind_ofdpa_table_features_reserve(buf, IND_OFDPA_TABLE_FEATURES_LEN);
+  if (p == NULL)
+  {
+    return;
+  }
+  p[2] = caps->tableId;
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    if (tableNameList[i].type == caps->tableId)
+    {
+      strncpy((char *)&p[8], tableNameList[i].name, IND_OFDPA_TABLE_FEATURES_NAME_LEN - 1);
+    }
+  }
+  /* Metadata is neither matched nor written; config is zero */
+  p[60] = stats.maxEntries >> 24;
+  p[61] = stats.maxEntries >> 16;
+  p[62] = stats.maxEntries >> 8;
+  p[63] = stats.maxEntries;
+
+  ind_ofdpa_table_features_ids_put(buf, OF_TABLE_FEATURE_INSTRUCTIONS, caps->instructions);
+
+  propOffset = ind_ofdpa_table_features_prop_start(buf, OF_TABLE_FEATURE_NEXT_TABLES);
+  for (i = 0; i < caps->nextTableCount; i++)
+  {
+    p = ind_ofdpa_table_features_reserve(buf, 1);
+    if (p != NULL)
+    {
+      *p = caps->nextTables[i];
+    }
+  }
+  ind_ofdpa_table_features_prop_end(buf, propOffset);
+
+  if (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS))
+  {
+    ind_ofdpa_table_features_ids_put(buf, OF_TABLE_FEATURE_WRITE_ACTIONS, caps->actions);
+  }
+  if (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS))
+  {
+    ind_ofdpa_table_features_ids_put(buf, OF_TABLE_FEATURE_APPLY_ACTIONS, caps->actions);
+  }
+
+  ind_ofdpa_table_features_oxms_put(buf, OF_TABLE_FEATURE_MATCH, caps->match, caps->masked);
+  ind_ofdpa_table_features_oxms_put(buf, OF_TABLE_FEATURE_WILDCARDS, caps->wildcards, 0);
+
+  if (caps->actions & IND_OFDPA_ACTION(OF_ACTION_TYPE_SET_FIELD))
+  {
+    if (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS))
+    {
+      ind_ofdpa_table_features_oxms_put(buf, OF_TABLE_FEATURE_WRITE_SETFIELD, caps->setFields, 0);
+    }
+    if (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS))
+    {
+      ind_ofdpa_table_features_oxms_put(buf, OF_TABLE_FEATURE_APPLY_SETFIELD, caps->setFields, 0);
+    }
+  }
+
+  ind_ofdpa_table_features_len_set(buf, offset, buf->len - offset);
+}
+
+indigo_error_t ind_ofdpa_table_features_init(void)
+{
+  ind_ofdpa_table_features_buf_t buf;
+  of_table_features_stats_reply_t *header;
+  uint32_t i;
+
+  ind_ofdpa_table_features_finish();
+
+  /* The multipart header is taken from an empty reply */
+  header = of_table_features_stats_reply_new(OF_VERSION_1_3);
+  if (header == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  memset(&buf, 0, sizeof(buf));
+  buf.size = OF_WIRE_BUFFER_MAX_LENGTH;
+  buf.data = INDIGO_MEM_ALLOC(buf.size);
+  if (buf.data == NULL)
+  {
+    of_table_features_stats_reply_delete(header);
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  INDIGO_MEM_COPY(ind_ofdpa_table_features_reserve(&buf, header->length),
+                  OF_OBJECT_TO_MESSAGE(header), header->length);
+  of_table_features_stats_reply_delete(header);
+
+  for (i = 0; i < IND_OFDPA_TABLE_CAPS_SIZE; i++)
+  {
+    ind_ofdpa_table_features_table_put(&buf, &ind_ofdpa_table_caps[i]);
+  }
+
+  if (buf.overflow)
+  {
+    LOG_ERROR("Table features do not fit in one reply.");
+    INDIGO_MEM_FREE(buf.data);
+    return INDIGO_ERROR_RESOURCE;
+  }
+  of_message_length_set(buf.data, buf.len);
+
+  ind_ofdpa_table_features = buf.data;
+  ind_ofdpa_table_features_len = buf.len;
+  LOG_INFO("Table features encoded in %u bytes.", buf.len);
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_table_features_finish(void)
+{
+  INDIGO_MEM_FREE(ind_ofdpa_table_features);
+  ind_ofdpa_table_features = NULL;
+  ind_ofdpa_table_features_len = 0;
+}
+
+indigo_error_t indigo_fwd_table_features_get(of_table_features_stats_request_t *table_features_request,
+                                             of_table_features_stats_reply_t **table_features_reply)
+{
+  of_table_features_stats_reply_t *reply;
+  indigo_error_t err;
+  uint8_t *msg;
+  uint32_t xid;
+
+  if (table_features_request->version != OF_VERSION_1_3)
+  {
+    return INDIGO_ERROR_VERSION;
+  }
+
+  if (ind_ofdpa_table_features == NULL)
+  {
+    err = ind_ofdpa_table_features_init();
+    if (err != INDIGO_ERROR_NONE)
+    {
+      return err;
+    }
+  }
+
+  /* The reply owns the copy and frees it with the object */
+  msg = INDIGO_MEM_ALLOC(ind_ofdpa_table_features_len);
+  if (msg == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+  INDIGO_MEM_COPY(msg, ind_ofdpa_table_features, ind_ofdpa_table_features_len);
+
+  reply = of_table_features_stats_reply_new_from_message(OF_BUFFER_TO_MESSAGE(msg));
+  if (reply == NULL)
+  {
+    INDIGO_MEM_FREE(msg);
+    return INDIGO_ERROR_RESOURCE;
+  }
+
+  of_table_features_stats_request_xid_get(table_features_request, &xid);
+  of_table_features_stats_reply_xid_set(reply, xid);
+
+  *table_features_reply = reply;
+  return INDIGO_ERROR_NONE;
+}
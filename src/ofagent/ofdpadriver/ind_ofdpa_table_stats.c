@@ -0,0 +1,285 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_table_stats.c
+*
+* @purpose      Per flow table occupancy and flow mod counters
+*
+* @component    OF-DPA
+*
+* @comments     The entry counts of each table in tableNameList are
+*               read from OF-DPA once and then kept current from the
+*               results of flow adds and deletes, flow expiry and
+*               reconciliation, so table stats need no RPC. Each table
+*               also counts the flow mods the agent made, their
+*               failures and the time spent in the OF-DPA calls.
+*
+*               The counters are also sent in reply to an experimenter
+*               message with experimenter IND_OFDPA_EXPERIMENTER_ID and
+*               subtype IND_OFDPA_EXP_TABLE_STATS_REQUEST. The reply,
+*               subtype IND_OFDPA_EXP_TABLE_STATS_REPLY, holds one
+*               record per table, all fields in network byte order:
+*
+*                 uint8_t  table_id
+*                 uint8_t  pad[3]
+*                 uint32_t active_count
+*                 uint32_t max_entries
+*                 uint32_t pad
+*                 uint64_t flow_adds, flow_add_failures
+*                 uint64_t flow_modifies, flow_modify_failures
+*                 uint64_t flow_deletes, flow_delete_failures
+*                 uint64_t flows_removed
+*                 uint64_t rpcs, rpc_usec_total, rpc_usec_max
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <string.h>
+#include <arpa/inet.h>
+#include <indigo/memory.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+/* Size of one table record in the experimenter reply */
+#define IND_OFDPA_EXP_STATS_TABLE_RECORD_LEN (16 + 10 * 8)
+
+typedef struct ind_ofdpa_table_stats_entry_s
+{
+  int                     loaded;   /* counts read from OF-DPA */
+  ind_ofdpa_table_stats_t stats;
+} ind_ofdpa_table_stats_entry_t;
+
+static ind_ofdpa_table_stats_entry_t *ind_ofdpa_table_stats;
+
+static ind_ofdpa_table_stats_entry_t *ind_ofdpa_table_stats_find(OFDPA_FLOW_TABLE_ID_t tableId)
+{
+  uint32_t i;
+
+  if (ind_ofdpa_table_stats == NULL)
+  {
+    ind_ofdpa_table_stats = INDIGO_MEM_ALLOC(tableNameListSize * sizeof(*ind_ofdpa_table_stats));
+    if (ind_ofdpa_table_stats == NULL)
+    {
+      return NULL;
+    }
+    memset(ind_ofdpa_table_stats, 0, tableNameListSize * sizeof(*ind_ofdpa_table_stats));
+  }
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    if (tableNameList[i].type == tableId)
+    {
+      return &ind_ofdpa_table_stats[i];
+    }
+  }
+
+  return NULL;
+}
+
+static OFDPA_ERROR_t ind_ofdpa_table_stats_load(OFDPA_FLOW_TABLE_ID_t tableId,
+                                                ind_ofdpa_table_stats_entry_t *entry)
+{
+  ofdpaFlowTableInfo_t tableInfo;
+  OFDPA_ERROR_t ofdpa_rv;
+
+  memset(&tableInfo, 0, sizeof(tableInfo));
+  ofdpa_rv = ofdpaFlowTableInfoGet(tableId, &tableInfo);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    LOG_INFO("Error getting flow table info. (ofdpa_rv = %d)", ofdpa_rv);
+    return ofdpa_rv;
+  }
+
+  entry->stats.numEntries = tableInfo.numEntries;
+  entry->stats.maxEntries = tableInfo.maxEntries;
+  entry->loaded = 1;
+  return OFDPA_E_NONE;
+}
+
+indigo_error_t ind_ofdpa_table_stats_init(void)
+{
+  ind_ofdpa_table_stats_entry_t *entry;
+  OFDPA_ERROR_t ofdpa_rv;
+  uint32_t i;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    entry = ind_ofdpa_table_stats_find(tableNameList[i].type);
+    if (entry == NULL)
+    {
+      return INDIGO_ERROR_RESOURCE;
+    }
+
+    ofdpa_rv = ind_ofdpa_table_stats_load(tableNameList[i].type, entry);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      return indigoConvertOfdpaRv(ofdpa_rv);
+    }
+  }
+
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_table_stats_finish(void)
+{
+  INDIGO_MEM_FREE(ind_ofdpa_table_stats);
+  ind_ofdpa_table_stats = NULL;
+}
+
+indigo_error_t ind_ofdpa_table_stats_get(OFDPA_FLOW_TABLE_ID_t tableId,
+                                         ind_ofdpa_table_stats_t *stats)
+{
+  ind_ofdpa_table_stats_entry_t *entry = ind_ofdpa_table_stats_find(tableId);
+  OFDPA_ERROR_t ofdpa_rv;
+
+  if (entry == NULL)
+  {
+    return INDIGO_ERROR_NOT_FOUND;
+  }
+
+  /* Only a table that failed to load at init still needs the RPC */
+  if (!entry->loaded)
+  {
+    ofdpa_rv = ind_ofdpa_table_stats_load(tableId, entry);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      return indigoConvertOfdpaRv(ofdpa_rv);
+    }
+  }
+
+  *stats = entry->stats;
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_table_stats_flow_mod(OFDPA_FLOW_TABLE_ID_t tableId, ind_ofdpa_flow_mod_t op,
+                                    OFDPA_ERROR_t ofdpa_rv, uint64_t usec)
+{
+  ind_ofdpa_table_stats_entry_t *entry = ind_ofdpa_table_stats_find(tableId);
+  ind_ofdpa_table_stats_t *stats;
+  int failed = (ofdpa_rv != OFDPA_E_NONE);
+
+  if (entry == NULL)
+  {
+    return;
+  }
+  stats = &entry->stats;
+
+  stats->rpcs++;
+  stats->rpcUsecTotal += usec;
+  if (usec > stats->rpcUsecMax)
+  {
+    stats->rpcUsecMax = usec;
+  }
+
+  switch (op)
+  {
+    case IND_OFDPA_FLOW_MOD_ADD:
+      stats->flowAdds++;
+      stats->flowAddFailures += failed;
+      if (!failed)
+      {
+        stats->numEntries++;
+      }
+      break;
+
+    case IND_OFDPA_FLOW_MOD_MODIFY:
+      stats->flowModifies++;
+      stats->flowModifyFailures += failed;
+      break;
+
+    case IND_OFDPA_FLOW_MOD_DELETE:
+      stats->flowDeletes++;
+      stats->flowDeleteFailures += failed;
+      if (!failed && (stats->numEntries > 0))
+      {
+        stats->numEntries--;
+      }
+      break;
+  }
+}
+
+void ind_ofdpa_table_stats_flow_removed(OFDPA_FLOW_TABLE_ID_t tableId)
+{
+  ind_ofdpa_table_stats_entry_t *entry = ind_ofdpa_table_stats_find(tableId);
+
+  if (entry == NULL)
+  {
+    return;
+  }
+
+  entry->stats.flowsRemoved++;
+  if (entry->stats.numEntries > 0)
+  {
+    entry->stats.numEntries--;
+  }
+}
+
+static uint8_t *ind_ofdpa_table_stats_put32(uint8_t *p, uint32_t value)
+{
+  value = htonl(value);
+  memcpy(p, &value, sizeof(value));
+  return p + sizeof(value);
+}
+
+static uint8_t *ind_ofdpa_table_stats_put64(uint8_t *p, uint64_t value)
+{
+  p = ind_ofdpa_table_stats_put32(p, (uint32_t)(value >> 32));
+  return ind_ofdpa_table_stats_put32(p, (uint32_t)value);
+}
+
+indigo_error_t ind_ofdpa_table_stats_encode(of_octets_t *data)
+{
+  ind_ofdpa_table_stats_t stats;
+  uint8_t *p;
+  uint32_t i;
+
+  data->bytes = tableNameListSize * IND_OFDPA_EXP_STATS_TABLE_RECORD_LEN;
+  data->data = INDIGO_MEM_ALLOC(data->bytes);
+  if (data->data == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+  memset(data->data, 0, data->bytes);
+
+  p = data->data;
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    memset(&stats, 0, sizeof(stats));
+    (void)ind_ofdpa_table_stats_get(tableNameList[i].type, &stats);
+
+    p[0] = (uint8_t)tableNameList[i].type;
+    p = ind_ofdpa_table_stats_put32(p + 4, stats.numEntries);
+    p = ind_ofdpa_table_stats_put32(p, stats.maxEntries);
+    p += 4;
+    p = ind_ofdpa_table_stats_put64(p, stats.flowAdds);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowAddFailures);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowModifies);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowModifyFailures);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowDeletes);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowDeleteFailures);
+    p = ind_ofdpa_table_stats_put64(p, stats.flowsRemoved);
+    p = ind_ofdpa_table_stats_put64(p, stats.rpcs);
+    p = ind_ofdpa_table_stats_put64(p, stats.rpcUsecTotal);
+    p = ind_ofdpa_table_stats_put64(p, stats.rpcUsecMax);
+  }
+
+  return INDIGO_ERROR_NONE;
+}
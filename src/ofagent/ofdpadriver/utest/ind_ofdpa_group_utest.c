@@ -0,0 +1,412 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_group_utest.c
+*
+* @purpose      Unit tests of group bucket updates against libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Modifies groups through indigo_fwd_group_modify() and
+*               checks, after each modify, the buckets the mock holds
+*               and the OF-DPA calls it took to get there.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <indigo/forwarding.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+/* Defined by ind_ofdpa_fwd.c, which is not linked; used by of_match.c */
+ind_ofdpa_fields_t ind_ofdpa_match_fields_bitmask;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+#define UTEST_VLAN 10
+
+#define UTEST_L2_INTERFACE(port) \
+  ((OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE << 28) | (UTEST_VLAN << 16) | (port))
+#define UTEST_L2_FLOOD(index) \
+  ((OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD << 28) | (UTEST_VLAN << 16) | (index))
+#define UTEST_L3_UNICAST(index) \
+  ((OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST << 28) | (index))
+
+/* An L2 interface group on a port the mock does not have */
+#define UTEST_PORT_MISSING 1000
+
+/* Port status messages go nowhere here */
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  of_port_status_delete(of_port_status);
+}
+
+/* Appends an action to a bucket, which may already be in a list */
+static void utestActionAppend(of_bucket_t *bucket, of_object_t *action)
+{
+  of_list_action_t actions;
+
+  of_bucket_actions_bind(bucket, &actions);
+  if (of_list_append(&actions, action) != 0)
+  {
+    fprintf(stderr, "of_list_append failed\n");
+    exit(1);
+  }
+  of_object_delete(action);
+}
+
+static void utestGroupAction(of_bucket_t *bucket, uint32_t groupId)
+{
+  of_action_group_t *action = of_action_group_new(OF_VERSION_1_3);
+
+  of_action_group_group_id_set(action, groupId);
+  utestActionAppend(bucket, (of_object_t *)action);
+}
+
+static void utestOutputAction(of_bucket_t *bucket, uint32_t port)
+{
+  of_action_output_t *action = of_action_output_new(OF_VERSION_1_3);
+
+  of_action_output_port_set(action, port);
+  utestActionAppend(bucket, (of_object_t *)action);
+}
+
+/* A set-field of the destination MAC; the OXM is padded to 8 bytes */
+static void utestDstMacAction(of_bucket_t *bucket, uint8_t lastByte)
+{
+  of_action_set_field_t *action = of_action_set_field_new(OF_VERSION_1_3);
+  uint8_t oxm[12] = { 0x80, 0x00, 0x06, 0x06, 0x00, 0x00, 0x5e, 0x00, 0x01, 0x00 };
+  of_octets_t octets = { oxm, sizeof(oxm) };
+
+  oxm[9] = lastByte;
+  if (of_action_set_field_field_set(action, &octets) < 0)
+  {
+    fprintf(stderr, "of_action_set_field_field_set failed\n");
+    exit(1);
+  }
+  utestActionAppend(bucket, (of_object_t *)action);
+}
+
+static of_group_mod_t *utestGroupModNew(void)
+{
+  of_group_mod_t *groupMod = of_group_mod_new(OF_VERSION_1_3);
+
+  if (groupMod == NULL)
+  {
+    fprintf(stderr, "of_group_mod_new failed\n");
+    exit(1);
+  }
+  return groupMod;
+}
+
+static void utestBucketAppend(of_group_mod_t *groupMod, of_bucket_t *bucket)
+{
+  of_list_bucket_t buckets;
+
+  of_group_mod_buckets_bind(groupMod, &buckets);
+  if (of_list_append(&buckets, bucket) != 0)
+  {
+    fprintf(stderr, "of_list_append failed\n");
+    exit(1);
+  }
+  of_object_delete(bucket);
+}
+
+/* A group mod whose buckets reference each of refs[] in turn */
+static of_group_mod_t *utestRefBucketsNew(const uint32_t *refs, int count)
+{
+  of_group_mod_t *groupMod = utestGroupModNew();
+  of_bucket_t *bucket;
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    bucket = of_bucket_new(OF_VERSION_1_3);
+    utestGroupAction(bucket, refs[i]);
+    utestBucketAppend(groupMod, bucket);
+  }
+  return groupMod;
+}
+
+static indigo_error_t utestGroupAdd(uint32_t groupId, of_group_mod_t *groupMod)
+{
+  of_list_bucket_t buckets;
+  indigo_error_t err;
+
+  of_group_mod_buckets_bind(groupMod, &buckets);
+  err = indigo_fwd_group_add(groupId, OF_GROUP_TYPE_ALL, &buckets);
+  of_group_mod_delete(groupMod);
+  return err;
+}
+
+static indigo_error_t utestGroupModify(uint32_t groupId, of_group_mod_t *groupMod)
+{
+  of_list_bucket_t buckets;
+  indigo_error_t err;
+
+  of_group_mod_buckets_bind(groupMod, &buckets);
+  ofdpaMockCallCountClear();
+  err = indigo_fwd_group_modify(groupId, &buckets);
+  of_group_mod_delete(groupMod);
+  return err;
+}
+
+static indigo_error_t utestL2InterfaceAdd(uint32_t port)
+{
+  of_group_mod_t *groupMod = utestGroupModNew();
+  of_bucket_t *bucket = of_bucket_new(OF_VERSION_1_3);
+
+  utestOutputAction(bucket, port);
+  utestBucketAppend(groupMod, bucket);
+  return utestGroupAdd(UTEST_L2_INTERFACE(port), groupMod);
+}
+
+/*
+ * Whether the mock holds exactly the buckets of groupId listed by
+ * index in indexes[] and reference group in refs[], in index order
+ */
+static int utestBucketsCheck(uint32_t groupId, const uint32_t *indexes,
+                             const uint32_t *refs, int count)
+{
+  ofdpaGroupBucketEntry_t entry;
+  OFDPA_ERROR_t rv;
+  int i = 0;
+
+  for (rv = ofdpaGroupBucketEntryFirstGet(groupId, &entry);
+       rv == OFDPA_E_NONE;
+       rv = ofdpaGroupBucketEntryNextGet(groupId, entry.bucketIndex, &entry))
+  {
+    if ((i >= count) ||
+        (entry.bucketIndex != indexes[i]) ||
+        (entry.referenceGroupId != refs[i]))
+    {
+      fprintf(stderr, "\ngroup 0x%x bucket %d: index %u ref 0x%x\n",
+              groupId, i, entry.bucketIndex, entry.referenceGroupId);
+      return 0;
+    }
+    i++;
+  }
+
+  return i == count;
+}
+
+#define UTEST_BUCKETS_CHECK(groupId, indexes, refs) \
+  utestBucketsCheck(groupId, indexes, refs, sizeof(indexes) / sizeof(indexes[0]))
+
+#define UTEST_CALLS(call) ofdpaMockCallCountGet(#call)
+
+static const uint32_t utestL2[] =
+{
+  UTEST_L2_INTERFACE(1), UTEST_L2_INTERFACE(2), UTEST_L2_INTERFACE(3),
+  UTEST_L2_INTERFACE(4), UTEST_L2_INTERFACE(5),
+};
+
+static int utestSetup(void)
+{
+  uint32_t i;
+
+  ofdpaMockReset();
+  for (i = 0; i < sizeof(utestL2) / sizeof(utestL2[0]); i++)
+  {
+    TEST_ASSERT(utestL2InterfaceAdd(i + 1) == INDIGO_ERROR_NONE);
+  }
+  return TEST_PASS;
+}
+
+static int test_flood_grow(void)
+{
+  uint32_t A = utestL2[0], B = utestL2[1], C = utestL2[2], D = utestL2[3];
+  const uint32_t refs[] = { A, B };
+  const uint32_t grown[] = { A, B, C, D };
+  const uint32_t indexes[] = { 0, 1, 2, 3 };
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestGroupAdd(UTEST_L2_FLOOD(1), utestRefBucketsNew(refs, 2)) == INDIGO_ERROR_NONE);
+
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(grown, 4)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 2);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 0);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryModify) == 0);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), indexes, grown));
+
+  /* The same buckets again take no calls at all */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(grown, 4)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(ofdpaMockCallCountGet(NULL) == 0);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), indexes, grown));
+
+  return TEST_PASS;
+}
+
+static int test_flood_shrink(void)
+{
+  uint32_t A = utestL2[0], B = utestL2[1], C = utestL2[2], D = utestL2[3];
+  const uint32_t refs[] = { A, B, C, D };
+  const uint32_t shrunk[] = { B, D };
+  const uint32_t indexes[] = { 1, 3 };
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestGroupAdd(UTEST_L2_FLOOD(1), utestRefBucketsNew(refs, 4)) == INDIGO_ERROR_NONE);
+
+  /* The buckets kept stay where they were programmed */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(shrunk, 2)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 0);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 2);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), indexes, shrunk));
+
+  return TEST_PASS;
+}
+
+static int test_flood_reorder(void)
+{
+  uint32_t A = utestL2[0], B = utestL2[1], C = utestL2[2], D = utestL2[3], E = utestL2[4];
+  const uint32_t refs[] = { A, B, C, D };
+  const uint32_t shrunk[] = { B, D };
+  const uint32_t reordered[] = { D, B, A };
+  const uint32_t reorderedRefs[] = { A, B, D };
+  const uint32_t reorderedIndexes[] = { 0, 1, 3 };
+  const uint32_t replaced[] = { E, D, C };
+  const uint32_t replacedIndexes[] = { 2, 3, 4 };
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestGroupAdd(UTEST_L2_FLOOD(1), utestRefBucketsNew(refs, 4)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(shrunk, 2)) == INDIGO_ERROR_NONE);
+
+  /* Reordering costs nothing; the new bucket takes the lowest free index */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(reordered, 3)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 1);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 0);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), reorderedIndexes, reorderedRefs));
+
+  /* Added before deleted, so indexes of buckets on their way out are skipped */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(replaced, 3)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 2);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 2);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), replacedIndexes, replaced));
+
+  return TEST_PASS;
+}
+
+static int test_flood_failure(void)
+{
+  uint32_t A = utestL2[0], B = utestL2[1], C = utestL2[2], D = utestL2[3];
+  uint32_t X = UTEST_L2_INTERFACE(UTEST_PORT_MISSING);
+  const uint32_t refs[] = { A, B };
+  const uint32_t failing[] = { A, C, X, D };
+  const uint32_t partialRefs[] = { A, B, C };
+  const uint32_t partialIndexes[] = { 0, 1, 2 };
+  const uint32_t repaired[] = { B, D };
+  const uint32_t repairedIndexes[] = { 0, 1 };
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestGroupAdd(UTEST_L2_FLOOD(1), utestRefBucketsNew(refs, 2)) == INDIGO_ERROR_NONE);
+
+  /* Stops at the bucket the mock refuses; what was added stays */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(failing, 4)) != INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 2);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 0);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), partialIndexes, partialRefs));
+
+  /* The driver no longer trusts its shadow and rewrites every bucket */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(repaired, 2)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketsDeleteAll) == 1);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 2);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L2_FLOOD(1), repairedIndexes, repaired));
+
+  /* And diffs against what it rewrote from then on */
+  TEST_ASSERT(utestGroupModify(UTEST_L2_FLOOD(1), utestRefBucketsNew(repaired, 2)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(ofdpaMockCallCountGet(NULL) == 0);
+
+  return TEST_PASS;
+}
+
+static of_group_mod_t *utestL3UnicastNew(uint32_t ref, uint8_t mac)
+{
+  of_group_mod_t *groupMod = utestGroupModNew();
+  of_bucket_t *bucket = of_bucket_new(OF_VERSION_1_3);
+
+  utestDstMacAction(bucket, mac);
+  utestGroupAction(bucket, ref);
+  utestBucketAppend(groupMod, bucket);
+  return groupMod;
+}
+
+static int test_unicast_modify(void)
+{
+  uint32_t A = utestL2[0], B = utestL2[1];
+  const uint32_t index[] = { 0 };
+  const uint32_t refA[] = { A };
+  const uint32_t refB[] = { B };
+  ofdpaGroupBucketEntry_t entry;
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestGroupAdd(UTEST_L3_UNICAST(1), utestL3UnicastNew(A, 1)) == INDIGO_ERROR_NONE);
+
+  /* A new MAC with the same reference is modified in place */
+  TEST_ASSERT(utestGroupModify(UTEST_L3_UNICAST(1), utestL3UnicastNew(A, 2)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(ofdpaMockCallCountGet(NULL) == 1);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryModify) == 1);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L3_UNICAST(1), index, refA));
+  TEST_ASSERT(ofdpaGroupBucketEntryGet(UTEST_L3_UNICAST(1), 0, &entry) == OFDPA_E_NONE);
+  TEST_ASSERT(entry.bucketData.l3Unicast.dstMac.addr[5] == 2);
+
+  /* A new reference replaces the only bucket, deleting it first */
+  TEST_ASSERT(utestGroupModify(UTEST_L3_UNICAST(1), utestL3UnicastNew(B, 2)) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryDelete) == 1);
+  TEST_ASSERT(UTEST_CALLS(ofdpaGroupBucketEntryAdd) == 1);
+  TEST_ASSERT(UTEST_BUCKETS_CHECK(UTEST_L3_UNICAST(1), index, refB));
+
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+  if (ofdpaClientInitialize("ind_ofdpa_group_utest") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the socket manager\n");
+    return 1;
+  }
+
+  RUN_TEST(flood_grow);
+  RUN_TEST(flood_shrink);
+  RUN_TEST(flood_reorder);
+  RUN_TEST(flood_failure);
+  RUN_TEST(unicast_modify);
+
+  ind_soc_finish();
+  return global_error;
+}
@@ -0,0 +1,239 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_match_template_utest.c
+*
+* @purpose      Unit tests of the flow mod match validation
+*
+* @component    OF-DPA
+*
+* @comments     Matches are built directly and given to
+*               indigo_fwd_flow_match_validate(), with the field bitmap
+*               of_match.c leaves in ind_ofdpa_match_fields_bitmask set to
+*               something else, so that only the match itself is judged.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <ind_ofdpa_util.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+/* Not called by the validation; the flow mod translation needs them */
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  of_port_status_delete(of_port_status);
+}
+
+indigo_error_t indigo_core_packet_in(of_packet_in_t *packet_in)
+{
+  of_packet_in_delete(packet_in);
+  return INDIGO_ERROR_NONE;
+}
+
+void indigo_core_flow_removed(indigo_fi_flow_removed_t reason,
+                              indigo_fi_flow_stats_t *flow_stats)
+{
+}
+
+void indigo_core_flow_create_callback(indigo_error_t result, indigo_cookie_t flow_id)
+{
+}
+
+indigo_error_t indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
+{
+  of_object_delete(obj);
+  return INDIGO_ERROR_NONE;
+}
+
+static void utestMatchInit(of_match_t *match)
+{
+  memset(match, 0, sizeof(*match));
+  match->version = OF_VERSION_1_3;
+}
+
+static void utestMatchIpv4Set(of_match_t *match)
+{
+  match->fields.eth_type = ETH_P_IP;
+  OF_MATCH_MASK_ETH_TYPE_EXACT_SET(match);
+}
+
+/*
+ * Validates the match with the parser's bitmap claiming the opposite
+ * of what the match holds: every field when it is refused, none when
+ * it is accepted. Returns INDIGO_ERROR_UNKNOWN if the bitmap made a
+ * difference.
+ */
+static indigo_error_t utestValidate(uint8_t tableId, of_match_t *match, uint16_t *code)
+{
+  indigo_error_t err;
+
+  ind_ofdpa_match_fields_bitmask = 0;
+  err = indigo_fwd_flow_match_validate(tableId, match, code);
+  ind_ofdpa_match_fields_bitmask = ~0;
+  if (indigo_fwd_flow_match_validate(tableId, match, code) != err)
+  {
+    return INDIGO_ERROR_UNKNOWN;
+  }
+  return err;
+}
+
+static int test_accepted(void)
+{
+  of_match_t match;
+  uint16_t code = 0;
+
+  /* A unicast route */
+  utestMatchInit(&match);
+  utestMatchIpv4Set(&match);
+  match.fields.ipv4_dst = 0x0a000000;
+  match.masks.ipv4_dst = 0xffffff00;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING, &match, &code) ==
+              INDIGO_ERROR_NONE);
+
+  /* An ACL policy on TCP */
+  utestMatchInit(&match);
+  utestMatchIpv4Set(&match);
+  match.fields.ip_proto = IPPROTO_TCP;
+  OF_MATCH_MASK_IP_PROTO_EXACT_SET(&match);
+  match.fields.tcp_dst = 80;
+  OF_MATCH_MASK_TCP_DST_EXACT_SET(&match);
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &match, &code) ==
+              INDIGO_ERROR_NONE);
+
+  /* Tables the driver does not know are left to the translation */
+  utestMatchInit(&match);
+  match.fields.ip_ecn = 1;
+  match.masks.ip_ecn = 0xff;
+  TEST_ASSERT(utestValidate(200, &match, &code) == INDIGO_ERROR_NONE);
+
+  return TEST_PASS;
+}
+
+static int test_required_missing(void)
+{
+  of_match_t match;
+  uint16_t code = 0;
+
+  /* The termination MAC table wildcards only the port and VLAN */
+  utestMatchInit(&match);
+  match.fields.in_port = 1;
+  OF_MATCH_MASK_IN_PORT_EXACT_SET(&match);
+  match.fields.eth_dst.addr[0] = 0x01;
+  OF_MATCH_MASK_ETH_DST_EXACT_SET(&match);
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_TERMINATION_MAC, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_WILDCARDS_BY_VERSION(OF_VERSION_1_3));
+
+  utestMatchIpv4Set(&match);
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_TERMINATION_MAC, &match, &code) ==
+              INDIGO_ERROR_NONE);
+
+  /* The VLAN table needs the ingress port */
+  utestMatchInit(&match);
+  match.fields.vlan_vid = OFDPA_VID_PRESENT | 10;
+  match.masks.vlan_vid = 0xffff;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_VLAN, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_WILDCARDS_BY_VERSION(OF_VERSION_1_3));
+
+  return TEST_PASS;
+}
+
+static int test_masked_exact_only(void)
+{
+  of_match_t match;
+  uint16_t code = 0;
+
+  /* The VLAN table takes the ingress port exact only */
+  utestMatchInit(&match);
+  match.fields.in_port = 0x100;
+  match.masks.in_port = 0xffffff00;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_VLAN, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_MASK_BY_VERSION(OF_VERSION_1_3));
+
+  /* The bridging table masks the destination MAC but not the VID */
+  utestMatchInit(&match);
+  match.fields.vlan_vid = OFDPA_VID_PRESENT | 0x10;
+  match.masks.vlan_vid = 0x1ff0;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_BRIDGING, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_MASK_BY_VERSION(OF_VERSION_1_3));
+
+  match.masks.vlan_vid = 0xffff;
+  match.fields.eth_dst.addr[0] = 0x01;
+  match.masks.eth_dst.addr[0] = 0x01;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_BRIDGING, &match, &code) ==
+              INDIGO_ERROR_NONE);
+
+  return TEST_PASS;
+}
+
+static int test_ecn(void)
+{
+  of_match_t match;
+  uint16_t code = 0;
+
+  /* The ACL policy table does not match ECN, even with its prerequisite */
+  utestMatchInit(&match);
+  utestMatchIpv4Set(&match);
+  match.fields.ip_ecn = 1;
+  match.masks.ip_ecn = 0xff;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_FIELD_BY_VERSION(OF_VERSION_1_3));
+
+  /* Its DSCP neighbour needs the IP ethertype */
+  utestMatchInit(&match);
+  match.fields.ip_dscp = 10;
+  match.masks.ip_dscp = 0xff;
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &match, &code) ==
+              INDIGO_ERROR_COMPAT);
+  TEST_ASSERT(code == OF_MATCH_FAILED_BAD_PREREQ_BY_VERSION(OF_VERSION_1_3));
+
+  utestMatchIpv4Set(&match);
+  TEST_ASSERT(utestValidate(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &match, &code) ==
+              INDIGO_ERROR_NONE);
+
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  RUN_TEST(accepted);
+  RUN_TEST(required_missing);
+  RUN_TEST(masked_exact_only);
+  RUN_TEST(ecn);
+
+  return global_error;
+}
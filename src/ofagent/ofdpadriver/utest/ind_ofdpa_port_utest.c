@@ -0,0 +1,225 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_port_utest.c
+*
+* @purpose      Unit tests of port events against libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Ports are deleted and brought back in the mock and the
+*               events read by the driver, with a coalescing window
+*               long enough that the port status goes out after the
+*               event. The tests check the status the controller gets
+*               and the ports listed in port desc replies meanwhile.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <indigo/forwarding.h>
+#include <indigo/port_manager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+/* Defined by ind_ofdpa_fwd.c, which is not linked; used by of_match.c */
+ind_ofdpa_fields_t ind_ofdpa_match_fields_bitmask;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+#define UTEST_WINDOW_MS 50
+
+#define UTEST_PORT 3
+
+/* The last port status sent, and how many were */
+static of_port_status_t *utestPortStatus;
+static int utestPortStatusCount;
+
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  if (utestPortStatus != NULL)
+  {
+    of_port_status_delete(utestPortStatus);
+  }
+  utestPortStatus = of_port_status;
+  utestPortStatusCount++;
+}
+
+/* Read the mock's port events, then run the event loop until the
+   coalescing window has closed */
+static void utestPortEventsRun(void)
+{
+  int i;
+
+  ind_ofdpa_port_event_receive();
+  for (i = 0; i < 2 * UTEST_WINDOW_MS / 10; i++)
+  {
+    ind_soc_select_and_run(10);
+  }
+}
+
+/* Whether a port desc stats reply lists the port */
+static int utestPortListed(uint32_t port)
+{
+  of_port_desc_stats_reply_t *reply;
+  of_list_port_desc_t list;
+  of_port_desc_t desc;
+  of_port_no_t portNo;
+  int rv, listed = 0;
+
+  reply = of_port_desc_stats_reply_new(OF_VERSION_1_3);
+  if ((reply == NULL) || (indigo_port_desc_stats_get(reply) != INDIGO_ERROR_NONE))
+  {
+    fprintf(stderr, "indigo_port_desc_stats_get failed\n");
+    exit(1);
+  }
+
+  of_port_desc_stats_reply_entries_bind(reply, &list);
+  OF_LIST_PORT_DESC_ITER(&list, &desc, rv)
+  {
+    of_port_desc_port_no_get(&desc, &portNo);
+    if (portNo == port)
+    {
+      listed = 1;
+    }
+  }
+  of_port_desc_stats_reply_delete(reply);
+  return listed;
+}
+
+/* Whether the port status sent last is for the port, with the reason,
+   and carries the description the mock gives the port */
+static int utestPortStatusCheck(uint32_t port, uint8_t reason)
+{
+  of_port_desc_t desc;
+  of_port_name_t name;
+  of_mac_addr_t mac;
+  of_port_no_t portNo;
+  uint8_t statusReason;
+  char expected[OF_MAX_PORT_NAME_LEN];
+
+  TEST_ASSERT(utestPortStatus != NULL);
+  of_port_status_reason_get(utestPortStatus, &statusReason);
+  TEST_ASSERT(statusReason == reason);
+
+  of_port_status_desc_bind(utestPortStatus, &desc);
+  of_port_desc_port_no_get(&desc, &portNo);
+  TEST_ASSERT(portNo == port);
+
+  of_port_desc_name_get(&desc, &name);
+  snprintf(expected, sizeof(expected), "port%u", port);
+  TEST_ASSERT(strcmp(name, expected) == 0);
+
+  of_port_desc_hw_addr_get(&desc, &mac);
+  TEST_ASSERT((mac.addr[0] == 0x02) && (mac.addr[1] == 0) && (mac.addr[2] == 0) &&
+              (mac.addr[3] == 0) && (mac.addr[4] == 0) && (mac.addr[5] == port));
+  return TEST_PASS;
+}
+
+static int test_delete(void)
+{
+  utestPortStatusCount = 0;
+  TEST_ASSERT(utestPortListed(UTEST_PORT));
+
+  /* Gone from replies at once, reported when the window closes */
+  TEST_ASSERT(ofdpaMockPortPresentSet(UTEST_PORT, 0) == OFDPA_E_NONE);
+  ind_ofdpa_port_event_receive();
+  TEST_ASSERT(utestPortStatusCount == 0);
+  TEST_ASSERT(!utestPortListed(UTEST_PORT));
+
+  utestPortEventsRun();
+  TEST_ASSERT(utestPortStatusCount == 1);
+  TEST_ASSERT(utestPortStatusCheck(UTEST_PORT, OF_PORT_CHANGE_REASON_DELETE) == TEST_PASS);
+  TEST_ASSERT(!utestPortListed(UTEST_PORT));
+
+  /* Back again */
+  TEST_ASSERT(ofdpaMockPortPresentSet(UTEST_PORT, 1) == OFDPA_E_NONE);
+  utestPortEventsRun();
+  TEST_ASSERT(utestPortStatusCount == 2);
+  TEST_ASSERT(utestPortStatusCheck(UTEST_PORT, OF_PORT_CHANGE_REASON_ADD) == TEST_PASS);
+  TEST_ASSERT(utestPortListed(UTEST_PORT));
+
+  return TEST_PASS;
+}
+
+static int test_delete_recreate(void)
+{
+  utestPortStatusCount = 0;
+
+  /* Deleted and back within one window: the controller still has it */
+  TEST_ASSERT(ofdpaMockPortPresentSet(UTEST_PORT, 0) == OFDPA_E_NONE);
+  ind_ofdpa_port_event_receive();
+  TEST_ASSERT(!utestPortListed(UTEST_PORT));
+  TEST_ASSERT(ofdpaMockPortPresentSet(UTEST_PORT, 1) == OFDPA_E_NONE);
+  ind_ofdpa_port_event_receive();
+  TEST_ASSERT(utestPortListed(UTEST_PORT));
+
+  utestPortEventsRun();
+  TEST_ASSERT(utestPortStatusCount == 1);
+  TEST_ASSERT(utestPortStatusCheck(UTEST_PORT, OF_PORT_CHANGE_REASON_MODIFY) == TEST_PASS);
+  TEST_ASSERT(utestPortListed(UTEST_PORT));
+
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+  ind_ofdpa_port_status_config_t statusConfig = { UTEST_WINDOW_MS, 0 };
+
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+  if (ofdpaClientInitialize("ind_ofdpa_port_utest") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the socket manager\n");
+    return 1;
+  }
+  ind_ofdpa_port_status_config_set(&statusConfig);
+  if (ind_ofdpa_port_desc_cache_init() != INDIGO_ERROR_NONE)
+  {
+    fprintf(stderr, "ind_ofdpa_port_desc_cache_init failed\n");
+    return 1;
+  }
+
+  RUN_TEST(delete);
+  RUN_TEST(delete_recreate);
+
+  ind_ofdpa_port_status_finish();
+  ind_ofdpa_port_desc_cache_finish();
+  if (utestPortStatus != NULL)
+  {
+    of_port_status_delete(utestPortStatus);
+  }
+  ind_soc_finish();
+  return global_error;
+}
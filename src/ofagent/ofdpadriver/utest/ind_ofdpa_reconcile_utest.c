@@ -0,0 +1,439 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_reconcile_utest.c
+*
+* @purpose      Unit tests of reconciliation against libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Flow and group mods go through the state manager and the
+*               driver into the mock. The tests then change the mock
+*               behind the agent's back, or restart the state manager
+*               over what the mock holds, and check what
+*               ind_ofdpa_reconcile() finds and leaves in the mock.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <OFStateManager/ofstatemanager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+#define UTEST_FLOW_COUNT 10
+
+/* What the state manager sent to the controller */
+static int utestErrors;
+static int utestFlowsRemoved;
+
+/****************************************************************
+ * Connection manager stubs
+ ****************************************************************/
+
+void ind_cxn_reset(indigo_cxn_id_t cxn_id)
+{
+}
+
+int indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
+                              uint32_t xid, uint16_t type, uint16_t code,
+                              of_octets_t *octets)
+{
+  utestErrors++;
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
+{
+  if (obj->object_id == OF_FLOW_REMOVED)
+  {
+    utestFlowsRemoved++;
+  }
+  of_object_delete(obj);
+  return INDIGO_ERROR_NONE;
+}
+
+/****************************************************************/
+
+/* An ACL flow per TCP port that asks for flow-removed messages */
+static void utestFlowAdd(uint16_t tcpDst)
+{
+  of_flow_add_t *flowAdd;
+  of_match_t match;
+
+  flowAdd = of_flow_add_new(OF_VERSION_1_3);
+
+  memset(&match, 0, sizeof(match));
+  match.version = OF_VERSION_1_3;
+  match.fields.eth_type = ETH_P_IP;
+  OF_MATCH_MASK_ETH_TYPE_EXACT_SET(&match);
+  match.fields.ip_proto = IPPROTO_TCP;
+  OF_MATCH_MASK_IP_PROTO_EXACT_SET(&match);
+  match.fields.tcp_dst = tcpDst;
+  OF_MATCH_MASK_TCP_DST_EXACT_SET(&match);
+
+  of_flow_add_table_id_set(flowAdd, OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+  of_flow_add_priority_set(flowAdd, 1000);
+  of_flow_add_flags_set(flowAdd, OF_FLOW_MOD_FLAG_SEND_FLOW_REM_BY_VERSION(OF_VERSION_1_3));
+  if (of_flow_add_match_set(flowAdd, &match) < 0)
+  {
+    fprintf(stderr, "of_flow_add_match_set failed\n");
+    exit(1);
+  }
+
+  indigo_core_receive_controller_message(0, flowAdd);
+}
+
+/* An L2 interface group out of port, with the output action only */
+static void utestL2InterfaceGroupAdd(uint32_t port)
+{
+  of_group_mod_t *groupMod = of_group_mod_new(OF_VERSION_1_3);
+  of_list_bucket_t buckets;
+  of_list_action_t actions;
+  of_bucket_t *bucket;
+  of_action_output_t *output;
+
+  of_group_mod_command_set(groupMod, OF_GROUP_ADD);
+  of_group_mod_group_type_set(groupMod, OF_GROUP_TYPE_INDIRECT);
+  of_group_mod_group_id_set(groupMod, port);
+
+  bucket = of_bucket_new(OF_VERSION_1_3);
+  of_bucket_actions_bind(bucket, &actions);
+  output = of_action_output_new(OF_VERSION_1_3);
+  of_action_output_port_set(output, port);
+  if ((of_list_append(&actions, output) != 0) ||
+      (of_group_mod_buckets_bind(groupMod, &buckets), of_list_append(&buckets, bucket) != 0))
+  {
+    fprintf(stderr, "of_list_append failed\n");
+    exit(1);
+  }
+  of_object_delete(output);
+  of_object_delete(bucket);
+
+  indigo_core_receive_controller_message(0, groupMod);
+}
+
+/* Cookies of the flows the mock holds, in table order */
+static int utestMockCookies(uint64_t *cookies, int max)
+{
+  ofdpaFlowEntry_t flow, nextFlow;
+  uint32_t i;
+  int count = 0;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    ofdpaFlowEntryInit(tableNameList[i].type, &flow);
+    while (ofdpaFlowNextGet(&flow, &nextFlow) == OFDPA_E_NONE)
+    {
+      flow = nextFlow;
+      if (count < max)
+      {
+        cookies[count] = flow.cookie;
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
+static int utestMockGroupCount(void)
+{
+  ofdpaGroupEntry_t nextGroup;
+  uint32_t groupId = 0;
+  int count = 0;
+
+  while (ofdpaGroupNextGet(groupId, &nextGroup) == OFDPA_E_NONE)
+  {
+    groupId = nextGroup.groupId;
+    count++;
+  }
+  return count;
+}
+
+static int utestSetup(void)
+{
+  int i;
+
+  ofdpaMockReset();
+  for (i = 0; i < UTEST_FLOW_COUNT; i++)
+  {
+    utestFlowAdd(i + 1);
+  }
+  utestErrors = 0;
+  utestFlowsRemoved = 0;
+  return TEST_PASS;
+}
+
+static int utestTeardown(void)
+{
+  of_flow_delete_t *flowDelete;
+  int i;
+
+  /* Every table, so no flow outlives the mock reset of the next test */
+  flowDelete = of_flow_delete_new(OF_VERSION_1_3);
+  of_flow_delete_table_id_set(flowDelete, 0xff);
+  of_flow_delete_out_port_set(flowDelete, OF_PORT_DEST_WILDCARD);
+  indigo_core_receive_controller_message(0, flowDelete);
+
+  /* The delete walks the flow table as a socket manager task */
+  for (i = 0; (i < 100) && (utestMockCookies(NULL, 0) != 0); i++)
+  {
+    ind_soc_select_and_run(10);
+  }
+  TEST_ASSERT(utestMockCookies(NULL, 0) == 0);
+  utestFlowsRemoved = 0;
+  return TEST_PASS;
+}
+
+static int test_in_sync(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  uint64_t cookies[UTEST_FLOW_COUNT];
+  int i;
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestMockCookies(cookies, UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT);
+  for (i = 0; i < UTEST_FLOW_COUNT; i++)
+  {
+    TEST_ASSERT(ind_core_flow_id_present(cookies[i]));
+  }
+
+  ofdpaMockCallCountClear();
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.hwFlows == UTEST_FLOW_COUNT);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize);
+  TEST_ASSERT(stats.orphanFlows == 0 && stats.staleFlows == 0);
+  TEST_ASSERT(ofdpaMockCallCountGet("ofdpaFlowByCookieDelete") == 0);
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+static int test_digest_mismatch(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  ofdpaFlowEntry_t flow;
+  ofdpaFlowEntryStats_t flowStats;
+  uint64_t cookies[UTEST_FLOW_COUNT];
+  uint64_t orphan;
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestMockCookies(cookies, UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT);
+
+  /* A flow the agent did not add, and one of its own gone missing */
+  TEST_ASSERT(ofdpaFlowByCookieGet(cookies[0], &flow, &flowStats) == OFDPA_E_NONE);
+  orphan = cookies[0] ^ 0xffff;
+  flow.cookie = orphan;
+  flow.priority++;
+  TEST_ASSERT(ofdpaFlowAdd(&flow) == OFDPA_E_NONE);
+  TEST_ASSERT(ofdpaFlowByCookieDelete(cookies[1]) == OFDPA_E_NONE);
+
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize - 1);
+  TEST_ASSERT(stats.orphanFlows == 1);
+  TEST_ASSERT(stats.staleFlows == 1);
+  TEST_ASSERT(ofdpaFlowByCookieGet(orphan, &flow, &flowStats) != OFDPA_E_NONE);
+  TEST_ASSERT(!ind_core_flow_id_present(cookies[1]));
+  TEST_ASSERT(utestFlowsRemoved == 1);
+
+  /* Both sides agree from then on */
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize);
+  TEST_ASSERT(utestMockCookies(cookies, UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT - 1);
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+static int test_content_mismatch(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  ofdpaFlowEntry_t flow;
+  ofdpaFlowEntryStats_t flowStats;
+  uint64_t cookies[UTEST_FLOW_COUNT];
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+  TEST_ASSERT(utestMockCookies(cookies, UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT);
+
+  /* One of the agent's flows changed behind its back, cookie and all kept */
+  TEST_ASSERT(ofdpaFlowByCookieGet(cookies[2], &flow, &flowStats) == OFDPA_E_NONE);
+  flow.flowData.policyAclFlowEntry.clearActions = 1;
+  TEST_ASSERT(ofdpaFlowModify(&flow) == OFDPA_E_NONE);
+
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize - 1);
+  TEST_ASSERT(stats.staleFlows == 1);
+  TEST_ASSERT(stats.orphanFlows == 1);
+  TEST_ASSERT(!ind_core_flow_id_present(cookies[2]));
+  TEST_ASSERT(ofdpaFlowByCookieGet(cookies[2], &flow, &flowStats) != OFDPA_E_NONE);
+  TEST_ASSERT(utestFlowsRemoved == 1);
+
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize);
+  TEST_ASSERT(utestMockCookies(cookies, UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT - 1);
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+/* A restart of the state manager, as after an agent restart */
+static int utestRestart(void)
+{
+  ind_core_config_t coreConfig;
+
+  TEST_ASSERT(ind_core_finish() == INDIGO_ERROR_NONE);
+  memset(&coreConfig, 0, sizeof(coreConfig));
+  coreConfig.expire_flows = 1;
+  coreConfig.stats_check_ms = 900;
+  TEST_ASSERT(ind_core_init(&coreConfig) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(ind_core_enable_set(1) == INDIGO_ERROR_NONE);
+  return TEST_PASS;
+}
+
+static int test_restart(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  uint64_t cookies[2 * UTEST_FLOW_COUNT];
+  int i;
+
+  /* Both runs of the agent number their flows from the start */
+  TEST_ASSERT(utestRestart() == TEST_PASS);
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+
+  /* The flows stay in the mock across the restart */
+  TEST_ASSERT(utestRestart() == TEST_PASS);
+
+  /* The same number of new flows, so only the cookies tell them apart */
+  for (i = 0; i < UTEST_FLOW_COUNT; i++)
+  {
+    utestFlowAdd(UTEST_FLOW_COUNT + i + 1);
+  }
+  TEST_ASSERT(utestErrors == 0);
+  TEST_ASSERT(utestMockCookies(cookies, 2 * UTEST_FLOW_COUNT) == 2 * UTEST_FLOW_COUNT);
+
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.orphanFlows == UTEST_FLOW_COUNT);
+  TEST_ASSERT(stats.staleFlows == 0);
+  TEST_ASSERT(utestMockCookies(cookies, 2 * UTEST_FLOW_COUNT) == UTEST_FLOW_COUNT);
+  for (i = 0; i < UTEST_FLOW_COUNT; i++)
+  {
+    TEST_ASSERT(ind_core_flow_id_present(cookies[i]));
+  }
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+static int test_groups(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  ofdpaGroupEntry_t group;
+  ofdpaGroupBucketEntry_t bucket;
+  uint32_t floodId = (OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD << 28) | 1;
+
+  ofdpaMockReset();
+  utestL2InterfaceGroupAdd(1);
+  utestL2InterfaceGroupAdd(2);
+  TEST_ASSERT(utestErrors == 0);
+  TEST_ASSERT(ind_core_group_id_present(1) && ind_core_group_id_present(2));
+
+  /*
+   * Orphans: an L2 interface group, and ahead of it in the walk a flood
+   * group referencing it, so it can only go on a second pass
+   */
+  memset(&group, 0, sizeof(group));
+  group.groupId = 3;
+  TEST_ASSERT(ofdpaGroupAdd(&group) == OFDPA_E_NONE);
+  memset(&bucket, 0, sizeof(bucket));
+  bucket.groupId = 3;
+  bucket.bucketData.l2Interface.outputPort = 3;
+  TEST_ASSERT(ofdpaGroupBucketEntryAdd(&bucket) == OFDPA_E_NONE);
+  group.groupId = floodId;
+  TEST_ASSERT(ofdpaGroupAdd(&group) == OFDPA_E_NONE);
+  memset(&bucket, 0, sizeof(bucket));
+  bucket.groupId = floodId;
+  bucket.referenceGroupId = 3;
+  TEST_ASSERT(ofdpaGroupBucketEntryAdd(&bucket) == OFDPA_E_NONE);
+
+  /* Stale: a group of the agent's removed behind its back */
+  TEST_ASSERT(ofdpaGroupDelete(2) == OFDPA_E_NONE);
+
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.hwGroups == 3);
+  TEST_ASSERT(stats.orphanGroups == 2);
+  TEST_ASSERT(stats.staleGroups == 1);
+  TEST_ASSERT(utestMockGroupCount() == 1);
+  TEST_ASSERT(ind_core_group_id_present(1) && !ind_core_group_id_present(2));
+
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+  ind_core_config_t coreConfig;
+
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+  if (ofdpaClientInitialize("ind_ofdpa_reconcile_utest") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  memset(&coreConfig, 0, sizeof(coreConfig));
+  coreConfig.expire_flows = 1;
+  coreConfig.stats_check_ms = 900;
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0) ||
+      (ind_core_init(&coreConfig) < 0) || (ind_core_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the state manager\n");
+    return 1;
+  }
+  if (ind_ofdpa_table_stats_init() != INDIGO_ERROR_NONE)
+  {
+    fprintf(stderr, "Failed to read the flow tables\n");
+    return 1;
+  }
+
+  RUN_TEST(in_sync);
+  RUN_TEST(digest_mismatch);
+  RUN_TEST(content_mismatch);
+  RUN_TEST(restart);
+  RUN_TEST(groups);
+
+  ind_ofdpa_table_stats_finish();
+  ind_core_finish();
+  ind_soc_finish();
+  return global_error;
+}
@@ -0,0 +1,317 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_rpc_utest.c
+*
+* @purpose      Unit tests of pipelined flow adds against libofdpa_mock
+*
+* @component    OF-DPA
+*
+* @comments     Flow mods go through the state manager and the driver,
+*               with the OF-DPA calls made on worker threads, into a mock
+*               whose ACL policy table is made too small for the last
+*               flow added. The tests check what the controller hears of
+*               the failed add, and that a fence reports it before the
+*               state manager goes on.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <OFStateManager/ofstatemanager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+/* Flows the ACL policy table has room for; one more is added */
+#define UTEST_FLOW_COUNT 4
+
+/* What the state manager sent to the controller */
+static int utestErrors;
+static int utestFlowsRemoved;
+
+static uint32_t utestAclMaxEntries;
+
+/****************************************************************
+ * Connection manager stubs
+ ****************************************************************/
+
+void ind_cxn_reset(indigo_cxn_id_t cxn_id)
+{
+}
+
+int indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
+                              uint32_t xid, uint16_t type, uint16_t code,
+                              of_octets_t *octets)
+{
+  utestErrors++;
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
+{
+  if (obj->object_id == OF_FLOW_REMOVED)
+  {
+    utestFlowsRemoved++;
+  }
+  of_object_delete(obj);
+  return INDIGO_ERROR_NONE;
+}
+
+/****************************************************************/
+
+static void utestMatchSet(of_match_t *match, uint16_t tcpDst)
+{
+  memset(match, 0, sizeof(*match));
+  match->version = OF_VERSION_1_3;
+  match->fields.eth_type = ETH_P_IP;
+  OF_MATCH_MASK_ETH_TYPE_EXACT_SET(match);
+  match->fields.ip_proto = IPPROTO_TCP;
+  OF_MATCH_MASK_IP_PROTO_EXACT_SET(match);
+  match->fields.tcp_dst = tcpDst;
+  OF_MATCH_MASK_TCP_DST_EXACT_SET(match);
+}
+
+/* An ACL flow per TCP port that asks for flow-removed messages */
+static void utestFlowAdd(uint16_t tcpDst)
+{
+  of_flow_add_t *flowAdd;
+  of_match_t match;
+
+  flowAdd = of_flow_add_new(OF_VERSION_1_3);
+  utestMatchSet(&match, tcpDst);
+  of_flow_add_table_id_set(flowAdd, OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+  of_flow_add_priority_set(flowAdd, 1000);
+  of_flow_add_flags_set(flowAdd, OF_FLOW_MOD_FLAG_SEND_FLOW_REM_BY_VERSION(OF_VERSION_1_3));
+  if (of_flow_add_match_set(flowAdd, &match) < 0)
+  {
+    fprintf(stderr, "of_flow_add_match_set failed\n");
+    exit(1);
+  }
+
+  indigo_core_receive_controller_message(0, flowAdd);
+}
+
+static void utestFlowDeleteStrict(uint16_t tcpDst)
+{
+  of_flow_delete_strict_t *flowDelete;
+  of_match_t match;
+
+  flowDelete = of_flow_delete_strict_new(OF_VERSION_1_3);
+  utestMatchSet(&match, tcpDst);
+  of_flow_delete_strict_table_id_set(flowDelete, OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+  of_flow_delete_strict_priority_set(flowDelete, 1000);
+  of_flow_delete_strict_out_port_set(flowDelete, OF_PORT_DEST_WILDCARD);
+  if (of_flow_delete_strict_match_set(flowDelete, &match) < 0)
+  {
+    fprintf(stderr, "of_flow_delete_strict_match_set failed\n");
+    exit(1);
+  }
+
+  indigo_core_receive_controller_message(0, flowDelete);
+}
+
+static uint32_t utestMockFlowCount(void)
+{
+  ofdpaFlowTableInfo_t info;
+
+  if (ofdpaFlowTableInfoGet(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &info) != OFDPA_E_NONE)
+  {
+    return 0;
+  }
+  return info.numEntries;
+}
+
+/* Run the event loop until every call made has been reported */
+static void utestCompletionsRun(void)
+{
+  ind_ofdpa_rpc_counters_t counters;
+  int i;
+
+  for (i = 0; i < 100; i++)
+  {
+    ind_ofdpa_rpc_counters_get(&counters);
+    if (counters.completed == counters.submitted)
+    {
+      break;
+    }
+    ind_soc_select_and_run(10);
+  }
+}
+
+/* A full ACL policy table once the flows are added */
+static int utestSetup(void)
+{
+  int i;
+
+  ofdpaMockReset();
+  TEST_ASSERT(ofdpaMockFlowTableMaxSet(OFDPA_FLOW_TABLE_ID_ACL_POLICY,
+                                       UTEST_FLOW_COUNT) == OFDPA_E_NONE);
+  for (i = 0; i < UTEST_FLOW_COUNT; i++)
+  {
+    utestFlowAdd(i + 1);
+  }
+  utestCompletionsRun();
+  TEST_ASSERT(utestMockFlowCount() == UTEST_FLOW_COUNT);
+  utestErrors = 0;
+  utestFlowsRemoved = 0;
+  return TEST_PASS;
+}
+
+static int utestTeardown(void)
+{
+  of_flow_delete_t *flowDelete;
+  int i;
+
+  flowDelete = of_flow_delete_new(OF_VERSION_1_3);
+  of_flow_delete_table_id_set(flowDelete, 0xff);
+  of_flow_delete_out_port_set(flowDelete, OF_PORT_DEST_WILDCARD);
+  indigo_core_receive_controller_message(0, flowDelete);
+
+  /* The delete walks the flow table as a socket manager task */
+  for (i = 0; (i < 100) && (utestMockFlowCount() != 0); i++)
+  {
+    ind_soc_select_and_run(10);
+  }
+  TEST_ASSERT(utestMockFlowCount() == 0);
+  TEST_ASSERT(ofdpaMockFlowTableMaxSet(OFDPA_FLOW_TABLE_ID_ACL_POLICY,
+                                       utestAclMaxEntries) == OFDPA_E_NONE);
+  utestFlowsRemoved = 0;
+  return TEST_PASS;
+}
+
+static int test_add_fails(void)
+{
+  ind_ofdpa_reconcile_stats_t stats;
+  ind_ofdpa_rpc_counters_t before, after;
+
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+
+  /* Queued to the workers, refused by OF-DPA later */
+  ind_ofdpa_rpc_counters_get(&before);
+  utestFlowAdd(UTEST_FLOW_COUNT + 1);
+  ind_ofdpa_rpc_counters_get(&after);
+  TEST_ASSERT(after.submitted == before.submitted + 1);
+  TEST_ASSERT(utestErrors == 0);
+  utestCompletionsRun();
+
+  TEST_ASSERT(utestErrors == 1);
+  TEST_ASSERT(utestFlowsRemoved == 0);
+  TEST_ASSERT(utestMockFlowCount() == UTEST_FLOW_COUNT);
+
+  /* The state manager dropped the flow too */
+  TEST_ASSERT(ind_ofdpa_reconcile(&stats) == INDIGO_ERROR_NONE);
+  TEST_ASSERT(stats.tablesInSync == tableNameListSize);
+  TEST_ASSERT(stats.orphanFlows == 0 && stats.staleFlows == 0);
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+static int test_fence_reports(void)
+{
+  TEST_ASSERT(utestSetup() == TEST_PASS);
+
+  /*
+   * The strict delete reaches forwarding at once; its fence reports
+   * the failed add ahead of it, without the event loop
+   */
+  utestFlowAdd(UTEST_FLOW_COUNT + 1);
+  utestFlowDeleteStrict(1);
+  TEST_ASSERT(utestErrors == 1);
+  TEST_ASSERT(utestFlowsRemoved == 1);
+  TEST_ASSERT(utestMockFlowCount() == UTEST_FLOW_COUNT - 1);
+
+  /* A delete of the failed flow itself finds it gone */
+  utestFlowAdd(UTEST_FLOW_COUNT + 2);
+  utestFlowAdd(UTEST_FLOW_COUNT + 3);
+  utestFlowDeleteStrict(UTEST_FLOW_COUNT + 3);
+  TEST_ASSERT(utestErrors == 2);
+  TEST_ASSERT(utestFlowsRemoved == 1);
+  TEST_ASSERT(utestMockFlowCount() == UTEST_FLOW_COUNT);
+
+  utestCompletionsRun();
+  TEST_ASSERT(utestErrors == 2);
+
+  TEST_ASSERT(utestTeardown() == TEST_PASS);
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+  ind_core_config_t coreConfig;
+  ind_ofdpa_rpc_config_t rpcConfig;
+  ofdpaFlowTableInfo_t info;
+
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+  if (ofdpaClientInitialize("ind_ofdpa_rpc_utest") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if (ofdpaFlowTableInfoGet(OFDPA_FLOW_TABLE_ID_ACL_POLICY, &info) != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaFlowTableInfoGet failed\n");
+    return 1;
+  }
+  utestAclMaxEntries = info.maxEntries;
+
+  memset(&coreConfig, 0, sizeof(coreConfig));
+  memset(&rpcConfig, 0, sizeof(rpcConfig));
+  rpcConfig.workers = 2;
+  rpcConfig.window = 8;
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0) ||
+      (ind_core_init(&coreConfig) < 0) || (ind_core_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the state manager\n");
+    return 1;
+  }
+  if ((ind_ofdpa_table_stats_init() != INDIGO_ERROR_NONE) ||
+      (ind_ofdpa_rpc_init(&rpcConfig) != INDIGO_ERROR_NONE) ||
+      !ind_ofdpa_rpc_enabled())
+  {
+    fprintf(stderr, "Failed to start the OF-DPA workers\n");
+    return 1;
+  }
+
+  RUN_TEST(add_fails);
+  RUN_TEST(fence_reports);
+
+  ind_ofdpa_rpc_finish();
+  ind_ofdpa_table_stats_finish();
+  ind_core_finish();
+  ind_soc_finish();
+  return global_error;
+}
@@ -0,0 +1,776 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ind_ofdpa_table_features_utest.c
+*
+* @purpose      Unit tests of the advertised table features against the
+*               flow mod translation
+*
+* @component    OF-DPA
+*
+* @comments     The capabilities ind_ofdpa_table_caps_get() advertises
+*               are kept by hand next to the translation in
+*               ind_ofdpa_fwd.c. For every flow table, each match field,
+*               mask, instruction, next table, action and set-field is
+*               tried in a flow add through indigo_fwd_flow_create(), and
+*               the entry the mock is given is compared with the same
+*               flow without it. What is advertised must be accepted and
+*               change the entry; what is not must be refused or leave
+*               the entry as it was.
+*
+* @create       19 Oct 2026
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <indigo/forwarding.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ofdpa_mock.h>
+#include <locitest/unittest.h>
+#include <locitest/test_common.h>
+
+int ofagent_of_version = OF_VERSION_1_3;
+
+int global_error = 0;
+int exit_on_error = 1;
+
+/* The group the group actions reference */
+#define UTEST_GROUP ((OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE << 28) | (10 << 16) | 1)
+
+/* Match fields the translation takes in the ACL policy table without
+   programming them, and so does not advertise */
+#define UTEST_MATCH_IGNORED (IND_OFDPA_IPV4_ARP_SPA | IND_OFDPA_IP_ECN)
+
+/* Fails the test naming the table and the capability that disagree */
+#define UTEST_CAPS_ASSERT(cond, tableId, what, bit) do {                  \
+    if (!(cond))                                                          \
+    {                                                                     \
+      fprintf(stderr, "\nTable %u, %s 0x%x: " #cond " :: %s:%d\n",       \
+              (uint32_t)(tableId), what, (uint32_t)(bit), __FILE__, __LINE__); \
+      return TEST_FAIL;                                                   \
+    }                                                                     \
+  } while (0)
+
+/* Asynchronous messages go nowhere here */
+void indigo_core_port_status_update(of_port_status_t *of_port_status)
+{
+  of_port_status_delete(of_port_status);
+}
+
+indigo_error_t indigo_core_packet_in(of_packet_in_t *packet_in)
+{
+  of_packet_in_delete(packet_in);
+  return INDIGO_ERROR_NONE;
+}
+
+void indigo_core_flow_removed(indigo_fi_flow_removed_t reason,
+                              indigo_fi_flow_stats_t *flow_stats)
+{
+}
+
+void indigo_core_flow_create_callback(indigo_error_t result, indigo_cookie_t flow_id)
+{
+}
+
+indigo_error_t indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
+{
+  of_object_delete(obj);
+  return INDIGO_ERROR_NONE;
+}
+
+/* Every match field the driver knows */
+static const uint32_t utestMatchFields[] =
+{
+  IND_OFDPA_PORT, IND_OFDPA_DSTMAC, IND_OFDPA_SRCMAC, IND_OFDPA_ETHER_TYPE,
+  IND_OFDPA_VLANID, IND_OFDPA_VLAN_PCP, IND_OFDPA_IP_DSCP, IND_OFDPA_IP_ECN,
+  IND_OFDPA_IP_PROTO, IND_OFDPA_IPV4_SRC, IND_OFDPA_IPV4_DST,
+  IND_OFDPA_TCP_L4_SRC_PORT, IND_OFDPA_TCP_L4_DST_PORT,
+  IND_OFDPA_UDP_L4_SRC_PORT, IND_OFDPA_UDP_L4_DST_PORT,
+  IND_OFDPA_SCTP_L4_SRC_PORT, IND_OFDPA_SCTP_L4_DST_PORT,
+  IND_OFDPA_ICMPV4_TYPE, IND_OFDPA_ICMPV4_CODE, IND_OFDPA_IPV4_ARP_SPA,
+  IND_OFDPA_IPV6_SRC, IND_OFDPA_IPV6_DST, IND_OFDPA_IPV6_FLOW_LABEL,
+  IND_OFDPA_ICMPV6_TYPE, IND_OFDPA_ICMPV6_CODE, IND_OFDPA_TUNNEL_ID
+};
+
+#define UTEST_MATCH_FIELDS_SIZE (sizeof(utestMatchFields)/sizeof(utestMatchFields[0]))
+
+/* Set-fields tried, with their OXM field number and value */
+typedef struct utest_set_field_s
+{
+  uint32_t field;
+  uint8_t  oxmField;
+  uint8_t  length;
+  uint8_t  value[16];
+} utest_set_field_t;
+
+static const utest_set_field_t utestSetFields[] =
+{
+  {IND_OFDPA_DSTMAC,           3, 6,  {0x00, 0x00, 0x5e, 0x00, 0x01, 0x01}},
+  {IND_OFDPA_SRCMAC,           4, 6,  {0x00, 0x00, 0x5e, 0x00, 0x01, 0x02}},
+  {IND_OFDPA_ETHER_TYPE,       5, 2,  {0x08, 0x00}},
+  {IND_OFDPA_VLANID,           6, 2,  {0x10, 0x05}},
+  {IND_OFDPA_VLAN_PCP,         7, 1,  {3}},
+  {IND_OFDPA_IP_DSCP,          8, 1,  {10}},
+  {IND_OFDPA_IP_ECN,           9, 1,  {1}},
+  {IND_OFDPA_IP_PROTO,        10, 1,  {IPPROTO_TCP}},
+  {IND_OFDPA_IPV4_SRC,        11, 4,  {10, 0, 0, 1}},
+  {IND_OFDPA_IPV4_DST,        12, 4,  {10, 0, 0, 2}},
+  {IND_OFDPA_TCP_L4_SRC_PORT, 13, 2,  {0x00, 80}},
+  {IND_OFDPA_TCP_L4_DST_PORT, 14, 2,  {0x00, 81}},
+  {IND_OFDPA_UDP_L4_SRC_PORT, 15, 2,  {0x00, 82}},
+  {IND_OFDPA_UDP_L4_DST_PORT, 16, 2,  {0x00, 83}},
+  {IND_OFDPA_IPV6_SRC,        26, 16, {0x20, 0x01, 0x0d, 0xb8, [15] = 1}},
+  {IND_OFDPA_IPV6_DST,        27, 16, {0x20, 0x01, 0x0d, 0xb8, [15] = 2}},
+  {IND_OFDPA_IPV6_FLOW_LABEL, 28, 4,  {0x00, 0x01, 0x23, 0x45}}
+};
+
+#define UTEST_SET_FIELDS_SIZE (sizeof(utestSetFields)/sizeof(utestSetFields[0]))
+
+static uint64_t utestCookie;
+
+/*
+ * Sets a match field, exactly or with a mask leaving some of its bits
+ * out. The values keep only bits either mask covers, so the two
+ * differ in the mask alone.
+ */
+static void utestMatchFieldSet(of_match_t *match, uint32_t field, int masked)
+{
+  static const of_ipv6_t ipv6 = {{0x20, 0x01, 0x0d, 0xb8}};
+  static const of_ipv6_t ipv6Exact =
+    {{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}};
+  static const of_ipv6_t ipv6Prefix =
+    {{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}};
+  static const of_mac_addr_t mac = {{0x00, 0x00, 0x5e, 0x00, 0x01, 0x00}};
+  static const of_mac_addr_t macExact = {{0xff, 0xff, 0xff, 0xff, 0xff, 0xff}};
+  static const of_mac_addr_t macPrefix = {{0xff, 0xff, 0xff, 0xff, 0xff, 0x00}};
+
+  switch (field)
+  {
+    case IND_OFDPA_PORT:
+      match->fields.in_port = 0x100;
+      match->masks.in_port = masked ? 0xffffff00 : 0xffffffff;
+      break;
+    case IND_OFDPA_DSTMAC:
+      match->fields.eth_dst = mac;
+      match->masks.eth_dst = masked ? macPrefix : macExact;
+      break;
+    case IND_OFDPA_SRCMAC:
+      match->fields.eth_src = mac;
+      match->masks.eth_src = masked ? macPrefix : macExact;
+      break;
+    case IND_OFDPA_ETHER_TYPE:
+      match->fields.eth_type = ETH_P_IP;
+      match->masks.eth_type = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_VLANID:
+      match->fields.vlan_vid = OFDPA_VID_PRESENT | 0x10;
+      match->masks.vlan_vid = masked ? 0x1ff0 : 0xffff;
+      break;
+    case IND_OFDPA_VLAN_PCP:
+      match->fields.vlan_pcp = 4;
+      match->masks.vlan_pcp = masked ? 4 : 0xff;
+      break;
+    case IND_OFDPA_IP_DSCP:
+      match->fields.ip_dscp = 0x20;
+      match->masks.ip_dscp = masked ? 0x30 : 0xff;
+      break;
+    case IND_OFDPA_IP_ECN:
+      match->fields.ip_ecn = 2;
+      match->masks.ip_ecn = masked ? 2 : 0xff;
+      break;
+    case IND_OFDPA_IP_PROTO:
+      match->fields.ip_proto = IPPROTO_TCP;
+      match->masks.ip_proto = masked ? 0x06 : 0xff;
+      break;
+    case IND_OFDPA_IPV4_SRC:
+      match->fields.ipv4_src = 0x0a000100;
+      match->masks.ipv4_src = masked ? 0xffffff00 : 0xffffffff;
+      break;
+    case IND_OFDPA_IPV4_DST:
+      match->fields.ipv4_dst = 0x0a000200;
+      match->masks.ipv4_dst = masked ? 0xffffff00 : 0xffffffff;
+      break;
+    case IND_OFDPA_IPV4_ARP_SPA:
+      match->fields.arp_spa = 0x0a000300;
+      match->masks.arp_spa = masked ? 0xffffff00 : 0xffffffff;
+      break;
+    case IND_OFDPA_TCP_L4_SRC_PORT:
+      match->fields.tcp_src = 0x5000;
+      match->masks.tcp_src = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_TCP_L4_DST_PORT:
+      match->fields.tcp_dst = 0x5100;
+      match->masks.tcp_dst = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_UDP_L4_SRC_PORT:
+      match->fields.udp_src = 0x5200;
+      match->masks.udp_src = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_UDP_L4_DST_PORT:
+      match->fields.udp_dst = 0x5300;
+      match->masks.udp_dst = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_SCTP_L4_SRC_PORT:
+      match->fields.sctp_src = 0x5400;
+      match->masks.sctp_src = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_SCTP_L4_DST_PORT:
+      match->fields.sctp_dst = 0x5500;
+      match->masks.sctp_dst = masked ? 0xff00 : 0xffff;
+      break;
+    case IND_OFDPA_ICMPV4_TYPE:
+      match->fields.icmpv4_type = 8;
+      match->masks.icmpv4_type = masked ? 0x0c : 0xff;
+      break;
+    case IND_OFDPA_ICMPV4_CODE:
+      match->fields.icmpv4_code = 0x10;
+      match->masks.icmpv4_code = masked ? 0xf0 : 0xff;
+      break;
+    case IND_OFDPA_ICMPV6_TYPE:
+      match->fields.icmpv6_type = 0x80;
+      match->masks.icmpv6_type = masked ? 0xf0 : 0xff;
+      break;
+    case IND_OFDPA_ICMPV6_CODE:
+      match->fields.icmpv6_code = 0x10;
+      match->masks.icmpv6_code = masked ? 0xf0 : 0xff;
+      break;
+    case IND_OFDPA_IPV6_SRC:
+      match->fields.ipv6_src = ipv6;
+      match->masks.ipv6_src = masked ? ipv6Prefix : ipv6Exact;
+      break;
+    case IND_OFDPA_IPV6_DST:
+      match->fields.ipv6_dst = ipv6;
+      match->masks.ipv6_dst = masked ? ipv6Prefix : ipv6Exact;
+      break;
+    case IND_OFDPA_IPV6_FLOW_LABEL:
+      match->fields.ipv6_flabel = 0x12000;
+      match->masks.ipv6_flabel = masked ? 0xff000 : 0xffffffff;
+      break;
+    case IND_OFDPA_TUNNEL_ID:
+      match->fields.tunnel_id = 0x5000;
+      match->masks.tunnel_id = masked ? 0xffffffffffffff00ULL : 0xffffffffffffffffULL;
+      break;
+    default:
+      fprintf(stderr, "No value for match field 0x%x\n", field);
+      exit(1);
+  }
+}
+
+/* The fields a match on field needs first, where the table takes them */
+static void utestMatchPrereqsSet(of_match_t *match, uint32_t field, uint32_t allowed)
+{
+  uint16_t ethType = 0;
+  uint8_t ipProto = 0;
+
+  switch (field)
+  {
+    case IND_OFDPA_TCP_L4_SRC_PORT:
+    case IND_OFDPA_TCP_L4_DST_PORT:
+      ipProto = IPPROTO_TCP;
+      ethType = ETH_P_IP;
+      break;
+    case IND_OFDPA_UDP_L4_SRC_PORT:
+    case IND_OFDPA_UDP_L4_DST_PORT:
+      ipProto = IPPROTO_UDP;
+      ethType = ETH_P_IP;
+      break;
+    case IND_OFDPA_SCTP_L4_SRC_PORT:
+    case IND_OFDPA_SCTP_L4_DST_PORT:
+      ipProto = IPPROTO_SCTP;
+      ethType = ETH_P_IP;
+      break;
+    case IND_OFDPA_ICMPV4_TYPE:
+    case IND_OFDPA_ICMPV4_CODE:
+      ipProto = IPPROTO_ICMP;
+      ethType = ETH_P_IP;
+      break;
+    case IND_OFDPA_ICMPV6_TYPE:
+    case IND_OFDPA_ICMPV6_CODE:
+      ipProto = IPPROTO_ICMPV6;
+      ethType = ETH_P_IPV6;
+      break;
+    case IND_OFDPA_IPV4_SRC:
+    case IND_OFDPA_IPV4_DST:
+    case IND_OFDPA_IP_DSCP:
+    case IND_OFDPA_IP_ECN:
+    case IND_OFDPA_IP_PROTO:
+      ethType = ETH_P_IP;
+      break;
+    case IND_OFDPA_IPV6_SRC:
+    case IND_OFDPA_IPV6_DST:
+    case IND_OFDPA_IPV6_FLOW_LABEL:
+      ethType = ETH_P_IPV6;
+      break;
+    case IND_OFDPA_VLAN_PCP:
+      if (allowed & IND_OFDPA_VLANID)
+      {
+        utestMatchFieldSet(match, IND_OFDPA_VLANID, 0);
+      }
+      break;
+    default:
+      break;
+  }
+
+  if ((ethType != 0) && (allowed & IND_OFDPA_ETHER_TYPE))
+  {
+    match->fields.eth_type = ethType;
+    OF_MATCH_MASK_ETH_TYPE_EXACT_SET(match);
+  }
+  if ((ipProto != 0) && (allowed & IND_OFDPA_IP_PROTO))
+  {
+    match->fields.ip_proto = ipProto;
+    OF_MATCH_MASK_IP_PROTO_EXACT_SET(match);
+  }
+}
+
+static of_flow_add_t *utestFlowAddNew(OFDPA_FLOW_TABLE_ID_t tableId, of_match_t *match)
+{
+  of_flow_add_t *flowAdd = of_flow_add_new(OF_VERSION_1_3);
+  of_match_t empty;
+
+  if (match == NULL)
+  {
+    memset(&empty, 0, sizeof(empty));
+    match = &empty;
+  }
+  match->version = OF_VERSION_1_3;
+
+  of_flow_add_table_id_set(flowAdd, tableId);
+  of_flow_add_priority_set(flowAdd, 1000);
+  if (of_flow_add_match_set(flowAdd, match) < 0)
+  {
+    fprintf(stderr, "of_flow_add_match_set failed\n");
+    exit(1);
+  }
+  return flowAdd;
+}
+
+static void utestInstructionAppend(of_flow_add_t *flowAdd, of_object_t *instruction)
+{
+  of_list_instruction_t instructions;
+
+  of_flow_add_instructions_bind(flowAdd, &instructions);
+  if (of_list_append(&instructions, instruction) != 0)
+  {
+    fprintf(stderr, "of_list_append failed\n");
+    exit(1);
+  }
+  of_object_delete(instruction);
+}
+
+/* An apply or write actions instruction with one action, or none */
+static void utestActionsAppend(of_flow_add_t *flowAdd, int write, of_object_t *action)
+{
+  of_object_t *instruction;
+  of_list_action_t actions;
+
+  if (write)
+  {
+    instruction = (of_object_t *)of_instruction_write_actions_new(OF_VERSION_1_3);
+    of_instruction_write_actions_actions_bind(instruction, &actions);
+  }
+  else
+  {
+    instruction = (of_object_t *)of_instruction_apply_actions_new(OF_VERSION_1_3);
+    of_instruction_apply_actions_actions_bind(instruction, &actions);
+  }
+  if (action != NULL)
+  {
+    if (of_list_append(&actions, action) != 0)
+    {
+      fprintf(stderr, "of_list_append failed\n");
+      exit(1);
+    }
+    of_object_delete(action);
+  }
+  utestInstructionAppend(flowAdd, instruction);
+}
+
+static of_object_t *utestSetFieldNew(const utest_set_field_t *setField)
+{
+  of_action_set_field_t *action = of_action_set_field_new(OF_VERSION_1_3);
+  uint8_t oxm[28];
+  of_octets_t octets;
+
+  /* The action, header and OXM, is padded to 8 bytes */
+  memset(oxm, 0, sizeof(oxm));
+  oxm[0] = 0x80;
+  oxm[1] = 0x00;
+  oxm[2] = setField->oxmField << 1;
+  oxm[3] = setField->length;
+  memcpy(&oxm[4], setField->value, setField->length);
+  octets.data = oxm;
+  octets.bytes = ((4 + 4 + setField->length + 7) & ~7) - 4;
+
+  if (of_action_set_field_field_set(action, &octets) < 0)
+  {
+    fprintf(stderr, "of_action_set_field_field_set failed\n");
+    exit(1);
+  }
+  return (of_object_t *)action;
+}
+
+/*
+ * Adds the flow to an empty mock and reads back the entry it was
+ * given. Returns what indigo_fwd_flow_create() did; the translation
+ * refuses a flow with INDIGO_ERROR_COMPAT.
+ */
+static indigo_error_t utestTranslate(of_flow_add_t *flowAdd, ofdpaFlowEntry_t *flow)
+{
+  ofdpaGroupEntry_t group;
+  ofdpaFlowEntryStats_t flowStats;
+  indigo_error_t err;
+  uint8_t tableId;
+
+  ofdpaMockReset();
+  memset(&group, 0, sizeof(group));
+  group.groupId = UTEST_GROUP;
+  if (ofdpaGroupAdd(&group) != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaGroupAdd failed\n");
+    exit(1);
+  }
+
+  memset(flow, 0, sizeof(*flow));
+  utestCookie++;
+  err = indigo_fwd_flow_create(utestCookie, flowAdd, &tableId);
+  of_flow_add_delete(flowAdd);
+  if ((err == INDIGO_ERROR_NONE) &&
+      (ofdpaFlowByCookieGet(utestCookie, flow, &flowStats) != OFDPA_E_NONE))
+  {
+    err = INDIGO_ERROR_UNKNOWN;
+  }
+  return err;
+}
+
+/*
+ * Whether the flow is accepted and programmed differently from the
+ * baseline; -1 if OF-DPA refused a flow the translation accepted
+ */
+static int utestProgrammed(of_flow_add_t *flowAdd, const ofdpaFlowEntry_t *baseline)
+{
+  ofdpaFlowEntry_t flow;
+  indigo_error_t err;
+
+  err = utestTranslate(flowAdd, &flow);
+  if (err == INDIGO_ERROR_COMPAT)
+  {
+    return 0;
+  }
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return -1;
+  }
+  return memcmp(&flow.flowData, &baseline->flowData, sizeof(flow.flowData)) != 0;
+}
+
+static const ind_ofdpa_table_caps_t *utestTableCaps(uint32_t i)
+{
+  const ind_ofdpa_table_caps_t *caps = ind_ofdpa_table_caps_get(tableNameList[i].type);
+
+  if (caps == NULL)
+  {
+    fprintf(stderr, "No capabilities for table %u\n", tableNameList[i].type);
+    exit(1);
+  }
+  return caps;
+}
+
+static int test_match_fields(void)
+{
+  const ind_ofdpa_table_caps_t *caps;
+  ofdpaFlowEntry_t baseline;
+  of_match_t match;
+  indigo_error_t err;
+  uint32_t i, j, field;
+  int programmed;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    caps = utestTableCaps(i);
+    for (j = 0; j < UTEST_MATCH_FIELDS_SIZE; j++)
+    {
+      field = utestMatchFields[j];
+
+      memset(&match, 0, sizeof(match));
+      utestMatchPrereqsSet(&match, field, caps->match);
+      err = utestTranslate(utestFlowAddNew(caps->tableId, &match), &baseline);
+      UTEST_CAPS_ASSERT(err == INDIGO_ERROR_NONE, caps->tableId, "prerequisites of", field);
+
+      utestMatchFieldSet(&match, field, 0);
+      programmed = utestProgrammed(utestFlowAddNew(caps->tableId, &match), &baseline);
+      if (caps->match & field)
+      {
+        UTEST_CAPS_ASSERT(programmed == 1, caps->tableId, "match field", field);
+      }
+      else if (!(field & UTEST_MATCH_IGNORED))
+      {
+        UTEST_CAPS_ASSERT(programmed == 0, caps->tableId, "match field", field);
+      }
+    }
+  }
+
+  return TEST_PASS;
+}
+
+static int test_match_masks(void)
+{
+  const ind_ofdpa_table_caps_t *caps;
+  ofdpaFlowEntry_t exact;
+  of_match_t match;
+  indigo_error_t err;
+  uint32_t i, j, field;
+  int programmed;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    caps = utestTableCaps(i);
+    TEST_ASSERT((caps->masked & ~caps->match) == 0);
+    TEST_ASSERT((caps->wildcards & ~caps->match) == 0);
+
+    for (j = 0; j < UTEST_MATCH_FIELDS_SIZE; j++)
+    {
+      field = utestMatchFields[j];
+      if (!(caps->match & field))
+      {
+        continue;
+      }
+
+      memset(&match, 0, sizeof(match));
+      utestMatchPrereqsSet(&match, field, caps->match);
+      utestMatchFieldSet(&match, field, 0);
+      err = utestTranslate(utestFlowAddNew(caps->tableId, &match), &exact);
+      UTEST_CAPS_ASSERT(err == INDIGO_ERROR_NONE, caps->tableId, "exact match field", field);
+
+      /* A mask the table does not take is refused or made exact */
+      utestMatchFieldSet(&match, field, 1);
+      programmed = utestProgrammed(utestFlowAddNew(caps->tableId, &match), &exact);
+      UTEST_CAPS_ASSERT(programmed == ((caps->masked & field) != 0),
+                        caps->tableId, "masked match field", field);
+    }
+  }
+
+  return TEST_PASS;
+}
+
+static int test_instructions(void)
+{
+  const ind_ofdpa_table_caps_t *caps;
+  ofdpaFlowEntry_t baseline, flow;
+  of_instruction_goto_table_t *gotoTable;
+  indigo_error_t err;
+  uint32_t i, j;
+  int advertised, programmed;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    caps = utestTableCaps(i);
+    TEST_ASSERT(utestTranslate(utestFlowAddNew(caps->tableId, NULL), &baseline) ==
+                INDIGO_ERROR_NONE);
+
+    /* Empty action lists, so only the instruction itself is judged */
+    for (j = 0; j < 2; j++)
+    {
+      of_flow_add_t *flowAdd = utestFlowAddNew(caps->tableId, NULL);
+      uint32_t bit = IND_OFDPA_INSTRUCTION(j ? OF_INSTRUCTION_TYPE_WRITE_ACTIONS :
+                                              OF_INSTRUCTION_TYPE_APPLY_ACTIONS);
+
+      utestActionsAppend(flowAdd, j, NULL);
+      err = utestTranslate(flowAdd, &flow);
+      UTEST_CAPS_ASSERT((err == INDIGO_ERROR_NONE) || (err == INDIGO_ERROR_COMPAT),
+                        caps->tableId, "instruction", bit);
+      UTEST_CAPS_ASSERT((err == INDIGO_ERROR_NONE) == ((caps->instructions & bit) != 0),
+                        caps->tableId, "instruction", bit);
+    }
+
+    {
+      of_flow_add_t *flowAdd = utestFlowAddNew(caps->tableId, NULL);
+      uint32_t bit = IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_CLEAR_ACTIONS);
+
+      utestInstructionAppend(flowAdd,
+                             (of_object_t *)of_instruction_clear_actions_new(OF_VERSION_1_3));
+      programmed = utestProgrammed(flowAdd, &baseline);
+      UTEST_CAPS_ASSERT(programmed == ((caps->instructions & bit) != 0),
+                        caps->tableId, "instruction", bit);
+    }
+
+    /* Every next table advertised is programmed; with none, goto is refused */
+    advertised = (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_GOTO_TABLE)) != 0;
+    TEST_ASSERT(advertised == (caps->nextTableCount != 0));
+    for (j = 0; j < (advertised ? caps->nextTableCount : 1); j++)
+    {
+      of_flow_add_t *flowAdd = utestFlowAddNew(caps->tableId, NULL);
+
+      gotoTable = of_instruction_goto_table_new(OF_VERSION_1_3);
+      of_instruction_goto_table_table_id_set(gotoTable, advertised ? caps->nextTables[j] :
+                                             OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+      utestInstructionAppend(flowAdd, (of_object_t *)gotoTable);
+      programmed = utestProgrammed(flowAdd, &baseline);
+      UTEST_CAPS_ASSERT(programmed == advertised, caps->tableId, "goto table",
+                        advertised ? caps->nextTables[j] : OFDPA_FLOW_TABLE_ID_ACL_POLICY);
+    }
+  }
+
+  return TEST_PASS;
+}
+
+static of_object_t *utestActionNew(int type)
+{
+  switch (type)
+  {
+    case OF_ACTION_TYPE_OUTPUT:
+    {
+      of_action_output_t *action = of_action_output_new(OF_VERSION_1_3);
+
+      of_action_output_port_set(action, OF_PORT_DEST_CONTROLLER);
+      return (of_object_t *)action;
+    }
+    case OF_ACTION_TYPE_GROUP:
+    {
+      of_action_group_t *action = of_action_group_new(OF_VERSION_1_3);
+
+      of_action_group_group_id_set(action, UTEST_GROUP);
+      return (of_object_t *)action;
+    }
+    case OF_ACTION_TYPE_SET_QUEUE:
+    {
+      of_action_set_queue_t *action = of_action_set_queue_new(OF_VERSION_1_3);
+
+      of_action_set_queue_queue_id_set(action, 1);
+      return (of_object_t *)action;
+    }
+    case OF_ACTION_TYPE_PUSH_VLAN:
+    {
+      of_action_push_vlan_t *action = of_action_push_vlan_new(OF_VERSION_1_3);
+
+      of_action_push_vlan_ethertype_set(action, 0x8100);
+      return (of_object_t *)action;
+    }
+    case OF_ACTION_TYPE_POP_VLAN:
+      return (of_object_t *)of_action_pop_vlan_new(OF_VERSION_1_3);
+    case OF_ACTION_TYPE_DEC_NW_TTL:
+      return (of_object_t *)of_action_dec_nw_ttl_new(OF_VERSION_1_3);
+    case OF_ACTION_TYPE_SET_NW_TTL:
+    {
+      of_action_set_nw_ttl_t *action = of_action_set_nw_ttl_new(OF_VERSION_1_3);
+
+      of_action_set_nw_ttl_nw_ttl_set(action, 16);
+      return (of_object_t *)action;
+    }
+    default:
+      fprintf(stderr, "No action of type %d\n", type);
+      exit(1);
+  }
+}
+
+static int test_actions(void)
+{
+  static const int actionTypes[] =
+  {
+    OF_ACTION_TYPE_OUTPUT, OF_ACTION_TYPE_GROUP, OF_ACTION_TYPE_SET_QUEUE,
+    OF_ACTION_TYPE_PUSH_VLAN, OF_ACTION_TYPE_POP_VLAN,
+    OF_ACTION_TYPE_DEC_NW_TTL, OF_ACTION_TYPE_SET_NW_TTL
+  };
+  const ind_ofdpa_table_caps_t *caps;
+  ofdpaFlowEntry_t baseline;
+  of_flow_add_t *flowAdd;
+  uint32_t i, j, bit;
+  int write, programmed;
+
+  for (i = 0; i < tableNameListSize; i++)
+  {
+    caps = utestTableCaps(i);
+    TEST_ASSERT(((caps->actions & IND_OFDPA_ACTION(OF_ACTION_TYPE_SET_FIELD)) != 0) ==
+                (caps->setFields != 0));
+
+    write = (caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_WRITE_ACTIONS)) != 0;
+    if (!write &&
+        !(caps->instructions & IND_OFDPA_INSTRUCTION(OF_INSTRUCTION_TYPE_APPLY_ACTIONS)))
+    {
+      /* No actions to be had */
+      TEST_ASSERT((caps->actions == 0) && (caps->setFields == 0));
+      continue;
+    }
+
+    flowAdd = utestFlowAddNew(caps->tableId, NULL);
+    utestActionsAppend(flowAdd, write, NULL);
+    TEST_ASSERT(utestTranslate(flowAdd, &baseline) == INDIGO_ERROR_NONE);
+
+    for (j = 0; j < sizeof(actionTypes) / sizeof(actionTypes[0]); j++)
+    {
+      bit = IND_OFDPA_ACTION(actionTypes[j]);
+      flowAdd = utestFlowAddNew(caps->tableId, NULL);
+      utestActionsAppend(flowAdd, write, utestActionNew(actionTypes[j]));
+      programmed = utestProgrammed(flowAdd, &baseline);
+      UTEST_CAPS_ASSERT(programmed == ((caps->actions & bit) != 0),
+                        caps->tableId, "action", bit);
+    }
+
+    for (j = 0; j < UTEST_SET_FIELDS_SIZE; j++)
+    {
+      bit = utestSetFields[j].field;
+      flowAdd = utestFlowAddNew(caps->tableId, NULL);
+      utestActionsAppend(flowAdd, write, utestSetFieldNew(&utestSetFields[j]));
+      programmed = utestProgrammed(flowAdd, &baseline);
+      UTEST_CAPS_ASSERT(programmed == ((caps->setFields & bit) != 0),
+                        caps->tableId, "set-field", bit);
+    }
+  }
+
+  return TEST_PASS;
+}
+
+int main(int argc, char *argv[])
+{
+  ind_soc_config_t socConfig = { 0 };
+
+  setenv("OFDPA_MOCK_AGING_MS", "0", 1);
+  if (ofdpaClientInitialize("ind_ofdpa_table_features_utest") != OFDPA_E_NONE)
+  {
+    fprintf(stderr, "ofdpaClientInitialize failed\n");
+    return 1;
+  }
+  if ((ind_soc_init(&socConfig) < 0) || (ind_soc_enable_set(1) < 0))
+  {
+    fprintf(stderr, "Failed to start the socket manager\n");
+    return 1;
+  }
+  if (ind_ofdpa_table_stats_init() != INDIGO_ERROR_NONE)
+  {
+    fprintf(stderr, "Failed to read the flow tables\n");
+    return 1;
+  }
+
+  RUN_TEST(match_fields);
+  RUN_TEST(match_masks);
+  RUN_TEST(instructions);
+  RUN_TEST(actions);
+
+  ind_ofdpa_table_stats_finish();
+  ind_soc_finish();
+  return global_error;
+}
@@ -0,0 +1,753 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock.c
+*
+* @purpose      OF-DPA mock: client setup, latency injection, event and
+*               packet sockets, debug and logging calls
+*
+* @component    OF-DPA
+*
+* @comments     none
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "ofdpa_mock_int.h"
+
+/* Largest packet the mock switch will punt, before the trailing CRC */
+#define OFDPA_MOCK_MAX_PKT_SIZE   9216
+/* Length of the CRC placeholder appended to packet-ins */
+#define OFDPA_MOCK_CRC_SIZE       4
+/* Packet-ins held before the mock starts dropping, like a CPU queue */
+#define OFDPA_MOCK_PKT_QUEUE_MAX  1024
+
+static pthread_once_t  ofdpaMockOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t ofdpaMockMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define OFDPA_MOCK_CALL_NAME(_name) #_name,
+static const char *ofdpaMockCallNames[OFDPA_MOCK_CALL_COUNT] =
+{
+  OFDPA_MOCK_CALLS(OFDPA_MOCK_CALL_NAME)
+};
+
+static uint32_t ofdpaMockLatency[OFDPA_MOCK_CALL_COUNT];
+static uint64_t ofdpaMockCalls[OFDPA_MOCK_CALL_COUNT];
+
+int ofdpaMockEventFd[2] = { -1, -1 };
+int ofdpaMockPktFd[2] = { -1, -1 };
+
+/* A byte is in the socket while something is pending */
+static int ofdpaMockEventPending;
+static int ofdpaMockPktPending;
+
+typedef struct ofdpaMockPkt_s
+{
+  struct ofdpaMockPkt_s   *next;
+  OFDPA_PACKET_IN_REASON_t reason;
+  OFDPA_FLOW_TABLE_ID_t    tableId;
+  uint32_t                 inPortNum;
+  uint32_t                 size;
+  uint8_t                  data[];
+} ofdpaMockPkt_t;
+
+static ofdpaMockPkt_t *ofdpaMockPktHead;
+static ofdpaMockPkt_t *ofdpaMockPktTail;
+static uint32_t        ofdpaMockPktCount;
+
+static int ofdpaMockDebugLevel;
+static int ofdpaMockDebugComponents[OFDPA_COMPONENT_MAX];
+
+static const char *ofdpaMockComponentNames[OFDPA_COMPONENT_MAX] =
+{
+  [OFDPA_COMPONENT_API]      = "API",
+  [OFDPA_COMPONENT_MAPPING]  = "Mapping",
+  [OFDPA_COMPONENT_RPC]      = "RPC",
+  [OFDPA_COMPONENT_OFDB]     = "OFDB",
+  [OFDPA_COMPONENT_DATAPATH] = "Datapath",
+};
+
+uint64_t ofdpaMockNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t ofdpaMockEnvGet(const char *name, uint32_t dflt)
+{
+  const char *value = getenv(name);
+
+  if (value == NULL || *value == '\0')
+  {
+    return dflt;
+  }
+  return (uint32_t)strtoul(value, NULL, 0);
+}
+
+static int ofdpaMockCallLookup(const char *call)
+{
+  int i;
+
+  for (i = 0; i < OFDPA_MOCK_CALL_COUNT; i++)
+  {
+    if (strcmp(ofdpaMockCallNames[i], call) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Parse "name=usec,name=usec" */
+static void ofdpaMockLatencyParse(const char *spec)
+{
+  char name[64];
+  unsigned int usec;
+  int len;
+
+  while (spec != NULL && sscanf(spec, " %63[^=,] = %u%n", name, &usec, &len) == 2)
+  {
+    if (ofdpaMockLatencySet(name, usec) != OFDPA_E_NONE)
+    {
+      fprintf(stderr, "ofdpa_mock: unknown call %s in OFDPA_MOCK_LATENCY\n", name);
+    }
+    spec = strchr(spec + len, ',');
+    if (spec != NULL)
+    {
+      spec++;
+    }
+  }
+}
+
+static void *ofdpaMockAgingThread(void *arg)
+{
+  uint32_t periodMs = (uint32_t)(uintptr_t)arg;
+  struct timespec ts;
+
+  ts.tv_sec = periodMs / 1000;
+  ts.tv_nsec = (periodMs % 1000) * 1000000L;
+  for (;;)
+  {
+    nanosleep(&ts, NULL);
+    ofdpaMockFlowAge();
+  }
+  return NULL;
+}
+
+static int ofdpaMockSocketPair(int fd[2])
+{
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) < 0)
+  {
+    return -1;
+  }
+  fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL, 0) | O_NONBLOCK);
+  fcntl(fd[1], F_SETFL, fcntl(fd[1], F_GETFL, 0) | O_NONBLOCK);
+  return 0;
+}
+
+static void ofdpaMockInit(void)
+{
+  pthread_t thread;
+  uint32_t agingMs;
+
+  if (ofdpaMockSocketPair(ofdpaMockEventFd) < 0 ||
+      ofdpaMockSocketPair(ofdpaMockPktFd) < 0)
+  {
+    fprintf(stderr, "ofdpa_mock: socketpair failed: %s\n", strerror(errno));
+  }
+
+  ofdpaMockLatencySet(NULL, ofdpaMockEnvGet("OFDPA_MOCK_LATENCY_US", 0));
+  ofdpaMockLatencyParse(getenv("OFDPA_MOCK_LATENCY"));
+
+  ofdpaMockFlowInit();
+  ofdpaMockPortInit();
+
+  agingMs = ofdpaMockEnvGet("OFDPA_MOCK_AGING_MS", 1000);
+  if (agingMs > 0 &&
+      pthread_create(&thread, NULL, ofdpaMockAgingThread, (void *)(uintptr_t)agingMs) == 0)
+  {
+    pthread_detach(thread);
+  }
+}
+
+void ofdpaMockLock(void)
+{
+  pthread_once(&ofdpaMockOnce, ofdpaMockInit);
+  pthread_mutex_lock(&ofdpaMockMutex);
+}
+
+static void ofdpaMockDelay(uint32_t usec)
+{
+  uint64_t end = ofdpaMockNow() + usec;
+  struct timespec ts;
+
+  /* Sleeping is too coarse for short delays */
+  if (usec >= 100)
+  {
+    ts.tv_sec = usec / 1000000;
+    ts.tv_nsec = (usec % 1000000) * 1000L;
+    nanosleep(&ts, NULL);
+  }
+  while (ofdpaMockNow() < end)
+    ;
+}
+
+void ofdpaMockEnter(ofdpaMockCall_t call)
+{
+  uint32_t usec;
+
+  pthread_once(&ofdpaMockOnce, ofdpaMockInit);
+  __atomic_fetch_add(&ofdpaMockCalls[call], 1, __ATOMIC_RELAXED);
+  usec = __atomic_load_n(&ofdpaMockLatency[call], __ATOMIC_RELAXED);
+  if (usec > 0)
+  {
+    ofdpaMockDelay(usec);
+  }
+  pthread_mutex_lock(&ofdpaMockMutex);
+}
+
+void ofdpaMockExit(void)
+{
+  pthread_mutex_unlock(&ofdpaMockMutex);
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Sorted identifier tables */
+
+static uint32_t ofdpaMockIdLowerBound(ofdpaMockIdTable_t *table, uint32_t id)
+{
+  uint32_t lo = 0, hi = table->count;
+
+  while (lo < hi)
+  {
+    uint32_t mid = (lo + hi) / 2;
+
+    if (table->entries[mid].id < id)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void *ofdpaMockIdFind(ofdpaMockIdTable_t *table, uint32_t id)
+{
+  uint32_t i = ofdpaMockIdLowerBound(table, id);
+
+  if (i < table->count && table->entries[i].id == id)
+  {
+    return table->entries[i].item;
+  }
+  return NULL;
+}
+
+int ofdpaMockIdExists(ofdpaMockIdTable_t *table, uint32_t id)
+{
+  uint32_t i = ofdpaMockIdLowerBound(table, id);
+
+  return i < table->count && table->entries[i].id == id;
+}
+
+OFDPA_ERROR_t ofdpaMockIdInsert(ofdpaMockIdTable_t *table, uint32_t id, void *item)
+{
+  uint32_t i = ofdpaMockIdLowerBound(table, id);
+
+  if (i < table->count && table->entries[i].id == id)
+  {
+    return OFDPA_E_EXISTS;
+  }
+  if (table->count == table->slots)
+  {
+    uint32_t slots = table->slots ? table->slots * 2 : 16;
+    ofdpaMockIdEntry_t *entries = realloc(table->entries, slots * sizeof(*entries));
+
+    if (entries == NULL)
+    {
+      return OFDPA_E_FULL;
+    }
+    table->entries = entries;
+    table->slots = slots;
+  }
+  memmove(&table->entries[i + 1], &table->entries[i],
+          (table->count - i) * sizeof(*table->entries));
+  table->entries[i].id = id;
+  table->entries[i].item = item;
+  table->count++;
+  return OFDPA_E_NONE;
+}
+
+void *ofdpaMockIdRemove(ofdpaMockIdTable_t *table, uint32_t id)
+{
+  uint32_t i = ofdpaMockIdLowerBound(table, id);
+  void *item;
+
+  if (i >= table->count || table->entries[i].id != id)
+  {
+    return NULL;
+  }
+  item = table->entries[i].item;
+  table->count--;
+  memmove(&table->entries[i], &table->entries[i + 1],
+          (table->count - i) * sizeof(*table->entries));
+  return item;
+}
+
+ofdpaMockIdEntry_t *ofdpaMockIdNext(ofdpaMockIdTable_t *table, uint32_t id)
+{
+  uint32_t i;
+
+  if (id == UINT32_MAX)
+  {
+    return NULL;
+  }
+  i = ofdpaMockIdLowerBound(table, id + 1);
+  return (i < table->count) ? &table->entries[i] : NULL;
+}
+
+void ofdpaMockIdTableFree(ofdpaMockIdTable_t *table)
+{
+  free(table->entries);
+  memset(table, 0, sizeof(*table));
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Mock control */
+
+OFDPA_ERROR_t ofdpaMockLatencySet(const char *call, uint32_t usec)
+{
+  int i;
+
+  if (call == NULL)
+  {
+    for (i = 0; i < OFDPA_MOCK_CALL_COUNT; i++)
+    {
+      __atomic_store_n(&ofdpaMockLatency[i], usec, __ATOMIC_RELAXED);
+    }
+    return OFDPA_E_NONE;
+  }
+
+  i = ofdpaMockCallLookup(call);
+  if (i < 0)
+  {
+    return OFDPA_E_NOT_FOUND;
+  }
+  __atomic_store_n(&ofdpaMockLatency[i], usec, __ATOMIC_RELAXED);
+  return OFDPA_E_NONE;
+}
+
+uint64_t ofdpaMockCallCountGet(const char *call)
+{
+  uint64_t count = 0;
+  int i;
+
+  if (call == NULL)
+  {
+    for (i = 0; i < OFDPA_MOCK_CALL_COUNT; i++)
+    {
+      count += __atomic_load_n(&ofdpaMockCalls[i], __ATOMIC_RELAXED);
+    }
+    return count;
+  }
+
+  i = ofdpaMockCallLookup(call);
+  return (i < 0) ? 0 : __atomic_load_n(&ofdpaMockCalls[i], __ATOMIC_RELAXED);
+}
+
+void ofdpaMockCallCountClear(void)
+{
+  int i;
+
+  for (i = 0; i < OFDPA_MOCK_CALL_COUNT; i++)
+  {
+    __atomic_store_n(&ofdpaMockCalls[i], 0, __ATOMIC_RELAXED);
+  }
+}
+
+void ofdpaMockReset(void)
+{
+  char byte;
+
+  ofdpaMockLock();
+  ofdpaMockFlowReset();
+  ofdpaMockGroupReset();
+  ofdpaMockTunnelReset();
+
+  while (ofdpaMockPktHead != NULL)
+  {
+    ofdpaMockPkt_t *pkt = ofdpaMockPktHead;
+
+    ofdpaMockPktHead = pkt->next;
+    free(pkt);
+  }
+  ofdpaMockPktTail = NULL;
+  ofdpaMockPktCount = 0;
+  if (ofdpaMockPktPending && read(ofdpaMockPktFd[0], &byte, 1) == 1)
+  {
+    ofdpaMockPktPending = 0;
+  }
+  ofdpaMockExit();
+}
+
+int ofdpaMockFlowAge(void)
+{
+  int count;
+
+  ofdpaMockLock();
+  count = ofdpaMockFlowAgeLocked();
+  ofdpaMockExit();
+  return count;
+}
+
+OFDPA_ERROR_t ofdpaMockPktInject(uint32_t inPortNum, OFDPA_PACKET_IN_REASON_t reason,
+                                 OFDPA_FLOW_TABLE_ID_t tableId,
+                                 const void *data, uint32_t size)
+{
+  OFDPA_ERROR_t rv;
+
+  ofdpaMockLock();
+  rv = ofdpaMockPktPost(inPortNum, reason, tableId, data, size);
+  ofdpaMockExit();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Event and packet sockets */
+
+void ofdpaMockEventNotify(void)
+{
+  if (!ofdpaMockEventPending && write(ofdpaMockEventFd[1], "e", 1) == 1)
+  {
+    ofdpaMockEventPending = 1;
+  }
+}
+
+OFDPA_ERROR_t ofdpaMockPktPost(uint32_t inPortNum, OFDPA_PACKET_IN_REASON_t reason,
+                               OFDPA_FLOW_TABLE_ID_t tableId,
+                               const void *data, uint32_t size)
+{
+  ofdpaMockPkt_t *pkt;
+
+  if (data == NULL || size > OFDPA_MOCK_MAX_PKT_SIZE)
+  {
+    return OFDPA_E_PARAM;
+  }
+  if (ofdpaMockPktCount >= OFDPA_MOCK_PKT_QUEUE_MAX)
+  {
+    return OFDPA_E_FULL;
+  }
+
+  /* Packet-ins carry a zeroed CRC, as the switch delivers them */
+  pkt = calloc(1, sizeof(*pkt) + size + OFDPA_MOCK_CRC_SIZE);
+  if (pkt == NULL)
+  {
+    return OFDPA_E_FAIL;
+  }
+  pkt->reason = reason;
+  pkt->tableId = tableId;
+  pkt->inPortNum = inPortNum;
+  pkt->size = size + OFDPA_MOCK_CRC_SIZE;
+  memcpy(pkt->data, data, size);
+
+  if (ofdpaMockPktTail != NULL)
+  {
+    ofdpaMockPktTail->next = pkt;
+  }
+  else
+  {
+    ofdpaMockPktHead = pkt;
+  }
+  ofdpaMockPktTail = pkt;
+  ofdpaMockPktCount++;
+
+  if (!ofdpaMockPktPending && write(ofdpaMockPktFd[1], "p", 1) == 1)
+  {
+    ofdpaMockPktPending = 1;
+  }
+  return OFDPA_E_NONE;
+}
+
+/* Wait for fd to become readable; 0 on timeout */
+static int ofdpaMockWait(int fd, struct timeval *timeout)
+{
+  struct pollfd pfd;
+  int ms = -1;
+
+  if (timeout != NULL)
+  {
+    ms = timeout->tv_sec * 1000 + timeout->tv_usec / 1000;
+  }
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  return poll(&pfd, 1, ms) > 0;
+}
+
+static int ofdpaMockTimeoutZero(struct timeval *timeout)
+{
+  return timeout != NULL && timeout->tv_sec == 0 && timeout->tv_usec == 0;
+}
+
+int ofdpaClientEventSockFdGet(void)
+{
+  pthread_once(&ofdpaMockOnce, ofdpaMockInit);
+  return ofdpaMockEventFd[0];
+}
+
+int ofdpaClientPktSockFdGet(void)
+{
+  pthread_once(&ofdpaMockOnce, ofdpaMockInit);
+  return ofdpaMockPktFd[0];
+}
+
+OFDPA_ERROR_t ofdpaEventReceive(struct timeval *timeout)
+{
+  char byte;
+  int waited = 0;
+
+  for (;;)
+  {
+    OFDPA_MOCK_ENTER(ofdpaEventReceive);
+    if (ofdpaMockEventPending && read(ofdpaMockEventFd[0], &byte, 1) == 1)
+    {
+      ofdpaMockEventPending = 0;
+      OFDPA_MOCK_EXIT();
+      return OFDPA_E_NONE;
+    }
+    OFDPA_MOCK_EXIT();
+
+    if (waited || ofdpaMockTimeoutZero(timeout) ||
+        !ofdpaMockWait(ofdpaMockEventFd[0], timeout))
+    {
+      return OFDPA_E_TIMEOUT;
+    }
+    waited = 1;
+  }
+}
+
+OFDPA_ERROR_t ofdpaPktReceive(struct timeval *timeout, ofdpaPacket_t *pkt)
+{
+  ofdpaMockPkt_t *head;
+  char byte;
+  int waited = 0;
+
+  if (pkt == NULL || pkt->pktData.pstart == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  for (;;)
+  {
+    ofdpaMockLock();
+    head = ofdpaMockPktHead;
+    if (head != NULL)
+    {
+      ofdpaMockPktHead = head->next;
+      if (ofdpaMockPktHead == NULL)
+      {
+        ofdpaMockPktTail = NULL;
+        if (read(ofdpaMockPktFd[0], &byte, 1) == 1)
+        {
+          ofdpaMockPktPending = 0;
+        }
+      }
+      ofdpaMockPktCount--;
+    }
+    ofdpaMockExit();
+
+    if (head != NULL)
+    {
+      break;
+    }
+    if (waited || ofdpaMockTimeoutZero(timeout) ||
+        !ofdpaMockWait(ofdpaMockPktFd[0], timeout))
+    {
+      return OFDPA_E_TIMEOUT;
+    }
+    waited = 1;
+  }
+
+  pkt->reason = head->reason;
+  pkt->tableId = head->tableId;
+  pkt->inPortNum = head->inPortNum;
+  if (pkt->pktData.size > head->size)
+  {
+    pkt->pktData.size = head->size;
+  }
+  memcpy(pkt->pktData.pstart, head->data, pkt->pktData.size);
+  free(head);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaMaxPktSizeGet(uint32_t *pktSize)
+{
+  if (pktSize == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  OFDPA_MOCK_ENTER(ofdpaMaxPktSizeGet);
+  *pktSize = OFDPA_MOCK_MAX_PKT_SIZE + OFDPA_MOCK_CRC_SIZE;
+  OFDPA_MOCK_EXIT();
+  return OFDPA_E_NONE;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Client setup, logging and debug */
+
+OFDPA_ERROR_t ofdpaClientInitialize(char *clientName)
+{
+  if (clientName == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  OFDPA_MOCK_ENTER(ofdpaClientInitialize);
+  OFDPA_MOCK_EXIT();
+  return OFDPA_E_NONE;
+}
+
+int ofdpaCltLogPrintf(int priority, char *fmt, ...)
+{
+  va_list ap;
+  int rv;
+
+  va_start(ap, fmt);
+  vsyslog(priority, fmt, ap);
+  va_end(ap);
+
+  va_start(ap, fmt);
+  rv = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  return rv;
+}
+
+int ofdpaCltLogBuf(int priority, ofdpa_buffdesc message)
+{
+  syslog(priority, "%.*s", (int)message.size, message.pstart);
+  return message.size;
+}
+
+int ofdpaCltDebugPrintf(const char *functionName, ofdpaComponentIds_t component,
+                        ofdpaDebugLevels_t verbosity, const char *format, ...)
+{
+  va_list ap;
+  int rv;
+
+  if (component <= 0 || component >= OFDPA_COMPONENT_MAX ||
+      !ofdpaMockDebugComponents[component] || verbosity > ofdpaMockDebugLevel)
+  {
+    return 0;
+  }
+
+  rv = fprintf(stderr, "%s: ", functionName);
+  va_start(ap, format);
+  rv += vfprintf(stderr, format, ap);
+  va_end(ap);
+  return rv;
+}
+
+int ofdpaCltDebugBuf(ofdpa_buffdesc functionName, ofdpaComponentIds_t component,
+                     ofdpaDebugLevels_t verbosity, ofdpa_buffdesc message)
+{
+  return ofdpaCltDebugPrintf(functionName.pstart, component, verbosity, "%.*s",
+                             (int)message.size, message.pstart);
+}
+
+int ofdpaDebugLvl(int lvl)
+{
+  OFDPA_MOCK_ENTER(ofdpaDebugLvl);
+  ofdpaMockDebugLevel = lvl;
+  OFDPA_MOCK_EXIT();
+  return 0;
+}
+
+int ofdpaDebugLvlGet(void)
+{
+  int lvl;
+
+  OFDPA_MOCK_ENTER(ofdpaDebugLvlGet);
+  lvl = ofdpaMockDebugLevel;
+  OFDPA_MOCK_EXIT();
+  return lvl;
+}
+
+int ofdpaComponentNameGet(int component, ofdpa_buffdesc *name)
+{
+  int rv = 1;
+
+  OFDPA_MOCK_ENTER(ofdpaComponentNameGet);
+  if (name != NULL && name->pstart != NULL &&
+      component >= OFDPA_COMPONENT_FIRST && component < OFDPA_COMPONENT_MAX)
+  {
+    snprintf(name->pstart, name->size, "%s", ofdpaMockComponentNames[component]);
+    name->size = strlen(name->pstart) + 1;
+    rv = 0;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+int ofdpaDebugComponentSet(int component, int enable)
+{
+  int rv = 1;
+
+  OFDPA_MOCK_ENTER(ofdpaDebugComponentSet);
+  if (component >= OFDPA_COMPONENT_FIRST && component < OFDPA_COMPONENT_MAX)
+  {
+    ofdpaMockDebugComponents[component] = enable;
+    rv = 0;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+int ofdpaDebugComponentGet(int component)
+{
+  int enable = 0;
+
+  OFDPA_MOCK_ENTER(ofdpaDebugComponentGet);
+  if (component >= OFDPA_COMPONENT_FIRST && component < OFDPA_COMPONENT_MAX)
+  {
+    enable = ofdpaMockDebugComponents[component];
+  }
+  OFDPA_MOCK_EXIT();
+  return enable;
+}
+
+int ofdpaBcmCommand(ofdpa_buffdesc buffer)
+{
+  OFDPA_MOCK_ENTER(ofdpaBcmCommand);
+  OFDPA_MOCK_EXIT();
+  /* There is no switch chip to run the command on */
+  return -1;
+}
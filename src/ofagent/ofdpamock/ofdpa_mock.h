@@ -0,0 +1,170 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock.h
+*
+* @purpose      Control interface of the in-process OF-DPA mock
+*
+* @component    OF-DPA
+*
+* @comments     libofdpa_mock implements the whole ofdpa_api.h surface
+*               in the calling process, so it can be linked in place
+*               of librpc_client to run and benchmark a client without
+*               a switch. The calls below let a test or benchmark drive
+*               the mock. The mock is also configured at
+*               ofdpaClientInitialize() time from the environment:
+*
+*               OFDPA_MOCK_PORTS          physical ports (default 32)
+*               OFDPA_MOCK_QUEUES         queues per port, 1 - 64
+*                                         (default 8)
+*               OFDPA_MOCK_LATENCY_US     latency of every RPC call
+*               OFDPA_MOCK_LATENCY        per call latency, e.g.
+*                                         "ofdpaFlowAdd=100,ofdpaPortStatsGet=20"
+*               OFDPA_MOCK_AGING_MS       flow timeout scan period,
+*                                         0 disables (default 1000)
+*               OFDPA_MOCK_PKT_LOOPBACK   if non-zero, packets sent
+*                                         out a port come back as
+*                                         packet-ins on that port
+*
+* @end
+*
+**********************************************************************/
+#ifndef INCLUDE_OFDPA_MOCK_H
+#define INCLUDE_OFDPA_MOCK_H
+
+#include <stdint.h>
+#include <ofdpa_api.h>
+
+/*********************************************************************
+* @purpose  Set the latency injected into a call.
+*
+* @param    call   @b{(input)} API name, e.g. "ofdpaFlowAdd", or NULL
+*                              for every RPC call
+* @param    usec   @b{(input)} latency in microseconds
+*
+* @returns  OFDPA_E_NONE       latency set
+* @returns  OFDPA_E_NOT_FOUND  no RPC call by that name
+*
+* @notes    The latency models the RPC round trip, so it is spent
+*           before the mock lock is taken and concurrent calls overlap.
+*
+* @end
+*********************************************************************/
+OFDPA_ERROR_t ofdpaMockLatencySet(const char *call, uint32_t usec);
+
+/*********************************************************************
+* @purpose  Get the number of times a call was made.
+*
+* @param    call   @b{(input)} API name, or NULL for all RPC calls
+*
+* @returns  call count
+*
+* @end
+*********************************************************************/
+uint64_t ofdpaMockCallCountGet(const char *call);
+
+/*********************************************************************
+* @purpose  Reset all call counts to zero.
+*
+* @end
+*********************************************************************/
+void ofdpaMockCallCountClear(void);
+
+/*********************************************************************
+* @purpose  Remove all flows, groups and tunnel objects and discard
+*           pending events and packets.
+*
+* @end
+*********************************************************************/
+void ofdpaMockReset(void);
+
+/*********************************************************************
+* @purpose  Set the capacity of a flow table.
+*
+* @param    tableId     @b{(input)} flow table
+* @param    maxEntries  @b{(input)} maximum number of entries
+*
+* @returns  OFDPA_E_NONE   capacity set
+* @returns  OFDPA_E_PARAM  unknown table
+*
+* @end
+*********************************************************************/
+OFDPA_ERROR_t ofdpaMockFlowTableMaxSet(OFDPA_FLOW_TABLE_ID_t tableId, uint32_t maxEntries);
+
+/*********************************************************************
+* @purpose  Expire flows whose hard or idle timeout has passed. Each
+*           expired flow is removed and reported as a flow event.
+*
+* @returns  number of flows expired
+*
+* @notes    The mock carries no traffic, so a flow's idle time runs
+*           from its last add or modify.
+*
+* @end
+*********************************************************************/
+int ofdpaMockFlowAge(void);
+
+/*********************************************************************
+* @purpose  Change the link state of a physical port and report it as
+*           a port event.
+*
+* @param    portNum  @b{(input)} physical port
+* @param    up       @b{(input)} non-zero for link up
+*
+* @returns  OFDPA_E_NONE       state changed
+* @returns  OFDPA_E_NOT_FOUND  no such port
+*
+* @end
+*********************************************************************/
+OFDPA_ERROR_t ofdpaMockPortLinkSet(uint32_t portNum, int up);
+
+/*********************************************************************
+* @purpose  Delete a physical port, or bring a deleted one back, and
+*           report it as a port event.
+*
+* @param    portNum  @b{(input)} physical port
+* @param    present  @b{(input)} zero to delete the port
+*
+* @returns  OFDPA_E_NONE       port changed, or already as asked
+* @returns  OFDPA_E_NOT_FOUND  no such port
+*
+* @notes    A deleted port is unknown to every other call.
+*
+* @end
+*********************************************************************/
+OFDPA_ERROR_t ofdpaMockPortPresentSet(uint32_t portNum, int present);
+
+/*********************************************************************
+* @purpose  Queue a packet-in on the packet socket.
+*
+* @param    inPortNum  @b{(input)} ingress port
+* @param    reason     @b{(input)} packet-in reason
+* @param    tableId    @b{(input)} table that sent the packet
+* @param    data       @b{(input)} packet, starting at the Ethernet header
+* @param    size       @b{(input)} packet length in bytes
+*
+* @returns  OFDPA_E_NONE   packet queued
+* @returns  OFDPA_E_PARAM  packet too large or NULL
+*
+* @end
+*********************************************************************/
+OFDPA_ERROR_t ofdpaMockPktInject(uint32_t inPortNum, OFDPA_PACKET_IN_REASON_t reason,
+                                 OFDPA_FLOW_TABLE_ID_t tableId,
+                                 const void *data, uint32_t size);
+
+#endif /* INCLUDE_OFDPA_MOCK_H */
@@ -0,0 +1,714 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock_flow.c
+*
+* @purpose      OF-DPA mock: flow tables, flow timeouts and flow events
+*
+* @component    OF-DPA
+*
+* @comments     Each table is hashed on (priority, match criteria) with
+*               every chain kept in key order, so a walk visits entries
+*               in (bucket, key) order. A second hash on the cookie
+*               serves the ByCookie calls the agent uses.
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "ofdpa_mock_int.h"
+
+#define OFDPA_MOCK_FLOW_BUCKETS_MIN  64
+#define OFDPA_MOCK_COOKIE_BUCKETS    65536
+
+typedef struct ofdpaMockFlow_s
+{
+  struct ofdpaMockFlow_s *next;        /* table chain, in key order */
+  struct ofdpaMockFlow_s *cookieNext;  /* cookie chain */
+  uint64_t                addTime;
+  uint64_t                modTime;
+  ofdpaFlowEntry_t        entry;
+} ofdpaMockFlow_t;
+
+typedef struct ofdpaMockFlowTable_s
+{
+  OFDPA_FLOW_TABLE_ID_t  tableId;
+  size_t                 matchSize;
+  uint32_t               maxEntries;
+  uint32_t               numEntries;
+  uint32_t               bucketCount;
+  ofdpaMockFlow_t      **buckets;
+} ofdpaMockFlowTable_t;
+
+#define OFDPA_MOCK_MATCH_SIZE(_entry) \
+  sizeof(((ofdpaFlowEntry_t *)0)->flowData._entry.match_criteria)
+
+static ofdpaMockFlowTable_t ofdpaMockFlowTables[] =
+{
+  { OFDPA_FLOW_TABLE_ID_INGRESS_PORT,      OFDPA_MOCK_MATCH_SIZE(ingressPortFlowEntry),      64    },
+  { OFDPA_FLOW_TABLE_ID_VLAN,              OFDPA_MOCK_MATCH_SIZE(vlanFlowEntry),             8192  },
+  { OFDPA_FLOW_TABLE_ID_TERMINATION_MAC,   OFDPA_MOCK_MATCH_SIZE(terminationMacFlowEntry),   512   },
+  { OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING,   OFDPA_MOCK_MATCH_SIZE(unicastRoutingFlowEntry),   16384 },
+  { OFDPA_FLOW_TABLE_ID_MULTICAST_ROUTING, OFDPA_MOCK_MATCH_SIZE(multicastRoutingFlowEntry), 2048  },
+  { OFDPA_FLOW_TABLE_ID_BRIDGING,          OFDPA_MOCK_MATCH_SIZE(bridgingFlowEntry),         32768 },
+  { OFDPA_FLOW_TABLE_ID_ACL_POLICY,        OFDPA_MOCK_MATCH_SIZE(policyAclFlowEntry),        4096  },
+};
+
+#define OFDPA_MOCK_FLOW_TABLE_COUNT \
+  (sizeof(ofdpaMockFlowTables) / sizeof(ofdpaMockFlowTables[0]))
+
+static ofdpaMockFlow_t *ofdpaMockCookieBuckets[OFDPA_MOCK_COOKIE_BUCKETS];
+
+typedef struct ofdpaMockFlowEvent_s
+{
+  struct ofdpaMockFlowEvent_s *next;
+  ofdpaFlowEvent_t             event;
+} ofdpaMockFlowEvent_t;
+
+static ofdpaMockFlowEvent_t *ofdpaMockFlowEventHead;
+static ofdpaMockFlowEvent_t *ofdpaMockFlowEventTail;
+
+static ofdpaMockFlowTable_t *ofdpaMockFlowTableGet(OFDPA_FLOW_TABLE_ID_t tableId)
+{
+  uint32_t i;
+
+  for (i = 0; i < OFDPA_MOCK_FLOW_TABLE_COUNT; i++)
+  {
+    if (ofdpaMockFlowTables[i].tableId == tableId)
+    {
+      return &ofdpaMockFlowTables[i];
+    }
+  }
+  return NULL;
+}
+
+static const uint8_t *ofdpaMockFlowMatch(const ofdpaFlowEntry_t *flow)
+{
+  /* Every flowData member starts with its match_criteria */
+  return (const uint8_t *)&flow->flowData;
+}
+
+static int ofdpaMockFlowKeyCompare(ofdpaMockFlowTable_t *table,
+                                   const ofdpaFlowEntry_t *a, const ofdpaFlowEntry_t *b)
+{
+  if (a->priority != b->priority)
+  {
+    return (a->priority < b->priority) ? -1 : 1;
+  }
+  return memcmp(ofdpaMockFlowMatch(a), ofdpaMockFlowMatch(b), table->matchSize);
+}
+
+/*
+ * FNV-1a over the key. The all-zero key, which starts a walk, always
+ * lands in bucket 0 so that it sorts before every other entry.
+ */
+static uint32_t ofdpaMockFlowBucket(ofdpaMockFlowTable_t *table, const ofdpaFlowEntry_t *flow)
+{
+  const uint8_t *match = ofdpaMockFlowMatch(flow);
+  uint32_t hash = 2166136261u;
+  uint32_t bits = flow->priority;
+  size_t i;
+
+  hash = (hash ^ flow->priority) * 16777619u;
+  for (i = 0; i < table->matchSize; i++)
+  {
+    hash = (hash ^ match[i]) * 16777619u;
+    bits |= match[i];
+  }
+  return (bits == 0) ? 0 : hash & (table->bucketCount - 1);
+}
+
+static uint32_t ofdpaMockCookieBucket(uint64_t cookie)
+{
+  cookie *= 0x9e3779b97f4a7c15ull;
+  return (uint32_t)(cookie >> 48) & (OFDPA_MOCK_COOKIE_BUCKETS - 1);
+}
+
+static void ofdpaMockFlowChainInsert(ofdpaMockFlowTable_t *table, ofdpaMockFlow_t *flow)
+{
+  ofdpaMockFlow_t **link;
+
+  link = &table->buckets[ofdpaMockFlowBucket(table, &flow->entry)];
+  while (*link != NULL && ofdpaMockFlowKeyCompare(table, &(*link)->entry, &flow->entry) < 0)
+  {
+    link = &(*link)->next;
+  }
+  flow->next = *link;
+  *link = flow;
+}
+
+static void ofdpaMockFlowTableGrow(ofdpaMockFlowTable_t *table)
+{
+  ofdpaMockFlow_t **old = table->buckets;
+  uint32_t oldCount = table->bucketCount;
+  uint32_t i;
+
+  table->bucketCount = oldCount ? oldCount * 2 : OFDPA_MOCK_FLOW_BUCKETS_MIN;
+  table->buckets = calloc(table->bucketCount, sizeof(*table->buckets));
+  if (table->buckets == NULL)
+  {
+    table->buckets = old;
+    table->bucketCount = oldCount;
+    return;
+  }
+
+  for (i = 0; i < oldCount; i++)
+  {
+    while (old[i] != NULL)
+    {
+      ofdpaMockFlow_t *flow = old[i];
+
+      old[i] = flow->next;
+      ofdpaMockFlowChainInsert(table, flow);
+    }
+  }
+  free(old);
+}
+
+static ofdpaMockFlow_t **ofdpaMockFlowFind(ofdpaMockFlowTable_t *table, const ofdpaFlowEntry_t *key)
+{
+  ofdpaMockFlow_t **link = &table->buckets[ofdpaMockFlowBucket(table, key)];
+  int cmp;
+
+  while (*link != NULL)
+  {
+    cmp = ofdpaMockFlowKeyCompare(table, &(*link)->entry, key);
+    if (cmp == 0)
+    {
+      return link;
+    }
+    if (cmp > 0)
+    {
+      break;
+    }
+    link = &(*link)->next;
+  }
+  return NULL;
+}
+
+static ofdpaMockFlow_t *ofdpaMockFlowByCookie(uint64_t cookie)
+{
+  ofdpaMockFlow_t *flow = ofdpaMockCookieBuckets[ofdpaMockCookieBucket(cookie)];
+
+  while (flow != NULL && flow->entry.cookie != cookie)
+  {
+    flow = flow->cookieNext;
+  }
+  return flow;
+}
+
+static void ofdpaMockCookieUnlink(ofdpaMockFlow_t *flow)
+{
+  ofdpaMockFlow_t **link = &ofdpaMockCookieBuckets[ofdpaMockCookieBucket(flow->entry.cookie)];
+
+  while (*link != flow)
+  {
+    link = &(*link)->cookieNext;
+  }
+  *link = flow->cookieNext;
+}
+
+static void ofdpaMockCookieLink(ofdpaMockFlow_t *flow)
+{
+  uint32_t bucket = ofdpaMockCookieBucket(flow->entry.cookie);
+
+  flow->cookieNext = ofdpaMockCookieBuckets[bucket];
+  ofdpaMockCookieBuckets[bucket] = flow;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Group and tunnel port references */
+
+static void ofdpaMockFlowRefsGet(const ofdpaFlowEntry_t *flow, uint32_t *groupId, uint32_t *tunnelPort)
+{
+  *groupId = 0;
+  *tunnelPort = 0;
+
+  switch (flow->tableId)
+  {
+    case OFDPA_FLOW_TABLE_ID_BRIDGING:
+      *groupId = flow->flowData.bridgingFlowEntry.groupID;
+      *tunnelPort = flow->flowData.bridgingFlowEntry.tunnelLogicalPort;
+      break;
+    case OFDPA_FLOW_TABLE_ID_UNICAST_ROUTING:
+      *groupId = flow->flowData.unicastRoutingFlowEntry.groupID;
+      break;
+    case OFDPA_FLOW_TABLE_ID_MULTICAST_ROUTING:
+      *groupId = flow->flowData.multicastRoutingFlowEntry.groupID;
+      break;
+    case OFDPA_FLOW_TABLE_ID_ACL_POLICY:
+      *groupId = flow->flowData.policyAclFlowEntry.groupID;
+      *tunnelPort = flow->flowData.policyAclFlowEntry.outputTunnelPort;
+      break;
+    default:
+      break;
+  }
+}
+
+static OFDPA_ERROR_t ofdpaMockFlowRefsCheck(const ofdpaFlowEntry_t *flow)
+{
+  uint32_t groupId, tunnelPort;
+
+  ofdpaMockFlowRefsGet(flow, &groupId, &tunnelPort);
+  if (groupId != 0 && ofdpaMockGroupRefCheck(groupId) != OFDPA_E_NONE)
+  {
+    return OFDPA_E_ERROR;
+  }
+  if (tunnelPort != 0 && ofdpaMockTunnelPortRefCheck(tunnelPort) != OFDPA_E_NONE)
+  {
+    return OFDPA_E_ERROR;
+  }
+  return OFDPA_E_NONE;
+}
+
+static void ofdpaMockFlowRefs(const ofdpaFlowEntry_t *flow, int delta)
+{
+  uint32_t groupId, tunnelPort;
+
+  ofdpaMockFlowRefsGet(flow, &groupId, &tunnelPort);
+  if (groupId != 0)
+  {
+    ofdpaMockGroupRef(groupId, delta);
+  }
+  if (tunnelPort != 0)
+  {
+    ofdpaMockTunnelPortRef(tunnelPort, delta);
+  }
+}
+
+static void ofdpaMockFlowRemove(ofdpaMockFlowTable_t *table, ofdpaMockFlow_t **link)
+{
+  ofdpaMockFlow_t *flow = *link;
+
+  *link = flow->next;
+  ofdpaMockCookieUnlink(flow);
+  ofdpaMockFlowRefs(&flow->entry, -1);
+  table->numEntries--;
+  free(flow);
+}
+
+static void ofdpaMockFlowStatsFill(ofdpaMockFlow_t *flow, ofdpaFlowEntryStats_t *stats)
+{
+  /* No traffic runs through the mock */
+  memset(stats, 0, sizeof(*stats));
+  stats->durationSec = (uint32_t)((ofdpaMockNow() - flow->addTime) / 1000000);
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Module state */
+
+void ofdpaMockFlowInit(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < OFDPA_MOCK_FLOW_TABLE_COUNT; i++)
+  {
+    ofdpaMockFlowTableGrow(&ofdpaMockFlowTables[i]);
+  }
+}
+
+void ofdpaMockFlowReset(void)
+{
+  ofdpaMockFlowTable_t *table;
+  uint32_t i, b;
+
+  for (i = 0; i < OFDPA_MOCK_FLOW_TABLE_COUNT; i++)
+  {
+    table = &ofdpaMockFlowTables[i];
+    for (b = 0; b < table->bucketCount; b++)
+    {
+      while (table->buckets[b] != NULL)
+      {
+        ofdpaMockFlowRemove(table, &table->buckets[b]);
+      }
+    }
+  }
+
+  while (ofdpaMockFlowEventHead != NULL)
+  {
+    ofdpaMockFlowEvent_t *node = ofdpaMockFlowEventHead;
+
+    ofdpaMockFlowEventHead = node->next;
+    free(node);
+  }
+  ofdpaMockFlowEventTail = NULL;
+}
+
+void ofdpaMockFlowEventPost(const ofdpaFlowEntry_t *flow, OFDPA_FLOW_EVENT_MASK_t mask)
+{
+  ofdpaMockFlowEvent_t *node = calloc(1, sizeof(*node));
+
+  if (node == NULL)
+  {
+    return;
+  }
+  node->event.eventMask = mask;
+  node->event.flowMatch = *flow;
+
+  if (ofdpaMockFlowEventTail != NULL)
+  {
+    ofdpaMockFlowEventTail->next = node;
+  }
+  else
+  {
+    ofdpaMockFlowEventHead = node;
+  }
+  ofdpaMockFlowEventTail = node;
+  ofdpaMockEventNotify();
+}
+
+int ofdpaMockFlowAgeLocked(void)
+{
+  uint64_t now = ofdpaMockNow();
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t **link;
+  OFDPA_FLOW_EVENT_MASK_t mask;
+  int count = 0;
+  uint32_t i, b;
+
+  for (i = 0; i < OFDPA_MOCK_FLOW_TABLE_COUNT; i++)
+  {
+    table = &ofdpaMockFlowTables[i];
+    for (b = 0; b < table->bucketCount; b++)
+    {
+      link = &table->buckets[b];
+      while (*link != NULL)
+      {
+        ofdpaFlowEntry_t *entry = &(*link)->entry;
+
+        mask = 0;
+        if (entry->hard_time != 0 &&
+            now >= (*link)->addTime + (uint64_t)entry->hard_time * 1000000)
+        {
+          mask = OFDPA_FLOW_EVENT_HARD_TIMEOUT;
+        }
+        else if (entry->idle_time != 0 &&
+                 now >= (*link)->modTime + (uint64_t)entry->idle_time * 1000000)
+        {
+          mask = OFDPA_FLOW_EVENT_IDLE_TIMEOUT;
+        }
+
+        if (mask == 0)
+        {
+          link = &(*link)->next;
+          continue;
+        }
+        ofdpaMockFlowEventPost(entry, mask);
+        ofdpaMockFlowRemove(table, link);
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+OFDPA_ERROR_t ofdpaMockFlowTableMaxSet(OFDPA_FLOW_TABLE_ID_t tableId, uint32_t maxEntries)
+{
+  ofdpaMockFlowTable_t *table;
+  OFDPA_ERROR_t rv = OFDPA_E_PARAM;
+
+  ofdpaMockLock();
+  table = ofdpaMockFlowTableGet(tableId);
+  if (table != NULL)
+  {
+    table->maxEntries = maxEntries;
+    rv = OFDPA_E_NONE;
+  }
+  ofdpaMockExit();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* OF-DPA API */
+
+OFDPA_ERROR_t ofdpaFlowEntryInit(OFDPA_FLOW_TABLE_ID_t tableId, ofdpaFlowEntry_t *flow)
+{
+  if (flow == NULL || ofdpaMockFlowTableGet(tableId) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  memset(flow, 0, sizeof(*flow));
+  flow->tableId = tableId;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaFlowAdd(ofdpaFlowEntry_t *flow)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t *node;
+  OFDPA_ERROR_t rv;
+
+  if (flow == NULL || (table = ofdpaMockFlowTableGet(flow->tableId)) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowAdd);
+  if (ofdpaMockFlowFind(table, flow) != NULL)
+  {
+    rv = OFDPA_E_EXISTS;
+  }
+  else if (table->numEntries >= table->maxEntries)
+  {
+    rv = OFDPA_E_FULL;
+  }
+  else if ((rv = ofdpaMockFlowRefsCheck(flow)) == OFDPA_E_NONE)
+  {
+    node = calloc(1, sizeof(*node));
+    if (node == NULL)
+    {
+      rv = OFDPA_E_FAIL;
+    }
+    else
+    {
+      node->entry = *flow;
+      node->addTime = node->modTime = ofdpaMockNow();
+      if (table->numEntries >= 2 * table->bucketCount)
+      {
+        ofdpaMockFlowTableGrow(table);
+      }
+      ofdpaMockFlowChainInsert(table, node);
+      ofdpaMockCookieLink(node);
+      ofdpaMockFlowRefs(flow, 1);
+      table->numEntries++;
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowModify(ofdpaFlowEntry_t *flow)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t **link;
+  OFDPA_ERROR_t rv;
+
+  if (flow == NULL || (table = ofdpaMockFlowTableGet(flow->tableId)) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowModify);
+  link = ofdpaMockFlowFind(table, flow);
+  if (link == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if ((rv = ofdpaMockFlowRefsCheck(flow)) == OFDPA_E_NONE)
+  {
+    ofdpaMockFlow_t *node = *link;
+
+    ofdpaMockFlowRefs(flow, 1);
+    ofdpaMockFlowRefs(&node->entry, -1);
+    ofdpaMockCookieUnlink(node);
+    node->entry = *flow;
+    ofdpaMockCookieLink(node);
+    node->modTime = ofdpaMockNow();
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowDelete(ofdpaFlowEntry_t *flow)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t **link;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (flow == NULL || (table = ofdpaMockFlowTableGet(flow->tableId)) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowDelete);
+  link = ofdpaMockFlowFind(table, flow);
+  if (link == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    ofdpaMockFlowRemove(table, link);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowNextGet(ofdpaFlowEntry_t *flow, ofdpaFlowEntry_t *nextFlow)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t *node;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+  uint32_t b;
+
+  if (flow == NULL || nextFlow == NULL ||
+      (table = ofdpaMockFlowTableGet(flow->tableId)) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowNextGet);
+  b = ofdpaMockFlowBucket(table, flow);
+  node = table->buckets[b];
+  while (node != NULL && ofdpaMockFlowKeyCompare(table, &node->entry, flow) <= 0)
+  {
+    node = node->next;
+  }
+  while (node == NULL && ++b < table->bucketCount)
+  {
+    node = table->buckets[b];
+  }
+  if (node != NULL)
+  {
+    *nextFlow = node->entry;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowStatsGet(ofdpaFlowEntry_t *flow, ofdpaFlowEntryStats_t *flowStats)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t **link;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (flow == NULL || flowStats == NULL ||
+      (table = ofdpaMockFlowTableGet(flow->tableId)) == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowStatsGet);
+  link = ofdpaMockFlowFind(table, flow);
+  if (link == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    ofdpaMockFlowStatsFill(*link, flowStats);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowByCookieGet(uint64_t cookie, ofdpaFlowEntry_t *flow, ofdpaFlowEntryStats_t *flowStats)
+{
+  ofdpaMockFlow_t *node;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (flow == NULL && flowStats == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowByCookieGet);
+  node = ofdpaMockFlowByCookie(cookie);
+  if (node == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    if (flow != NULL)
+    {
+      *flow = node->entry;
+    }
+    if (flowStats != NULL)
+    {
+      ofdpaMockFlowStatsFill(node, flowStats);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowByCookieDelete(uint64_t cookie)
+{
+  ofdpaMockFlowTable_t *table;
+  ofdpaMockFlow_t *node;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  OFDPA_MOCK_ENTER(ofdpaFlowByCookieDelete);
+  node = ofdpaMockFlowByCookie(cookie);
+  if (node != NULL)
+  {
+    table = ofdpaMockFlowTableGet(node->entry.tableId);
+    ofdpaMockFlowRemove(table, ofdpaMockFlowFind(table, &node->entry));
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowTableInfoGet(OFDPA_FLOW_TABLE_ID_t tableId, ofdpaFlowTableInfo_t *info)
+{
+  ofdpaMockFlowTable_t *table;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (info == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaFlowTableInfoGet);
+  table = ofdpaMockFlowTableGet(tableId);
+  if (table == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    info->numEntries = table->numEntries;
+    info->maxEntries = table->maxEntries;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaFlowEventNextGet(ofdpaFlowEvent_t *eventData)
+{
+  ofdpaMockFlowEvent_t *node;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (eventData == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  /* Events are delivered in the order they occurred, from every table */
+  OFDPA_MOCK_ENTER(ofdpaFlowEventNextGet);
+  node = ofdpaMockFlowEventHead;
+  if (node != NULL)
+  {
+    ofdpaMockFlowEventHead = node->next;
+    if (ofdpaMockFlowEventHead == NULL)
+    {
+      ofdpaMockFlowEventTail = NULL;
+    }
+    *eventData = node->event;
+    free(node);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
@@ -0,0 +1,779 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock_group.c
+*
+* @purpose      OF-DPA mock: group table, group buckets and group ID
+*               encoding
+*
+* @component    OF-DPA
+*
+* @comments     none
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ofdpa_mock_int.h"
+
+#define OFDPA_MOCK_GROUP_MAX  4096
+
+#define OFDPA_MOCK_GROUP_TYPE_SHIFT      28
+#define OFDPA_MOCK_GROUP_VLAN_SHIFT      16
+#define OFDPA_MOCK_GROUP_VLAN_MASK       0x0fff
+#define OFDPA_MOCK_GROUP_SHORT_MASK      0xffff
+#define OFDPA_MOCK_GROUP_INDEX_MASK      0x0fffffff
+#define OFDPA_MOCK_GROUP_TUNNEL_SHIFT    12
+#define OFDPA_MOCK_GROUP_TUNNEL_MASK     0xffff
+#define OFDPA_MOCK_GROUP_SUBTYPE_SHIFT   10
+#define OFDPA_MOCK_GROUP_SUBTYPE_MASK    0x3
+#define OFDPA_MOCK_GROUP_OVERLAY_MASK    0x3ff
+
+#define OFDPA_MOCK_GROUP_TYPE(_id)  ((_id) >> OFDPA_MOCK_GROUP_TYPE_SHIFT)
+
+typedef struct ofdpaMockGroup_s
+{
+  uint32_t            refCount;
+  uint64_t            addTime;
+  ofdpaMockIdTable_t  buckets;   /* ofdpaGroupBucketEntry_t by bucketIndex */
+} ofdpaMockGroup_t;
+
+static ofdpaMockIdTable_t ofdpaMockGroups;
+static uint32_t           ofdpaMockGroupCount[OFDPA_GROUP_ENTRY_TYPE_LAST];
+
+static uint32_t ofdpaMockGroupMaxBuckets(uint32_t type)
+{
+  switch (type)
+  {
+    case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
+      return 32;
+    case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY:
+      return 256;
+    default:
+      return 1;
+  }
+}
+
+static int ofdpaMockGroupHasVlan(uint32_t type)
+{
+  return (type == OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST);
+}
+
+static int ofdpaMockGroupHasShortIndex(uint32_t type)
+{
+  return (type == OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST);
+}
+
+static int ofdpaMockGroupHasIndex(uint32_t type)
+{
+  return (type == OFDPA_GROUP_ENTRY_TYPE_L2_REWRITE ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L3_INTERFACE ||
+          type == OFDPA_GROUP_ENTRY_TYPE_L3_ECMP);
+}
+
+/* Groups whose buckets chain to another group */
+static int ofdpaMockGroupChains(uint32_t type)
+{
+  return (type != OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE &&
+          type != OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY);
+}
+
+static void ofdpaMockGroupFree(ofdpaMockGroup_t *group)
+{
+  uint32_t i;
+
+  for (i = 0; i < group->buckets.count; i++)
+  {
+    free(group->buckets.entries[i].item);
+  }
+  ofdpaMockIdTableFree(&group->buckets);
+  free(group);
+}
+
+static void ofdpaMockBucketUnref(uint32_t groupId, ofdpaGroupBucketEntry_t *bucket)
+{
+  if (ofdpaMockGroupChains(OFDPA_MOCK_GROUP_TYPE(groupId)))
+  {
+    ofdpaMockGroupRef(bucket->referenceGroupId, -1);
+  }
+}
+
+static OFDPA_ERROR_t ofdpaMockBucketRefCheck(ofdpaGroupBucketEntry_t *bucket)
+{
+  if (ofdpaMockGroupChains(OFDPA_MOCK_GROUP_TYPE(bucket->groupId)) &&
+      !ofdpaMockIdExists(&ofdpaMockGroups, bucket->referenceGroupId))
+  {
+    return OFDPA_E_NOT_FOUND;
+  }
+  return OFDPA_E_NONE;
+}
+
+static void ofdpaMockBucketRef(ofdpaGroupBucketEntry_t *bucket)
+{
+  if (ofdpaMockGroupChains(OFDPA_MOCK_GROUP_TYPE(bucket->groupId)))
+  {
+    ofdpaMockGroupRef(bucket->referenceGroupId, 1);
+  }
+}
+
+static void ofdpaMockBucketsDeleteAll(uint32_t groupId, ofdpaMockGroup_t *group)
+{
+  uint32_t i;
+
+  for (i = 0; i < group->buckets.count; i++)
+  {
+    ofdpaMockBucketUnref(groupId, group->buckets.entries[i].item);
+    free(group->buckets.entries[i].item);
+  }
+  group->buckets.count = 0;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Module state */
+
+void ofdpaMockGroupReset(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < ofdpaMockGroups.count; i++)
+  {
+    ofdpaMockGroupFree(ofdpaMockGroups.entries[i].item);
+  }
+  ofdpaMockIdTableFree(&ofdpaMockGroups);
+  memset(ofdpaMockGroupCount, 0, sizeof(ofdpaMockGroupCount));
+}
+
+OFDPA_ERROR_t ofdpaMockGroupRefCheck(uint32_t groupId)
+{
+  return ofdpaMockIdExists(&ofdpaMockGroups, groupId) ? OFDPA_E_NONE : OFDPA_E_NOT_FOUND;
+}
+
+void ofdpaMockGroupRef(uint32_t groupId, int delta)
+{
+  ofdpaMockGroup_t *group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+
+  if (group != NULL)
+  {
+    group->refCount += delta;
+  }
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Group ID encoding */
+
+OFDPA_ERROR_t ofdpaGroupTypeGet(uint32_t groupId, uint32_t *type)
+{
+  if (type == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *type = OFDPA_MOCK_GROUP_TYPE(groupId);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupVlanGet(uint32_t groupId, uint32_t *vlanId)
+{
+  if (vlanId == NULL || !ofdpaMockGroupHasVlan(OFDPA_MOCK_GROUP_TYPE(groupId)))
+  {
+    return OFDPA_E_PARAM;
+  }
+  *vlanId = (groupId >> OFDPA_MOCK_GROUP_VLAN_SHIFT) & OFDPA_MOCK_GROUP_VLAN_MASK;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupPortIdGet(uint32_t groupId, uint32_t *portId)
+{
+  if (portId == NULL || OFDPA_MOCK_GROUP_TYPE(groupId) != OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *portId = groupId & OFDPA_MOCK_GROUP_SHORT_MASK;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupIndexShortGet(uint32_t groupId, uint32_t *index)
+{
+  if (index == NULL || !ofdpaMockGroupHasShortIndex(OFDPA_MOCK_GROUP_TYPE(groupId)))
+  {
+    return OFDPA_E_PARAM;
+  }
+  *index = groupId & OFDPA_MOCK_GROUP_SHORT_MASK;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupIndexGet(uint32_t groupId, uint32_t *index)
+{
+  uint32_t type = OFDPA_MOCK_GROUP_TYPE(groupId);
+
+  if (index == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  if (ofdpaMockGroupHasIndex(type))
+  {
+    *index = groupId & OFDPA_MOCK_GROUP_INDEX_MASK;
+  }
+  else if (type == OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY)
+  {
+    *index = groupId & OFDPA_MOCK_GROUP_OVERLAY_MASK;
+  }
+  else
+  {
+    return OFDPA_E_PARAM;
+  }
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupTypeSet(uint32_t *groupId, uint32_t type)
+{
+  if (groupId == NULL || type >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId = (*groupId & OFDPA_MOCK_GROUP_INDEX_MASK) | (type << OFDPA_MOCK_GROUP_TYPE_SHIFT);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupVlanSet(uint32_t *groupId, uint32_t vlanId)
+{
+  if (groupId == NULL || !ofdpaMockGroupHasVlan(OFDPA_MOCK_GROUP_TYPE(*groupId)))
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId &= ~(OFDPA_MOCK_GROUP_VLAN_MASK << OFDPA_MOCK_GROUP_VLAN_SHIFT);
+  *groupId |= (vlanId & OFDPA_MOCK_GROUP_VLAN_MASK) << OFDPA_MOCK_GROUP_VLAN_SHIFT;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupOverlayTunnelIdSet(uint32_t *groupId, uint32_t tunnelId)
+{
+  if (groupId == NULL || OFDPA_MOCK_GROUP_TYPE(*groupId) != OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId &= ~(OFDPA_MOCK_GROUP_TUNNEL_MASK << OFDPA_MOCK_GROUP_TUNNEL_SHIFT);
+  *groupId |= (tunnelId & OFDPA_MOCK_GROUP_TUNNEL_MASK) << OFDPA_MOCK_GROUP_TUNNEL_SHIFT;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupOverlaySubTypeSet(uint32_t *groupId, OFDPA_L2_OVERLAY_SUBTYPE_t subType)
+{
+  if (groupId == NULL || OFDPA_MOCK_GROUP_TYPE(*groupId) != OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId &= ~(OFDPA_MOCK_GROUP_SUBTYPE_MASK << OFDPA_MOCK_GROUP_SUBTYPE_SHIFT);
+  *groupId |= (subType & OFDPA_MOCK_GROUP_SUBTYPE_MASK) << OFDPA_MOCK_GROUP_SUBTYPE_SHIFT;
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupOverlayIndexSet(uint32_t *groupId, uint32_t index)
+{
+  if (groupId == NULL || OFDPA_MOCK_GROUP_TYPE(*groupId) != OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId = (*groupId & ~OFDPA_MOCK_GROUP_OVERLAY_MASK) | (index & OFDPA_MOCK_GROUP_OVERLAY_MASK);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupPortIdSet(uint32_t *groupId, uint32_t portId)
+{
+  if (groupId == NULL || OFDPA_MOCK_GROUP_TYPE(*groupId) != OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE)
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId = (*groupId & ~OFDPA_MOCK_GROUP_SHORT_MASK) | (portId & OFDPA_MOCK_GROUP_SHORT_MASK);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupIndexShortSet(uint32_t *groupId, uint32_t index)
+{
+  if (groupId == NULL || !ofdpaMockGroupHasShortIndex(OFDPA_MOCK_GROUP_TYPE(*groupId)))
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId = (*groupId & ~OFDPA_MOCK_GROUP_SHORT_MASK) | (index & OFDPA_MOCK_GROUP_SHORT_MASK);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupIndexSet(uint32_t *groupId, uint32_t index)
+{
+  if (groupId == NULL || !ofdpaMockGroupHasIndex(OFDPA_MOCK_GROUP_TYPE(*groupId)))
+  {
+    return OFDPA_E_PARAM;
+  }
+  *groupId = (*groupId & ~OFDPA_MOCK_GROUP_INDEX_MASK) | (index & OFDPA_MOCK_GROUP_INDEX_MASK);
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupDecode(uint32_t groupId, char *outBuf, int bufSize)
+{
+  static const char *typeNames[OFDPA_GROUP_ENTRY_TYPE_LAST] =
+  {
+    "L2 Interface", "L2 Rewrite", "L3 Unicast", "L2 Multicast", "L2 Flood",
+    "L3 Interface", "L3 Multicast", "L3 ECMP", "L2 Overlay",
+  };
+  uint32_t type = OFDPA_MOCK_GROUP_TYPE(groupId);
+  int len;
+
+  if (outBuf == NULL || bufSize <= 0)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  if (type >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    len = snprintf(outBuf, bufSize, "0x%08x (unknown type %u)", groupId, type);
+  }
+  else if (type == OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE)
+  {
+    len = snprintf(outBuf, bufSize, "0x%08x (%s, VLAN %u, port %u)", groupId, typeNames[type],
+                   (groupId >> OFDPA_MOCK_GROUP_VLAN_SHIFT) & OFDPA_MOCK_GROUP_VLAN_MASK,
+                   groupId & OFDPA_MOCK_GROUP_SHORT_MASK);
+  }
+  else if (ofdpaMockGroupHasShortIndex(type))
+  {
+    len = snprintf(outBuf, bufSize, "0x%08x (%s, VLAN %u, index %u)", groupId, typeNames[type],
+                   (groupId >> OFDPA_MOCK_GROUP_VLAN_SHIFT) & OFDPA_MOCK_GROUP_VLAN_MASK,
+                   groupId & OFDPA_MOCK_GROUP_SHORT_MASK);
+  }
+  else if (type == OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY)
+  {
+    len = snprintf(outBuf, bufSize, "0x%08x (%s, tunnel %u, sub-type %u, index %u)", groupId, typeNames[type],
+                   (groupId >> OFDPA_MOCK_GROUP_TUNNEL_SHIFT) & OFDPA_MOCK_GROUP_TUNNEL_MASK,
+                   (groupId >> OFDPA_MOCK_GROUP_SUBTYPE_SHIFT) & OFDPA_MOCK_GROUP_SUBTYPE_MASK,
+                   groupId & OFDPA_MOCK_GROUP_OVERLAY_MASK);
+  }
+  else
+  {
+    len = snprintf(outBuf, bufSize, "0x%08x (%s, index %u)", groupId, typeNames[type],
+                   groupId & OFDPA_MOCK_GROUP_INDEX_MASK);
+  }
+
+  return (len >= bufSize) ? OFDPA_E_FULL : OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaGroupEntryInit(OFDPA_GROUP_ENTRY_TYPE_t groupType, ofdpaGroupEntry_t *group)
+{
+  if (group == NULL || groupType >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    return OFDPA_E_PARAM;
+  }
+  memset(group, 0, sizeof(*group));
+  return ofdpaGroupTypeSet(&group->groupId, groupType);
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryInit(OFDPA_GROUP_ENTRY_TYPE_t groupType, ofdpaGroupBucketEntry_t *bucket)
+{
+  if (bucket == NULL || groupType >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    return OFDPA_E_PARAM;
+  }
+  memset(bucket, 0, sizeof(*bucket));
+  return OFDPA_E_NONE;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Group table */
+
+OFDPA_ERROR_t ofdpaGroupAdd(ofdpaGroupEntry_t *group)
+{
+  ofdpaMockGroup_t *node;
+  uint32_t type;
+  OFDPA_ERROR_t rv;
+
+  if (group == NULL || (type = OFDPA_MOCK_GROUP_TYPE(group->groupId)) >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupAdd);
+  if (ofdpaMockIdExists(&ofdpaMockGroups, group->groupId))
+  {
+    rv = OFDPA_E_EXISTS;
+  }
+  else if (ofdpaMockGroupCount[type] >= OFDPA_MOCK_GROUP_MAX)
+  {
+    rv = OFDPA_E_FULL;
+  }
+  else if (type == OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE &&
+           !ofdpaMockPortValid(group->groupId & OFDPA_MOCK_GROUP_SHORT_MASK))
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if ((node = calloc(1, sizeof(*node))) == NULL)
+  {
+    rv = OFDPA_E_INTERNAL;
+  }
+  else
+  {
+    node->addTime = ofdpaMockNow();
+    rv = ofdpaMockIdInsert(&ofdpaMockGroups, group->groupId, node);
+    if (rv == OFDPA_E_NONE)
+    {
+      ofdpaMockGroupCount[type]++;
+    }
+    else
+    {
+      free(node);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupDelete(uint32_t groupId)
+{
+  ofdpaMockGroup_t *group;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  OFDPA_MOCK_ENTER(ofdpaGroupDelete);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (group->refCount > 0)
+  {
+    /* Still used by a flow or by another group's bucket */
+    rv = OFDPA_E_EXISTS;
+  }
+  else
+  {
+    ofdpaMockBucketsDeleteAll(groupId, group);
+    ofdpaMockIdRemove(&ofdpaMockGroups, groupId);
+    ofdpaMockGroupCount[OFDPA_MOCK_GROUP_TYPE(groupId)]--;
+    ofdpaMockGroupFree(group);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupNextGet(uint32_t groupId, ofdpaGroupEntry_t *nextGroup)
+{
+  ofdpaMockIdEntry_t *entry;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (nextGroup == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupNextGet);
+  entry = ofdpaMockIdNext(&ofdpaMockGroups, groupId);
+  if (entry != NULL)
+  {
+    nextGroup->groupId = entry->id;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupTypeNextGet(uint32_t groupId,
+                                    OFDPA_GROUP_ENTRY_TYPE_t groupType,
+                                    ofdpaGroupEntry_t *nextGroup)
+{
+  ofdpaMockIdEntry_t *entry;
+  uint32_t first;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (nextGroup == NULL || groupType >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupTypeNextGet);
+  /* Groups sort by type first, so skip straight to the requested type */
+  first = (uint32_t)groupType << OFDPA_MOCK_GROUP_TYPE_SHIFT;
+  if (groupId < first)
+  {
+    entry = ofdpaMockIdNext(&ofdpaMockGroups, first - 1);
+  }
+  else
+  {
+    entry = ofdpaMockIdNext(&ofdpaMockGroups, groupId);
+  }
+  if (entry != NULL && OFDPA_MOCK_GROUP_TYPE(entry->id) == groupType)
+  {
+    nextGroup->groupId = entry->id;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupStatsGet(uint32_t groupId, ofdpaGroupEntryStats_t *groupStats)
+{
+  ofdpaMockGroup_t *group;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (groupStats == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupStatsGet);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    groupStats->refCount = group->refCount;
+    groupStats->duration = (uint32_t)((ofdpaMockNow() - group->addTime) / 1000000);
+    groupStats->bucketCount = group->buckets.count;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupTableInfoGet(OFDPA_GROUP_ENTRY_TYPE_t groupType, ofdpaGroupTableInfo_t *info)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (info == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupTableInfoGet);
+  if (groupType >= OFDPA_GROUP_ENTRY_TYPE_LAST)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    info->numGroupEntries = ofdpaMockGroupCount[groupType];
+    info->maxGroupEntries = OFDPA_MOCK_GROUP_MAX;
+    info->maxBucketEntries = ofdpaMockGroupMaxBuckets(groupType);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Group buckets */
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryAdd(ofdpaGroupBucketEntry_t *bucket)
+{
+  ofdpaMockGroup_t *group;
+  ofdpaGroupBucketEntry_t *node;
+  OFDPA_ERROR_t rv;
+
+  if (bucket == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryAdd);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, bucket->groupId);
+  if (group == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (ofdpaMockIdExists(&group->buckets, bucket->bucketIndex))
+  {
+    rv = OFDPA_E_EXISTS;
+  }
+  else if (group->buckets.count >= ofdpaMockGroupMaxBuckets(OFDPA_MOCK_GROUP_TYPE(bucket->groupId)))
+  {
+    rv = OFDPA_E_FULL;
+  }
+  else if ((rv = ofdpaMockBucketRefCheck(bucket)) != OFDPA_E_NONE)
+  {
+    /* referenced group does not exist */
+  }
+  else if ((node = malloc(sizeof(*node))) == NULL)
+  {
+    rv = OFDPA_E_INTERNAL;
+  }
+  else
+  {
+    *node = *bucket;
+    rv = ofdpaMockIdInsert(&group->buckets, bucket->bucketIndex, node);
+    if (rv == OFDPA_E_NONE)
+    {
+      ofdpaMockBucketRef(bucket);
+    }
+    else
+    {
+      free(node);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryDelete(uint32_t groupId, uint32_t bucketIndex)
+{
+  ofdpaMockGroup_t *group;
+  ofdpaGroupBucketEntry_t *node = NULL;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryDelete);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group != NULL)
+  {
+    node = ofdpaMockIdRemove(&group->buckets, bucketIndex);
+  }
+  if (node != NULL)
+  {
+    ofdpaMockBucketUnref(groupId, node);
+    free(node);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketsDeleteAll(uint32_t groupId)
+{
+  ofdpaMockGroup_t *group;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketsDeleteAll);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group == NULL)
+  {
+    rv = OFDPA_E_PARAM;
+  }
+  else
+  {
+    ofdpaMockBucketsDeleteAll(groupId, group);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryGet(uint32_t groupId, uint32_t bucketIndex,
+                                       ofdpaGroupBucketEntry_t *groupBucket)
+{
+  ofdpaMockGroup_t *group;
+  ofdpaGroupBucketEntry_t *node = NULL;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (groupBucket == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryGet);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group != NULL)
+  {
+    node = ofdpaMockIdFind(&group->buckets, bucketIndex);
+  }
+  if (node != NULL)
+  {
+    *groupBucket = *node;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryFirstGet(uint32_t groupId,
+                                            ofdpaGroupBucketEntry_t *firstGroupBucket)
+{
+  ofdpaMockGroup_t *group;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (firstGroupBucket == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryFirstGet);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group != NULL && group->buckets.count > 0)
+  {
+    *firstGroupBucket = *(ofdpaGroupBucketEntry_t *)group->buckets.entries[0].item;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryNextGet(uint32_t groupId, uint32_t bucketIndex,
+                                           ofdpaGroupBucketEntry_t *nextBucketEntry)
+{
+  ofdpaMockGroup_t *group;
+  ofdpaMockIdEntry_t *entry = NULL;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (nextBucketEntry == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryNextGet);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, groupId);
+  if (group != NULL)
+  {
+    entry = ofdpaMockIdNext(&group->buckets, bucketIndex);
+  }
+  if (entry != NULL)
+  {
+    *nextBucketEntry = *(ofdpaGroupBucketEntry_t *)entry->item;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaGroupBucketEntryModify(ofdpaGroupBucketEntry_t *bucket)
+{
+  ofdpaMockGroup_t *group;
+  ofdpaGroupBucketEntry_t *node = NULL;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (bucket == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaGroupBucketEntryModify);
+  group = ofdpaMockIdFind(&ofdpaMockGroups, bucket->groupId);
+  if (group != NULL)
+  {
+    node = ofdpaMockIdFind(&group->buckets, bucket->bucketIndex);
+  }
+  if (node != NULL && (rv = ofdpaMockBucketRefCheck(bucket)) == OFDPA_E_NONE)
+  {
+    ofdpaMockBucketRef(bucket);
+    ofdpaMockBucketUnref(node->groupId, node);
+    *node = *bucket;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
@@ -0,0 +1,205 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock_int.h
+*
+* @purpose      Internal definitions of the in-process OF-DPA mock
+*
+* @component    OF-DPA
+*
+* @comments     none
+*
+* @end
+*
+**********************************************************************/
+#ifndef INCLUDE_OFDPA_MOCK_INT_H
+#define INCLUDE_OFDPA_MOCK_INT_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <ofdpa_api.h>
+#include "ofdpa_mock.h"
+
+/*
+ * Every call that goes over RPC to the switch. Pure group ID and port
+ * number encoders, and ofdpaPktReceive(), run in the client library and
+ * are not listed.
+ */
+#define OFDPA_MOCK_CALLS(_)                     \
+  _(ofdpaClientInitialize)                      \
+  _(ofdpaFlowAdd)                               \
+  _(ofdpaFlowModify)                            \
+  _(ofdpaFlowDelete)                            \
+  _(ofdpaFlowNextGet)                           \
+  _(ofdpaFlowStatsGet)                          \
+  _(ofdpaFlowByCookieGet)                       \
+  _(ofdpaFlowByCookieDelete)                    \
+  _(ofdpaFlowTableInfoGet)                      \
+  _(ofdpaGroupAdd)                              \
+  _(ofdpaGroupDelete)                           \
+  _(ofdpaGroupNextGet)                          \
+  _(ofdpaGroupTypeNextGet)                      \
+  _(ofdpaGroupStatsGet)                         \
+  _(ofdpaGroupBucketEntryAdd)                   \
+  _(ofdpaGroupBucketEntryDelete)                \
+  _(ofdpaGroupBucketsDeleteAll)                 \
+  _(ofdpaGroupBucketEntryGet)                   \
+  _(ofdpaGroupBucketEntryFirstGet)              \
+  _(ofdpaGroupBucketEntryNextGet)               \
+  _(ofdpaGroupBucketEntryModify)                \
+  _(ofdpaGroupTableInfoGet)                     \
+  _(ofdpaPortNextGet)                           \
+  _(ofdpaPortMacGet)                            \
+  _(ofdpaPortNameGet)                           \
+  _(ofdpaPortStateGet)                          \
+  _(ofdpaPortConfigSet)                         \
+  _(ofdpaPortConfigGet)                         \
+  _(ofdpaPortMaxSpeedGet)                       \
+  _(ofdpaPortCurrSpeedGet)                      \
+  _(ofdpaPortFeatureGet)                        \
+  _(ofdpaPortAdvertiseFeatureSet)               \
+  _(ofdpaPortStatsClear)                        \
+  _(ofdpaPortStatsGet)                          \
+  _(ofdpaNumQueuesGet)                          \
+  _(ofdpaQueueStatsGet)                         \
+  _(ofdpaQueueStatsClear)                       \
+  _(ofdpaQueueRateSet)                          \
+  _(ofdpaQueueRateGet)                          \
+  _(ofdpaTunnelPortCreate)                      \
+  _(ofdpaTunnelPortDelete)                      \
+  _(ofdpaTunnelPortGet)                         \
+  _(ofdpaTunnelPortNextGet)                     \
+  _(ofdpaTunnelPortTenantAdd)                   \
+  _(ofdpaTunnelPortTenantDelete)                \
+  _(ofdpaTunnelPortTenantGet)                   \
+  _(ofdpaTunnelPortTenantNextGet)               \
+  _(ofdpaTunnelTenantCreate)                    \
+  _(ofdpaTunnelTenantDelete)                    \
+  _(ofdpaTunnelTenantGet)                       \
+  _(ofdpaTunnelTenantNextGet)                   \
+  _(ofdpaTunnelNextHopCreate)                   \
+  _(ofdpaTunnelNextHopDelete)                   \
+  _(ofdpaTunnelNextHopModify)                   \
+  _(ofdpaTunnelNextHopGet)                      \
+  _(ofdpaTunnelNextHopNextGet)                  \
+  _(ofdpaTunnelEcmpNextHopGroupCreate)          \
+  _(ofdpaTunnelEcmpNextHopGroupDelete)          \
+  _(ofdpaTunnelEcmpNextHopGroupGet)             \
+  _(ofdpaTunnelEcmpNextHopGroupNextGet)         \
+  _(ofdpaTunnelEcmpNextHopGroupMaxMembersGet)   \
+  _(ofdpaTunnelEcmpNextHopGroupMemberAdd)       \
+  _(ofdpaTunnelEcmpNextHopGroupMemberDelete)    \
+  _(ofdpaTunnelEcmpNextHopGroupMemberGet)       \
+  _(ofdpaTunnelEcmpNextHopGroupMemberNextGet)   \
+  _(ofdpaPktSend)                               \
+  _(ofdpaMaxPktSizeGet)                         \
+  _(ofdpaEventReceive)                          \
+  _(ofdpaPortEventNextGet)                      \
+  _(ofdpaFlowEventNextGet)                      \
+  _(ofdpaSourceMacLearningSet)                  \
+  _(ofdpaSourceMacLearningGet)                  \
+  _(ofdpaDebugLvl)                              \
+  _(ofdpaDebugLvlGet)                           \
+  _(ofdpaComponentNameGet)                      \
+  _(ofdpaDebugComponentSet)                     \
+  _(ofdpaDebugComponentGet)                     \
+  _(ofdpaBcmCommand)
+
+#define OFDPA_MOCK_CALL_ENUM(_name) OFDPA_MOCK_CALL_##_name,
+typedef enum
+{
+  OFDPA_MOCK_CALLS(OFDPA_MOCK_CALL_ENUM)
+  OFDPA_MOCK_CALL_COUNT
+} ofdpaMockCall_t;
+
+/* Apply the latency configured for a call, then take the mock lock */
+void ofdpaMockEnter(ofdpaMockCall_t call);
+void ofdpaMockExit(void);
+
+/* Take the mock lock without counting a call, for the mock controls */
+void ofdpaMockLock(void);
+
+#define OFDPA_MOCK_ENTER(_name) ofdpaMockEnter(OFDPA_MOCK_CALL_##_name)
+#define OFDPA_MOCK_EXIT()       ofdpaMockExit()
+
+/* Monotonic time in microseconds */
+uint64_t ofdpaMockNow(void);
+
+/* Value of an environment variable, or dflt if unset */
+uint32_t ofdpaMockEnvGet(const char *name, uint32_t dflt);
+
+/*
+ * Sorted table of 32-bit identifiers, used for groups, tunnel objects
+ * and their member lists. Walks in identifier order, as the
+ * ofdpa*NextGet() calls require.
+ */
+typedef struct ofdpaMockIdEntry_s
+{
+  uint32_t  id;
+  void     *item;
+} ofdpaMockIdEntry_t;
+
+typedef struct ofdpaMockIdTable_s
+{
+  ofdpaMockIdEntry_t *entries;
+  uint32_t            count;
+  uint32_t            slots;
+} ofdpaMockIdTable_t;
+
+void *ofdpaMockIdFind(ofdpaMockIdTable_t *table, uint32_t id);
+int ofdpaMockIdExists(ofdpaMockIdTable_t *table, uint32_t id);
+OFDPA_ERROR_t ofdpaMockIdInsert(ofdpaMockIdTable_t *table, uint32_t id, void *item);
+void *ofdpaMockIdRemove(ofdpaMockIdTable_t *table, uint32_t id);
+/* First entry with an identifier greater than id, or NULL */
+ofdpaMockIdEntry_t *ofdpaMockIdNext(ofdpaMockIdTable_t *table, uint32_t id);
+void ofdpaMockIdTableFree(ofdpaMockIdTable_t *table);
+
+/* Per-module state, all called with the mock lock held */
+void ofdpaMockFlowInit(void);
+void ofdpaMockFlowReset(void);
+void ofdpaMockGroupReset(void);
+void ofdpaMockTunnelReset(void);
+void ofdpaMockPortInit(void);
+
+/* Group and tunnel port references held by flows */
+OFDPA_ERROR_t ofdpaMockGroupRefCheck(uint32_t groupId);
+void ofdpaMockGroupRef(uint32_t groupId, int delta);
+OFDPA_ERROR_t ofdpaMockTunnelPortRefCheck(uint32_t portNum);
+void ofdpaMockTunnelPortRef(uint32_t portNum, int delta);
+
+int ofdpaMockPortValid(uint32_t portNum);
+
+/* Queue a flow event and wake the event socket */
+void ofdpaMockFlowEventPost(const ofdpaFlowEntry_t *flow, OFDPA_FLOW_EVENT_MASK_t mask);
+
+/* Wake the client's event socket */
+void ofdpaMockEventNotify(void);
+
+/* Queue a packet-in and wake the client's packet socket */
+OFDPA_ERROR_t ofdpaMockPktPost(uint32_t inPortNum, OFDPA_PACKET_IN_REASON_t reason,
+                               OFDPA_FLOW_TABLE_ID_t tableId,
+                               const void *data, uint32_t size);
+
+/* Expire flows past their timeouts, returns the number removed */
+int ofdpaMockFlowAgeLocked(void);
+
+/* Client ends of the event and packet socket pairs */
+extern int ofdpaMockEventFd[2];
+extern int ofdpaMockPktFd[2];
+
+#endif /* INCLUDE_OFDPA_MOCK_INT_H */
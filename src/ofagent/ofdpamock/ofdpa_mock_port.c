@@ -0,0 +1,721 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock_port.c
+*
+* @purpose      OF-DPA mock: physical ports, queues, port events and
+*               packet transmit
+*
+* @component    OF-DPA
+*
+* @comments     Every port receives and transmits a steady synthetic
+*               traffic stream, so counters advance between reads the
+*               way they do on a live switch.
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ofdpa_mock_int.h"
+
+#define OFDPA_MOCK_PORTS_DEFAULT  32
+#define OFDPA_MOCK_PORT_QUEUES_DEFAULT 8
+#define OFDPA_MOCK_PORT_QUEUES_MAX     64
+/* 10 Gbps, in kbps */
+#define OFDPA_MOCK_PORT_SPEED     10000000
+
+/* Synthetic traffic, per port: packets per millisecond and packet size */
+#define OFDPA_MOCK_PKTS_PER_MS    10
+#define OFDPA_MOCK_PKT_BYTES      512
+
+#define OFDPA_MOCK_PORT_TYPE_SHIFT  16
+#define OFDPA_MOCK_PORT_INDEX_MASK  0xffff
+
+#define OFDPA_MOCK_PORT_SUPPORTED \
+  (OFDPA_PORT_FEAT_1GB_FD | OFDPA_PORT_FEAT_10GB_FD | OFDPA_PORT_FEAT_FIBER | OFDPA_PORT_FEAT_AUTONEG)
+
+typedef struct ofdpaMockQueue_s
+{
+  uint32_t  minRate;
+  uint32_t  maxRate;
+  uint64_t  clearTime;
+} ofdpaMockQueue_t;
+
+typedef struct ofdpaMockPort_s
+{
+  OFDPA_PORT_CONFIG_t  config;
+  int                  deleted;       /* removed with ofdpaMockPortPresentSet() */
+  int                  linkUp;
+  uint32_t             advertised;
+  uint64_t             clearTime;
+  uint64_t             txPkts;        /* sent with ofdpaPktSend() */
+  uint64_t             txBytes;
+  uint64_t             txPktsBase;
+  uint64_t             txBytesBase;
+  OFDPA_PORT_EVENT_MASK_t eventMask;  /* events not yet read */
+  ofdpaMockQueue_t     queues[OFDPA_MOCK_PORT_QUEUES_MAX];
+} ofdpaMockPort_t;
+
+static ofdpaMockPort_t *ofdpaMockPorts;
+static uint32_t         ofdpaMockPortCount;
+static uint32_t         ofdpaMockQueueCount;
+static int              ofdpaMockPktLoopback;
+
+static OFDPA_CONTROL_t           ofdpaMockMacLearning = OFDPA_DISABLE;
+static ofdpaSrcMacLearnModeCfg_t ofdpaMockMacLearningCfg;
+
+/* Physical port, deleted or not, or NULL */
+static ofdpaMockPort_t *ofdpaMockPortSlotGet(uint32_t portNum)
+{
+  if ((portNum >> OFDPA_MOCK_PORT_TYPE_SHIFT) != OFDPA_PORT_TYPE_PHYSICAL ||
+      portNum == 0 || portNum > ofdpaMockPortCount)
+  {
+    return NULL;
+  }
+  return &ofdpaMockPorts[portNum - 1];
+}
+
+/* Physical port, or NULL */
+static ofdpaMockPort_t *ofdpaMockPortGet(uint32_t portNum)
+{
+  ofdpaMockPort_t *port = ofdpaMockPortSlotGet(portNum);
+
+  return ((port != NULL) && !port->deleted) ? port : NULL;
+}
+
+static OFDPA_PORT_STATE_t ofdpaMockPortState(ofdpaMockPort_t *port)
+{
+  return (port->linkUp && !(port->config & OFDPA_PORT_CONFIG_DOWN)) ? 0 : OFDPA_PORT_STATE_LINK_DOWN;
+}
+
+static void ofdpaMockPortEventPost(ofdpaMockPort_t *port, OFDPA_PORT_EVENT_MASK_t mask)
+{
+  port->eventMask |= mask;
+  ofdpaMockEventNotify();
+}
+
+/* Synthetic packets seen since a point in time */
+static uint64_t ofdpaMockPkts(uint64_t since)
+{
+  return (ofdpaMockNow() - since) / 1000 * OFDPA_MOCK_PKTS_PER_MS;
+}
+
+void ofdpaMockPortInit(void)
+{
+  uint64_t now = ofdpaMockNow();
+  uint32_t i, q;
+
+  ofdpaMockPortCount = ofdpaMockEnvGet("OFDPA_MOCK_PORTS", OFDPA_MOCK_PORTS_DEFAULT);
+  if (ofdpaMockPortCount > OFDPA_MOCK_PORT_INDEX_MASK)
+  {
+    ofdpaMockPortCount = OFDPA_MOCK_PORT_INDEX_MASK;
+  }
+  ofdpaMockQueueCount = ofdpaMockEnvGet("OFDPA_MOCK_QUEUES", OFDPA_MOCK_PORT_QUEUES_DEFAULT);
+  if (ofdpaMockQueueCount == 0 || ofdpaMockQueueCount > OFDPA_MOCK_PORT_QUEUES_MAX)
+  {
+    ofdpaMockQueueCount = OFDPA_MOCK_PORT_QUEUES_DEFAULT;
+  }
+  ofdpaMockPktLoopback = ofdpaMockEnvGet("OFDPA_MOCK_PKT_LOOPBACK", 0);
+
+  ofdpaMockPorts = calloc(ofdpaMockPortCount, sizeof(*ofdpaMockPorts));
+  if (ofdpaMockPorts == NULL)
+  {
+    ofdpaMockPortCount = 0;
+    return;
+  }
+  for (i = 0; i < ofdpaMockPortCount; i++)
+  {
+    ofdpaMockPorts[i].linkUp = 1;
+    ofdpaMockPorts[i].advertised = OFDPA_MOCK_PORT_SUPPORTED;
+    ofdpaMockPorts[i].clearTime = now;
+    for (q = 0; q < OFDPA_MOCK_PORT_QUEUES_MAX; q++)
+    {
+      ofdpaMockPorts[i].queues[q].clearTime = now;
+    }
+  }
+}
+
+int ofdpaMockPortValid(uint32_t portNum)
+{
+  return ofdpaMockPortGet(portNum) != NULL;
+}
+
+OFDPA_ERROR_t ofdpaMockPortLinkSet(uint32_t portNum, int up)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_PORT_STATE_t state;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  ofdpaMockLock();
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    state = ofdpaMockPortState(port);
+    port->linkUp = (up != 0);
+    if (ofdpaMockPortState(port) != state)
+    {
+      ofdpaMockPortEventPost(port, OFDPA_EVENT_PORT_STATE);
+    }
+    rv = OFDPA_E_NONE;
+  }
+  ofdpaMockExit();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaMockPortPresentSet(uint32_t portNum, int present)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  ofdpaMockLock();
+  port = ofdpaMockPortSlotGet(portNum);
+  if (port != NULL)
+  {
+    if (port->deleted != !present)
+    {
+      port->deleted = !present;
+      ofdpaMockPortEventPost(port, present ? OFDPA_EVENT_PORT_CREATE : OFDPA_EVENT_PORT_DELETE);
+    }
+    rv = OFDPA_E_NONE;
+  }
+  ofdpaMockExit();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Port numbering */
+
+void ofdpaPortTypeGet(uint32_t portNum, uint32_t *type)
+{
+  *type = portNum >> OFDPA_MOCK_PORT_TYPE_SHIFT;
+}
+
+void ofdpaPortTypeSet(uint32_t *portNum, uint32_t type)
+{
+  *portNum = (*portNum & OFDPA_MOCK_PORT_INDEX_MASK) | (type << OFDPA_MOCK_PORT_TYPE_SHIFT);
+}
+
+void ofdpaPortIndexGet(uint32_t portNum, uint32_t *index)
+{
+  *index = portNum & OFDPA_MOCK_PORT_INDEX_MASK;
+}
+
+void ofdpaPortIndexSet(uint32_t *portNum, uint32_t index)
+{
+  *portNum = (*portNum & ~OFDPA_MOCK_PORT_INDEX_MASK) | (index & OFDPA_MOCK_PORT_INDEX_MASK);
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Port table */
+
+OFDPA_ERROR_t ofdpaPortNextGet(uint32_t portNum, uint32_t *nextPortNum)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  if (nextPortNum == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortNextGet);
+  if ((portNum >> OFDPA_MOCK_PORT_TYPE_SHIFT) == OFDPA_PORT_TYPE_PHYSICAL)
+  {
+    for (portNum++; portNum <= ofdpaMockPortCount; portNum++)
+    {
+      if (!ofdpaMockPorts[portNum - 1].deleted)
+      {
+        *nextPortNum = portNum;
+        rv = OFDPA_E_NONE;
+        break;
+      }
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortMacGet(uint32_t portNum, ofdpaMacAddr_t *mac)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (mac == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortMacGet);
+  if (ofdpaMockPortGet(portNum) != NULL)
+  {
+    /* Locally administered, 02:00:00:00:<port> */
+    memset(mac, 0, sizeof(*mac));
+    mac->addr[0] = 0x02;
+    mac->addr[4] = (portNum >> 8) & 0xff;
+    mac->addr[5] = portNum & 0xff;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortNameGet(uint32_t portNum, ofdpa_buffdesc *name)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (name == NULL || name->pstart == NULL || name->size == 0)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortNameGet);
+  if (ofdpaMockPortGet(portNum) != NULL)
+  {
+    snprintf(name->pstart, name->size, "port%u", portNum);
+    name->size = strlen(name->pstart) + 1;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortStateGet(uint32_t portNum, OFDPA_PORT_STATE_t *state)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (state == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortStateGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    *state = ofdpaMockPortState(port);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortConfigSet(uint32_t portNum, OFDPA_PORT_CONFIG_t config)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_PORT_STATE_t state;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaPortConfigSet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    state = ofdpaMockPortState(port);
+    port->config = config;
+    if (ofdpaMockPortState(port) != state)
+    {
+      ofdpaMockPortEventPost(port, OFDPA_EVENT_PORT_STATE);
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortConfigGet(uint32_t portNum, OFDPA_PORT_CONFIG_t *config)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (config == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortConfigGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    *config = port->config;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortMaxSpeedGet(uint32_t portNum, uint32_t *maxSpeed)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (maxSpeed == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortMaxSpeedGet);
+  if (ofdpaMockPortGet(portNum) != NULL)
+  {
+    *maxSpeed = OFDPA_MOCK_PORT_SPEED;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortCurrSpeedGet(uint32_t portNum, uint32_t *currSpeed)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (currSpeed == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortCurrSpeedGet);
+  if (ofdpaMockPortGet(portNum) != NULL)
+  {
+    *currSpeed = OFDPA_MOCK_PORT_SPEED;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortFeatureGet(uint32_t portNum, ofdpaPortFeature_t *feature)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (feature == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortFeatureGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    feature->curr = OFDPA_PORT_FEAT_10GB_FD | OFDPA_PORT_FEAT_FIBER;
+    feature->advertised = port->advertised;
+    feature->supported = OFDPA_MOCK_PORT_SUPPORTED;
+    feature->peer = port->linkUp ? OFDPA_MOCK_PORT_SUPPORTED : 0;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortAdvertiseFeatureSet(uint32_t portNum, uint32_t advertise)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (advertise & ~OFDPA_MOCK_PORT_SUPPORTED)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortAdvertiseFeatureSet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    port->advertised = advertise;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortStatsClear(uint32_t portNum)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaPortStatsClear);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    port->clearTime = ofdpaMockNow();
+    port->txPktsBase = port->txPkts;
+    port->txBytesBase = port->txBytes;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaPortStatsGet(uint32_t portNum, ofdpaPortStats_t *stats)
+{
+  ofdpaMockPort_t *port;
+  uint64_t pkts;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (stats == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortStatsGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    pkts = ofdpaMockPkts(port->clearTime);
+    memset(stats, 0, sizeof(*stats));
+    stats->rx_packets = pkts;
+    stats->rx_bytes = pkts * OFDPA_MOCK_PKT_BYTES;
+    stats->tx_packets = pkts + port->txPkts - port->txPktsBase;
+    stats->tx_bytes = pkts * OFDPA_MOCK_PKT_BYTES + port->txBytes - port->txBytesBase;
+    stats->duration_seconds = (uint32_t)((ofdpaMockNow() - port->clearTime) / 1000000);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Queues */
+
+OFDPA_ERROR_t ofdpaNumQueuesGet(uint32_t portNum, uint32_t *numQueues)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (numQueues == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaNumQueuesGet);
+  if (ofdpaMockPortGet(portNum) != NULL)
+  {
+    *numQueues = ofdpaMockQueueCount;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaQueueStatsGet(uint32_t portNum, uint32_t queueId, ofdpaPortQueueStats_t *stats)
+{
+  ofdpaMockPort_t *port;
+  uint64_t pkts;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (stats == NULL || queueId >= ofdpaMockQueueCount)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaQueueStatsGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    /* The port's synthetic traffic is spread over its queues */
+    pkts = ofdpaMockPkts(port->queues[queueId].clearTime) / ofdpaMockQueueCount;
+    memset(stats, 0, sizeof(*stats));
+    stats->txPkts = pkts;
+    stats->txBytes = pkts * OFDPA_MOCK_PKT_BYTES;
+    stats->duration_seconds = (uint32_t)((ofdpaMockNow() - port->queues[queueId].clearTime) / 1000000);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaQueueStatsClear(uint32_t portNum, uint32_t queueId)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (queueId >= ofdpaMockQueueCount)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaQueueStatsClear);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    port->queues[queueId].clearTime = ofdpaMockNow();
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaQueueRateSet(uint32_t portNum, uint32_t queueId, uint32_t minRate, uint32_t maxRate)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (queueId >= ofdpaMockQueueCount || (maxRate != 0 && minRate > maxRate))
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaQueueRateSet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    port->queues[queueId].minRate = minRate;
+    port->queues[queueId].maxRate = maxRate;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaQueueRateGet(uint32_t portNum, uint32_t queueId, uint32_t *minRate, uint32_t *maxRate)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (minRate == NULL || maxRate == NULL || queueId >= ofdpaMockQueueCount)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaQueueRateGet);
+  port = ofdpaMockPortGet(portNum);
+  if (port != NULL)
+  {
+    *minRate = port->queues[queueId].minRate;
+    *maxRate = port->queues[queueId].maxRate;
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Port events */
+
+OFDPA_ERROR_t ofdpaPortEventNextGet(ofdpaPortEvent_t *eventData)
+{
+  ofdpaMockPort_t *port;
+  uint32_t i;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (eventData == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPortEventNextGet);
+  i = ((eventData->portNum >> OFDPA_MOCK_PORT_TYPE_SHIFT) == OFDPA_PORT_TYPE_PHYSICAL) ?
+    eventData->portNum : ofdpaMockPortCount;
+  for (; i < ofdpaMockPortCount; i++)
+  {
+    port = &ofdpaMockPorts[i];
+    if (port->eventMask != 0)
+    {
+      eventData->eventMask = port->eventMask;
+      eventData->portNum = i + 1;
+      eventData->state = ofdpaMockPortState(port);
+      port->eventMask = 0;
+      rv = OFDPA_E_NONE;
+      break;
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Packet transmit */
+
+OFDPA_ERROR_t ofdpaPktSend(ofdpa_buffdesc *pkt, uint32_t flags, uint32_t outPortNum, uint32_t inPortNum)
+{
+  ofdpaMockPort_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (pkt == NULL || pkt->pstart == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaPktSend);
+  port = ofdpaMockPortGet(outPortNum);
+  if (flags & OFDPA_PKT_LOOKUP)
+  {
+    /* No pipeline to run the packet through; it is consumed */
+  }
+  else if (port == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else
+  {
+    port->txPkts++;
+    port->txBytes += pkt->size;
+    if (ofdpaMockPktLoopback)
+    {
+      rv = ofdpaMockPktPost(outPortNum, OFDPA_PACKET_IN_REASON_ACTION,
+                            OFDPA_FLOW_TABLE_ID_ACL_POLICY, pkt->pstart, pkt->size);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Source MAC learning */
+
+OFDPA_ERROR_t ofdpaSourceMacLearningSet(OFDPA_CONTROL_t mode, ofdpaSrcMacLearnModeCfg_t *srcMacLearnModeCfg)
+{
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (mode != OFDPA_ENABLE && mode != OFDPA_DISABLE)
+  {
+    return OFDPA_E_PARAM;
+  }
+  if (mode == OFDPA_ENABLE && srcMacLearnModeCfg == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaSourceMacLearningSet);
+  if (mode == OFDPA_ENABLE && srcMacLearnModeCfg->destPortNum != OFDPA_PORT_CONTROLLER)
+  {
+    rv = OFDPA_E_UNAVAIL;
+  }
+  else
+  {
+    ofdpaMockMacLearning = mode;
+    if (srcMacLearnModeCfg != NULL)
+    {
+      ofdpaMockMacLearningCfg = *srcMacLearnModeCfg;
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaSourceMacLearningGet(OFDPA_CONTROL_t *mode, ofdpaSrcMacLearnModeCfg_t *srcMacLearnModeCfg)
+{
+  if (mode == NULL || srcMacLearnModeCfg == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaSourceMacLearningGet);
+  *mode = ofdpaMockMacLearning;
+  *srcMacLearnModeCfg = ofdpaMockMacLearningCfg;
+  OFDPA_MOCK_EXIT();
+  return OFDPA_E_NONE;
+}
@@ -0,0 +1,730 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename     ofdpa_mock_tunnel.c
+*
+* @purpose      OF-DPA mock: tunnel logical ports, tenants, next hops
+*               and ECMP next hop groups
+*
+* @component    OF-DPA
+*
+* @comments     none
+*
+* @end
+*
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ofdpa_mock_int.h"
+
+#define OFDPA_MOCK_TUNNEL_OBJ_MAX      4096
+#define OFDPA_MOCK_ECMP_MEMBERS_MAX    16
+
+typedef struct ofdpaMockTunnelObj_s
+{
+  uint32_t            refCount;
+  /* Tenants of a tunnel port, or next hops of an ECMP group */
+  ofdpaMockIdTable_t  members;
+  char                name[OFDPA_PORT_NAME_STRING_SIZE];
+  union
+  {
+    ofdpaTunnelPortConfig_t              port;
+    ofdpaTunnelTenantConfig_t            tenant;
+    ofdpaTunnelNextHopConfig_t           nextHop;
+    ofdpaTunnelEcmpNextHopGroupConfig_t  ecmp;
+  } config;
+} ofdpaMockTunnelObj_t;
+
+static ofdpaMockIdTable_t ofdpaMockTunnelPorts;
+static ofdpaMockIdTable_t ofdpaMockTenants;
+static ofdpaMockIdTable_t ofdpaMockNextHops;
+static ofdpaMockIdTable_t ofdpaMockEcmpGroups;
+
+static void ofdpaMockTunnelTableFree(ofdpaMockIdTable_t *table)
+{
+  uint32_t i;
+
+  for (i = 0; i < table->count; i++)
+  {
+    ofdpaMockTunnelObj_t *obj = table->entries[i].item;
+
+    ofdpaMockIdTableFree(&obj->members);
+    free(obj);
+  }
+  ofdpaMockIdTableFree(table);
+}
+
+static OFDPA_ERROR_t ofdpaMockTunnelObjAdd(ofdpaMockIdTable_t *table, uint32_t id,
+                                           ofdpaMockTunnelObj_t **obj)
+{
+  OFDPA_ERROR_t rv;
+
+  if (ofdpaMockIdExists(table, id))
+  {
+    return OFDPA_E_EXISTS;
+  }
+  if (table->count >= OFDPA_MOCK_TUNNEL_OBJ_MAX)
+  {
+    return OFDPA_E_FULL;
+  }
+  *obj = calloc(1, sizeof(**obj));
+  if (*obj == NULL)
+  {
+    return OFDPA_E_FAIL;
+  }
+  rv = ofdpaMockIdInsert(table, id, *obj);
+  if (rv != OFDPA_E_NONE)
+  {
+    free(*obj);
+  }
+  return rv;
+}
+
+static void ofdpaMockTunnelObjRef(ofdpaMockIdTable_t *table, uint32_t id, int delta)
+{
+  ofdpaMockTunnelObj_t *obj = ofdpaMockIdFind(table, id);
+
+  if (obj != NULL)
+  {
+    obj->refCount += delta;
+  }
+}
+
+static OFDPA_ERROR_t ofdpaMockTunnelNextGet(ofdpaMockIdTable_t *table, uint32_t id,
+                                            uint32_t *nextId, OFDPA_ERROR_t notFound)
+{
+  ofdpaMockIdEntry_t *entry;
+
+  if (nextId == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+  entry = ofdpaMockIdNext(table, id);
+  if (entry == NULL)
+  {
+    return notFound;
+  }
+  *nextId = entry->id;
+  return OFDPA_E_NONE;
+}
+
+/* Next hop or ECMP group an endpoint sends through */
+static ofdpaMockIdTable_t *ofdpaMockEndpointNextHopTable(ofdpaTunnelPortConfig_t *config)
+{
+  return config->configData.endpoint.ecmp ? &ofdpaMockEcmpGroups : &ofdpaMockNextHops;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Module state */
+
+void ofdpaMockTunnelReset(void)
+{
+  ofdpaMockTunnelTableFree(&ofdpaMockTunnelPorts);
+  ofdpaMockTunnelTableFree(&ofdpaMockTenants);
+  ofdpaMockTunnelTableFree(&ofdpaMockNextHops);
+  ofdpaMockTunnelTableFree(&ofdpaMockEcmpGroups);
+}
+
+OFDPA_ERROR_t ofdpaMockTunnelPortRefCheck(uint32_t portNum)
+{
+  return ofdpaMockIdExists(&ofdpaMockTunnelPorts, portNum) ? OFDPA_E_NONE : OFDPA_E_NOT_FOUND;
+}
+
+void ofdpaMockTunnelPortRef(uint32_t portNum, int delta)
+{
+  ofdpaMockTunnelObjRef(&ofdpaMockTunnelPorts, portNum, delta);
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Tunnel logical ports */
+
+OFDPA_ERROR_t ofdpaTunnelPortCreate(uint32_t portNum, ofdpa_buffdesc *name, ofdpaTunnelPortConfig_t *config)
+{
+  ofdpaMockTunnelObj_t *obj;
+  uint32_t type;
+  OFDPA_ERROR_t rv;
+
+  ofdpaPortTypeGet(portNum, &type);
+  if (config == NULL || type != OFDPA_PORT_TYPE_LOGICAL_TUNNEL ||
+      (config->type != OFDPA_TUNNEL_PORT_TYPE_ENDPOINT &&
+       config->type != OFDPA_TUNNEL_PORT_TYPE_ACCESS))
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortCreate);
+  if (config->type == OFDPA_TUNNEL_PORT_TYPE_ACCESS &&
+      !ofdpaMockPortValid(config->configData.access.physicalPortNum))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if (config->type == OFDPA_TUNNEL_PORT_TYPE_ENDPOINT &&
+           !ofdpaMockIdExists(ofdpaMockEndpointNextHopTable(config),
+                              config->configData.endpoint.nextHopId))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if ((rv = ofdpaMockTunnelObjAdd(&ofdpaMockTunnelPorts, portNum, &obj)) == OFDPA_E_NONE)
+  {
+    obj->config.port = *config;
+    if (name != NULL && name->pstart != NULL)
+    {
+      snprintf(obj->name, sizeof(obj->name), "%.*s", (int)name->size, name->pstart);
+    }
+    if (config->type == OFDPA_TUNNEL_PORT_TYPE_ENDPOINT)
+    {
+      ofdpaMockTunnelObjRef(ofdpaMockEndpointNextHopTable(config),
+                            config->configData.endpoint.nextHopId, 1);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortDelete(uint32_t portNum)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortDelete);
+  obj = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (obj == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (obj->refCount > 0 || obj->members.count > 0)
+  {
+    rv = OFDPA_E_FAIL;
+  }
+  else
+  {
+    if (obj->config.port.type == OFDPA_TUNNEL_PORT_TYPE_ENDPOINT)
+    {
+      ofdpaMockTunnelObjRef(ofdpaMockEndpointNextHopTable(&obj->config.port),
+                            obj->config.port.configData.endpoint.nextHopId, -1);
+    }
+    ofdpaMockIdRemove(&ofdpaMockTunnelPorts, portNum);
+    ofdpaMockIdTableFree(&obj->members);
+    free(obj);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortGet(uint32_t portNum,
+                                 ofdpaTunnelPortConfig_t *config,
+                                 ofdpaTunnelPortStatus_t *status)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortGet);
+  obj = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (obj != NULL)
+  {
+    if (config != NULL)
+    {
+      *config = obj->config.port;
+    }
+    if (status != NULL)
+    {
+      status->refCount = obj->refCount;
+      status->tenantCount = obj->members.count;
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortNextGet(uint32_t portNum, uint32_t *nextPortNum)
+{
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortNextGet);
+  rv = ofdpaMockTunnelNextGet(&ofdpaMockTunnelPorts, portNum, nextPortNum, OFDPA_E_FAIL);
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortTenantAdd(uint32_t portNum, uint32_t tunnelId)
+{
+  ofdpaMockTunnelObj_t *port;
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortTenantAdd);
+  port = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (port == NULL || !ofdpaMockIdExists(&ofdpaMockTenants, tunnelId))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if ((rv = ofdpaMockIdInsert(&port->members, tunnelId, NULL)) == OFDPA_E_NONE)
+  {
+    ofdpaMockTunnelObjRef(&ofdpaMockTenants, tunnelId, 1);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortTenantDelete(uint32_t portNum, uint32_t tunnelId)
+{
+  ofdpaMockTunnelObj_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_FAIL;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortTenantDelete);
+  port = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (port != NULL && ofdpaMockIdExists(&port->members, tunnelId))
+  {
+    ofdpaMockIdRemove(&port->members, tunnelId);
+    ofdpaMockTunnelObjRef(&ofdpaMockTenants, tunnelId, -1);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortTenantGet(uint32_t portNum, uint32_t tunnelId, ofdpaTunnelPortTenantStatus_t *status)
+{
+  ofdpaMockTunnelObj_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortTenantGet);
+  port = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (port != NULL && ofdpaMockIdExists(&port->members, tunnelId))
+  {
+    if (status != NULL)
+    {
+      /* Flows do not reference port and tenant pairs in the mock */
+      status->refCount = 0;
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelPortTenantNextGet(uint32_t portNum, uint32_t tunnelId, uint32_t *nextTunnelId)
+{
+  ofdpaMockTunnelObj_t *port;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (nextTunnelId == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelPortTenantNextGet);
+  port = ofdpaMockIdFind(&ofdpaMockTunnelPorts, portNum);
+  if (port != NULL)
+  {
+    rv = ofdpaMockTunnelNextGet(&port->members, tunnelId, nextTunnelId, OFDPA_E_NOT_FOUND);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Tenants */
+
+OFDPA_ERROR_t ofdpaTunnelTenantCreate(uint32_t tunnelId, ofdpaTunnelTenantConfig_t *config)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv;
+
+  if (config == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelTenantCreate);
+  if (config->mcastNextHopId != 0 && !ofdpaMockIdExists(&ofdpaMockNextHops, config->mcastNextHopId))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if ((rv = ofdpaMockTunnelObjAdd(&ofdpaMockTenants, tunnelId, &obj)) == OFDPA_E_NONE)
+  {
+    obj->config.tenant = *config;
+    if (config->mcastNextHopId != 0)
+    {
+      ofdpaMockTunnelObjRef(&ofdpaMockNextHops, config->mcastNextHopId, 1);
+    }
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelTenantDelete(uint32_t tunnelId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelTenantDelete);
+  obj = ofdpaMockIdFind(&ofdpaMockTenants, tunnelId);
+  if (obj == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (obj->refCount > 0)
+  {
+    rv = OFDPA_E_FAIL;
+  }
+  else
+  {
+    if (obj->config.tenant.mcastNextHopId != 0)
+    {
+      ofdpaMockTunnelObjRef(&ofdpaMockNextHops, obj->config.tenant.mcastNextHopId, -1);
+    }
+    ofdpaMockIdRemove(&ofdpaMockTenants, tunnelId);
+    free(obj);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelTenantGet(uint32_t tunnelId,
+                                   ofdpaTunnelTenantConfig_t *config,
+                                   ofdpaTunnelTenantStatus_t *status)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelTenantGet);
+  obj = ofdpaMockIdFind(&ofdpaMockTenants, tunnelId);
+  if (obj != NULL)
+  {
+    if (config != NULL)
+    {
+      *config = obj->config.tenant;
+    }
+    if (status != NULL)
+    {
+      status->refCount = obj->refCount;
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelTenantNextGet(uint32_t tunnelId, uint32_t *nextTunnelId)
+{
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelTenantNextGet);
+  rv = ofdpaMockTunnelNextGet(&ofdpaMockTenants, tunnelId, nextTunnelId, OFDPA_E_FAIL);
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* Next hops */
+
+OFDPA_ERROR_t ofdpaTunnelNextHopCreate(uint32_t nextHopId, ofdpaTunnelNextHopConfig_t *config)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv;
+
+  if (config == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelNextHopCreate);
+  if (!ofdpaMockPortValid(config->physicalPortNum))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if ((rv = ofdpaMockTunnelObjAdd(&ofdpaMockNextHops, nextHopId, &obj)) == OFDPA_E_NONE)
+  {
+    obj->config.nextHop = *config;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelNextHopDelete(uint32_t nextHopId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelNextHopDelete);
+  obj = ofdpaMockIdFind(&ofdpaMockNextHops, nextHopId);
+  if (obj == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (obj->refCount > 0)
+  {
+    rv = OFDPA_E_FAIL;
+  }
+  else
+  {
+    ofdpaMockIdRemove(&ofdpaMockNextHops, nextHopId);
+    free(obj);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelNextHopModify(uint32_t nextHopId, ofdpaTunnelNextHopConfig_t *config)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+
+  if (config == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelNextHopModify);
+  obj = ofdpaMockIdFind(&ofdpaMockNextHops, nextHopId);
+  if (obj == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (!ofdpaMockPortValid(config->physicalPortNum) ||
+           (config->dstAddr.addr[0] & 1) != (obj->config.nextHop.dstAddr.addr[0] & 1))
+  {
+    /* The destination cannot change between unicast and multicast */
+    rv = OFDPA_E_ERROR;
+  }
+  else
+  {
+    obj->config.nextHop = *config;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelNextHopGet(uint32_t nextHopId,
+                                    ofdpaTunnelNextHopConfig_t *config,
+                                    ofdpaTunnelNextHopStatus_t *status)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelNextHopGet);
+  obj = ofdpaMockIdFind(&ofdpaMockNextHops, nextHopId);
+  if (obj != NULL)
+  {
+    if (config != NULL)
+    {
+      *config = obj->config.nextHop;
+    }
+    if (status != NULL)
+    {
+      status->refCount = obj->refCount;
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelNextHopNextGet(uint32_t nextHopId, uint32_t *nextNextHopId)
+{
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelNextHopNextGet);
+  rv = ofdpaMockTunnelNextGet(&ofdpaMockNextHops, nextHopId, nextNextHopId, OFDPA_E_FAIL);
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+/*------------------------------------------------------------------------------------*/
+/* ECMP next hop groups */
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupCreate(uint32_t ecmpNextHopGroupId, ofdpaTunnelEcmpNextHopGroupConfig_t *config)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv;
+
+  if (config == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupCreate);
+  rv = ofdpaMockTunnelObjAdd(&ofdpaMockEcmpGroups, ecmpNextHopGroupId, &obj);
+  if (rv == OFDPA_E_NONE)
+  {
+    obj->config.ecmp = *config;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupDelete(uint32_t ecmpNextHopGroupId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NONE;
+  uint32_t i;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupDelete);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopGroupId);
+  if (obj == NULL)
+  {
+    rv = OFDPA_E_NOT_FOUND;
+  }
+  else if (obj->refCount > 0)
+  {
+    rv = OFDPA_E_FAIL;
+  }
+  else
+  {
+    for (i = 0; i < obj->members.count; i++)
+    {
+      ofdpaMockTunnelObjRef(&ofdpaMockNextHops, obj->members.entries[i].id, -1);
+    }
+    ofdpaMockIdRemove(&ofdpaMockEcmpGroups, ecmpNextHopGroupId);
+    ofdpaMockIdTableFree(&obj->members);
+    free(obj);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupGet(uint32_t ecmpNextHopGroupId,
+                                             ofdpaTunnelEcmpNextHopGroupConfig_t *config,
+                                             ofdpaTunnelEcmpNextHopGroupStatus_t *status)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupGet);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopGroupId);
+  if (obj != NULL)
+  {
+    if (config != NULL)
+    {
+      *config = obj->config.ecmp;
+    }
+    if (status != NULL)
+    {
+      status->refCount = obj->refCount;
+      status->memberCount = obj->members.count;
+    }
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupNextGet(uint32_t ecmpNextHopGroupId, uint32_t *nextEcmpNextHopGroupId)
+{
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupNextGet);
+  rv = ofdpaMockTunnelNextGet(&ofdpaMockEcmpGroups, ecmpNextHopGroupId, nextEcmpNextHopGroupId, OFDPA_E_FAIL);
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupMaxMembersGet(uint32_t *maxMemberCount)
+{
+  if (maxMemberCount == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupMaxMembersGet);
+  *maxMemberCount = OFDPA_MOCK_ECMP_MEMBERS_MAX;
+  OFDPA_MOCK_EXIT();
+  return OFDPA_E_NONE;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupMemberAdd(uint32_t ecmpNextHopGroupId, uint32_t nextHopId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupMemberAdd);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopGroupId);
+  if (obj == NULL || !ofdpaMockIdExists(&ofdpaMockNextHops, nextHopId))
+  {
+    rv = OFDPA_E_ERROR;
+  }
+  else if (ofdpaMockIdExists(&obj->members, nextHopId))
+  {
+    rv = OFDPA_E_EXISTS;
+  }
+  else if (obj->members.count >= OFDPA_MOCK_ECMP_MEMBERS_MAX)
+  {
+    rv = OFDPA_E_FULL;
+  }
+  else if ((rv = ofdpaMockIdInsert(&obj->members, nextHopId, NULL)) == OFDPA_E_NONE)
+  {
+    ofdpaMockTunnelObjRef(&ofdpaMockNextHops, nextHopId, 1);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupMemberDelete(uint32_t ecmpNextHopGroupId, uint32_t nextHopId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupMemberDelete);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopGroupId);
+  if (obj != NULL && ofdpaMockIdExists(&obj->members, nextHopId))
+  {
+    ofdpaMockIdRemove(&obj->members, nextHopId);
+    ofdpaMockTunnelObjRef(&ofdpaMockNextHops, nextHopId, -1);
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupMemberGet(uint32_t ecmpNextHopListGroupId, uint32_t nextHopId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupMemberGet);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopListGroupId);
+  if (obj != NULL && ofdpaMockIdExists(&obj->members, nextHopId))
+  {
+    rv = OFDPA_E_NONE;
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}
+
+OFDPA_ERROR_t ofdpaTunnelEcmpNextHopGroupMemberNextGet(uint32_t ecmpNextHopListGroupId, uint32_t nextHopId, uint32_t *nextNextHopId)
+{
+  ofdpaMockTunnelObj_t *obj;
+  OFDPA_ERROR_t rv = OFDPA_E_NOT_FOUND;
+
+  if (nextNextHopId == NULL)
+  {
+    return OFDPA_E_PARAM;
+  }
+
+  OFDPA_MOCK_ENTER(ofdpaTunnelEcmpNextHopGroupMemberNextGet);
+  obj = ofdpaMockIdFind(&ofdpaMockEcmpGroups, ecmpNextHopListGroupId);
+  if (obj != NULL)
+  {
+    rv = ofdpaMockTunnelNextGet(&obj->members, nextHopId, nextNextHopId, OFDPA_E_NOT_FOUND);
+  }
+  OFDPA_MOCK_EXIT();
+  return rv;
+}